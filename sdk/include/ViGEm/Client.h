@@ -61,14 +61,16 @@ extern "C" {
         VIGEM_ERROR_BUS_INVALID_HANDLE = 0xE0000013,
         VIGEM_ERROR_XUSB_USERINDEX_OUT_OF_RANGE = 0xE0000014,
 		VIGEM_ERROR_INVALID_PARAMETER = 0xE0000015,
-    	VIGEM_ERROR_NOT_SUPPORTED = 0xE0000016
+    	VIGEM_ERROR_NOT_SUPPORTED = 0xE0000016,
+        VIGEM_ERROR_QUEUE_FULL = 0xE0000017,
+        VIGEM_ERROR_TIMED_OUT = 0xE0000018
 
     } VIGEM_ERROR;
 
 /**
  * A macro that defines if the API succeeded
  *
- * @author	Benjamin "Nefarius" Hglinger-Stelzer
+ * @author	Benjamin "Nefarius" Höglinger-Stelzer
  * @date	01.09.2020
  *
  * @param 	_val_	The error value.
@@ -81,6 +83,23 @@ extern "C" {
     /** Defines an alias representing a target device object */
     typedef struct _VIGEM_TARGET_T *PVIGEM_TARGET;
 
+    /** Defines an alias representing an input transform object */
+    typedef struct _VIGEM_TRANSFORM_T *PVIGEM_TRANSFORM;
+
+    /** Analog inputs an input transform can shape */
+    typedef enum _VIGEM_TRANSFORM_AXIS
+    {
+        VIGEM_TRANSFORM_AXIS_LEFT_X,
+        VIGEM_TRANSFORM_AXIS_LEFT_Y,
+        VIGEM_TRANSFORM_AXIS_RIGHT_X,
+        VIGEM_TRANSFORM_AXIS_RIGHT_Y,
+        VIGEM_TRANSFORM_AXIS_LEFT_TRIGGER,
+        VIGEM_TRANSFORM_AXIS_RIGHT_TRIGGER,
+
+        VIGEM_TRANSFORM_AXIS_COUNT
+
+    } VIGEM_TRANSFORM_AXIS;
+
     typedef
         _Function_class_(EVT_VIGEM_TARGET_ADD_RESULT)
         VOID CALLBACK
@@ -123,7 +142,7 @@ extern "C" {
     /**
      *  Allocates an object representing a driver connection
      *
-     * @author	Benjamin "Nefarius" Hglinger-Stelzer
+     * @author	Benjamin "Nefarius" Höglinger-Stelzer
      * @date	28.08.2017
      *
      * @returns	A PVIGEM_CLIENT object.
@@ -133,7 +152,7 @@ extern "C" {
     /**
      * Frees up memory used by the driver connection object
      *
-     * @author	Benjamin "Nefarius" Hglinger-Stelzer
+     * @author	Benjamin "Nefarius" Höglinger-Stelzer
      * @date	28.08.2017
      *
      * @param 	vigem	The PVIGEM_CLIENT object.
@@ -144,7 +163,7 @@ extern "C" {
      * Initializes the driver object and establishes a connection to the emulation bus
      *          driver. Returns an error if no compatible bus device has been found.
      *
-     * @author	Benjamin "Nefarius" Hglinger-Stelzer
+     * @author	Benjamin "Nefarius" Höglinger-Stelzer
      * @date	28.08.2017
      *
      * @param 	vigem	The PVIGEM_CLIENT object.
@@ -159,7 +178,7 @@ extern "C" {
      *           still be connected will be destroyed automatically. Be aware, that allocated target
      *           objects won't be automatically freed, this has to be taken care of by the caller.
      *
-     * @author	Benjamin "Nefarius" Hglinger-Stelzer
+     * @author	Benjamin "Nefarius" Höglinger-Stelzer
      * @date	28.08.2017
      *
      * @param 	vigem	The PVIGEM_CLIENT object.
@@ -169,7 +188,7 @@ extern "C" {
     /**
      * Allocates an object representing an Xbox 360 Controller device.
      *
-     * @author	Benjamin "Nefarius" Hglinger-Stelzer
+     * @author	Benjamin "Nefarius" Höglinger-Stelzer
      * @date	28.08.2017
      *
      * @returns	A PVIGEM_TARGET representing an Xbox 360 Controller device.
@@ -179,7 +198,7 @@ extern "C" {
     /**
      * Allocates an object representing a DualShock 4 Controller device.
      *
-     * @author	Benjamin "Nefarius" Hglinger-Stelzer
+     * @author	Benjamin "Nefarius" Höglinger-Stelzer
      * @date	28.08.2017
      *
      * @returns	A PVIGEM_TARGET representing a DualShock 4 Controller device.
@@ -192,7 +211,7 @@ extern "C" {
      *          removed before this call, the device becomes orphaned until the owning process is
      *          terminated.
      *
-     * @author	Benjamin "Nefarius" Hglinger-Stelzer
+     * @author	Benjamin "Nefarius" Höglinger-Stelzer
      * @date	28.08.2017
      *
      * @param 	target	The target device object.
@@ -204,7 +223,7 @@ extern "C" {
      *          event of a physical hardware device. This function blocks until the target device is
      *          in full operational mode.
      *
-     * @author	Benjamin "Nefarius" Hglinger-Stelzer
+     * @author	Benjamin "Nefarius" Höglinger-Stelzer
      * @date	28.08.2017
      *
      * @param 	vigem 	The driver connection object.
@@ -220,7 +239,7 @@ extern "C" {
      *          callback may be registered which gets called on error or if the target device has
      *          become fully operational.
      *
-     * @author	Benjamin "Nefarius" Hglinger-Stelzer
+     * @author	Benjamin "Nefarius" Höglinger-Stelzer
      * @date	28.08.2017
      *
      * @param 	vigem 	The driver connection object.
@@ -237,7 +256,7 @@ extern "C" {
      *           after this function is called. If this function is never called on target device
      *           objects, they will be removed from the bus when the owning process terminates.
      *
-     * @author	Benjamin "Nefarius" Hglinger
+     * @author	Benjamin "Nefarius" Höglinger
      * @date	28.08.2017
      *
      * @param 	vigem 	The driver connection object.
@@ -252,7 +271,7 @@ extern "C" {
      *                 occur on the provided target device. This function fails if the provided
      *                 target device isn't fully operational or in an erroneous state.
      *
-     * @author	Benjamin "Nefarius" Hglinger
+     * @author	Benjamin "Nefarius" Höglinger
      * @date	28.08.2017
      *
      * @param 	vigem			The driver connection object.
@@ -269,7 +288,7 @@ extern "C" {
      *                 occur on the provided target device. This function fails if the provided
      *                 target device isn't fully operational or in an erroneous state.
      *
-     * @author	Benjamin "Nefarius" Hglinger
+     * @author	Benjamin "Nefarius" Höglinger
      * @date	28.08.2017
      *
      * @param 	vigem			The driver connection object.
@@ -284,7 +303,7 @@ extern "C" {
     /**
      * Removes a previously registered callback function from the provided target object.
      *
-     * @author	Benjamin "Nefarius" Hglinger
+     * @author	Benjamin "Nefarius" Höglinger
      * @date	28.08.2017
      *
      * @param 	target	The target device object.
@@ -294,7 +313,7 @@ extern "C" {
     /**
      * Removes a previously registered callback function from the provided target object.
      *
-     * @author	Benjamin "Nefarius" Hglinger
+     * @author	Benjamin "Nefarius" Höglinger
      * @date	28.08.2017
      *
      * @param 	target	The target device object.
@@ -304,7 +323,7 @@ extern "C" {
     /**
      * Overrides the default Vendor ID value with the provided one.
      *
-     * @author	Benjamin "Nefarius" Hglinger
+     * @author	Benjamin "Nefarius" Höglinger
      * @date	28.08.2017
      *
      * @param 	target	The target device object.
@@ -315,7 +334,7 @@ extern "C" {
     /**
      * Overrides the default Product ID value with the provided one.
      *
-     * @author	Benjamin "Nefarius" Hglinger
+     * @author	Benjamin "Nefarius" Höglinger
      * @date	28.08.2017
      *
      * @param 	target	The target device object.
@@ -326,7 +345,7 @@ extern "C" {
     /**
      * Returns the Vendor ID of the provided target device object.
      *
-     * @author	Benjamin "Nefarius" Hglinger
+     * @author	Benjamin "Nefarius" Höglinger
      * @date	28.08.2017
      *
      * @param 	target	The target device object.
@@ -338,7 +357,7 @@ extern "C" {
     /**
      * Returns the Product ID of the provided target device object.
      *
-     * @author	Benjamin "Nefarius" Hglinger
+     * @author	Benjamin "Nefarius" Höglinger
      * @date	28.08.2017
      *
      * @param 	target	The target device object.
@@ -347,10 +366,84 @@ extern "C" {
      */
     VIGEM_API USHORT vigem_target_get_pid(PVIGEM_TARGET target);
 
+    /**
+     * Overrides the polling interval (bInterval, in milliseconds) the target advertises on its
+     * interrupt endpoints. Has to be set before the target is added, zero keeps the default.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	target  	The target device object.
+     * @param 	interval	The polling interval in milliseconds, zero for the device default.
+     */
+    VIGEM_API void vigem_target_set_polling_interval(PVIGEM_TARGET target, UCHAR interval);
+
+    /**
+     * Returns the polling interval override of the provided target device object.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	target	The target device object.
+     *
+     * @returns	The polling interval in milliseconds, zero if the device default is used.
+     */
+    VIGEM_API UCHAR vigem_target_get_polling_interval(PVIGEM_TARGET target);
+
+    /**
+     * Sets how many output reports (rumble, lightbar, ...) the bus keeps queued until the
+     * notification callback picks them up. Has to be set before the target is added, zero
+     * keeps the default. The buffers are only allocated once a notification is registered.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	target	The target device object.
+     * @param 	count 	The number of buffered output reports, zero for the default.
+     */
+    VIGEM_API void vigem_target_set_output_buffer_count(PVIGEM_TARGET target, USHORT count);
+
+    /**
+     * Lets the bus serve the Xbox 360 boot handshake in as few transfers as the host buffers
+     * fit, shortening the time until the first report is delivered. Has to be set before the
+     * target is added. Has no effect on other target types.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	target 	The target device object.
+     * @param 	enabled	TRUE to enable the fast boot sequence.
+     */
+    VIGEM_API void vigem_target_set_fast_boot(PVIGEM_TARGET target, BOOL enabled);
+
+    /**
+     * By default the bus drops output (rumble, LED, lightbar) transfers that repeat the previous
+     * one, so notification callbacks only fire on changes. Enable this to receive every transfer
+     * the host sends. Has to be set before the target is added.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	target 	The target device object.
+     * @param 	enabled	TRUE to deliver duplicate output transfers.
+     */
+    VIGEM_API void vigem_target_set_keep_duplicate_output(PVIGEM_TARGET target, BOOL enabled);
+
+    /**
+     * Lets the bus fill wTimestamp, the report counter in the upper bits of bSpecial and the
+     * touch packet counter of DualShock 4 reports whenever one is handed to the host, so
+     * unchanged reports don't have to be resubmitted just to advance them. Values supplied
+     * for those fields are overwritten. Has to be set before the target is added. Has no
+     * effect on other target types.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	target 	The target device object.
+     * @param 	enabled	TRUE to have the bus maintain the counters.
+     */
+    VIGEM_API void vigem_target_set_driver_counters(PVIGEM_TARGET target, BOOL enabled);
+
     /**
      * Sends a state report to the provided target device.
+     * With drivers handing out target tokens, DualShock 4 targets accept it as well; the bus
+     * translates it to their format.
      *
-     * @author	Benjamin "Nefarius" Hglinger
+     * @author	Benjamin "Nefarius" Höglinger
      * @date	28.08.2017
      *
      * @param 	vigem 	The driver connection object.
@@ -363,8 +456,10 @@ extern "C" {
 
     /**
      * Sends a state report to the provided target device.
+     * With drivers handing out target tokens, Xbox 360 targets accept it as well; the bus
+     * translates it to their format.
      *
-     * @author	Benjamin "Nefarius" Hglinger
+     * @author	Benjamin "Nefarius" Höglinger
      * @date	28.08.2017
      *
      * @param 	vigem 	The driver connection object.
@@ -378,7 +473,7 @@ extern "C" {
     /**
      * Sends a full size state report to the provided target device.
      *
-     * @author	Benjamin "Nefarius" Hglinger-Stelzer
+     * @author	Benjamin "Nefarius" Höglinger-Stelzer
      * @date	07.09.2020
      *
      * @param 	vigem 	The driver connection object.
@@ -389,6 +484,41 @@ extern "C" {
      */
     VIGEM_API VIGEM_ERROR vigem_target_ds4_update_ex(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, DS4_REPORT_EX report);
 
+    /**
+     * Sends only the selected fields of a full size state report to the provided target
+     * device, the remaining fields keep the values of the previously submitted report.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	vigem	 	The driver connection object.
+     * @param 	target   	The target device object.
+     * @param 	fieldMask	Combination of DS4_PARTIAL_FIELD_* flags, DS4_PARTIAL_REPORT_DIFF
+     * 						yields the fields which differ between two reports.
+     * @param 	report   	The report buffer, only fields selected by fieldMask are sent.
+     *
+     * @returns	A VIGEM_ERROR. VIGEM_ERROR_NOT_SUPPORTED if the driver doesn't offer partial reports.
+     */
+    VIGEM_API VIGEM_ERROR vigem_target_ds4_update_fields(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, ULONG fieldMask, DS4_REPORT_EX report);
+
+    /**
+     * Streams timestamped gyroscope and accelerometer samples to the provided target device.
+     * Each host poll carries the motion interpolated at its time minus the delay, so samples
+     * may be produced at any rate. While samples keep coming the motion fields of regular
+     * reports are overridden; after the stream runs dry the last sample is held briefly.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	vigem  	The driver connection object.
+     * @param 	target 	The target device object.
+     * @param 	samples	The samples in ascending order of their QueryPerformanceCounter timestamps.
+     * @param 	count  	Number of samples, larger batches are split up.
+     * @param 	delay  	Playout delay in microseconds, samples arriving later are skipped.
+     * 					0 selects the default of 10 milliseconds.
+     *
+     * @returns	A VIGEM_ERROR. VIGEM_ERROR_NOT_SUPPORTED if the driver doesn't offer motion streams.
+     */
+    VIGEM_API VIGEM_ERROR vigem_target_ds4_stream_motion(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, const DS4_IMU_SAMPLE* samples, ULONG count, ULONG delay);
+
     /**
      * Returns the internal index (serial number) the bus driver assigned to the provided
      *               target device object. Note that this value is specific to the inner workings of
@@ -398,7 +528,7 @@ extern "C" {
      *               device is removed from the bus and may change on the next addition of the
      *               device.
      *
-     * @author	Benjamin "Nefarius" Hglinger
+     * @author	Benjamin "Nefarius" Höglinger
      * @date	28.08.2017
      *
      * @param 	target	The target device object.
@@ -410,7 +540,7 @@ extern "C" {
     /**
      * Returns the type of the provided target device object.
      *
-     * @author	Benjamin "Nefarius" Hglinger
+     * @author	Benjamin "Nefarius" Höglinger
      * @date	28.08.2017
      *
      * @param 	target	The target device object.
@@ -423,7 +553,7 @@ extern "C" {
      * Returns TRUE if the provided target device object is currently attached to the bus,
      *              FALSE otherwise.
      *
-     * @author	Benjamin "Nefarius" Hglinger
+     * @author	Benjamin "Nefarius" Höglinger
      * @date	30.08.2017
      *
      * @param 	target	The target device object.
@@ -438,7 +568,7 @@ extern "C" {
      *                physical controller and is compatible to the dwUserIndex property of the
      *                XInput* APIs.
      *
-     * @author	Benjamin "Nefarius" Hglinger
+     * @author	Benjamin "Nefarius" Höglinger
      * @date	10.05.2018
      *
      * @param 	vigem 	The driver connection object.
@@ -449,6 +579,455 @@ extern "C" {
      */
     VIGEM_API VIGEM_ERROR vigem_target_x360_get_user_index(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, PULONG index);
 
+    /**
+     * Queues a state report for delivery to the provided Xbox 360 target device once the
+     *              performance counter reaches dueTime. Reports are delivered in due time order
+     *              with the next interrupt transfer the host issues after that point.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	vigem  	The driver connection object.
+     * @param 	target 	The target device object.
+     * @param 	report 	The report to send to the target device.
+     * @param 	dueTime	Absolute QueryPerformanceCounter value the report is due at.
+     *
+     * @returns	A VIGEM_ERROR. VIGEM_ERROR_QUEUE_FULL if too many reports are pending.
+     */
+    VIGEM_API VIGEM_ERROR vigem_target_x360_update_scheduled(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, XUSB_REPORT report, LONGLONG dueTime);
+
+    /**
+     * Queues a full size state report for delivery to the provided DualShock 4 target device
+     *              once the performance counter reaches dueTime.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	vigem  	The driver connection object.
+     * @param 	target 	The target device object.
+     * @param 	report 	The report buffer.
+     * @param 	dueTime	Absolute QueryPerformanceCounter value the report is due at.
+     *
+     * @returns	A VIGEM_ERROR. VIGEM_ERROR_QUEUE_FULL if too many reports are pending.
+     */
+    VIGEM_API VIGEM_ERROR vigem_target_ds4_update_ex_scheduled(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, DS4_REPORT_EX report, LONGLONG dueTime);
+
+    /**
+     * Stages a state report for the provided Xbox 360 target device. The report is not
+     *              visible to the host until vigem_commit_frame gets called on the same
+     *              driver connection object. Staging again before the commit replaces it.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	vigem 	The driver connection object.
+     * @param 	target	The target device object.
+     * @param 	report	The report to stage.
+     *
+     * @returns	A VIGEM_ERROR.
+     */
+    VIGEM_API VIGEM_ERROR vigem_target_x360_stage(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, XUSB_REPORT report);
+
+    /**
+     * Stages a full size state report for the provided DualShock 4 target device. The report
+     *              is not visible to the host until vigem_commit_frame gets called on the same
+     *              driver connection object.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	vigem 	The driver connection object.
+     * @param 	target	The target device object.
+     * @param 	report	The report to stage.
+     *
+     * @returns	A VIGEM_ERROR.
+     */
+    VIGEM_API VIGEM_ERROR vigem_target_ds4_stage_ex(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, DS4_REPORT_EX report);
+
+    /**
+     * Makes all reports staged on this driver connection object visible at once. Every
+     *              interrupt transfer the host completes afterwards observes either none or
+     *              all of them.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	vigem      	The driver connection object.
+     * @param 	targetCount	Optional. Receives the number of targets updated by the commit.
+     *
+     * @returns	A VIGEM_ERROR.
+     */
+    VIGEM_API VIGEM_ERROR vigem_commit_frame(PVIGEM_CLIENT vigem, PULONG targetCount);
+
+    /**
+     * Blocks until the host has an interrupt transfer pending on the provided target device,
+     *              returns immediately if one is already waiting. Calling this right before
+     *              each update submits the report just in time for the next host poll.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	vigem       	The driver connection object.
+     * @param 	target      	The target device object.
+     * @param 	milliseconds	Time-out interval, INFINITE to wait forever.
+     * @param 	pollInterval	Optional. Receives the last measured host poll interval in
+     *                      	microseconds (0 if not known yet).
+     *
+     * @returns	A VIGEM_ERROR. VIGEM_ERROR_TIMED_OUT if the host didn't poll in time.
+     */
+    VIGEM_API VIGEM_ERROR vigem_target_await_poll(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, DWORD milliseconds, PULONG pollInterval);
+
+    /**
+     * Retrieves how often the host actually polls the provided target device. Feeders can use
+     *              AverageInterval to pick an update rate matching the consumption rate.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	vigem	  	The driver connection object.
+     * @param 	target	  	The target device object.
+     * @param 	statistics	Receives the polling statistics.
+     *
+     * @returns	A VIGEM_ERROR.
+     */
+    VIGEM_API VIGEM_ERROR vigem_target_get_poll_statistics(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, PVIGEM_POLL_STATISTICS statistics);
+
+    /**
+     * Retrieves how much non-paged memory the provided target device occupies on the bus.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	vigem	  	The driver connection object.
+     * @param 	target	  	The target device object.
+     * @param 	statistics	Receives the memory statistics.
+     *
+     * @returns	A VIGEM_ERROR.
+     */
+    VIGEM_API VIGEM_ERROR vigem_target_get_memory_statistics(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, PVIGEM_MEMORY_STATISTICS statistics);
+
+    /**
+     * Retrieves when the provided target device reached each boot phase, from plug-in until
+     *              the first input report was handed to the host.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	vigem   	The driver connection object.
+     * @param 	target  	The target device object.
+     * @param 	timeline	Receives the boot timeline.
+     *
+     * @returns	A VIGEM_ERROR.
+     */
+    VIGEM_API VIGEM_ERROR vigem_target_get_boot_timeline(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, PVIGEM_BOOT_TIMELINE timeline);
+
+    /**
+     * Retrieves how many output transfers the host sent to the provided target device and how
+     *              many of them got dropped as duplicates.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	vigem	  	The driver connection object.
+     * @param 	target	  	The target device object.
+     * @param 	statistics	Receives the output statistics.
+     *
+     * @returns	A VIGEM_ERROR.
+     */
+    VIGEM_API VIGEM_ERROR vigem_target_get_output_statistics(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, PVIGEM_OUTPUT_STATISTICS statistics);
+
+    /**
+     * Keeps the provided target device plugged in for a grace period after the driver connection
+     *              got closed (e.g. the feeder crashed or restarted), so the game doesn't see the
+     *              controller vanish. Calling it again updates the grace period.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	vigem	   	The driver connection object.
+     * @param 	target	   	The target device object.
+     * @param 	gracePeriod	Time in milliseconds the target waits to be reclaimed (at most 60000).
+     * @param 	leaseKey   	Receives the key to pass to vigem_target_reclaim, keep it across restarts.
+     *
+     * @returns	A VIGEM_ERROR.
+     */
+    VIGEM_API VIGEM_ERROR vigem_target_grant_lease(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, DWORD gracePeriod, PULONG leaseKey);
+
+    /**
+     * Takes over a leased target device left behind by a closed driver connection instead of
+     *              adding a new one. The target type is updated to the one of the leased device.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	vigem   	The driver connection object.
+     * @param 	target  	An allocated, not yet added target device object.
+     * @param 	leaseKey	The key obtained via vigem_target_grant_lease.
+     *
+     * @returns	A VIGEM_ERROR. VIGEM_ERROR_TARGET_NOT_PLUGGED_IN if the lease expired or is unknown.
+     */
+    VIGEM_API VIGEM_ERROR vigem_target_reclaim(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, ULONG leaseKey);
+
+    /**
+     * Issues a single use ticket another process can use to take over the provided target device
+     *              without unplugging it. Once claimed, the issuing side should only free its target
+     *              object via vigem_target_free, not remove it. Issuing again invalidates the previous ticket.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	vigem 	The driver connection object.
+     * @param 	target	The target device object.
+     * @param 	ticket	Receives the ticket to hand over to the recipient process.
+     *
+     * @returns	A VIGEM_ERROR.
+     */
+    VIGEM_API VIGEM_ERROR vigem_target_issue_transfer_ticket(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, PULONG ticket);
+
+    /**
+     * Takes over a target device owned by another process that issued a transfer ticket for it. The
+     *              device stays plugged in, the game sees no change. The target type is updated to the
+     *              one of the transferred device.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	vigem 	The driver connection object.
+     * @param 	target	An allocated, not yet added target device object.
+     * @param 	ticket	The ticket obtained via vigem_target_issue_transfer_ticket.
+     *
+     * @returns	A VIGEM_ERROR.
+     */
+    VIGEM_API VIGEM_ERROR vigem_target_claim_transfer(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, ULONG ticket);
+
+    /**
+     * Allows other processes to feed reports into the provided target device alongside its owner.
+     *              The driver combines the latest report of every writer: buttons are OR'ed, axes
+     *              follow the given policy. Calling it again updates policy and priority and hands
+     *              out a new key; writers already attached stay.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	vigem		 	The driver connection object.
+     * @param 	target		 	The target device object.
+     * @param 	policy		 	How axes of different writers get combined.
+     * @param 	ownerPriority	Priority of the owner's reports under VigemFusionPolicyPriority (higher wins).
+     * @param 	writerKey	 	Receives the key to hand over to vigem_target_attach_writer callers.
+     *
+     * @returns	A VIGEM_ERROR.
+     */
+    VIGEM_API VIGEM_ERROR vigem_target_enable_input_fusion(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, VIGEM_FUSION_POLICY policy, UCHAR ownerPriority, PULONG writerKey);
+
+    /**
+     * Binds an allocated target device object to a target owned by another process as an additional
+     *              writer. Reports submitted via vigem_target_x360_update or vigem_target_ds4_update(_ex)
+     *              get combined with the ones of the owner. Up to three writers can be attached at a time.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	vigem	 	The driver connection object.
+     * @param 	target   	An allocated, not yet added target device object.
+     * @param 	serialNo 	Serial number of the target to write to.
+     * @param 	writerKey	The key obtained via vigem_target_enable_input_fusion.
+     * @param 	priority 	Priority of this writer's reports under VigemFusionPolicyPriority (higher wins).
+     *
+     * @returns	A VIGEM_ERROR.
+     */
+    VIGEM_API VIGEM_ERROR vigem_target_attach_writer(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, ULONG serialNo, ULONG writerKey, UCHAR priority);
+
+    /**
+     * Stops a target device object attached via vigem_target_attach_writer from contributing reports.
+     *              Closing the driver connection has the same effect.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	vigem 	The driver connection object.
+     * @param 	target	The target device object attached as writer.
+     *
+     * @returns	A VIGEM_ERROR.
+     */
+    VIGEM_API VIGEM_ERROR vigem_target_detach_writer(PVIGEM_CLIENT vigem, PVIGEM_TARGET target);
+
+    /**
+     * Binds an allocated target device object to a target owned by another process as a read-only
+     *              subscriber of its rumble and LED notifications. The owner's own notifications are
+     *              not affected. Closing the driver connection ends the subscription.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	vigem	 	The driver connection object.
+     * @param 	target   	An allocated, not yet added target device object.
+     * @param 	serialNo 	Serial number of the target to subscribe to.
+     * @param 	accessKey	Lease key or transfer ticket handed out by the owner, 0 if the caller
+     * 						owns the target itself.
+     *
+     * @returns	A VIGEM_ERROR. VIGEM_ERROR_INVALID_TARGET if the key isn't accepted.
+     */
+    VIGEM_API VIGEM_ERROR vigem_target_subscribe(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, ULONG serialNo, ULONG accessKey);
+
+    /**
+     * Blocks until the next notification of a subscribed X360 target arrives.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	vigem	  	The driver connection object.
+     * @param 	target	  	A target device object bound via vigem_target_subscribe.
+     * @param 	largeMotor	Receives the large motor intensity. Can be NULL.
+     * @param 	smallMotor	Receives the small motor intensity. Can be NULL.
+     * @param 	ledNumber 	Receives the LED number. Can be NULL.
+     * @param 	dropped   	Receives the number of notifications skipped since the last call because
+     * 						this subscriber fell behind. Can be NULL.
+     *
+     * @returns	A VIGEM_ERROR.
+     */
+    VIGEM_API VIGEM_ERROR vigem_target_x360_await_notification(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, PUCHAR largeMotor, PUCHAR smallMotor, PUCHAR ledNumber, PULONG dropped);
+
+    /**
+     * Blocks until the next notification of a subscribed DS4 target arrives.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	vigem		 	The driver connection object.
+     * @param 	target		 	A target device object bound via vigem_target_subscribe.
+     * @param 	largeMotor	 	Receives the large motor intensity. Can be NULL.
+     * @param 	smallMotor	 	Receives the small motor intensity. Can be NULL.
+     * @param 	lightbarColor	Receives the lightbar color. Can be NULL.
+     * @param 	dropped		 	Receives the number of notifications skipped since the last call because
+     * 							this subscriber fell behind. Can be NULL.
+     *
+     * @returns	A VIGEM_ERROR.
+     */
+    VIGEM_API VIGEM_ERROR vigem_target_ds4_await_notification(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, PUCHAR largeMotor, PUCHAR smallMotor, PDS4_LIGHTBAR_COLOR lightbarColor, PULONG dropped);
+
+    /**
+     * Hands the driver a page it keeps updated with the latest rumble, LED and lightbar values of
+     *              every target of this connection. Afterwards the vigem_target_*_get_output_state
+     *              functions read them without a round trip to the driver. The page stays mapped until
+     *              vigem_disconnect or until the calling thread exits; call it again to re-map.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	vigem	The driver connection object.
+     *
+     * @returns	A VIGEM_ERROR.
+     */
+    VIGEM_API VIGEM_ERROR vigem_map_output_state(PVIGEM_CLIENT vigem);
+
+    /**
+     * Reads the latest rumble and LED values of an X360 target from the output state page. Returns
+     *              zero motor values and LED number 0xFF until the target received output.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	vigem	  	The driver connection object, mapped via vigem_map_output_state.
+     * @param 	target	  	The target device object.
+     * @param 	largeMotor	Receives the large motor intensity. Can be NULL.
+     * @param 	smallMotor	Receives the small motor intensity. Can be NULL.
+     * @param 	ledNumber 	Receives the LED number. Can be NULL.
+     *
+     * @returns	A VIGEM_ERROR.
+     */
+    VIGEM_API VIGEM_ERROR vigem_target_x360_get_output_state(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, PUCHAR largeMotor, PUCHAR smallMotor, PUCHAR ledNumber);
+
+    /**
+     * Reads the latest rumble and lightbar values of a DS4 target from the output state page.
+     *              Returns zero values until the target received output.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	vigem		 	The driver connection object, mapped via vigem_map_output_state.
+     * @param 	target		 	The target device object.
+     * @param 	largeMotor	 	Receives the large motor intensity. Can be NULL.
+     * @param 	smallMotor	 	Receives the small motor intensity. Can be NULL.
+     * @param 	lightbarColor	Receives the lightbar color. Can be NULL.
+     *
+     * @returns	A VIGEM_ERROR.
+     */
+    VIGEM_API VIGEM_ERROR vigem_target_ds4_get_output_state(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, PUCHAR largeMotor, PUCHAR smallMotor, PDS4_LIGHTBAR_COLOR lightbarColor);
+
+    /**
+     * Allocates an input transform object. A new transform passes reports through unchanged
+     *              until axes are shaped or buttons remapped.
+     *
+     * @date	19.10.2026
+     *
+     * @returns	A PVIGEM_TRANSFORM, NULL on allocation failure.
+     */
+    VIGEM_API PVIGEM_TRANSFORM vigem_transform_alloc(void);
+
+    /**
+     * Frees up memory used by the input transform object.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	transform	The input transform object.
+     */
+    VIGEM_API void vigem_transform_free(PVIGEM_TRANSFORM transform);
+
+    /**
+     * Shapes an analog input. Deflections up to the deadzone read as rest, deflections from
+     *              the saturation point on read as full and the range in between is rescaled
+     *              and raised to the exponent. Sticks are shaped per axis around their center;
+     *              for triggers the deadzone acts as the activation threshold.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	transform 	The input transform object.
+     * @param 	axis	  	The analog input to shape.
+     * @param 	deadzone  	Fraction of the full deflection read as rest, in [0, 1).
+     * @param 	saturation	Fraction of the full deflection read as full, in (deadzone, 1].
+     * @param 	exponent  	Response curve exponent, 1 is linear. Must be positive.
+     * @param 	invert	  	TRUE to mirror the axis.
+     *
+     * @returns	A VIGEM_ERROR.
+     */
+    VIGEM_API VIGEM_ERROR vigem_transform_set_axis(PVIGEM_TRANSFORM transform, VIGEM_TRANSFORM_AXIS axis, float deadzone, float saturation, float exponent, BOOL invert);
+
+    /**
+     * Remaps an Xbox 360 button. Remaps are applied to the reported state, so swapping two
+     *              buttons takes one call for each of them.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	transform	The input transform object.
+     * @param 	button   	The XUSB_BUTTON to remap.
+     * @param 	mapping  	The XUSB_BUTTON flags it reports as, 0 to suppress it.
+     *
+     * @returns	A VIGEM_ERROR.
+     */
+    VIGEM_API VIGEM_ERROR vigem_transform_remap_x360_button(PVIGEM_TRANSFORM transform, USHORT button, USHORT mapping);
+
+    /**
+     * Remaps a DualShock 4 button. The D-Pad is passed through unchanged and can neither be
+     *              remapped nor be a mapping target.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	transform	The input transform object.
+     * @param 	button   	The DS4_BUTTONS flag to remap.
+     * @param 	mapping  	The DS4_BUTTONS flags it reports as, 0 to suppress it.
+     *
+     * @returns	A VIGEM_ERROR.
+     */
+    VIGEM_API VIGEM_ERROR vigem_transform_remap_ds4_button(PVIGEM_TRANSFORM transform, USHORT button, USHORT mapping);
+
+    /**
+     * Runs the input transform over a batch of Xbox 360 reports in place, typically one per
+     *              target before they are staged. The transform is compiled into lookup tables
+     *              on first use after a change, so the same object must not be modified or
+     *              applied from another thread at the same time.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	transform	The input transform object.
+     * @param 	reports  	The reports to transform.
+     * @param 	count	 	Number of reports.
+     *
+     * @returns	A VIGEM_ERROR.
+     */
+    VIGEM_API VIGEM_ERROR vigem_transform_apply_x360(PVIGEM_TRANSFORM transform, PXUSB_REPORT reports, ULONG count);
+
+    /**
+     * Runs the input transform over a batch of DualShock 4 reports in place, typically one
+     *              per target before they are staged. Fields other than sticks, triggers and
+     *              wButtons are left untouched. Same threading rules as vigem_transform_apply_x360.
+     *
+     * @date	19.10.2026
+     *
+     * @param 	transform	The input transform object.
+     * @param 	reports  	The reports to transform.
+     * @param 	count	 	Number of reports.
+     *
+     * @returns	A VIGEM_ERROR.
+     */
+    VIGEM_API VIGEM_ERROR vigem_transform_apply_ds4(PVIGEM_TRANSFORM transform, PDS4_REPORT_EX reports, ULONG count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -253,4 +253,225 @@ typedef struct _DS4_REPORT_EX
 	};
 } DS4_REPORT_EX, *PDS4_REPORT_EX;
 
+//
+// DualShock 4 gyroscope and accelerometer reading
+//
+typedef struct _DS4_IMU_SAMPLE
+{
+    LONGLONG Timestamp; // QueryPerformanceCounter value of the reading
+    SHORT wGyroX;
+    SHORT wGyroY;
+    SHORT wGyroZ;
+    SHORT wAccelX;
+    SHORT wAccelY;
+    SHORT wAccelZ;
+} DS4_IMU_SAMPLE, *PDS4_IMU_SAMPLE;
+
 #include <poppack.h>
+
+//
+// Fields of a DS4_REPORT_EX a partial report can carry, in report order
+// 
+#define DS4_PARTIAL_FIELD_THUMBS        0x00000001  // bThumbLX, bThumbLY, bThumbRX, bThumbRY
+#define DS4_PARTIAL_FIELD_BUTTONS       0x00000002  // wButtons, bSpecial
+#define DS4_PARTIAL_FIELD_TRIGGERS      0x00000004  // bTriggerL, bTriggerR
+#define DS4_PARTIAL_FIELD_TIMESTAMP     0x00000008  // wTimestamp
+#define DS4_PARTIAL_FIELD_BATTERY       0x00000010  // bBatteryLvl
+#define DS4_PARTIAL_FIELD_GYRO          0x00000020  // wGyroX, wGyroY, wGyroZ
+#define DS4_PARTIAL_FIELD_ACCEL         0x00000040  // wAccelX, wAccelY, wAccelZ
+#define DS4_PARTIAL_FIELD_STATUS        0x00000080  // _bUnknown1, bBatteryLvlSpecial, _bUnknown2
+#define DS4_PARTIAL_FIELD_TOUCH         0x00000100  // bTouchPacketsN, sCurrentTouch, sPreviousTouch
+#define DS4_PARTIAL_FIELD_ALL           0x000001FF
+
+#define DS4_PARTIAL_FIELD_COUNT         9
+
+//
+// Byte offsets of the fields within DS4_REPORT_EX, the last entry ends the touch field.
+// 
+#define DS4_PARTIAL_FIELD_OFFSETS       { 0, 4, 7, 9, 11, 12, 18, 24, 32, 60 }
+
+C_ASSERT(FIELD_OFFSET(DS4_REPORT_EX, Report.wButtons) == 4);
+C_ASSERT(FIELD_OFFSET(DS4_REPORT_EX, Report.bTriggerL) == 7);
+C_ASSERT(FIELD_OFFSET(DS4_REPORT_EX, Report.wTimestamp) == 9);
+C_ASSERT(FIELD_OFFSET(DS4_REPORT_EX, Report.bBatteryLvl) == 11);
+C_ASSERT(FIELD_OFFSET(DS4_REPORT_EX, Report.wGyroX) == 12);
+C_ASSERT(FIELD_OFFSET(DS4_REPORT_EX, Report.wAccelX) == 18);
+C_ASSERT(FIELD_OFFSET(DS4_REPORT_EX, Report._bUnknown1) == 24);
+C_ASSERT(FIELD_OFFSET(DS4_REPORT_EX, Report.bTouchPacketsN) == 32);
+C_ASSERT(sizeof(((PDS4_REPORT_EX)0)->Report) == 60);
+
+//
+// Returns the DS4_PARTIAL_FIELD_* bits of the fields that differ between two reports.
+// 
+ULONG FORCEINLINE DS4_PARTIAL_REPORT_DIFF(
+    _In_ const DS4_REPORT_EX* Previous,
+    _In_ const DS4_REPORT_EX* Current
+)
+{
+    const UCHAR offsets[] = DS4_PARTIAL_FIELD_OFFSETS;
+    ULONG mask = 0;
+
+    for (ULONG field = 0; field < DS4_PARTIAL_FIELD_COUNT; field++)
+    {
+        if (!RtlEqualMemory(
+            &Previous->ReportBuffer[offsets[field]],
+            &Current->ReportBuffer[offsets[field]],
+            offsets[field + 1] - offsets[field]))
+        {
+            mask |= (1UL << field);
+        }
+    }
+
+    return mask;
+}
+
+//
+// Host polling rate of a target as observed by the bus, intervals in microseconds.
+// 
+typedef struct _VIGEM_POLL_STATISTICS
+{
+    //
+    // Time between the two most recent host transfers.
+    // 
+    ULONG LastInterval;
+
+    //
+    // Exponentially weighted moving average (1/8 weight per sample).
+    // 
+    ULONG AverageInterval;
+
+    //
+    // Shortest observed interval.
+    // 
+    ULONG MinimumInterval;
+
+    //
+    // Longest observed interval.
+    // 
+    ULONG MaximumInterval;
+
+    //
+    // Number of intervals measured.
+    // 
+    ULONG Count;
+
+} VIGEM_POLL_STATISTICS, *PVIGEM_POLL_STATISTICS;
+
+//
+// Non-paged memory held by a target on the bus, sizes in bytes.
+// 
+typedef struct _VIGEM_MEMORY_STATISTICS
+{
+    //
+    // Size of the target object itself.
+    // 
+    ULONG TargetSize;
+
+    //
+    // Number of output report buffers, zero until the first notification request.
+    // 
+    ULONG OutputBufferCount;
+
+    //
+    // Memory reserved for output report buffers.
+    // 
+    ULONG OutputBufferBytes;
+
+} VIGEM_MEMORY_STATISTICS, *PVIGEM_MEMORY_STATISTICS;
+
+//
+// Output (rumble, LED, lightbar) transfers the host sent to a target.
+// 
+typedef struct _VIGEM_OUTPUT_STATISTICS
+{
+    //
+    // Number of output transfers received.
+    // 
+    ULONG Received;
+
+    //
+    // Number of those dropped for repeating the previous one.
+    // 
+    ULONG Suppressed;
+
+} VIGEM_OUTPUT_STATISTICS, *PVIGEM_OUTPUT_STATISTICS;
+
+//
+// Milestones a target passes between plug-in and delivering the first input report.
+// 
+typedef enum _VIGEM_BOOT_PHASE
+{
+    //
+    // Target object created by the bus
+    // 
+    VigemBootPhasePlugIn = 0,
+    //
+    // PnP manager started the device
+    // 
+    VigemBootPhasePnpStart,
+    //
+    // Host selected the USB configuration
+    // 
+    VigemBootPhaseConfigurationSelected,
+    //
+    // XUSB only: init packets served on the data pipe
+    // 
+    VigemBootPhaseInitStage0,
+    VigemBootPhaseInitStage1,
+    VigemBootPhaseInitStage2,
+    VigemBootPhaseInitStage3,
+    VigemBootPhaseInitStage4,
+    VigemBootPhaseInitStage5,
+    //
+    // Host finished the boot sequence (LED set on XUSB), target accepts reports
+    // 
+    VigemBootPhaseReady,
+    //
+    // First input report handed to the host
+    // 
+    VigemBootPhaseFirstReport,
+
+    VigemBootPhaseMax
+
+} VIGEM_BOOT_PHASE, *PVIGEM_BOOT_PHASE;
+
+//
+// Boot timeline of a target as observed by the bus, times in microseconds since plug-in.
+// 
+typedef struct _VIGEM_BOOT_TIMELINE
+{
+    //
+    // Bit (1 << VIGEM_BOOT_PHASE) set for every phase reached so far.
+    // 
+    ULONG ReachedPhases;
+
+    //
+    // Time each phase was first reached, zero if not reached.
+    // 
+    ULONG PhaseTime[VigemBootPhaseMax];
+
+    //
+    // Number of data pipe transfers used to serve the init packets.
+    // 
+    ULONG InitTransfers;
+
+} VIGEM_BOOT_TIMELINE, *PVIGEM_BOOT_TIMELINE;
+
+//
+// How reports of several writers feeding the same target get combined.
+// Buttons are always OR'ed.
+// 
+typedef enum _VIGEM_FUSION_POLICY
+{
+    //
+    // Each axis (stick, trigger, D-Pad) follows the writer deflecting it the most
+    // 
+    VigemFusionPolicyMaxMagnitude = 0,
+    //
+    // Each axis follows the highest priority writer deflecting it
+    // 
+    VigemFusionPolicyPriority,
+
+    VigemFusionPolicyMax
+
+} VIGEM_FUSION_POLICY, *PVIGEM_FUSION_POLICY;
@@ -3,48 +3,204 @@
 #include "ViGEm/Common.h"
 #include <limits.h>
 
-VOID FORCEINLINE XUSB_TO_DS4_REPORT(
-    _Out_ PXUSB_REPORT Input,
+//
+// DS4 D-Pad (HAT) value for each combination of the XUSB D-Pad bits. Opposing 
+// directions resolve the way the former branching conversion did.
+// 
+UCHAR FORCEINLINE XUSB_TO_DS4_DPAD(
+    _In_ USHORT Buttons
+)
+{
+    static const UCHAR table[16] = { 8, 0, 4, 4, 6, 7, 5, 7, 2, 1, 3, 3, 6, 7, 5, 7 };
+
+    return table[Buttons & 0xF];
+}
+
+//
+// XUSB D-Pad bits for each DS4 D-Pad (HAT) value, out of range values are released.
+// 
+USHORT FORCEINLINE DS4_TO_XUSB_DPAD(
+    _In_ USHORT Buttons
+)
+{
+    static const UCHAR table[16] = { 0x1, 0x9, 0x8, 0xA, 0x2, 0x6, 0x4, 0x5, 0, 0, 0, 0, 0, 0, 0, 0 };
+
+    return table[Buttons & 0xF];
+}
+
+//
+// Moves a single bit of Value from bit position From to To.
+// 
+#define VIGEM_MOVE_BIT(Value, From, To)     ((((Value) >> (From)) & 1) << (To))
+
+//
+// Branch-free XUSB to DS4 translation, replaces all fields of Output.
+// 
+VOID FORCEINLINE XUSB_TO_DS4(
+    _In_ const XUSB_REPORT* Input,
     _Out_ PDS4_REPORT Output
 )
 {
-    if (Input->wButtons & XUSB_GAMEPAD_BACK) Output->wButtons |= DS4_BUTTON_SHARE;
-    if (Input->wButtons & XUSB_GAMEPAD_START) Output->wButtons |= DS4_BUTTON_OPTIONS;
-    if (Input->wButtons & XUSB_GAMEPAD_LEFT_THUMB) Output->wButtons |= DS4_BUTTON_THUMB_LEFT;
-    if (Input->wButtons & XUSB_GAMEPAD_RIGHT_THUMB) Output->wButtons |= DS4_BUTTON_THUMB_RIGHT;
-    if (Input->wButtons & XUSB_GAMEPAD_LEFT_SHOULDER) Output->wButtons |= DS4_BUTTON_SHOULDER_LEFT;
-    if (Input->wButtons & XUSB_GAMEPAD_RIGHT_SHOULDER) Output->wButtons |= DS4_BUTTON_SHOULDER_RIGHT;
-    if (Input->wButtons & XUSB_GAMEPAD_GUIDE) Output->bSpecial |= DS4_SPECIAL_BUTTON_PS;
-    if (Input->wButtons & XUSB_GAMEPAD_A) Output->wButtons |= DS4_BUTTON_CROSS;
-    if (Input->wButtons & XUSB_GAMEPAD_B) Output->wButtons |= DS4_BUTTON_CIRCLE;
-    if (Input->wButtons & XUSB_GAMEPAD_X) Output->wButtons |= DS4_BUTTON_SQUARE;
-    if (Input->wButtons & XUSB_GAMEPAD_Y) Output->wButtons |= DS4_BUTTON_TRIANGLE;
+    const USHORT buttons = Input->wButtons;
+    USHORT lx, ly, rx, ry;
+
+    Output->wButtons = (USHORT)(XUSB_TO_DS4_DPAD(buttons)
+        | VIGEM_MOVE_BIT(buttons, 14, 4)    // X -> Square
+        | VIGEM_MOVE_BIT(buttons, 12, 5)    // A -> Cross
+        | VIGEM_MOVE_BIT(buttons, 13, 6)    // B -> Circle
+        | VIGEM_MOVE_BIT(buttons, 15, 7)    // Y -> Triangle
+        | VIGEM_MOVE_BIT(buttons, 8, 8)     // Left shoulder
+        | VIGEM_MOVE_BIT(buttons, 9, 9)     // Right shoulder
+        | ((Input->bLeftTrigger != 0) << 10)
+        | ((Input->bRightTrigger != 0) << 11)
+        | VIGEM_MOVE_BIT(buttons, 5, 12)    // Back -> Share
+        | VIGEM_MOVE_BIT(buttons, 4, 13)    // Start -> Options
+        | VIGEM_MOVE_BIT(buttons, 6, 14)    // Left thumb
+        | VIGEM_MOVE_BIT(buttons, 7, 15));  // Right thumb
+
+    Output->bSpecial = (BYTE)VIGEM_MOVE_BIT(buttons, 10, 0); // Guide -> PS
 
     Output->bTriggerL = Input->bLeftTrigger;
     Output->bTriggerR = Input->bRightTrigger;
 
-    if (Input->bLeftTrigger > 0)Output->wButtons |= DS4_BUTTON_TRIGGER_LEFT;
-    if (Input->bRightTrigger > 0)Output->wButtons |= DS4_BUTTON_TRIGGER_RIGHT;
+    //
+    // XUSB Y axes point up, DS4 ones down. 0 maps to the 0x80 center; 
+    // the inverted range is 1..256 and gets saturated to 255.
+    // 
+    lx = (USHORT)((USHORT)Input->sThumbLX ^ 0x8000) >> 8;
+    rx = (USHORT)((USHORT)Input->sThumbRX ^ 0x8000) >> 8;
+    ly = (USHORT)((32768 - (LONG)Input->sThumbLY) >> 8);
+    ry = (USHORT)((32768 - (LONG)Input->sThumbRY) >> 8);
+
+    Output->bThumbLX = (BYTE)lx;
+    Output->bThumbLY = (BYTE)(ly - (ly >> 8));
+    Output->bThumbRX = (BYTE)rx;
+    Output->bThumbRY = (BYTE)(ry - (ry >> 8));
+}
+
+//
+// Branch-free DS4 to XUSB translation, replaces all fields of Output. 
+// The touchpad click has no XUSB counterpart and gets dropped.
+// 
+VOID FORCEINLINE DS4_TO_XUSB(
+    _In_ const DS4_REPORT* Input,
+    _Out_ PXUSB_REPORT Output
+)
+{
+    const USHORT buttons = Input->wButtons;
+
+    Output->wButtons = (USHORT)(DS4_TO_XUSB_DPAD(buttons)
+        | VIGEM_MOVE_BIT(buttons, 13, 4)    // Options -> Start
+        | VIGEM_MOVE_BIT(buttons, 12, 5)    // Share -> Back
+        | VIGEM_MOVE_BIT(buttons, 14, 6)    // Left thumb
+        | VIGEM_MOVE_BIT(buttons, 15, 7)    // Right thumb
+        | VIGEM_MOVE_BIT(buttons, 8, 8)     // Left shoulder
+        | VIGEM_MOVE_BIT(buttons, 9, 9)     // Right shoulder
+        | VIGEM_MOVE_BIT(Input->bSpecial, 0, 10) // PS -> Guide
+        | VIGEM_MOVE_BIT(buttons, 5, 12)    // Cross -> A
+        | VIGEM_MOVE_BIT(buttons, 6, 13)    // Circle -> B
+        | VIGEM_MOVE_BIT(buttons, 4, 14)    // Square -> X
+        | VIGEM_MOVE_BIT(buttons, 7, 15));  // Triangle -> Y
+
+    Output->bLeftTrigger = Input->bTriggerL;
+    Output->bRightTrigger = Input->bTriggerR;
+
+    //
+    // Bytes get replicated into both halves to span the full 16 bit range
+    // 
+    Output->sThumbLX = (SHORT)(((Input->bThumbLX << 8) | Input->bThumbLX) ^ 0x8000);
+    Output->sThumbLY = (SHORT)(((Input->bThumbLY << 8) | Input->bThumbLY) ^ 0x7FFF);
+    Output->sThumbRX = (SHORT)(((Input->bThumbRX << 8) | Input->bThumbRX) ^ 0x8000);
+    Output->sThumbRY = (SHORT)(((Input->bThumbRY << 8) | Input->bThumbRY) ^ 0x7FFF);
+}
+
+//
+// Converts a stick axis the way XUSB_TO_DS4_REPORT always did: Bias 32766 
+// is what the left Y axis historically used, 32768 the right one. A result 
+// of 0 is reported as 0xFF.
+// 
+BYTE FORCEINLINE XUSB_TO_DS4_AXIS_INVERTED(
+    _In_ SHORT Value,
+    _In_ LONG Bias
+)
+{
+    LONG biased = Value + Bias;
+
+    //
+    // Negative sums divide to 0 as well
+    // 
+    const LONG quotient = (biased & ~(biased >> 31)) / 257;
+
+    return (BYTE)((BYTE)(256 - quotient) - (quotient == 0));
+}
+
+//
+// Adds the state of Input to Output; buttons already set in Output are kept.
+// 
+VOID FORCEINLINE XUSB_TO_DS4_REPORT(
+    _In_ const XUSB_REPORT* Input,
+    _Inout_ PDS4_REPORT Output
+)
+{
+    const USHORT buttons = Input->wButtons;
 
-    if (Input->wButtons & XUSB_GAMEPAD_DPAD_UP) DS4_SET_DPAD(Output, DS4_BUTTON_DPAD_NORTH);
-    if (Input->wButtons & XUSB_GAMEPAD_DPAD_RIGHT) DS4_SET_DPAD(Output, DS4_BUTTON_DPAD_EAST);
-    if (Input->wButtons & XUSB_GAMEPAD_DPAD_DOWN) DS4_SET_DPAD(Output, DS4_BUTTON_DPAD_SOUTH);
-    if (Input->wButtons & XUSB_GAMEPAD_DPAD_LEFT) DS4_SET_DPAD(Output, DS4_BUTTON_DPAD_WEST);
+    Output->wButtons |= (USHORT)(VIGEM_MOVE_BIT(buttons, 14, 4)  // X -> Square
+        | VIGEM_MOVE_BIT(buttons, 12, 5)    // A -> Cross
+        | VIGEM_MOVE_BIT(buttons, 13, 6)    // B -> Circle
+        | VIGEM_MOVE_BIT(buttons, 15, 7)    // Y -> Triangle
+        | VIGEM_MOVE_BIT(buttons, 8, 8)     // Left shoulder
+        | VIGEM_MOVE_BIT(buttons, 9, 9)     // Right shoulder
+        | ((Input->bLeftTrigger != 0) << 10)
+        | ((Input->bRightTrigger != 0) << 11)
+        | VIGEM_MOVE_BIT(buttons, 5, 12)    // Back -> Share
+        | VIGEM_MOVE_BIT(buttons, 4, 13)    // Start -> Options
+        | VIGEM_MOVE_BIT(buttons, 6, 14)    // Left thumb
+        | VIGEM_MOVE_BIT(buttons, 7, 15));  // Right thumb
 
-    if (Input->wButtons & XUSB_GAMEPAD_DPAD_UP
-        && Input->wButtons & XUSB_GAMEPAD_DPAD_RIGHT) DS4_SET_DPAD(Output, DS4_BUTTON_DPAD_NORTHEAST);
-    if (Input->wButtons & XUSB_GAMEPAD_DPAD_RIGHT
-        && Input->wButtons & XUSB_GAMEPAD_DPAD_DOWN) DS4_SET_DPAD(Output, DS4_BUTTON_DPAD_SOUTHEAST);
-    if (Input->wButtons & XUSB_GAMEPAD_DPAD_DOWN
-        && Input->wButtons & XUSB_GAMEPAD_DPAD_LEFT) DS4_SET_DPAD(Output, DS4_BUTTON_DPAD_SOUTHWEST);
-    if (Input->wButtons & XUSB_GAMEPAD_DPAD_LEFT
-        && Input->wButtons & XUSB_GAMEPAD_DPAD_UP) DS4_SET_DPAD(Output, DS4_BUTTON_DPAD_NORTHWEST);
+    Output->bSpecial |= (BYTE)VIGEM_MOVE_BIT(buttons, 10, 0); // Guide -> PS
 
-    Output->bThumbLX = ((Input->sThumbLX + ((USHRT_MAX / 2) + 1)) / 257);
-    Output->bThumbLY = (-(Input->sThumbLY + ((USHRT_MAX / 2) - 1)) / 257);
-    Output->bThumbLY = (Output->bThumbLY == 0) ? 0xFF : Output->bThumbLY;
-    Output->bThumbRX = ((Input->sThumbRX + ((USHRT_MAX / 2) + 1)) / 257);
-    Output->bThumbRY = (-(Input->sThumbRY + ((USHRT_MAX / 2) + 1)) / 257);
-    Output->bThumbRY = (Output->bThumbRY == 0) ? 0xFF : Output->bThumbRY;
+    Output->bTriggerL = Input->bLeftTrigger;
+    Output->bTriggerR = Input->bRightTrigger;
+
+    //
+    // Like the other buttons, a released D-Pad leaves the hat in Output alone
+    // 
+    if (buttons & 0x000F)
+        DS4_SET_DPAD(Output, (DS4_DPAD_DIRECTIONS)XUSB_TO_DS4_DPAD(buttons));
+
+    Output->bThumbLX = (BYTE)((Input->sThumbLX + ((USHRT_MAX / 2) + 1)) / 257);
+    Output->bThumbLY = XUSB_TO_DS4_AXIS_INVERTED(Input->sThumbLY, (USHRT_MAX / 2) - 1);
+    Output->bThumbRX = (BYTE)((Input->sThumbRX + ((USHRT_MAX / 2) + 1)) / 257);
+    Output->bThumbRY = XUSB_TO_DS4_AXIS_INVERTED(Input->sThumbRY, (USHRT_MAX / 2) + 1);
 }
 
+//
+// Converts Count reports, each Output starts out as set by DS4_REPORT_INIT.
+// 
+VOID FORCEINLINE XUSB_TO_DS4_REPORTS(
+    _In_reads_(Count) const XUSB_REPORT* Input,
+    _Out_writes_(Count) PDS4_REPORT Output,
+    _In_ ULONG Count
+)
+{
+    for (ULONG index = 0; index < Count; index++)
+    {
+        DS4_REPORT_INIT(&Output[index]);
+        XUSB_TO_DS4_REPORT(&Input[index], &Output[index]);
+    }
+}
+
+//
+// Converts Count reports with DS4_TO_XUSB.
+// 
+VOID FORCEINLINE DS4_TO_XUSB_REPORTS(
+    _In_reads_(Count) const DS4_REPORT* Input,
+    _Out_writes_(Count) PXUSB_REPORT Output,
+    _In_ ULONG Count
+)
+{
+    for (ULONG index = 0; index < Count; index++)
+    {
+        DS4_TO_XUSB(&Input[index], &Output[index]);
+    }
+}
@@ -53,6 +53,7 @@ DEFINE_GUID(GUID_DEVINTERFACE_BUSENUM_VIGEM,
 #define BUSENUM_W_IOCTL(_index_)        CTL_CODE(FILE_DEVICE_BUSENUM, _index_, METHOD_BUFFERED, FILE_WRITE_DATA)
 #define BUSENUM_R_IOCTL(_index_)        CTL_CODE(FILE_DEVICE_BUSENUM, _index_, METHOD_BUFFERED, FILE_READ_DATA)
 #define BUSENUM_RW_IOCTL(_index_)       CTL_CODE(FILE_DEVICE_BUSENUM, _index_, METHOD_BUFFERED, FILE_WRITE_DATA | FILE_READ_DATA)
+#define BUSENUM_R_DIRECT_IOCTL(_index_) CTL_CODE(FILE_DEVICE_BUSENUM, _index_, METHOD_OUT_DIRECT, FILE_READ_DATA)
 
 #define IOCTL_VIGEM_BASE 0x801
 
@@ -63,6 +64,17 @@ DEFINE_GUID(GUID_DEVINTERFACE_BUSENUM_VIGEM,
 #define IOCTL_VIGEM_UNPLUG_TARGET       BUSENUM_W_IOCTL (IOCTL_VIGEM_BASE + 0x001)
 #define IOCTL_VIGEM_CHECK_VERSION       BUSENUM_W_IOCTL (IOCTL_VIGEM_BASE + 0x002)
 #define IOCTL_VIGEM_WAIT_DEVICE_READY   BUSENUM_W_IOCTL (IOCTL_VIGEM_BASE + 0x003)
+#define IOCTL_VIGEM_GET_TARGET_TOKEN    BUSENUM_RW_IOCTL(IOCTL_VIGEM_BASE + 0x004)
+#define IOCTL_VIGEM_COMMIT_FRAME        BUSENUM_RW_IOCTL(IOCTL_VIGEM_BASE + 0x005)
+#define IOCTL_VIGEM_CLAIM_STANDBY_TARGET    BUSENUM_RW_IOCTL(IOCTL_VIGEM_BASE + 0x006)
+#define IOCTL_VIGEM_RECLAIM_LEASED_TARGET   BUSENUM_RW_IOCTL(IOCTL_VIGEM_BASE + 0x007)
+#define IOCTL_VIGEM_CLAIM_TRANSFERRED_TARGET BUSENUM_RW_IOCTL(IOCTL_VIGEM_BASE + 0x008)
+#define IOCTL_VIGEM_ATTACH_INPUT_WRITER     BUSENUM_RW_IOCTL(IOCTL_VIGEM_BASE + 0x009)
+#define IOCTL_VIGEM_SUBSCRIBE_NOTIFICATIONS BUSENUM_RW_IOCTL(IOCTL_VIGEM_BASE + 0x00A)
+//
+// Output buffer is a VIGEM_OUTPUT_STATE_PAGE the driver keeps updating while the request pends
+// 
+#define IOCTL_VIGEM_MAP_OUTPUT_STATE        BUSENUM_R_DIRECT_IOCTL(IOCTL_VIGEM_BASE + 0x00B)
 
 #define IOCTL_XUSB_REQUEST_NOTIFICATION BUSENUM_RW_IOCTL(IOCTL_VIGEM_BASE + 0x200)
 #define IOCTL_XUSB_SUBMIT_REPORT        BUSENUM_W_IOCTL (IOCTL_VIGEM_BASE + 0x201)
@@ -71,6 +83,24 @@ DEFINE_GUID(GUID_DEVINTERFACE_BUSENUM_VIGEM,
 //#define IOCTL_XGIP_SUBMIT_REPORT        BUSENUM_W_IOCTL (IOCTL_VIGEM_BASE + 0x204)
 //#define IOCTL_XGIP_SUBMIT_INTERRUPT     BUSENUM_W_IOCTL (IOCTL_VIGEM_BASE + 0x205)
 #define IOCTL_XUSB_GET_USER_INDEX       BUSENUM_RW_IOCTL(IOCTL_VIGEM_BASE + 0x206)
+//
+// Same input buffers as IOCTL_XUSB_SUBMIT_REPORT and IOCTL_DS4_SUBMIT_REPORT but the
+// SerialNo member carries the token obtained via IOCTL_VIGEM_GET_TARGET_TOKEN. 
+// Reports not matching the target type get translated by the bus.
+// 
+#define IOCTL_XUSB_SUBMIT_REPORT_BY_TOKEN   BUSENUM_W_IOCTL (IOCTL_VIGEM_BASE + 0x207)
+#define IOCTL_DS4_SUBMIT_REPORT_BY_TOKEN    BUSENUM_W_IOCTL (IOCTL_VIGEM_BASE + 0x208)
+#define IOCTL_VIGEM_SUBMIT_SCHEDULED_REPORT BUSENUM_W_IOCTL (IOCTL_VIGEM_BASE + 0x209)
+#define IOCTL_VIGEM_STAGE_REPORT            BUSENUM_W_IOCTL (IOCTL_VIGEM_BASE + 0x20A)
+#define IOCTL_VIGEM_AWAIT_POLL              BUSENUM_RW_IOCTL(IOCTL_VIGEM_BASE + 0x20B)
+#define IOCTL_VIGEM_GET_TARGET_STATISTICS   BUSENUM_RW_IOCTL(IOCTL_VIGEM_BASE + 0x20C)
+#define IOCTL_VIGEM_GRANT_TARGET_LEASE      BUSENUM_RW_IOCTL(IOCTL_VIGEM_BASE + 0x20D)
+#define IOCTL_VIGEM_ISSUE_TRANSFER_TICKET   BUSENUM_RW_IOCTL(IOCTL_VIGEM_BASE + 0x20E)
+#define IOCTL_VIGEM_ENABLE_INPUT_FUSION     BUSENUM_RW_IOCTL(IOCTL_VIGEM_BASE + 0x20F)
+#define IOCTL_VIGEM_DETACH_INPUT_WRITER     BUSENUM_W_IOCTL (IOCTL_VIGEM_BASE + 0x210)
+#define IOCTL_VIGEM_AWAIT_NOTIFICATION      BUSENUM_RW_IOCTL(IOCTL_VIGEM_BASE + 0x211)
+#define IOCTL_DS4_SUBMIT_PARTIAL_REPORT     BUSENUM_W_IOCTL (IOCTL_VIGEM_BASE + 0x212)
+#define IOCTL_DS4_SUBMIT_IMU_SAMPLES        BUSENUM_W_IOCTL (IOCTL_VIGEM_BASE + 0x213)
 
 
 //
@@ -79,6 +109,21 @@ DEFINE_GUID(GUID_DEVINTERFACE_BUSENUM_VIGEM,
 
 #pragma region Plugin
 
+//
+// XUSB: serve as many init packets per data pipe transfer as the buffer fits
+// 
+#define VIGEM_PLUGIN_FLAG_FAST_BOOT     0x00000001
+
+//
+// Deliver every output transfer, even if it repeats the previous one
+// 
+#define VIGEM_PLUGIN_FLAG_KEEP_DUPLICATE_OUTPUT 0x00000002
+
+//
+// DS4: the bus advances timestamp, report counter and touch packet counter itself
+// 
+#define VIGEM_PLUGIN_FLAG_DRIVER_COUNTERS       0x00000004
+
 //
 // Data structure used in IOCTL_VIGEM_PLUGIN_TARGET requests.
 // 
@@ -127,6 +172,70 @@ VOID FORCEINLINE VIGEM_PLUGIN_TARGET_INIT(
     PlugIn->TargetType = TargetType;
 }
 
+//
+// Extended data structure used in IOCTL_VIGEM_PLUGIN_TARGET requests. Starts 
+// with the same members as VIGEM_PLUGIN_TARGET, the Size member tells them apart.
+// 
+typedef struct _VIGEM_PLUGIN_TARGET_EX
+{
+    //
+    // sizeof (struct _VIGEM_PLUGIN_TARGET_EX)
+    //
+    IN ULONG Size;
+
+    //
+    // Serial number of target device.
+    // 
+    IN ULONG SerialNo;
+
+    // 
+    // Type of the target device to emulate.
+    // 
+    VIGEM_TARGET_TYPE TargetType;
+
+    //
+    // If set, the vendor ID the emulated device is reporting
+    // 
+    USHORT VendorId;
+
+    //
+    // If set, the product ID the emulated device is reporting
+    // 
+    USHORT ProductId;
+
+    //
+    // If set, bInterval (milliseconds) advertised for all interrupt endpoints
+    // 
+    UCHAR PollingInterval;
+
+    //
+    // If set, number of output reports kept queued for notification requests
+    // 
+    USHORT OutputBufferCount;
+
+    //
+    // Combination of VIGEM_PLUGIN_FLAG_* values
+    // 
+    ULONG Flags;
+
+} VIGEM_PLUGIN_TARGET_EX, *PVIGEM_PLUGIN_TARGET_EX;
+
+//
+// Initializes a VIGEM_PLUGIN_TARGET_EX structure.
+// 
+VOID FORCEINLINE VIGEM_PLUGIN_TARGET_EX_INIT(
+    _Out_ PVIGEM_PLUGIN_TARGET_EX PlugIn,
+    _In_ ULONG SerialNo,
+    _In_ VIGEM_TARGET_TYPE TargetType
+)
+{
+    RtlZeroMemory(PlugIn, sizeof(VIGEM_PLUGIN_TARGET_EX));
+
+    PlugIn->Size = sizeof(VIGEM_PLUGIN_TARGET_EX);
+    PlugIn->SerialNo = SerialNo;
+    PlugIn->TargetType = TargetType;
+}
+
 #pragma endregion 
 
 #pragma region Unplug
@@ -210,258 +319,1329 @@ VOID FORCEINLINE VIGEM_WAIT_DEVICE_READY_INIT(
 
 #pragma endregion 
 
-#pragma region XUSB (aka Xbox 360 device) section
+#pragma region Target token
 
 //
-// Data structure used in IOCTL_XUSB_REQUEST_NOTIFICATION requests.
+// Data structure used in IOCTL_VIGEM_GET_TARGET_TOKEN requests.
 // 
-typedef struct _XUSB_REQUEST_NOTIFICATION
+typedef struct _VIGEM_GET_TARGET_TOKEN
 {
     //
-    // sizeof(struct _XUSB_REQUEST_NOTIFICATION)
+    // sizeof(struct _VIGEM_GET_TARGET_TOKEN)
     // 
-    ULONG Size;
+    IN ULONG Size;
 
     //
     // Serial number of target device.
     // 
-    ULONG SerialNo;
+    IN ULONG SerialNo;
 
     //
-    // Vibration intensity value of the large motor (0-255).
+    // Opaque handle to the target, only valid on the file handle it was requested on.
     // 
-    UCHAR LargeMotor;
+    OUT ULONG Token;
+
+} VIGEM_GET_TARGET_TOKEN, *PVIGEM_GET_TARGET_TOKEN;
+
+//
+// Initializes a VIGEM_GET_TARGET_TOKEN structure.
+// 
+VOID FORCEINLINE VIGEM_GET_TARGET_TOKEN_INIT(
+    _Out_ PVIGEM_GET_TARGET_TOKEN GetToken,
+    _In_ ULONG SerialNo
+)
+{
+    RtlZeroMemory(GetToken, sizeof(VIGEM_GET_TARGET_TOKEN));
+
+    GetToken->Size = sizeof(VIGEM_GET_TARGET_TOKEN);
+    GetToken->SerialNo = SerialNo;
+}
+
+#pragma endregion
 
+#pragma region Standby target
+
+//
+// Data structure used in IOCTL_VIGEM_CLAIM_STANDBY_TARGET requests.
+// 
+typedef struct _VIGEM_CLAIM_STANDBY_TARGET
+{
     //
-    // Vibration intensity value of the small motor (0-255).
+    // sizeof(struct _VIGEM_CLAIM_STANDBY_TARGET)
     // 
-    UCHAR SmallMotor;
+    IN ULONG Size;
 
     //
-    // Index number of the slot/LED that XUSB.sys has assigned.
+    // Type of the target device to claim.
     // 
-    UCHAR LedNumber;
+    IN VIGEM_TARGET_TYPE TargetType;
 
-} XUSB_REQUEST_NOTIFICATION, *PXUSB_REQUEST_NOTIFICATION;
+    //
+    // Vendor ID the claimed target must report (0 for the type default).
+    // 
+    IN USHORT VendorId;
+
+    //
+    // Product ID the claimed target must report (0 for the type default).
+    // 
+    IN USHORT ProductId;
+
+    //
+    // Serial number of the already booted target now owned by the caller.
+    // 
+    OUT ULONG SerialNo;
+
+} VIGEM_CLAIM_STANDBY_TARGET, *PVIGEM_CLAIM_STANDBY_TARGET;
 
 //
-// Initializes a XUSB_REQUEST_NOTIFICATION structure.
+// Initializes a VIGEM_CLAIM_STANDBY_TARGET structure.
 // 
-VOID FORCEINLINE XUSB_REQUEST_NOTIFICATION_INIT(
-    _Out_ PXUSB_REQUEST_NOTIFICATION Request,
-          _In_ ULONG SerialNo
+VOID FORCEINLINE VIGEM_CLAIM_STANDBY_TARGET_INIT(
+    _Out_ PVIGEM_CLAIM_STANDBY_TARGET Claim,
+    _In_ VIGEM_TARGET_TYPE TargetType,
+    _In_ USHORT VendorId,
+    _In_ USHORT ProductId
 )
 {
-    RtlZeroMemory(Request, sizeof(XUSB_REQUEST_NOTIFICATION));
+    RtlZeroMemory(Claim, sizeof(VIGEM_CLAIM_STANDBY_TARGET));
 
-    Request->Size = sizeof(XUSB_REQUEST_NOTIFICATION);
-    Request->SerialNo = SerialNo;
+    Claim->Size = sizeof(VIGEM_CLAIM_STANDBY_TARGET);
+    Claim->TargetType = TargetType;
+    Claim->VendorId = VendorId;
+    Claim->ProductId = ProductId;
 }
 
+#pragma endregion
+
+#pragma region Target lease
+
 //
-// Data structure used in IOCTL_XUSB_SUBMIT_REPORT requests.
+// Data structure used in IOCTL_VIGEM_GRANT_TARGET_LEASE requests.
 // 
-typedef struct _XUSB_SUBMIT_REPORT
+typedef struct _VIGEM_GRANT_TARGET_LEASE
 {
     //
-    // sizeof(struct _XUSB_SUBMIT_REPORT)
+    // sizeof(struct _VIGEM_GRANT_TARGET_LEASE)
     // 
-    ULONG Size;
+    IN ULONG Size;
 
     //
-    // Serial number of target device.
+    // Token obtained via IOCTL_VIGEM_GET_TARGET_TOKEN.
     // 
-    ULONG SerialNo;
+    IN ULONG Token;
 
     //
-    // Report to submit to the target device.
+    // Time in milliseconds the target stays plugged in after the owning handle got closed.
     // 
-    XUSB_REPORT Report;
+    IN ULONG GracePeriod;
 
-} XUSB_SUBMIT_REPORT, *PXUSB_SUBMIT_REPORT;
+    //
+    // Key a new handle presents in IOCTL_VIGEM_RECLAIM_LEASED_TARGET to take the target over.
+    // 
+    OUT ULONG LeaseKey;
+
+} VIGEM_GRANT_TARGET_LEASE, *PVIGEM_GRANT_TARGET_LEASE;
 
 //
-// Initializes an XUSB report.
+// Initializes a VIGEM_GRANT_TARGET_LEASE structure.
 // 
-VOID FORCEINLINE XUSB_SUBMIT_REPORT_INIT(
-    _Out_ PXUSB_SUBMIT_REPORT Report,
-    _In_ ULONG SerialNo
+VOID FORCEINLINE VIGEM_GRANT_TARGET_LEASE_INIT(
+    _Out_ PVIGEM_GRANT_TARGET_LEASE GrantLease,
+    _In_ ULONG Token,
+    _In_ ULONG GracePeriod
 )
 {
-    RtlZeroMemory(Report, sizeof(XUSB_SUBMIT_REPORT));
+    RtlZeroMemory(GrantLease, sizeof(VIGEM_GRANT_TARGET_LEASE));
 
-    Report->Size = sizeof(XUSB_SUBMIT_REPORT);
-    Report->SerialNo = SerialNo;
+    GrantLease->Size = sizeof(VIGEM_GRANT_TARGET_LEASE);
+    GrantLease->Token = Token;
+    GrantLease->GracePeriod = GracePeriod;
 }
 
-typedef struct _XUSB_GET_USER_INDEX
+//
+// Data structure used in IOCTL_VIGEM_RECLAIM_LEASED_TARGET requests.
+// 
+typedef struct _VIGEM_RECLAIM_LEASED_TARGET
 {
     //
-    // sizeof(struct _XUSB_GET_USER_INDEX)
+    // sizeof(struct _VIGEM_RECLAIM_LEASED_TARGET)
     // 
-    ULONG Size;
+    IN ULONG Size;
 
     //
-    // Serial number of target device.
+    // Key obtained via IOCTL_VIGEM_GRANT_TARGET_LEASE.
     // 
-    ULONG SerialNo;
+    IN ULONG LeaseKey;
 
     //
-    // User index of target device.
+    // Serial number of the target now owned by the caller.
     // 
-    OUT ULONG UserIndex;
+    OUT ULONG SerialNo;
 
-} XUSB_GET_USER_INDEX, *PXUSB_GET_USER_INDEX;
+    //
+    // Type of the target now owned by the caller.
+    // 
+    OUT VIGEM_TARGET_TYPE TargetType;
+
+} VIGEM_RECLAIM_LEASED_TARGET, *PVIGEM_RECLAIM_LEASED_TARGET;
 
 //
-// Initializes XUSB_GET_USER_INDEX structure.
+// Initializes a VIGEM_RECLAIM_LEASED_TARGET structure.
 // 
-VOID FORCEINLINE XUSB_GET_USER_INDEX_INIT(
-    _Out_ PXUSB_GET_USER_INDEX GetRequest,
-    _In_ ULONG SerialNo
+VOID FORCEINLINE VIGEM_RECLAIM_LEASED_TARGET_INIT(
+    _Out_ PVIGEM_RECLAIM_LEASED_TARGET Reclaim,
+    _In_ ULONG LeaseKey
 )
 {
-    RtlZeroMemory(GetRequest, sizeof(XUSB_GET_USER_INDEX));
+    RtlZeroMemory(Reclaim, sizeof(VIGEM_RECLAIM_LEASED_TARGET));
 
-    GetRequest->Size = sizeof(XUSB_GET_USER_INDEX);
-    GetRequest->SerialNo = SerialNo;
+    Reclaim->Size = sizeof(VIGEM_RECLAIM_LEASED_TARGET);
+    Reclaim->LeaseKey = LeaseKey;
 }
 
 #pragma endregion
 
-#pragma region DualShock 4 section
+#pragma region Ownership transfer
 
-typedef struct _DS4_OUTPUT_REPORT
+//
+// Data structure used in IOCTL_VIGEM_ISSUE_TRANSFER_TICKET requests.
+// 
+typedef struct _VIGEM_ISSUE_TRANSFER_TICKET
 {
     //
-    // Vibration intensity value of the small motor (0-255).
+    // sizeof(struct _VIGEM_ISSUE_TRANSFER_TICKET)
     // 
-    UCHAR SmallMotor;
+    IN ULONG Size;
 
     //
-    // Vibration intensity value of the large motor (0-255).
+    // Token obtained via IOCTL_VIGEM_GET_TARGET_TOKEN.
     // 
-    UCHAR LargeMotor;
+    IN ULONG Token;
 
     //
-    // Color values of the Lightbar.
-    //
-    DS4_LIGHTBAR_COLOR LightbarColor;
+    // Single use ticket the recipient presents in IOCTL_VIGEM_CLAIM_TRANSFERRED_TARGET.
+    // 
+    OUT ULONG Ticket;
 
-} DS4_OUTPUT_REPORT, *PDS4_OUTPUT_REPORT;
+} VIGEM_ISSUE_TRANSFER_TICKET, *PVIGEM_ISSUE_TRANSFER_TICKET;
 
 //
-// Data structure used in IOCTL_DS4_REQUEST_NOTIFICATION requests.
+// Initializes a VIGEM_ISSUE_TRANSFER_TICKET structure.
 // 
-typedef struct _DS4_REQUEST_NOTIFICATION
+VOID FORCEINLINE VIGEM_ISSUE_TRANSFER_TICKET_INIT(
+    _Out_ PVIGEM_ISSUE_TRANSFER_TICKET IssueTicket,
+    _In_ ULONG Token
+)
+{
+    RtlZeroMemory(IssueTicket, sizeof(VIGEM_ISSUE_TRANSFER_TICKET));
+
+    IssueTicket->Size = sizeof(VIGEM_ISSUE_TRANSFER_TICKET);
+    IssueTicket->Token = Token;
+}
+
+//
+// Data structure used in IOCTL_VIGEM_CLAIM_TRANSFERRED_TARGET requests.
+// 
+typedef struct _VIGEM_CLAIM_TRANSFERRED_TARGET
 {
     //
-    // sizeof(struct _XUSB_REQUEST_NOTIFICATION)
+    // sizeof(struct _VIGEM_CLAIM_TRANSFERRED_TARGET)
     // 
-    ULONG Size;
+    IN ULONG Size;
 
     //
-    // Serial number of target device.
+    // Ticket obtained via IOCTL_VIGEM_ISSUE_TRANSFER_TICKET.
     // 
-    ULONG SerialNo;
+    IN ULONG Ticket;
 
     //
-    // The HID output report
+    // Serial number of the target now owned by the caller.
     // 
-    DS4_OUTPUT_REPORT Report;
+    OUT ULONG SerialNo;
 
-} DS4_REQUEST_NOTIFICATION, *PDS4_REQUEST_NOTIFICATION;
+    //
+    // Type of the target now owned by the caller.
+    // 
+    OUT VIGEM_TARGET_TYPE TargetType;
+
+} VIGEM_CLAIM_TRANSFERRED_TARGET, *PVIGEM_CLAIM_TRANSFERRED_TARGET;
 
 //
-// Initializes a DS4_REQUEST_NOTIFICATION structure.
+// Initializes a VIGEM_CLAIM_TRANSFERRED_TARGET structure.
 // 
-VOID FORCEINLINE DS4_REQUEST_NOTIFICATION_INIT(
-    _Out_ PDS4_REQUEST_NOTIFICATION Request,
-    _In_ ULONG SerialNo
+VOID FORCEINLINE VIGEM_CLAIM_TRANSFERRED_TARGET_INIT(
+    _Out_ PVIGEM_CLAIM_TRANSFERRED_TARGET Claim,
+    _In_ ULONG Ticket
 )
 {
-    RtlZeroMemory(Request, sizeof(DS4_REQUEST_NOTIFICATION));
+    RtlZeroMemory(Claim, sizeof(VIGEM_CLAIM_TRANSFERRED_TARGET));
 
-    Request->Size = sizeof(DS4_REQUEST_NOTIFICATION);
-    Request->SerialNo = SerialNo;
+    Claim->Size = sizeof(VIGEM_CLAIM_TRANSFERRED_TARGET);
+    Claim->Ticket = Ticket;
 }
 
+#pragma endregion
+
+#pragma region Input fusion
+
 //
-// DualShock 4 request data
+// Data structure used in IOCTL_VIGEM_ENABLE_INPUT_FUSION requests.
 // 
-typedef struct _DS4_SUBMIT_REPORT
+typedef struct _VIGEM_ENABLE_INPUT_FUSION
 {
     //
-    // sizeof(struct _DS4_SUBMIT_REPORT)
+    // sizeof(struct _VIGEM_ENABLE_INPUT_FUSION)
     // 
-    ULONG Size;
+    IN ULONG Size;
 
     //
-    // Serial number of target device.
+    // Token obtained via IOCTL_VIGEM_GET_TARGET_TOKEN.
     // 
-    ULONG SerialNo;
+    IN ULONG Token;
 
     //
-    // HID Input report
+    // How the reports of all writers get combined.
     // 
-    DS4_REPORT Report;
+    IN VIGEM_FUSION_POLICY Policy;
 
-} DS4_SUBMIT_REPORT, *PDS4_SUBMIT_REPORT;
+    //
+    // Priority of the owner's reports (higher wins) under VigemFusionPolicyPriority.
+    // 
+    IN UCHAR OwnerPriority;
+
+    //
+    // Key other processes present in IOCTL_VIGEM_ATTACH_INPUT_WRITER.
+    // 
+    OUT ULONG WriterKey;
+
+} VIGEM_ENABLE_INPUT_FUSION, *PVIGEM_ENABLE_INPUT_FUSION;
 
 //
-// Initializes a DualShock 4 report.
+// Initializes a VIGEM_ENABLE_INPUT_FUSION structure.
 // 
-VOID FORCEINLINE DS4_SUBMIT_REPORT_INIT(
-    _Out_ PDS4_SUBMIT_REPORT Report,
-    _In_ ULONG SerialNo
+VOID FORCEINLINE VIGEM_ENABLE_INPUT_FUSION_INIT(
+    _Out_ PVIGEM_ENABLE_INPUT_FUSION EnableFusion,
+    _In_ ULONG Token,
+    _In_ VIGEM_FUSION_POLICY Policy,
+    _In_ UCHAR OwnerPriority
 )
 {
-    RtlZeroMemory(Report, sizeof(DS4_SUBMIT_REPORT));
-
-    Report->Size = sizeof(DS4_SUBMIT_REPORT);
-    Report->SerialNo = SerialNo;
+    RtlZeroMemory(EnableFusion, sizeof(VIGEM_ENABLE_INPUT_FUSION));
 
-    DS4_REPORT_INIT(&Report->Report);
+    EnableFusion->Size = sizeof(VIGEM_ENABLE_INPUT_FUSION);
+    EnableFusion->Token = Token;
+    EnableFusion->Policy = Policy;
+    EnableFusion->OwnerPriority = OwnerPriority;
 }
 
-#include <pshpack1.h>
-
 //
-// DualShock 4 extended report request
+// Data structure used in IOCTL_VIGEM_ATTACH_INPUT_WRITER requests.
 // 
-typedef struct _DS4_SUBMIT_REPORT_EX
+typedef struct _VIGEM_ATTACH_INPUT_WRITER
 {
     //
-     // sizeof(struct _DS4_SUBMIT_REPORT_EX)
-     // 
-    _In_ ULONG Size;
+    // sizeof(struct _VIGEM_ATTACH_INPUT_WRITER)
+    // 
+    IN ULONG Size;
 
     //
-    // Serial number of target device.
+    // Serial number of the target to write to.
     // 
-    _In_ ULONG SerialNo;
+    IN ULONG SerialNo;
 
     //
-    // Full size HID report excluding fixed Report ID.
+    // Key obtained by the owner via IOCTL_VIGEM_ENABLE_INPUT_FUSION.
     // 
-    _In_ DS4_REPORT_EX Report;
+    IN ULONG WriterKey;
 
-} DS4_SUBMIT_REPORT_EX, * PDS4_SUBMIT_REPORT_EX;
+    //
+    // Priority of this writer's reports (higher wins) under VigemFusionPolicyPriority.
+    // 
+    IN UCHAR Priority;
 
-#include <poppack.h>
+    //
+    // Token to submit reports with (IOCTL_XUSB_SUBMIT_REPORT_BY_TOKEN, IOCTL_DS4_SUBMIT_REPORT_BY_TOKEN).
+    // 
+    OUT ULONG Token;
+
+    //
+    // Type of the target written to.
+    // 
+    OUT VIGEM_TARGET_TYPE TargetType;
+
+} VIGEM_ATTACH_INPUT_WRITER, *PVIGEM_ATTACH_INPUT_WRITER;
 
 //
-// Initializes a DualShock 4 extended report.
+// Initializes a VIGEM_ATTACH_INPUT_WRITER structure.
 // 
-VOID FORCEINLINE DS4_SUBMIT_REPORT_EX_INIT(
-    _Out_ PDS4_SUBMIT_REPORT_EX Report,
-    _In_ ULONG SerialNo
+VOID FORCEINLINE VIGEM_ATTACH_INPUT_WRITER_INIT(
+    _Out_ PVIGEM_ATTACH_INPUT_WRITER AttachWriter,
+    _In_ ULONG SerialNo,
+    _In_ ULONG WriterKey,
+    _In_ UCHAR Priority
 )
 {
-    RtlZeroMemory(Report, sizeof(DS4_SUBMIT_REPORT_EX));
+    RtlZeroMemory(AttachWriter, sizeof(VIGEM_ATTACH_INPUT_WRITER));
 
-    Report->Size = sizeof(DS4_SUBMIT_REPORT_EX);
-    Report->SerialNo = SerialNo;
+    AttachWriter->Size = sizeof(VIGEM_ATTACH_INPUT_WRITER);
+    AttachWriter->SerialNo = SerialNo;
+    AttachWriter->WriterKey = WriterKey;
+    AttachWriter->Priority = Priority;
+}
+
+//
+// Data structure used in IOCTL_VIGEM_DETACH_INPUT_WRITER requests.
+// 
+typedef struct _VIGEM_DETACH_INPUT_WRITER
+{
+    //
+    // sizeof(struct _VIGEM_DETACH_INPUT_WRITER)
+    // 
+    IN ULONG Size;
+
+    //
+    // Token obtained via IOCTL_VIGEM_ATTACH_INPUT_WRITER.
+    // 
+    IN ULONG Token;
+
+} VIGEM_DETACH_INPUT_WRITER, *PVIGEM_DETACH_INPUT_WRITER;
+
+//
+// Initializes a VIGEM_DETACH_INPUT_WRITER structure.
+// 
+VOID FORCEINLINE VIGEM_DETACH_INPUT_WRITER_INIT(
+    _Out_ PVIGEM_DETACH_INPUT_WRITER DetachWriter,
+    _In_ ULONG Token
+)
+{
+    RtlZeroMemory(DetachWriter, sizeof(VIGEM_DETACH_INPUT_WRITER));
+
+    DetachWriter->Size = sizeof(VIGEM_DETACH_INPUT_WRITER);
+    DetachWriter->Token = Token;
+}
+
+#pragma endregion
+
+#pragma region Notification subscribers
+
+//
+// Data structure used in IOCTL_VIGEM_SUBSCRIBE_NOTIFICATIONS requests.
+// 
+typedef struct _VIGEM_SUBSCRIBE_NOTIFICATIONS
+{
+    //
+    // sizeof(struct _VIGEM_SUBSCRIBE_NOTIFICATIONS)
+    // 
+    IN ULONG Size;
+
+    //
+    // Serial number of the target to receive notifications of.
+    // 
+    IN ULONG SerialNo;
+
+    //
+    // Lease key or transfer ticket handed out by the owner, ignored for the owner itself.
+    // 
+    IN ULONG AccessKey;
+
+    //
+    // Token to pass in IOCTL_VIGEM_AWAIT_NOTIFICATION.
+    // 
+    OUT ULONG Token;
+
+    //
+    // Type of the target subscribed to.
+    // 
+    OUT VIGEM_TARGET_TYPE TargetType;
+
+} VIGEM_SUBSCRIBE_NOTIFICATIONS, *PVIGEM_SUBSCRIBE_NOTIFICATIONS;
+
+//
+// Initializes a VIGEM_SUBSCRIBE_NOTIFICATIONS structure.
+// 
+VOID FORCEINLINE VIGEM_SUBSCRIBE_NOTIFICATIONS_INIT(
+    _Out_ PVIGEM_SUBSCRIBE_NOTIFICATIONS Subscribe,
+    _In_ ULONG SerialNo,
+    _In_ ULONG AccessKey
+)
+{
+    RtlZeroMemory(Subscribe, sizeof(VIGEM_SUBSCRIBE_NOTIFICATIONS));
+
+    Subscribe->Size = sizeof(VIGEM_SUBSCRIBE_NOTIFICATIONS);
+    Subscribe->SerialNo = SerialNo;
+    Subscribe->AccessKey = AccessKey;
+}
+
+//
+// Data structure used in IOCTL_VIGEM_AWAIT_NOTIFICATION requests.
+// 
+typedef struct _VIGEM_AWAIT_NOTIFICATION
+{
+    //
+    // sizeof(struct _VIGEM_AWAIT_NOTIFICATION)
+    // 
+    IN ULONG Size;
+
+    //
+    // Token obtained via IOCTL_VIGEM_SUBSCRIBE_NOTIFICATIONS.
+    // 
+    IN ULONG Token;
+
+    //
+    // Notifications lost since the previous request because this subscriber fell behind.
+    // 
+    OUT ULONG Dropped;
+
+    //
+    // Valid bytes in Data.
+    // 
+    OUT ULONG Length;
+
+    //
+    // XUSB_REQUEST_NOTIFICATION or DS4_REQUEST_NOTIFICATION, depending on the target type.
+    // 
+    OUT UCHAR Data[32];
+
+} VIGEM_AWAIT_NOTIFICATION, *PVIGEM_AWAIT_NOTIFICATION;
+
+//
+// Initializes a VIGEM_AWAIT_NOTIFICATION structure.
+// 
+VOID FORCEINLINE VIGEM_AWAIT_NOTIFICATION_INIT(
+    _Out_ PVIGEM_AWAIT_NOTIFICATION AwaitNotification,
+    _In_ ULONG Token
+)
+{
+    RtlZeroMemory(AwaitNotification, sizeof(VIGEM_AWAIT_NOTIFICATION));
+
+    AwaitNotification->Size = sizeof(VIGEM_AWAIT_NOTIFICATION);
+    AwaitNotification->Token = Token;
+}
+
+#pragma endregion
+
+#pragma region Output state page
+
+#define VIGEM_OUTPUT_STATE_PAGE_SIZE    0x1000
+
+#define VIGEM_OUTPUT_STATE_MAX_TARGETS  63
+
+//
+// Latest output values of a single target, one cache line each.
+// 
+typedef struct _VIGEM_OUTPUT_STATE
+{
+    //
+    // Odd while the driver updates this entry, readers retry until it's even and unchanged
+    // 
+    volatile LONG Sequence;
+
+    //
+    // Serial number of the target, 0 if the entry is unused
+    // 
+    ULONG SerialNo;
+
+    //
+    // Type of the target
+    // 
+    VIGEM_TARGET_TYPE TargetType;
+
+    //
+    // Vibration intensity value of the large motor (0-255).
+    // 
+    UCHAR LargeMotor;
+
+    //
+    // Vibration intensity value of the small motor (0-255).
+    // 
+    UCHAR SmallMotor;
+
+    //
+    // XUSB only: index of the LED currently lit (XInput slot index), 0xFF if not assigned yet.
+    // 
+    UCHAR LedNumber;
+
+    //
+    // DS4 only: color values of the Lightbar.
+    // 
+    DS4_LIGHTBAR_COLOR LightbarColor;
+
+    UCHAR Reserved[46];
+
+} VIGEM_OUTPUT_STATE, *PVIGEM_OUTPUT_STATE;
+
+C_ASSERT(sizeof(VIGEM_OUTPUT_STATE) == 64);
+
+//
+// Output buffer of IOCTL_VIGEM_MAP_OUTPUT_STATE requests, holds all targets of the session.
+// 
+typedef struct _VIGEM_OUTPUT_STATE_PAGE
+{
+    //
+    // sizeof(struct _VIGEM_OUTPUT_STATE_PAGE)
+    // 
+    ULONG Size;
+
+    //
+    // Non-zero while the driver keeps this page up to date
+    // 
+    volatile LONG Active;
+
+    UCHAR Reserved[56];
+
+    VIGEM_OUTPUT_STATE Targets[VIGEM_OUTPUT_STATE_MAX_TARGETS];
+
+} VIGEM_OUTPUT_STATE_PAGE, *PVIGEM_OUTPUT_STATE_PAGE;
+
+C_ASSERT(sizeof(VIGEM_OUTPUT_STATE_PAGE) == VIGEM_OUTPUT_STATE_PAGE_SIZE);
+
+//
+// Data structure used in IOCTL_VIGEM_MAP_OUTPUT_STATE requests.
+// 
+typedef struct _VIGEM_MAP_OUTPUT_STATE
+{
+    //
+    // sizeof(struct _VIGEM_MAP_OUTPUT_STATE)
+    // 
+    IN ULONG Size;
+
+} VIGEM_MAP_OUTPUT_STATE, *PVIGEM_MAP_OUTPUT_STATE;
+
+//
+// Initializes a VIGEM_MAP_OUTPUT_STATE structure.
+// 
+VOID FORCEINLINE VIGEM_MAP_OUTPUT_STATE_INIT(
+    _Out_ PVIGEM_MAP_OUTPUT_STATE MapOutputState
+)
+{
+    RtlZeroMemory(MapOutputState, sizeof(VIGEM_MAP_OUTPUT_STATE));
+
+    MapOutputState->Size = sizeof(VIGEM_MAP_OUTPUT_STATE);
+}
+
+//
+// Writer side of the entry sequence lock, only ever called by the driver. The
+// sequence lives with the writer, the entry is only ever written to.
+// 
+VOID FORCEINLINE VIGEM_OUTPUT_STATE_WRITE(
+    _Out_ PVIGEM_OUTPUT_STATE Entry,
+    _Inout_ PLONG Sequence,
+    _In_ const VIGEM_OUTPUT_STATE* Values
+)
+{
+    InterlockedExchange(&Entry->Sequence, ++(*Sequence));
+
+    RtlCopyMemory(
+        (PUCHAR)Entry + FIELD_OFFSET(VIGEM_OUTPUT_STATE, SerialNo),
+        (const UCHAR*)Values + FIELD_OFFSET(VIGEM_OUTPUT_STATE, SerialNo),
+        sizeof(VIGEM_OUTPUT_STATE) - FIELD_OFFSET(VIGEM_OUTPUT_STATE, SerialNo)
+    );
+
+    InterlockedExchange(&Entry->Sequence, ++(*Sequence));
+}
+
+//
+// Reader side of the entry sequence lock, returns FALSE if a write interfered.
+// 
+BOOLEAN FORCEINLINE VIGEM_OUTPUT_STATE_READ(
+    _In_ const VIGEM_OUTPUT_STATE* Entry,
+    _Out_ PVIGEM_OUTPUT_STATE Values
+)
+{
+    const LONG sequence = Entry->Sequence;
+
+    if (sequence & 1)
+        return FALSE;
+
+    MemoryBarrier();
+
+    RtlCopyMemory(Values, (const VOID*)Entry, sizeof(VIGEM_OUTPUT_STATE));
+
+    MemoryBarrier();
+
+    return (Entry->Sequence == sequence) ? TRUE : FALSE;
+}
+
+#pragma endregion
+
+#pragma region XUSB (aka Xbox 360 device) section
+
+//
+// Data structure used in IOCTL_XUSB_REQUEST_NOTIFICATION requests.
+// 
+typedef struct _XUSB_REQUEST_NOTIFICATION
+{
+    //
+    // sizeof(struct _XUSB_REQUEST_NOTIFICATION)
+    // 
+    ULONG Size;
+
+    //
+    // Serial number of target device.
+    // 
+    ULONG SerialNo;
+
+    //
+    // Vibration intensity value of the large motor (0-255).
+    // 
+    UCHAR LargeMotor;
+
+    //
+    // Vibration intensity value of the small motor (0-255).
+    // 
+    UCHAR SmallMotor;
+
+    //
+    // Index number of the slot/LED that XUSB.sys has assigned.
+    // 
+    UCHAR LedNumber;
+
+} XUSB_REQUEST_NOTIFICATION, *PXUSB_REQUEST_NOTIFICATION;
+
+//
+// Initializes a XUSB_REQUEST_NOTIFICATION structure.
+// 
+VOID FORCEINLINE XUSB_REQUEST_NOTIFICATION_INIT(
+    _Out_ PXUSB_REQUEST_NOTIFICATION Request,
+          _In_ ULONG SerialNo
+)
+{
+    RtlZeroMemory(Request, sizeof(XUSB_REQUEST_NOTIFICATION));
+
+    Request->Size = sizeof(XUSB_REQUEST_NOTIFICATION);
+    Request->SerialNo = SerialNo;
+}
+
+//
+// Data structure used in IOCTL_XUSB_SUBMIT_REPORT requests.
+// 
+typedef struct _XUSB_SUBMIT_REPORT
+{
+    //
+    // sizeof(struct _XUSB_SUBMIT_REPORT)
+    // 
+    ULONG Size;
+
+    //
+    // Serial number of target device.
+    // 
+    ULONG SerialNo;
+
+    //
+    // Report to submit to the target device.
+    // 
+    XUSB_REPORT Report;
+
+} XUSB_SUBMIT_REPORT, *PXUSB_SUBMIT_REPORT;
+
+//
+// Initializes an XUSB report.
+// 
+VOID FORCEINLINE XUSB_SUBMIT_REPORT_INIT(
+    _Out_ PXUSB_SUBMIT_REPORT Report,
+    _In_ ULONG SerialNo
+)
+{
+    RtlZeroMemory(Report, sizeof(XUSB_SUBMIT_REPORT));
+
+    Report->Size = sizeof(XUSB_SUBMIT_REPORT);
+    Report->SerialNo = SerialNo;
+}
+
+typedef struct _XUSB_GET_USER_INDEX
+{
+    //
+    // sizeof(struct _XUSB_GET_USER_INDEX)
+    // 
+    ULONG Size;
+
+    //
+    // Serial number of target device.
+    // 
+    ULONG SerialNo;
+
+    //
+    // User index of target device.
+    // 
+    OUT ULONG UserIndex;
+
+} XUSB_GET_USER_INDEX, *PXUSB_GET_USER_INDEX;
+
+//
+// Initializes XUSB_GET_USER_INDEX structure.
+// 
+VOID FORCEINLINE XUSB_GET_USER_INDEX_INIT(
+    _Out_ PXUSB_GET_USER_INDEX GetRequest,
+    _In_ ULONG SerialNo
+)
+{
+    RtlZeroMemory(GetRequest, sizeof(XUSB_GET_USER_INDEX));
+
+    GetRequest->Size = sizeof(XUSB_GET_USER_INDEX);
+    GetRequest->SerialNo = SerialNo;
+}
+
+#pragma endregion
+
+#pragma region DualShock 4 section
+
+typedef struct _DS4_OUTPUT_REPORT
+{
+    //
+    // Vibration intensity value of the small motor (0-255).
+    // 
+    UCHAR SmallMotor;
+
+    //
+    // Vibration intensity value of the large motor (0-255).
+    // 
+    UCHAR LargeMotor;
+
+    //
+    // Color values of the Lightbar.
+    //
+    DS4_LIGHTBAR_COLOR LightbarColor;
+
+} DS4_OUTPUT_REPORT, *PDS4_OUTPUT_REPORT;
+
+//
+// Data structure used in IOCTL_DS4_REQUEST_NOTIFICATION requests.
+// 
+typedef struct _DS4_REQUEST_NOTIFICATION
+{
+    //
+    // sizeof(struct _XUSB_REQUEST_NOTIFICATION)
+    // 
+    ULONG Size;
+
+    //
+    // Serial number of target device.
+    // 
+    ULONG SerialNo;
+
+    //
+    // The HID output report
+    // 
+    DS4_OUTPUT_REPORT Report;
+
+} DS4_REQUEST_NOTIFICATION, *PDS4_REQUEST_NOTIFICATION;
+
+//
+// Initializes a DS4_REQUEST_NOTIFICATION structure.
+// 
+VOID FORCEINLINE DS4_REQUEST_NOTIFICATION_INIT(
+    _Out_ PDS4_REQUEST_NOTIFICATION Request,
+    _In_ ULONG SerialNo
+)
+{
+    RtlZeroMemory(Request, sizeof(DS4_REQUEST_NOTIFICATION));
+
+    Request->Size = sizeof(DS4_REQUEST_NOTIFICATION);
+    Request->SerialNo = SerialNo;
+}
+
+//
+// DualShock 4 request data
+// 
+typedef struct _DS4_SUBMIT_REPORT
+{
+    //
+    // sizeof(struct _DS4_SUBMIT_REPORT)
+    // 
+    ULONG Size;
+
+    //
+    // Serial number of target device.
+    // 
+    ULONG SerialNo;
+
+    //
+    // HID Input report
+    // 
+    DS4_REPORT Report;
+
+} DS4_SUBMIT_REPORT, *PDS4_SUBMIT_REPORT;
+
+//
+// Initializes a DualShock 4 report.
+// 
+VOID FORCEINLINE DS4_SUBMIT_REPORT_INIT(
+    _Out_ PDS4_SUBMIT_REPORT Report,
+    _In_ ULONG SerialNo
+)
+{
+    RtlZeroMemory(Report, sizeof(DS4_SUBMIT_REPORT));
+
+    Report->Size = sizeof(DS4_SUBMIT_REPORT);
+    Report->SerialNo = SerialNo;
+
+    DS4_REPORT_INIT(&Report->Report);
+}
+
+#include <pshpack1.h>
+
+//
+// DualShock 4 extended report request
+// 
+typedef struct _DS4_SUBMIT_REPORT_EX
+{
+    //
+     // sizeof(struct _DS4_SUBMIT_REPORT_EX)
+     // 
+    _In_ ULONG Size;
+
+    //
+    // Serial number of target device.
+    // 
+    _In_ ULONG SerialNo;
+
+    //
+    // Full size HID report excluding fixed Report ID.
+    // 
+    _In_ DS4_REPORT_EX Report;
+
+} DS4_SUBMIT_REPORT_EX, * PDS4_SUBMIT_REPORT_EX;
+
+#include <poppack.h>
+
+//
+// Initializes a DualShock 4 extended report.
+// 
+VOID FORCEINLINE DS4_SUBMIT_REPORT_EX_INIT(
+    _Out_ PDS4_SUBMIT_REPORT_EX Report,
+    _In_ ULONG SerialNo
+)
+{
+    RtlZeroMemory(Report, sizeof(DS4_SUBMIT_REPORT_EX));
+
+    Report->Size = sizeof(DS4_SUBMIT_REPORT_EX);
+    Report->SerialNo = SerialNo;
+}
+
+#pragma endregion
+
+#pragma region DualShock 4 partial report
+
+//
+// Data structure used in IOCTL_DS4_SUBMIT_PARTIAL_REPORT requests.
+// 
+typedef struct _DS4_SUBMIT_PARTIAL_REPORT
+{
+    //
+    // FIELD_OFFSET(DS4_SUBMIT_PARTIAL_REPORT, Data) plus the bytes used in Data
+    // 
+    ULONG Size;
+
+    //
+    // Token obtained via IOCTL_VIGEM_GET_TARGET_TOKEN.
+    // 
+    ULONG Token;
+
+    //
+    // DS4_PARTIAL_FIELD_* bits of the fields carried in Data.
+    // 
+    ULONG FieldMask;
+
+    //
+    // The carried fields, packed back to back in ascending bit order.
+    // 
+    UCHAR Data[sizeof(DS4_REPORT_EX)];
+
+} DS4_SUBMIT_PARTIAL_REPORT, *PDS4_SUBMIT_PARTIAL_REPORT;
+
+//
+// Initializes a DS4_SUBMIT_PARTIAL_REPORT structure without any fields.
+// 
+VOID FORCEINLINE DS4_SUBMIT_PARTIAL_REPORT_INIT(
+    _Out_ PDS4_SUBMIT_PARTIAL_REPORT Report,
+    _In_ ULONG Token
+)
+{
+    RtlZeroMemory(Report, sizeof(DS4_SUBMIT_PARTIAL_REPORT));
+
+    Report->Size = FIELD_OFFSET(DS4_SUBMIT_PARTIAL_REPORT, Data);
+    Report->Token = Token;
+}
+
+//
+// Packs the fields selected by FieldMask of Source into a partial report.
+// 
+VOID FORCEINLINE DS4_SUBMIT_PARTIAL_REPORT_PACK(
+    _Inout_ PDS4_SUBMIT_PARTIAL_REPORT Report,
+    _In_ ULONG FieldMask,
+    _In_ const DS4_REPORT_EX* Source
+)
+{
+    const UCHAR offsets[] = DS4_PARTIAL_FIELD_OFFSETS;
+    ULONG length = 0;
+
+    FieldMask &= DS4_PARTIAL_FIELD_ALL;
+
+    for (ULONG field = 0; field < DS4_PARTIAL_FIELD_COUNT; field++)
+    {
+        if (!(FieldMask & (1UL << field)))
+            continue;
+
+        RtlCopyMemory(
+            &Report->Data[length],
+            &Source->ReportBuffer[offsets[field]],
+            offsets[field + 1] - offsets[field]
+        );
+
+        length += offsets[field + 1] - offsets[field];
+    }
+
+    Report->FieldMask = FieldMask;
+    Report->Size = FIELD_OFFSET(DS4_SUBMIT_PARTIAL_REPORT, Data) + length;
+}
+
+//
+// Merges the carried fields into Target, FALSE if Size doesn't match FieldMask.
+// 
+BOOLEAN FORCEINLINE DS4_SUBMIT_PARTIAL_REPORT_MERGE(
+    _In_ const DS4_SUBMIT_PARTIAL_REPORT* Report,
+    _Inout_ PDS4_REPORT_EX Target
+)
+{
+    const UCHAR offsets[] = DS4_PARTIAL_FIELD_OFFSETS;
+    ULONG length = 0;
+
+    if ((Report->FieldMask & ~DS4_PARTIAL_FIELD_ALL) != 0
+        || Report->Size < FIELD_OFFSET(DS4_SUBMIT_PARTIAL_REPORT, Data))
+        return FALSE;
+
+    for (ULONG field = 0; field < DS4_PARTIAL_FIELD_COUNT; field++)
+    {
+        if (Report->FieldMask & (1UL << field))
+            length += offsets[field + 1] - offsets[field];
+    }
+
+    if (Report->Size != FIELD_OFFSET(DS4_SUBMIT_PARTIAL_REPORT, Data) + length)
+        return FALSE;
+
+    length = 0;
+
+    for (ULONG field = 0; field < DS4_PARTIAL_FIELD_COUNT; field++)
+    {
+        if (!(Report->FieldMask & (1UL << field)))
+            continue;
+
+        RtlCopyMemory(
+            &Target->ReportBuffer[offsets[field]],
+            &Report->Data[length],
+            offsets[field + 1] - offsets[field]
+        );
+
+        length += offsets[field + 1] - offsets[field];
+    }
+
+    return TRUE;
+}
+
+#pragma endregion
+
+#pragma region DualShock 4 motion samples
+
+//
+// Maximum number of samples per IOCTL_DS4_SUBMIT_IMU_SAMPLES request.
+// 
+#define DS4_IMU_MAX_SAMPLES             64
+
+//
+// Playout delay used when a request doesn't specify one, in microseconds.
+// 
+#define DS4_IMU_DEFAULT_DELAY           10000
+
+#include <pshpack1.h>
+
+//
+// Data structure used in IOCTL_DS4_SUBMIT_IMU_SAMPLES requests.
+// 
+typedef struct _DS4_SUBMIT_IMU_SAMPLES
+{
+    //
+    // FIELD_OFFSET(DS4_SUBMIT_IMU_SAMPLES, Samples) plus Count samples
+    // 
+    IN ULONG Size;
+
+    //
+    // Token obtained via IOCTL_VIGEM_GET_TARGET_TOKEN.
+    // 
+    IN ULONG Token;
+
+    //
+    // Number of valid entries in Samples, in ascending timestamp order.
+    // 
+    IN ULONG Count;
+
+    //
+    // How far behind the current time the host sees the motion, in microseconds. 
+    // Samples arriving later than that are skipped. 0 selects DS4_IMU_DEFAULT_DELAY.
+    // 
+    IN ULONG Delay;
+
+    IN DS4_IMU_SAMPLE Samples[DS4_IMU_MAX_SAMPLES];
+
+} DS4_SUBMIT_IMU_SAMPLES, *PDS4_SUBMIT_IMU_SAMPLES;
+
+#include <poppack.h>
+
+//
+// Initializes the header of a DS4_SUBMIT_IMU_SAMPLES structure for Count samples.
+// 
+VOID FORCEINLINE DS4_SUBMIT_IMU_SAMPLES_INIT(
+    _Out_ PDS4_SUBMIT_IMU_SAMPLES Samples,
+    _In_ ULONG Token,
+    _In_ ULONG Count
+)
+{
+    RtlZeroMemory(Samples, FIELD_OFFSET(DS4_SUBMIT_IMU_SAMPLES, Samples));
+
+    Samples->Size = FIELD_OFFSET(DS4_SUBMIT_IMU_SAMPLES, Samples) + Count * sizeof(DS4_IMU_SAMPLE);
+    Samples->Token = Token;
+    Samples->Count = Count;
+}
+
+#pragma endregion
+
+#pragma region Scheduled report
+
+#include <pshpack1.h>
+
+//
+// Data structure used in IOCTL_VIGEM_SUBMIT_SCHEDULED_REPORT requests.
+// 
+typedef struct _VIGEM_SUBMIT_SCHEDULED_REPORT
+{
+    //
+    // sizeof(struct _VIGEM_SUBMIT_SCHEDULED_REPORT)
+    // 
+    IN ULONG Size;
+
+    //
+    // Token obtained via IOCTL_VIGEM_GET_TARGET_TOKEN.
+    // 
+    IN ULONG Token;
+
+    //
+    // Absolute performance counter value (QueryPerformanceCounter units) 
+    // before which the report must not be delivered to the host.
+    // 
+    IN LONGLONG DueTime;
+
+    //
+    // Report matching the type of the target.
+    // 
+    union
+    {
+        IN XUSB_REPORT Xusb;
+
+        IN DS4_REPORT_EX Ds4;
+    } Report;
+
+} VIGEM_SUBMIT_SCHEDULED_REPORT, *PVIGEM_SUBMIT_SCHEDULED_REPORT;
+
+#include <poppack.h>
+
+//
+// Initializes a VIGEM_SUBMIT_SCHEDULED_REPORT structure.
+// 
+VOID FORCEINLINE VIGEM_SUBMIT_SCHEDULED_REPORT_INIT(
+    _Out_ PVIGEM_SUBMIT_SCHEDULED_REPORT Report,
+    _In_ ULONG Token,
+    _In_ LONGLONG DueTime
+)
+{
+    RtlZeroMemory(Report, sizeof(VIGEM_SUBMIT_SCHEDULED_REPORT));
+
+    Report->Size = sizeof(VIGEM_SUBMIT_SCHEDULED_REPORT);
+    Report->Token = Token;
+    Report->DueTime = DueTime;
+}
+
+#pragma endregion
+
+#pragma region Frame commit
+
+#include <pshpack1.h>
+
+//
+// Data structure used in IOCTL_VIGEM_STAGE_REPORT requests.
+// 
+typedef struct _VIGEM_STAGE_REPORT
+{
+    //
+    // sizeof(struct _VIGEM_STAGE_REPORT)
+    // 
+    IN ULONG Size;
+
+    //
+    // Token obtained via IOCTL_VIGEM_GET_TARGET_TOKEN.
+    // 
+    IN ULONG Token;
+
+    //
+    // Report matching the type of the target, held back until the next
+    // IOCTL_VIGEM_COMMIT_FRAME on the same file handle.
+    // 
+    union
+    {
+        IN XUSB_REPORT Xusb;
+
+        IN DS4_REPORT_EX Ds4;
+    } Report;
+
+} VIGEM_STAGE_REPORT, *PVIGEM_STAGE_REPORT;
+
+#include <poppack.h>
+
+//
+// Initializes a VIGEM_STAGE_REPORT structure.
+// 
+VOID FORCEINLINE VIGEM_STAGE_REPORT_INIT(
+    _Out_ PVIGEM_STAGE_REPORT Report,
+    _In_ ULONG Token
+)
+{
+    RtlZeroMemory(Report, sizeof(VIGEM_STAGE_REPORT));
+
+    Report->Size = sizeof(VIGEM_STAGE_REPORT);
+    Report->Token = Token;
+}
+
+//
+// Data structure used in IOCTL_VIGEM_COMMIT_FRAME requests.
+// 
+typedef struct _VIGEM_COMMIT_FRAME
+{
+    //
+    // sizeof(struct _VIGEM_COMMIT_FRAME)
+    // 
+    IN ULONG Size;
+
+    //
+    // Number of targets the commit made new reports visible on.
+    // 
+    OUT ULONG TargetCount;
+
+    //
+    // Bus-wide sequence number of this commit.
+    // 
+    OUT LONGLONG Epoch;
+
+} VIGEM_COMMIT_FRAME, *PVIGEM_COMMIT_FRAME;
+
+//
+// Initializes a VIGEM_COMMIT_FRAME structure.
+// 
+VOID FORCEINLINE VIGEM_COMMIT_FRAME_INIT(
+    _Out_ PVIGEM_COMMIT_FRAME Commit
+)
+{
+    RtlZeroMemory(Commit, sizeof(VIGEM_COMMIT_FRAME));
+
+    Commit->Size = sizeof(VIGEM_COMMIT_FRAME);
+}
+
+#pragma endregion
+
+#pragma region Await poll
+
+//
+// Data structure used in IOCTL_VIGEM_AWAIT_POLL requests. The request stays 
+// pending until the host has an interrupt IN transfer waiting on the target.
+// 
+typedef struct _VIGEM_AWAIT_POLL
+{
+    //
+    // sizeof(struct _VIGEM_AWAIT_POLL)
+    // 
+    IN ULONG Size;
+
+    //
+    // Token obtained via IOCTL_VIGEM_GET_TARGET_TOKEN.
+    // 
+    IN ULONG Token;
+
+    //
+    // Performance counter value at which the host posted the transfer.
+    // 
+    OUT LONGLONG PollTime;
+
+    //
+    // Last measured time between two host transfers in microseconds, 0 if unknown.
+    // 
+    OUT ULONG PollInterval;
+
+} VIGEM_AWAIT_POLL, *PVIGEM_AWAIT_POLL;
+
+//
+// Initializes a VIGEM_AWAIT_POLL structure.
+// 
+VOID FORCEINLINE VIGEM_AWAIT_POLL_INIT(
+    _Out_ PVIGEM_AWAIT_POLL AwaitPoll,
+    _In_ ULONG Token
+)
+{
+    RtlZeroMemory(AwaitPoll, sizeof(VIGEM_AWAIT_POLL));
+
+    AwaitPoll->Size = sizeof(VIGEM_AWAIT_POLL);
+    AwaitPoll->Token = Token;
+}
+
+#pragma endregion
+
+#pragma region Target statistics
+
+//
+// Data structure used in IOCTL_VIGEM_GET_TARGET_STATISTICS requests.
+// 
+typedef struct _VIGEM_TARGET_STATISTICS
+{
+    //
+    // sizeof(struct _VIGEM_TARGET_STATISTICS)
+    // 
+    IN ULONG Size;
+
+    //
+    // Token obtained via IOCTL_VIGEM_GET_TARGET_TOKEN.
+    // 
+    IN ULONG Token;
+
+    //
+    // Interrupt IN transfer timing.
+    // 
+    OUT VIGEM_POLL_STATISTICS Polling;
+
+    //
+    // Memory footprint.
+    // 
+    OUT VIGEM_MEMORY_STATISTICS Memory;
+
+    //
+    // Time-to-first-input breakdown.
+    // 
+    OUT VIGEM_BOOT_TIMELINE Boot;
+
+    //
+    // Output transfer deduplication.
+    // 
+    OUT VIGEM_OUTPUT_STATISTICS Output;
+
+} VIGEM_TARGET_STATISTICS, *PVIGEM_TARGET_STATISTICS;
+
+//
+// Initializes a VIGEM_TARGET_STATISTICS structure.
+// 
+VOID FORCEINLINE VIGEM_TARGET_STATISTICS_INIT(
+    _Out_ PVIGEM_TARGET_STATISTICS Statistics,
+    _In_ ULONG Token
+)
+{
+    RtlZeroMemory(Statistics, sizeof(VIGEM_TARGET_STATISTICS));
+
+    Statistics->Size = sizeof(VIGEM_TARGET_STATISTICS);
+    Statistics->Token = Token;
 }
 
 #pragma endregion
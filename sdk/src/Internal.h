@@ -38,6 +38,16 @@ typedef struct _VIGEM_CLIENT_T
 {
     HANDLE hBusDevice;
 
+    //
+    // Output state page kept up to date by the driver (NULL if not mapped)
+    // 
+    PVIGEM_OUTPUT_STATE_PAGE OutputState;
+
+    //
+    // Carries the pending request backing OutputState
+    // 
+    OVERLAPPED OutputStateOverlapped;
+
 } VIGEM_CLIENT;
 
 //
@@ -60,12 +70,61 @@ typedef struct _VIGEM_TARGET_T
 {
     ULONG Size;
     ULONG SerialNo;
+    ULONG Token;
     VIGEM_TARGET_STATE State;
     USHORT VendorId;
     USHORT ProductId;
+    UCHAR PollingInterval;
+    USHORT OutputBufferCount;
+    ULONG PlugInFlags;
     VIGEM_TARGET_TYPE Type;
     FARPROC Notification;
     LPVOID NotificationUserData;
 
 	HANDLE cancelNotificationThreadEvent;
 } VIGEM_TARGET;
+
+//
+// Shaping parameters of one analog input.
+// 
+typedef struct _VIGEM_TRANSFORM_AXIS_SPEC
+{
+    double Deadzone;
+    double Saturation;
+    double Exponent;
+    BOOL Invert;
+} VIGEM_TRANSFORM_AXIS_SPEC, *PVIGEM_TRANSFORM_AXIS_SPEC;
+
+//
+// Represents an input transform and the lookup tables compiled from it.
+// 
+typedef struct _VIGEM_TRANSFORM_T
+{
+    VIGEM_TRANSFORM_AXIS_SPEC Axes[VIGEM_TRANSFORM_AXIS_COUNT];
+
+    //
+    // Reported flags per source button bit
+    // 
+    USHORT X360Mapping[16];
+    USHORT Ds4Mapping[16];
+
+    //
+    // Set when the tables below are out of date
+    // 
+    BOOL X360Dirty;
+    BOOL Ds4Dirty;
+
+    //
+    // Xbox 360 tables, sticks indexed by the raw 16-bit value
+    // 
+    SHORT X360Sticks[4][USHRT_MAX + 1];
+    UCHAR X360Triggers[2][UCHAR_MAX + 1];
+    USHORT X360Buttons[2][UCHAR_MAX + 1];
+
+    //
+    // DualShock 4 tables
+    // 
+    UCHAR Ds4Sticks[4][UCHAR_MAX + 1];
+    UCHAR Ds4Triggers[2][UCHAR_MAX + 1];
+    USHORT Ds4Buttons[2][UCHAR_MAX + 1];
+} VIGEM_TRANSFORM;
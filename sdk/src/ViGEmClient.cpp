@@ -94,6 +94,191 @@ PVIGEM_TARGET FORCEINLINE VIGEM_TARGET_ALLOC_INIT(
     return target;
 }
 
+//
+// Requests a handle from the bus which speeds up report submission. Failure is not
+// fatal, the target simply keeps being addressed by serial number.
+// 
+static void vigem_internal_acquire_token(PVIGEM_CLIENT vigem, PVIGEM_TARGET target)
+{
+    DWORD transferred = 0;
+    OVERLAPPED lOverlapped = { 0 };
+    lOverlapped.hEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+    VIGEM_GET_TARGET_TOKEN gtt;
+    VIGEM_GET_TARGET_TOKEN_INIT(&gtt, target->SerialNo);
+
+    DeviceIoControl(
+        vigem->hBusDevice,
+        IOCTL_VIGEM_GET_TARGET_TOKEN,
+        &gtt,
+        gtt.Size,
+        &gtt,
+        gtt.Size,
+        &transferred,
+        &lOverlapped
+    );
+
+    target->Token = (GetOverlappedResult(vigem->hBusDevice, &lOverlapped, &transferred, TRUE) != 0)
+        ? gtt.Token
+        : 0;
+
+    CloseHandle(lOverlapped.hEvent);
+}
+
+//
+// True if the target needs VIGEM_PLUGIN_TARGET_EX to be plugged in as configured.
+// 
+static bool vigem_internal_has_plugin_options(PVIGEM_TARGET target)
+{
+    return target->PollingInterval || target->OutputBufferCount || target->PlugInFlags;
+}
+
+//
+// Asks the bus for an already booted target from its standby pool. Fails if the pool
+// is disabled, empty or the driver predates it; the caller then plugs in a new target.
+// 
+static bool vigem_internal_claim_standby(PVIGEM_CLIENT vigem, PVIGEM_TARGET target)
+{
+    DWORD transferred = 0;
+    OVERLAPPED lOverlapped = { 0 };
+    lOverlapped.hEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+    VIGEM_CLAIM_STANDBY_TARGET cst;
+    VIGEM_CLAIM_STANDBY_TARGET_INIT(&cst, target->Type, target->VendorId, target->ProductId);
+
+    DeviceIoControl(
+        vigem->hBusDevice,
+        IOCTL_VIGEM_CLAIM_STANDBY_TARGET,
+        &cst,
+        cst.Size,
+        &cst,
+        cst.Size,
+        &transferred,
+        &lOverlapped
+    );
+
+    const bool claimed = (GetOverlappedResult(vigem->hBusDevice, &lOverlapped, &transferred, TRUE) != 0);
+
+    if (claimed)
+        target->SerialNo = cst.SerialNo;
+
+    CloseHandle(lOverlapped.hEvent);
+
+    return claimed;
+}
+
+//
+// Common part of the scheduled report submission APIs
+// 
+static VIGEM_ERROR vigem_internal_submit_scheduled(PVIGEM_CLIENT vigem, PVIGEM_SUBMIT_SCHEDULED_REPORT ssr)
+{
+    VIGEM_ERROR error = VIGEM_ERROR_NONE;
+    DWORD transferred = 0;
+    OVERLAPPED lOverlapped = { 0 };
+    lOverlapped.hEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+    DeviceIoControl(
+        vigem->hBusDevice,
+        IOCTL_VIGEM_SUBMIT_SCHEDULED_REPORT,
+        ssr,
+        ssr->Size,
+        nullptr,
+        0,
+        &transferred,
+        &lOverlapped
+    );
+
+    if (GetOverlappedResult(vigem->hBusDevice, &lOverlapped, &transferred, TRUE) == 0)
+    {
+        switch (GetLastError())
+        {
+        case ERROR_ACCESS_DENIED:
+            error = VIGEM_ERROR_INVALID_TARGET;
+            break;
+        case ERROR_BUSY:
+            error = VIGEM_ERROR_QUEUE_FULL;
+            break;
+        default:
+            error = VIGEM_ERROR_NOT_SUPPORTED;
+            break;
+        }
+    }
+
+    CloseHandle(lOverlapped.hEvent);
+
+    return error;
+}
+
+//
+// Ends the pending page request and frees the page
+// 
+static void vigem_internal_unmap_output_state(PVIGEM_CLIENT vigem)
+{
+    if (!vigem->OutputState)
+        return;
+
+    DWORD transferred = 0;
+
+    CancelIoEx(vigem->hBusDevice, &vigem->OutputStateOverlapped);
+    GetOverlappedResult(vigem->hBusDevice, &vigem->OutputStateOverlapped, &transferred, TRUE);
+
+    CloseHandle(vigem->OutputStateOverlapped.hEvent);
+    VirtualFree(vigem->OutputState, 0, MEM_RELEASE);
+
+    vigem->OutputState = nullptr;
+    RtlZeroMemory(&vigem->OutputStateOverlapped, sizeof(OVERLAPPED));
+}
+
+//
+// Common part of the output state getters, never enters the driver
+// 
+static VIGEM_ERROR vigem_internal_read_output_state(
+    PVIGEM_CLIENT vigem,
+    PVIGEM_TARGET target,
+    VIGEM_TARGET_TYPE type,
+    PVIGEM_OUTPUT_STATE state
+)
+{
+    if (!vigem)
+        return VIGEM_ERROR_BUS_INVALID_HANDLE;
+
+    if (!target || target->Type != type)
+        return VIGEM_ERROR_INVALID_TARGET;
+
+    if (target->State != VIGEM_TARGET_CONNECTED)
+        return VIGEM_ERROR_TARGET_NOT_PLUGGED_IN;
+
+    if (!vigem->OutputState || !vigem->OutputState->Active)
+        return VIGEM_ERROR_NOT_SUPPORTED;
+
+    for (const auto& entry : vigem->OutputState->Targets)
+    {
+        if (entry.SerialNo != target->SerialNo)
+            continue;
+
+        while (!VIGEM_OUTPUT_STATE_READ(&entry, state))
+            YieldProcessor();
+
+        //
+        // The entry may have been handed to another target meanwhile
+        // 
+        if (state->SerialNo == target->SerialNo)
+            return VIGEM_ERROR_NONE;
+
+        break;
+    }
+
+    //
+    // No output received yet
+    // 
+    RtlZeroMemory(state, sizeof(VIGEM_OUTPUT_STATE));
+    state->SerialNo = target->SerialNo;
+    state->TargetType = type;
+    state->LedNumber = 0xFF;
+
+    return VIGEM_ERROR_NONE;
+}
+
 #ifdef VIGEM_USE_CRASH_HANDLER
 LONG WINAPI vigem_internal_exception_handler(struct _EXCEPTION_POINTERS* apExceptionInfo)
 {
@@ -283,6 +468,8 @@ void vigem_disconnect(PVIGEM_CLIENT vigem)
 
     if (vigem->hBusDevice != INVALID_HANDLE_VALUE)
     {
+        vigem_internal_unmap_output_state(vigem);
+
         CloseHandle(vigem->hBusDevice);
 
         RtlZeroMemory(vigem, sizeof(VIGEM_CLIENT));
@@ -326,7 +513,7 @@ VIGEM_ERROR vigem_target_add(PVIGEM_CLIENT vigem, PVIGEM_TARGET target)
 {
     VIGEM_ERROR error = VIGEM_ERROR_NO_FREE_SLOT;
     DWORD transferred = 0;
-    VIGEM_PLUGIN_TARGET plugin;
+    VIGEM_PLUGIN_TARGET_EX plugin;
     VIGEM_WAIT_DEVICE_READY devReady;
     OVERLAPPED olPlugIn = { 0 };
     olPlugIn.hEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
@@ -364,15 +551,40 @@ VIGEM_ERROR vigem_target_add(PVIGEM_CLIENT vigem, PVIGEM_TARGET target)
         	break;
         }       
 
+        target->Token = 0;
+
+        //
+        // Pooled targets only come with default options
+        // 
+        if (!vigem_internal_has_plugin_options(target)
+            && vigem_internal_claim_standby(vigem, target))
+        {
+            target->State = VIGEM_TARGET_CONNECTED;
+
+            vigem_internal_acquire_token(vigem, target);
+
+            error = VIGEM_ERROR_NONE;
+            break;
+        }
+
     	//
     	// TODO: this is mad stupid, redesign, so that the bus fills the assigned slot
     	// 
         for (target->SerialNo = 1; target->SerialNo <= VIGEM_TARGETS_MAX; target->SerialNo++)
         {
-	        VIGEM_PLUGIN_TARGET_INIT(&plugin, target->SerialNo, target->Type);
+	        VIGEM_PLUGIN_TARGET_EX_INIT(&plugin, target->SerialNo, target->Type);
 
 	        plugin.VendorId = target->VendorId;
 	        plugin.ProductId = target->ProductId;
+	        plugin.PollingInterval = target->PollingInterval;
+	        plugin.OutputBufferCount = target->OutputBufferCount;
+	        plugin.Flags = target->PlugInFlags;
+
+	        //
+	        // Only send the extended structure if needed so older drivers keep working
+	        // 
+	        if (!vigem_internal_has_plugin_options(target))
+		        plugin.Size = sizeof(VIGEM_PLUGIN_TARGET);
 
         	/*
         	 * Request plugin of device. This is an inherently asynchronous operation,
@@ -429,6 +641,8 @@ VIGEM_ERROR vigem_target_add(PVIGEM_CLIENT vigem, PVIGEM_TARGET target)
 		        {
 			        target->State = VIGEM_TARGET_CONNECTED;
 
+			        vigem_internal_acquire_token(vigem, target);
+
 			        error = VIGEM_ERROR_NONE;
 			        break;
 		        }
@@ -535,6 +749,7 @@ VIGEM_ERROR vigem_target_remove(PVIGEM_CLIENT vigem, PVIGEM_TARGET target)
     if (GetOverlappedResult(vigem->hBusDevice, &lOverlapped, &transfered, TRUE) != 0)
     {
         target->State = VIGEM_TARGET_DISCONNECTED;
+        target->Token = 0;
         CloseHandle(lOverlapped.hEvent);
 
         return VIGEM_ERROR_NONE;
@@ -771,6 +986,45 @@ USHORT vigem_target_get_pid(PVIGEM_TARGET target)
     return target->ProductId;
 }
 
+void vigem_target_set_polling_interval(PVIGEM_TARGET target, UCHAR interval)
+{
+    target->PollingInterval = interval;
+}
+
+UCHAR vigem_target_get_polling_interval(PVIGEM_TARGET target)
+{
+    return target->PollingInterval;
+}
+
+void vigem_target_set_output_buffer_count(PVIGEM_TARGET target, USHORT count)
+{
+    target->OutputBufferCount = count;
+}
+
+void vigem_target_set_fast_boot(PVIGEM_TARGET target, BOOL enabled)
+{
+    if (enabled)
+        target->PlugInFlags |= VIGEM_PLUGIN_FLAG_FAST_BOOT;
+    else
+        target->PlugInFlags &= ~VIGEM_PLUGIN_FLAG_FAST_BOOT;
+}
+
+void vigem_target_set_keep_duplicate_output(PVIGEM_TARGET target, BOOL enabled)
+{
+    if (enabled)
+        target->PlugInFlags |= VIGEM_PLUGIN_FLAG_KEEP_DUPLICATE_OUTPUT;
+    else
+        target->PlugInFlags &= ~VIGEM_PLUGIN_FLAG_KEEP_DUPLICATE_OUTPUT;
+}
+
+void vigem_target_set_driver_counters(PVIGEM_TARGET target, BOOL enabled)
+{
+    if (enabled)
+        target->PlugInFlags |= VIGEM_PLUGIN_FLAG_DRIVER_COUNTERS;
+    else
+        target->PlugInFlags &= ~VIGEM_PLUGIN_FLAG_DRIVER_COUNTERS;
+}
+
 VIGEM_ERROR vigem_target_x360_update(
     PVIGEM_CLIENT vigem,
     PVIGEM_TARGET target,
@@ -794,13 +1048,13 @@ VIGEM_ERROR vigem_target_x360_update(
     lOverlapped.hEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
 
     XUSB_SUBMIT_REPORT xsr;
-    XUSB_SUBMIT_REPORT_INIT(&xsr, target->SerialNo);
+    XUSB_SUBMIT_REPORT_INIT(&xsr, (target->Token) ? target->Token : target->SerialNo);
 
     xsr.Report = report;
 
     DeviceIoControl(
         vigem->hBusDevice,
-        IOCTL_XUSB_SUBMIT_REPORT,
+        (target->Token) ? IOCTL_XUSB_SUBMIT_REPORT_BY_TOKEN : IOCTL_XUSB_SUBMIT_REPORT,
         &xsr,
         xsr.Size,
         nullptr,
@@ -846,13 +1100,13 @@ VIGEM_ERROR vigem_target_ds4_update(
     lOverlapped.hEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
 
     DS4_SUBMIT_REPORT dsr;
-    DS4_SUBMIT_REPORT_INIT(&dsr, target->SerialNo);
+    DS4_SUBMIT_REPORT_INIT(&dsr, (target->Token) ? target->Token : target->SerialNo);
 
     dsr.Report = report;
 
     DeviceIoControl(
         vigem->hBusDevice,
-        IOCTL_DS4_SUBMIT_REPORT,
+        (target->Token) ? IOCTL_DS4_SUBMIT_REPORT_BY_TOKEN : IOCTL_DS4_SUBMIT_REPORT,
         &dsr,
         dsr.Size,
         nullptr,
@@ -894,13 +1148,14 @@ VIGEM_ERROR vigem_target_ds4_update_ex(PVIGEM_CLIENT vigem, PVIGEM_TARGET target
 	lOverlapped.hEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
 
 	DS4_SUBMIT_REPORT_EX dsr;
-	DS4_SUBMIT_REPORT_EX_INIT(&dsr, target->SerialNo);
+	DS4_SUBMIT_REPORT_EX_INIT(&dsr, (target->Token) ? target->Token : target->SerialNo);
 
 	dsr.Report = report;
 
 	DeviceIoControl(
 		vigem->hBusDevice,
-		IOCTL_DS4_SUBMIT_REPORT, // Same IOCTL, just different size
+		// Same IOCTLs, just different size
+		(target->Token) ? IOCTL_DS4_SUBMIT_REPORT_BY_TOKEN : IOCTL_DS4_SUBMIT_REPORT,
 		&dsr,
 		dsr.Size,
 		nullptr,
@@ -936,6 +1191,141 @@ VIGEM_ERROR vigem_target_ds4_update_ex(PVIGEM_CLIENT vigem, PVIGEM_TARGET target
 	return VIGEM_ERROR_NONE;
 }
 
+VIGEM_ERROR vigem_target_ds4_update_fields(PVIGEM_CLIENT vigem, PVIGEM_TARGET target, ULONG fieldMask, DS4_REPORT_EX report)
+{
+	if (!vigem)
+		return VIGEM_ERROR_BUS_INVALID_HANDLE;
+
+	if (!target)
+		return VIGEM_ERROR_INVALID_TARGET;
+
+	if (vigem->hBusDevice == INVALID_HANDLE_VALUE)
+		return VIGEM_ERROR_BUS_NOT_FOUND;
+
+	if (target->SerialNo == 0 || target->Type != DualShock4Wired)
+		return VIGEM_ERROR_INVALID_TARGET;
+
+	if (fieldMask == 0 || (fieldMask & ~DS4_PARTIAL_FIELD_ALL))
+		return VIGEM_ERROR_INVALID_PARAMETER;
+
+	//
+	// Partial reports are only offered by drivers which hand out tokens
+	// 
+	if (target->Token == 0)
+		return VIGEM_ERROR_NOT_SUPPORTED;
+
+	VIGEM_ERROR error = VIGEM_ERROR_NONE;
+	DWORD transferred = 0;
+	OVERLAPPED lOverlapped = {0};
+	lOverlapped.hEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+	DS4_SUBMIT_PARTIAL_REPORT dpr;
+	DS4_SUBMIT_PARTIAL_REPORT_INIT(&dpr, target->Token);
+	DS4_SUBMIT_PARTIAL_REPORT_PACK(&dpr, fieldMask, &report);
+
+	DeviceIoControl(
+		vigem->hBusDevice,
+		IOCTL_DS4_SUBMIT_PARTIAL_REPORT,
+		&dpr,
+		dpr.Size,
+		nullptr,
+		0,
+		&transferred,
+		&lOverlapped
+	);
+
+	if (GetOverlappedResult(vigem->hBusDevice, &lOverlapped, &transferred, TRUE) == 0)
+	{
+		switch (GetLastError())
+		{
+		case ERROR_ACCESS_DENIED:
+			error = VIGEM_ERROR_INVALID_TARGET;
+			break;
+		case ERROR_INVALID_FUNCTION:
+			error = VIGEM_ERROR_NOT_SUPPORTED;
+			break;
+		default:
+			break;
+		}
+	}
+
+	CloseHandle(lOverlapped.hEvent);
+
+	return error;
+}
+
+VIGEM_ERROR vigem_target_ds4_stream_motion(
+	PVIGEM_CLIENT vigem,
+	PVIGEM_TARGET target,
+	const DS4_IMU_SAMPLE* samples,
+	ULONG count,
+	ULONG delay
+)
+{
+	if (!vigem)
+		return VIGEM_ERROR_BUS_INVALID_HANDLE;
+
+	if (!target)
+		return VIGEM_ERROR_INVALID_TARGET;
+
+	if (vigem->hBusDevice == INVALID_HANDLE_VALUE)
+		return VIGEM_ERROR_BUS_NOT_FOUND;
+
+	if (target->SerialNo == 0 || target->Type != DualShock4Wired)
+		return VIGEM_ERROR_INVALID_TARGET;
+
+	if (!samples && count > 0)
+		return VIGEM_ERROR_INVALID_PARAMETER;
+
+	//
+	// Motion streams are only offered by drivers which hand out tokens
+	// 
+	if (target->Token == 0)
+		return VIGEM_ERROR_NOT_SUPPORTED;
+
+	VIGEM_ERROR error = VIGEM_ERROR_NONE;
+	DWORD transferred = 0;
+	OVERLAPPED lOverlapped = {0};
+	lOverlapped.hEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+	DS4_SUBMIT_IMU_SAMPLES dis;
+
+	//
+	// Larger batches go out in chunks the driver accepts
+	// 
+	for (ULONG offset = 0; offset < count && VIGEM_SUCCESS(error); offset += DS4_IMU_MAX_SAMPLES)
+	{
+		const ULONG chunk = (count - offset > DS4_IMU_MAX_SAMPLES) ? DS4_IMU_MAX_SAMPLES : count - offset;
+
+		DS4_SUBMIT_IMU_SAMPLES_INIT(&dis, target->Token, chunk);
+		dis.Delay = delay;
+
+		CopyMemory(dis.Samples, &samples[offset], chunk * sizeof(DS4_IMU_SAMPLE));
+
+		DeviceIoControl(
+			vigem->hBusDevice,
+			IOCTL_DS4_SUBMIT_IMU_SAMPLES,
+			&dis,
+			dis.Size,
+			nullptr,
+			0,
+			&transferred,
+			&lOverlapped
+		);
+
+		if (GetOverlappedResult(vigem->hBusDevice, &lOverlapped, &transferred, TRUE) == 0)
+		{
+			error = (GetLastError() == ERROR_ACCESS_DENIED)
+				? VIGEM_ERROR_INVALID_TARGET
+				: VIGEM_ERROR_NOT_SUPPORTED;
+		}
+	}
+
+	CloseHandle(lOverlapped.hEvent);
+
+	return error;
+}
+
 ULONG vigem_target_get_index(PVIGEM_TARGET target)
 {
     return target->SerialNo;
@@ -1013,3 +1403,1154 @@ VIGEM_ERROR vigem_target_x360_get_user_index(
 
     return VIGEM_ERROR_NONE;
 }
+
+VIGEM_ERROR vigem_target_x360_update_scheduled(
+    PVIGEM_CLIENT vigem,
+    PVIGEM_TARGET target,
+    XUSB_REPORT report,
+    LONGLONG dueTime
+)
+{
+    if (!vigem)
+        return VIGEM_ERROR_BUS_INVALID_HANDLE;
+
+    if (!target)
+        return VIGEM_ERROR_INVALID_TARGET;
+
+    if (vigem->hBusDevice == INVALID_HANDLE_VALUE)
+        return VIGEM_ERROR_BUS_NOT_FOUND;
+
+    if (target->SerialNo == 0 || target->Type != Xbox360Wired)
+        return VIGEM_ERROR_INVALID_TARGET;
+
+    //
+    // Scheduling is only offered by drivers which hand out tokens
+    // 
+    if (target->Token == 0)
+        return VIGEM_ERROR_NOT_SUPPORTED;
+
+    VIGEM_SUBMIT_SCHEDULED_REPORT ssr;
+    VIGEM_SUBMIT_SCHEDULED_REPORT_INIT(&ssr, target->Token, dueTime);
+
+    ssr.Report.Xusb = report;
+
+    return vigem_internal_submit_scheduled(vigem, &ssr);
+}
+
+VIGEM_ERROR vigem_target_ds4_update_ex_scheduled(
+    PVIGEM_CLIENT vigem,
+    PVIGEM_TARGET target,
+    DS4_REPORT_EX report,
+    LONGLONG dueTime
+)
+{
+    if (!vigem)
+        return VIGEM_ERROR_BUS_INVALID_HANDLE;
+
+    if (!target)
+        return VIGEM_ERROR_INVALID_TARGET;
+
+    if (vigem->hBusDevice == INVALID_HANDLE_VALUE)
+        return VIGEM_ERROR_BUS_NOT_FOUND;
+
+    if (target->SerialNo == 0 || target->Type != DualShock4Wired)
+        return VIGEM_ERROR_INVALID_TARGET;
+
+    //
+    // Scheduling is only offered by drivers which hand out tokens
+    // 
+    if (target->Token == 0)
+        return VIGEM_ERROR_NOT_SUPPORTED;
+
+    VIGEM_SUBMIT_SCHEDULED_REPORT ssr;
+    VIGEM_SUBMIT_SCHEDULED_REPORT_INIT(&ssr, target->Token, dueTime);
+
+    ssr.Report.Ds4 = report;
+
+    return vigem_internal_submit_scheduled(vigem, &ssr);
+}
+
+//
+// Common part of the report staging APIs
+// 
+static VIGEM_ERROR vigem_internal_stage(PVIGEM_CLIENT vigem, PVIGEM_STAGE_REPORT vsr)
+{
+    VIGEM_ERROR error = VIGEM_ERROR_NONE;
+    DWORD transferred = 0;
+    OVERLAPPED lOverlapped = { 0 };
+    lOverlapped.hEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+    DeviceIoControl(
+        vigem->hBusDevice,
+        IOCTL_VIGEM_STAGE_REPORT,
+        vsr,
+        vsr->Size,
+        nullptr,
+        0,
+        &transferred,
+        &lOverlapped
+    );
+
+    if (GetOverlappedResult(vigem->hBusDevice, &lOverlapped, &transferred, TRUE) == 0)
+    {
+        error = (GetLastError() == ERROR_ACCESS_DENIED)
+            ? VIGEM_ERROR_INVALID_TARGET
+            : VIGEM_ERROR_NOT_SUPPORTED;
+    }
+
+    CloseHandle(lOverlapped.hEvent);
+
+    return error;
+}
+
+VIGEM_ERROR vigem_target_x360_stage(
+    PVIGEM_CLIENT vigem,
+    PVIGEM_TARGET target,
+    XUSB_REPORT report
+)
+{
+    if (!vigem)
+        return VIGEM_ERROR_BUS_INVALID_HANDLE;
+
+    if (!target)
+        return VIGEM_ERROR_INVALID_TARGET;
+
+    if (vigem->hBusDevice == INVALID_HANDLE_VALUE)
+        return VIGEM_ERROR_BUS_NOT_FOUND;
+
+    if (target->SerialNo == 0 || target->Type != Xbox360Wired)
+        return VIGEM_ERROR_INVALID_TARGET;
+
+    if (target->Token == 0)
+        return VIGEM_ERROR_NOT_SUPPORTED;
+
+    VIGEM_STAGE_REPORT vsr;
+    VIGEM_STAGE_REPORT_INIT(&vsr, target->Token);
+
+    vsr.Report.Xusb = report;
+
+    return vigem_internal_stage(vigem, &vsr);
+}
+
+VIGEM_ERROR vigem_target_ds4_stage_ex(
+    PVIGEM_CLIENT vigem,
+    PVIGEM_TARGET target,
+    DS4_REPORT_EX report
+)
+{
+    if (!vigem)
+        return VIGEM_ERROR_BUS_INVALID_HANDLE;
+
+    if (!target)
+        return VIGEM_ERROR_INVALID_TARGET;
+
+    if (vigem->hBusDevice == INVALID_HANDLE_VALUE)
+        return VIGEM_ERROR_BUS_NOT_FOUND;
+
+    if (target->SerialNo == 0 || target->Type != DualShock4Wired)
+        return VIGEM_ERROR_INVALID_TARGET;
+
+    if (target->Token == 0)
+        return VIGEM_ERROR_NOT_SUPPORTED;
+
+    VIGEM_STAGE_REPORT vsr;
+    VIGEM_STAGE_REPORT_INIT(&vsr, target->Token);
+
+    vsr.Report.Ds4 = report;
+
+    return vigem_internal_stage(vigem, &vsr);
+}
+
+VIGEM_ERROR vigem_commit_frame(PVIGEM_CLIENT vigem, PULONG targetCount)
+{
+    if (!vigem)
+        return VIGEM_ERROR_BUS_INVALID_HANDLE;
+
+    if (vigem->hBusDevice == INVALID_HANDLE_VALUE)
+        return VIGEM_ERROR_BUS_NOT_FOUND;
+
+    DWORD transferred = 0;
+    OVERLAPPED lOverlapped = { 0 };
+    lOverlapped.hEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+    VIGEM_COMMIT_FRAME vcf;
+    VIGEM_COMMIT_FRAME_INIT(&vcf);
+
+    DeviceIoControl(
+        vigem->hBusDevice,
+        IOCTL_VIGEM_COMMIT_FRAME,
+        &vcf,
+        vcf.Size,
+        &vcf,
+        vcf.Size,
+        &transferred,
+        &lOverlapped
+    );
+
+    if (GetOverlappedResult(vigem->hBusDevice, &lOverlapped, &transferred, TRUE) == 0)
+    {
+        CloseHandle(lOverlapped.hEvent);
+        return VIGEM_ERROR_NOT_SUPPORTED;
+    }
+
+    CloseHandle(lOverlapped.hEvent);
+
+    if (targetCount)
+        *targetCount = vcf.TargetCount;
+
+    return VIGEM_ERROR_NONE;
+}
+
+VIGEM_ERROR vigem_target_await_poll(
+    PVIGEM_CLIENT vigem,
+    PVIGEM_TARGET target,
+    DWORD milliseconds,
+    PULONG pollInterval
+)
+{
+    if (!vigem)
+        return VIGEM_ERROR_BUS_INVALID_HANDLE;
+
+    if (!target)
+        return VIGEM_ERROR_INVALID_TARGET;
+
+    if (vigem->hBusDevice == INVALID_HANDLE_VALUE)
+        return VIGEM_ERROR_BUS_NOT_FOUND;
+
+    if (target->SerialNo == 0)
+        return VIGEM_ERROR_INVALID_TARGET;
+
+    if (target->Token == 0)
+        return VIGEM_ERROR_NOT_SUPPORTED;
+
+    VIGEM_ERROR error = VIGEM_ERROR_NONE;
+    DWORD transferred = 0;
+    OVERLAPPED lOverlapped = { 0 };
+    // Manual reset, gets waited on twice
+    lOverlapped.hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+
+    VIGEM_AWAIT_POLL vap;
+    VIGEM_AWAIT_POLL_INIT(&vap, target->Token);
+
+    DeviceIoControl(
+        vigem->hBusDevice,
+        IOCTL_VIGEM_AWAIT_POLL,
+        &vap,
+        vap.Size,
+        &vap,
+        vap.Size,
+        &transferred,
+        &lOverlapped
+    );
+
+    if (WaitForSingleObject(lOverlapped.hEvent, milliseconds) == WAIT_TIMEOUT)
+    {
+        CancelIoEx(vigem->hBusDevice, &lOverlapped);
+        error = VIGEM_ERROR_TIMED_OUT;
+    }
+
+    if (GetOverlappedResult(vigem->hBusDevice, &lOverlapped, &transferred, TRUE) == 0)
+    {
+        if (error == VIGEM_ERROR_NONE)
+        {
+            error = (GetLastError() == ERROR_ACCESS_DENIED)
+                ? VIGEM_ERROR_INVALID_TARGET
+                : VIGEM_ERROR_NOT_SUPPORTED;
+        }
+    }
+    else if (error == VIGEM_ERROR_TIMED_OUT)
+    {
+        //
+        // Completed in the window before cancellation took effect
+        // 
+        error = VIGEM_ERROR_NONE;
+    }
+
+    CloseHandle(lOverlapped.hEvent);
+
+    if (VIGEM_SUCCESS(error) && pollInterval)
+        *pollInterval = vap.PollInterval;
+
+    return error;
+}
+
+static VIGEM_ERROR vigem_internal_get_statistics(
+    PVIGEM_CLIENT vigem,
+    PVIGEM_TARGET target,
+    PVIGEM_TARGET_STATISTICS statistics
+)
+{
+    if (!vigem)
+        return VIGEM_ERROR_BUS_INVALID_HANDLE;
+
+    if (!target)
+        return VIGEM_ERROR_INVALID_TARGET;
+
+    if (vigem->hBusDevice == INVALID_HANDLE_VALUE)
+        return VIGEM_ERROR_BUS_NOT_FOUND;
+
+    if (target->SerialNo == 0)
+        return VIGEM_ERROR_INVALID_TARGET;
+
+    if (target->Token == 0)
+        return VIGEM_ERROR_NOT_SUPPORTED;
+
+    DWORD transferred = 0;
+    OVERLAPPED lOverlapped = { 0 };
+    lOverlapped.hEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+    VIGEM_TARGET_STATISTICS_INIT(statistics, target->Token);
+
+    DeviceIoControl(
+        vigem->hBusDevice,
+        IOCTL_VIGEM_GET_TARGET_STATISTICS,
+        statistics,
+        statistics->Size,
+        statistics,
+        statistics->Size,
+        &transferred,
+        &lOverlapped
+    );
+
+    if (GetOverlappedResult(vigem->hBusDevice, &lOverlapped, &transferred, TRUE) == 0)
+    {
+        const auto error = GetLastError();
+
+        CloseHandle(lOverlapped.hEvent);
+
+        return (error == ERROR_ACCESS_DENIED)
+            ? VIGEM_ERROR_INVALID_TARGET
+            : VIGEM_ERROR_NOT_SUPPORTED;
+    }
+
+    CloseHandle(lOverlapped.hEvent);
+
+    return VIGEM_ERROR_NONE;
+}
+
+VIGEM_ERROR vigem_target_get_poll_statistics(
+    PVIGEM_CLIENT vigem,
+    PVIGEM_TARGET target,
+    PVIGEM_POLL_STATISTICS statistics
+)
+{
+    if (!statistics)
+        return VIGEM_ERROR_INVALID_PARAMETER;
+
+    VIGEM_TARGET_STATISTICS vts;
+
+    const auto error = vigem_internal_get_statistics(vigem, target, &vts);
+
+    if (VIGEM_SUCCESS(error))
+        *statistics = vts.Polling;
+
+    return error;
+}
+
+VIGEM_ERROR vigem_target_get_memory_statistics(
+    PVIGEM_CLIENT vigem,
+    PVIGEM_TARGET target,
+    PVIGEM_MEMORY_STATISTICS statistics
+)
+{
+    if (!statistics)
+        return VIGEM_ERROR_INVALID_PARAMETER;
+
+    VIGEM_TARGET_STATISTICS vts;
+
+    const auto error = vigem_internal_get_statistics(vigem, target, &vts);
+
+    if (VIGEM_SUCCESS(error))
+        *statistics = vts.Memory;
+
+    return error;
+}
+
+VIGEM_ERROR vigem_target_get_boot_timeline(
+    PVIGEM_CLIENT vigem,
+    PVIGEM_TARGET target,
+    PVIGEM_BOOT_TIMELINE timeline
+)
+{
+    if (!timeline)
+        return VIGEM_ERROR_INVALID_PARAMETER;
+
+    VIGEM_TARGET_STATISTICS vts;
+
+    const auto error = vigem_internal_get_statistics(vigem, target, &vts);
+
+    if (VIGEM_SUCCESS(error))
+        *timeline = vts.Boot;
+
+    return error;
+}
+
+VIGEM_ERROR vigem_target_get_output_statistics(
+    PVIGEM_CLIENT vigem,
+    PVIGEM_TARGET target,
+    PVIGEM_OUTPUT_STATISTICS statistics
+)
+{
+    if (!statistics)
+        return VIGEM_ERROR_INVALID_PARAMETER;
+
+    VIGEM_TARGET_STATISTICS vts;
+
+    const auto error = vigem_internal_get_statistics(vigem, target, &vts);
+
+    if (VIGEM_SUCCESS(error))
+        *statistics = vts.Output;
+
+    return error;
+}
+
+VIGEM_ERROR vigem_target_grant_lease(
+    PVIGEM_CLIENT vigem,
+    PVIGEM_TARGET target,
+    DWORD gracePeriod,
+    PULONG leaseKey
+)
+{
+    if (!vigem)
+        return VIGEM_ERROR_BUS_INVALID_HANDLE;
+
+    if (!target)
+        return VIGEM_ERROR_INVALID_TARGET;
+
+    if (!leaseKey || gracePeriod == 0)
+        return VIGEM_ERROR_INVALID_PARAMETER;
+
+    if (vigem->hBusDevice == INVALID_HANDLE_VALUE)
+        return VIGEM_ERROR_BUS_NOT_FOUND;
+
+    if (target->SerialNo == 0)
+        return VIGEM_ERROR_INVALID_TARGET;
+
+    if (target->Token == 0)
+        return VIGEM_ERROR_NOT_SUPPORTED;
+
+    DWORD transferred = 0;
+    OVERLAPPED lOverlapped = { 0 };
+    lOverlapped.hEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+    VIGEM_GRANT_TARGET_LEASE gtl;
+    VIGEM_GRANT_TARGET_LEASE_INIT(&gtl, target->Token, gracePeriod);
+
+    DeviceIoControl(
+        vigem->hBusDevice,
+        IOCTL_VIGEM_GRANT_TARGET_LEASE,
+        &gtl,
+        gtl.Size,
+        &gtl,
+        gtl.Size,
+        &transferred,
+        &lOverlapped
+    );
+
+    if (GetOverlappedResult(vigem->hBusDevice, &lOverlapped, &transferred, TRUE) == 0)
+    {
+        const auto error = GetLastError();
+
+        CloseHandle(lOverlapped.hEvent);
+
+        if (error == ERROR_ACCESS_DENIED)
+            return VIGEM_ERROR_INVALID_TARGET;
+
+        return (error == ERROR_INVALID_PARAMETER)
+            ? VIGEM_ERROR_INVALID_PARAMETER
+            : VIGEM_ERROR_NOT_SUPPORTED;
+    }
+
+    CloseHandle(lOverlapped.hEvent);
+
+    *leaseKey = gtl.LeaseKey;
+
+    return VIGEM_ERROR_NONE;
+}
+
+VIGEM_ERROR vigem_target_reclaim(
+    PVIGEM_CLIENT vigem,
+    PVIGEM_TARGET target,
+    ULONG leaseKey
+)
+{
+    if (!vigem)
+        return VIGEM_ERROR_BUS_INVALID_HANDLE;
+
+    if (!target)
+        return VIGEM_ERROR_INVALID_TARGET;
+
+    if (leaseKey == 0)
+        return VIGEM_ERROR_INVALID_PARAMETER;
+
+    if (vigem->hBusDevice == INVALID_HANDLE_VALUE)
+        return VIGEM_ERROR_BUS_NOT_FOUND;
+
+    if (target->State == VIGEM_TARGET_NEW)
+        return VIGEM_ERROR_TARGET_UNINITIALIZED;
+
+    if (target->State == VIGEM_TARGET_CONNECTED)
+        return VIGEM_ERROR_ALREADY_CONNECTED;
+
+    DWORD transferred = 0;
+    OVERLAPPED lOverlapped = { 0 };
+    lOverlapped.hEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+    VIGEM_RECLAIM_LEASED_TARGET rlt;
+    VIGEM_RECLAIM_LEASED_TARGET_INIT(&rlt, leaseKey);
+
+    DeviceIoControl(
+        vigem->hBusDevice,
+        IOCTL_VIGEM_RECLAIM_LEASED_TARGET,
+        &rlt,
+        rlt.Size,
+        &rlt,
+        rlt.Size,
+        &transferred,
+        &lOverlapped
+    );
+
+    if (GetOverlappedResult(vigem->hBusDevice, &lOverlapped, &transferred, TRUE) == 0)
+    {
+        CloseHandle(lOverlapped.hEvent);
+
+        //
+        // Lease expired (target got unplugged) or key unknown
+        // 
+        return VIGEM_ERROR_TARGET_NOT_PLUGGED_IN;
+    }
+
+    CloseHandle(lOverlapped.hEvent);
+
+    //
+    // The lease decides what the target is, not the allocation
+    // 
+    target->Type = rlt.TargetType;
+    target->SerialNo = rlt.SerialNo;
+    target->State = VIGEM_TARGET_CONNECTED;
+
+    vigem_internal_acquire_token(vigem, target);
+
+    return VIGEM_ERROR_NONE;
+}
+
+VIGEM_ERROR vigem_target_issue_transfer_ticket(
+    PVIGEM_CLIENT vigem,
+    PVIGEM_TARGET target,
+    PULONG ticket
+)
+{
+    if (!vigem)
+        return VIGEM_ERROR_BUS_INVALID_HANDLE;
+
+    if (!target)
+        return VIGEM_ERROR_INVALID_TARGET;
+
+    if (!ticket)
+        return VIGEM_ERROR_INVALID_PARAMETER;
+
+    if (vigem->hBusDevice == INVALID_HANDLE_VALUE)
+        return VIGEM_ERROR_BUS_NOT_FOUND;
+
+    if (target->SerialNo == 0)
+        return VIGEM_ERROR_INVALID_TARGET;
+
+    if (target->Token == 0)
+        return VIGEM_ERROR_NOT_SUPPORTED;
+
+    DWORD transferred = 0;
+    OVERLAPPED lOverlapped = { 0 };
+    lOverlapped.hEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+    VIGEM_ISSUE_TRANSFER_TICKET itt;
+    VIGEM_ISSUE_TRANSFER_TICKET_INIT(&itt, target->Token);
+
+    DeviceIoControl(
+        vigem->hBusDevice,
+        IOCTL_VIGEM_ISSUE_TRANSFER_TICKET,
+        &itt,
+        itt.Size,
+        &itt,
+        itt.Size,
+        &transferred,
+        &lOverlapped
+    );
+
+    if (GetOverlappedResult(vigem->hBusDevice, &lOverlapped, &transferred, TRUE) == 0)
+    {
+        const auto error = GetLastError();
+
+        CloseHandle(lOverlapped.hEvent);
+
+        return (error == ERROR_ACCESS_DENIED)
+            ? VIGEM_ERROR_INVALID_TARGET
+            : VIGEM_ERROR_NOT_SUPPORTED;
+    }
+
+    CloseHandle(lOverlapped.hEvent);
+
+    *ticket = itt.Ticket;
+
+    return VIGEM_ERROR_NONE;
+}
+
+VIGEM_ERROR vigem_target_claim_transfer(
+    PVIGEM_CLIENT vigem,
+    PVIGEM_TARGET target,
+    ULONG ticket
+)
+{
+    if (!vigem)
+        return VIGEM_ERROR_BUS_INVALID_HANDLE;
+
+    if (!target)
+        return VIGEM_ERROR_INVALID_TARGET;
+
+    if (ticket == 0)
+        return VIGEM_ERROR_INVALID_PARAMETER;
+
+    if (vigem->hBusDevice == INVALID_HANDLE_VALUE)
+        return VIGEM_ERROR_BUS_NOT_FOUND;
+
+    if (target->State == VIGEM_TARGET_NEW)
+        return VIGEM_ERROR_TARGET_UNINITIALIZED;
+
+    if (target->State == VIGEM_TARGET_CONNECTED)
+        return VIGEM_ERROR_ALREADY_CONNECTED;
+
+    DWORD transferred = 0;
+    OVERLAPPED lOverlapped = { 0 };
+    lOverlapped.hEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+    VIGEM_CLAIM_TRANSFERRED_TARGET ctt;
+    VIGEM_CLAIM_TRANSFERRED_TARGET_INIT(&ctt, ticket);
+
+    DeviceIoControl(
+        vigem->hBusDevice,
+        IOCTL_VIGEM_CLAIM_TRANSFERRED_TARGET,
+        &ctt,
+        ctt.Size,
+        &ctt,
+        ctt.Size,
+        &transferred,
+        &lOverlapped
+    );
+
+    if (GetOverlappedResult(vigem->hBusDevice, &lOverlapped, &transferred, TRUE) == 0)
+    {
+        CloseHandle(lOverlapped.hEvent);
+
+        //
+        // Ticket already used, superseded or target got unplugged
+        // 
+        return VIGEM_ERROR_TARGET_NOT_PLUGGED_IN;
+    }
+
+    CloseHandle(lOverlapped.hEvent);
+
+    target->Type = ctt.TargetType;
+    target->SerialNo = ctt.SerialNo;
+    target->State = VIGEM_TARGET_CONNECTED;
+
+    vigem_internal_acquire_token(vigem, target);
+
+    return VIGEM_ERROR_NONE;
+}
+
+VIGEM_ERROR vigem_target_enable_input_fusion(
+    PVIGEM_CLIENT vigem,
+    PVIGEM_TARGET target,
+    VIGEM_FUSION_POLICY policy,
+    UCHAR ownerPriority,
+    PULONG writerKey
+)
+{
+    if (!vigem)
+        return VIGEM_ERROR_BUS_INVALID_HANDLE;
+
+    if (!target)
+        return VIGEM_ERROR_INVALID_TARGET;
+
+    if (!writerKey || policy < 0 || policy >= VigemFusionPolicyMax)
+        return VIGEM_ERROR_INVALID_PARAMETER;
+
+    if (vigem->hBusDevice == INVALID_HANDLE_VALUE)
+        return VIGEM_ERROR_BUS_NOT_FOUND;
+
+    if (target->SerialNo == 0 || target->State != VIGEM_TARGET_CONNECTED)
+        return VIGEM_ERROR_INVALID_TARGET;
+
+    if (target->Token == 0)
+        return VIGEM_ERROR_NOT_SUPPORTED;
+
+    DWORD transferred = 0;
+    OVERLAPPED lOverlapped = { 0 };
+    lOverlapped.hEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+    VIGEM_ENABLE_INPUT_FUSION eif;
+    VIGEM_ENABLE_INPUT_FUSION_INIT(&eif, target->Token, policy, ownerPriority);
+
+    DeviceIoControl(
+        vigem->hBusDevice,
+        IOCTL_VIGEM_ENABLE_INPUT_FUSION,
+        &eif,
+        eif.Size,
+        &eif,
+        eif.Size,
+        &transferred,
+        &lOverlapped
+    );
+
+    if (GetOverlappedResult(vigem->hBusDevice, &lOverlapped, &transferred, TRUE) == 0)
+    {
+        const auto error = GetLastError();
+
+        CloseHandle(lOverlapped.hEvent);
+
+        return (error == ERROR_ACCESS_DENIED)
+            ? VIGEM_ERROR_INVALID_TARGET
+            : VIGEM_ERROR_NOT_SUPPORTED;
+    }
+
+    CloseHandle(lOverlapped.hEvent);
+
+    *writerKey = eif.WriterKey;
+
+    return VIGEM_ERROR_NONE;
+}
+
+VIGEM_ERROR vigem_target_attach_writer(
+    PVIGEM_CLIENT vigem,
+    PVIGEM_TARGET target,
+    ULONG serialNo,
+    ULONG writerKey,
+    UCHAR priority
+)
+{
+    if (!vigem)
+        return VIGEM_ERROR_BUS_INVALID_HANDLE;
+
+    if (!target)
+        return VIGEM_ERROR_INVALID_TARGET;
+
+    if (serialNo == 0 || writerKey == 0)
+        return VIGEM_ERROR_INVALID_PARAMETER;
+
+    if (vigem->hBusDevice == INVALID_HANDLE_VALUE)
+        return VIGEM_ERROR_BUS_NOT_FOUND;
+
+    if (target->State == VIGEM_TARGET_NEW)
+        return VIGEM_ERROR_TARGET_UNINITIALIZED;
+
+    if (target->State == VIGEM_TARGET_CONNECTED || target->Token != 0)
+        return VIGEM_ERROR_ALREADY_CONNECTED;
+
+    DWORD transferred = 0;
+    OVERLAPPED lOverlapped = { 0 };
+    lOverlapped.hEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+    VIGEM_ATTACH_INPUT_WRITER aiw;
+    VIGEM_ATTACH_INPUT_WRITER_INIT(&aiw, serialNo, writerKey, priority);
+
+    DeviceIoControl(
+        vigem->hBusDevice,
+        IOCTL_VIGEM_ATTACH_INPUT_WRITER,
+        &aiw,
+        aiw.Size,
+        &aiw,
+        aiw.Size,
+        &transferred,
+        &lOverlapped
+    );
+
+    if (GetOverlappedResult(vigem->hBusDevice, &lOverlapped, &transferred, TRUE) == 0)
+    {
+        const auto error = GetLastError();
+
+        CloseHandle(lOverlapped.hEvent);
+
+        if (error == ERROR_ACCESS_DENIED)
+            return VIGEM_ERROR_INVALID_PARAMETER;
+
+        return (error == ERROR_NO_SYSTEM_RESOURCES)
+            ? VIGEM_ERROR_NO_FREE_SLOT
+            : VIGEM_ERROR_TARGET_NOT_PLUGGED_IN;
+    }
+
+    CloseHandle(lOverlapped.hEvent);
+
+    //
+    // Stays initialized, the target isn't ours to remove
+    // 
+    target->Type = aiw.TargetType;
+    target->SerialNo = serialNo;
+    target->Token = aiw.Token;
+
+    return VIGEM_ERROR_NONE;
+}
+
+VIGEM_ERROR vigem_target_detach_writer(
+    PVIGEM_CLIENT vigem,
+    PVIGEM_TARGET target
+)
+{
+    if (!vigem)
+        return VIGEM_ERROR_BUS_INVALID_HANDLE;
+
+    if (!target)
+        return VIGEM_ERROR_INVALID_TARGET;
+
+    if (vigem->hBusDevice == INVALID_HANDLE_VALUE)
+        return VIGEM_ERROR_BUS_NOT_FOUND;
+
+    if (target->State == VIGEM_TARGET_CONNECTED || target->Token == 0)
+        return VIGEM_ERROR_INVALID_TARGET;
+
+    DWORD transferred = 0;
+    OVERLAPPED lOverlapped = { 0 };
+    lOverlapped.hEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+    VIGEM_DETACH_INPUT_WRITER diw;
+    VIGEM_DETACH_INPUT_WRITER_INIT(&diw, target->Token);
+
+    DeviceIoControl(
+        vigem->hBusDevice,
+        IOCTL_VIGEM_DETACH_INPUT_WRITER,
+        &diw,
+        diw.Size,
+        nullptr,
+        0,
+        &transferred,
+        &lOverlapped
+    );
+
+    const auto result = GetOverlappedResult(vigem->hBusDevice, &lOverlapped, &transferred, TRUE);
+
+    CloseHandle(lOverlapped.hEvent);
+
+    target->SerialNo = 0;
+    target->Token = 0;
+
+    return (result != 0) ? VIGEM_ERROR_NONE : VIGEM_ERROR_INVALID_TARGET;
+}
+
+VIGEM_ERROR vigem_target_subscribe(
+    PVIGEM_CLIENT vigem,
+    PVIGEM_TARGET target,
+    ULONG serialNo,
+    ULONG accessKey
+)
+{
+    if (!vigem)
+        return VIGEM_ERROR_BUS_INVALID_HANDLE;
+
+    if (!target)
+        return VIGEM_ERROR_INVALID_TARGET;
+
+    if (serialNo == 0)
+        return VIGEM_ERROR_INVALID_PARAMETER;
+
+    if (vigem->hBusDevice == INVALID_HANDLE_VALUE)
+        return VIGEM_ERROR_BUS_NOT_FOUND;
+
+    if (target->State == VIGEM_TARGET_NEW)
+        return VIGEM_ERROR_TARGET_UNINITIALIZED;
+
+    if (target->State == VIGEM_TARGET_CONNECTED || target->Token != 0)
+        return VIGEM_ERROR_ALREADY_CONNECTED;
+
+    DWORD transferred = 0;
+    OVERLAPPED lOverlapped = { 0 };
+    lOverlapped.hEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+    VIGEM_SUBSCRIBE_NOTIFICATIONS sn;
+    VIGEM_SUBSCRIBE_NOTIFICATIONS_INIT(&sn, serialNo, accessKey);
+
+    DeviceIoControl(
+        vigem->hBusDevice,
+        IOCTL_VIGEM_SUBSCRIBE_NOTIFICATIONS,
+        &sn,
+        sn.Size,
+        &sn,
+        sn.Size,
+        &transferred,
+        &lOverlapped
+    );
+
+    if (GetOverlappedResult(vigem->hBusDevice, &lOverlapped, &transferred, TRUE) == 0)
+    {
+        const auto error = GetLastError();
+
+        CloseHandle(lOverlapped.hEvent);
+
+        switch (error)
+        {
+        case ERROR_NO_SYSTEM_RESOURCES:
+            return VIGEM_ERROR_NO_FREE_SLOT;
+        case ERROR_ACCESS_DENIED:
+            return VIGEM_ERROR_INVALID_TARGET;
+        default:
+            return VIGEM_ERROR_TARGET_NOT_PLUGGED_IN;
+        }
+    }
+
+    CloseHandle(lOverlapped.hEvent);
+
+    //
+    // Stays initialized, the target isn't ours to remove
+    // 
+    target->Type = sn.TargetType;
+    target->SerialNo = serialNo;
+    target->Token = sn.Token;
+
+    return VIGEM_ERROR_NONE;
+}
+
+//
+// Common part of the subscriber notification APIs
+// 
+static VIGEM_ERROR vigem_internal_await_notification(
+    PVIGEM_CLIENT vigem,
+    PVIGEM_TARGET target,
+    VIGEM_TARGET_TYPE type,
+    PVIGEM_AWAIT_NOTIFICATION an
+)
+{
+    if (!vigem)
+        return VIGEM_ERROR_BUS_INVALID_HANDLE;
+
+    if (!target)
+        return VIGEM_ERROR_INVALID_TARGET;
+
+    if (vigem->hBusDevice == INVALID_HANDLE_VALUE)
+        return VIGEM_ERROR_BUS_NOT_FOUND;
+
+    if (target->State == VIGEM_TARGET_CONNECTED || target->Token == 0 || target->Type != type)
+        return VIGEM_ERROR_INVALID_TARGET;
+
+    DWORD transferred = 0;
+    OVERLAPPED lOverlapped = { 0 };
+    lOverlapped.hEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+    VIGEM_AWAIT_NOTIFICATION_INIT(an, target->Token);
+
+    DeviceIoControl(
+        vigem->hBusDevice,
+        IOCTL_VIGEM_AWAIT_NOTIFICATION,
+        an,
+        an->Size,
+        an,
+        an->Size,
+        &transferred,
+        &lOverlapped
+    );
+
+    VIGEM_ERROR error = VIGEM_ERROR_NONE;
+
+    if (GetOverlappedResult(vigem->hBusDevice, &lOverlapped, &transferred, TRUE) == 0)
+    {
+        switch (GetLastError())
+        {
+        case ERROR_ACCESS_DENIED:
+            error = VIGEM_ERROR_INVALID_TARGET;
+            break;
+        default:
+            error = VIGEM_ERROR_TARGET_NOT_PLUGGED_IN;
+            break;
+        }
+    }
+
+    CloseHandle(lOverlapped.hEvent);
+
+    return error;
+}
+
+VIGEM_ERROR vigem_target_x360_await_notification(
+    PVIGEM_CLIENT vigem,
+    PVIGEM_TARGET target,
+    PUCHAR largeMotor,
+    PUCHAR smallMotor,
+    PUCHAR ledNumber,
+    PULONG dropped
+)
+{
+    VIGEM_AWAIT_NOTIFICATION an;
+
+    const auto error = vigem_internal_await_notification(vigem, target, Xbox360Wired, &an);
+
+    if (!VIGEM_SUCCESS(error))
+        return error;
+
+    const auto notification = reinterpret_cast<PXUSB_REQUEST_NOTIFICATION>(an.Data);
+
+    if (largeMotor)
+        *largeMotor = notification->LargeMotor;
+    if (smallMotor)
+        *smallMotor = notification->SmallMotor;
+    if (ledNumber)
+        *ledNumber = notification->LedNumber;
+    if (dropped)
+        *dropped = an.Dropped;
+
+    return VIGEM_ERROR_NONE;
+}
+
+VIGEM_ERROR vigem_target_ds4_await_notification(
+    PVIGEM_CLIENT vigem,
+    PVIGEM_TARGET target,
+    PUCHAR largeMotor,
+    PUCHAR smallMotor,
+    PDS4_LIGHTBAR_COLOR lightbarColor,
+    PULONG dropped
+)
+{
+    VIGEM_AWAIT_NOTIFICATION an;
+
+    const auto error = vigem_internal_await_notification(vigem, target, DualShock4Wired, &an);
+
+    if (!VIGEM_SUCCESS(error))
+        return error;
+
+    const auto notification = reinterpret_cast<PDS4_REQUEST_NOTIFICATION>(an.Data);
+
+    if (largeMotor)
+        *largeMotor = notification->Report.LargeMotor;
+    if (smallMotor)
+        *smallMotor = notification->Report.SmallMotor;
+    if (lightbarColor)
+        *lightbarColor = notification->Report.LightbarColor;
+    if (dropped)
+        *dropped = an.Dropped;
+
+    return VIGEM_ERROR_NONE;
+}
+
+VIGEM_ERROR vigem_map_output_state(PVIGEM_CLIENT vigem)
+{
+    if (!vigem)
+        return VIGEM_ERROR_BUS_INVALID_HANDLE;
+
+    if (vigem->hBusDevice == INVALID_HANDLE_VALUE)
+        return VIGEM_ERROR_BUS_NOT_FOUND;
+
+    if (vigem->OutputState)
+    {
+        if (vigem->OutputState->Active)
+            return VIGEM_ERROR_NONE;
+
+        //
+        // Driver let go of the page (issuing thread exited), start over
+        // 
+        vigem_internal_unmap_output_state(vigem);
+    }
+
+    const auto page = static_cast<PVIGEM_OUTPUT_STATE_PAGE>(VirtualAlloc(
+        nullptr,
+        VIGEM_OUTPUT_STATE_PAGE_SIZE,
+        MEM_COMMIT | MEM_RESERVE,
+        PAGE_READWRITE
+    ));
+
+    if (!page)
+        return VIGEM_ERROR_NO_FREE_SLOT;
+
+    //
+    // The driver completes into this one whenever the mapping ends
+    // 
+    auto& lOverlapped = vigem->OutputStateOverlapped;
+    RtlZeroMemory(&lOverlapped, sizeof(OVERLAPPED));
+    lOverlapped.hEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+    VIGEM_MAP_OUTPUT_STATE mos;
+    VIGEM_MAP_OUTPUT_STATE_INIT(&mos);
+
+    //
+    // Stays pending, the driver writes to the page for as long as it does
+    // 
+    DeviceIoControl(
+        vigem->hBusDevice,
+        IOCTL_VIGEM_MAP_OUTPUT_STATE,
+        &mos,
+        mos.Size,
+        page,
+        VIGEM_OUTPUT_STATE_PAGE_SIZE,
+        nullptr,
+        &lOverlapped
+    );
+
+    while (!page->Active)
+    {
+        if (HasOverlappedIoCompleted(&lOverlapped))
+        {
+            DWORD transferred = 0;
+
+            GetOverlappedResult(vigem->hBusDevice, &lOverlapped, &transferred, FALSE);
+
+            const auto error = GetLastError();
+
+            CloseHandle(lOverlapped.hEvent);
+            RtlZeroMemory(&lOverlapped, sizeof(OVERLAPPED));
+            VirtualFree(page, 0, MEM_RELEASE);
+
+            return (error == ERROR_BUSY)
+                ? VIGEM_ERROR_ALREADY_CONNECTED
+                : VIGEM_ERROR_NOT_SUPPORTED;
+        }
+
+        SwitchToThread();
+    }
+
+    vigem->OutputState = page;
+
+    return VIGEM_ERROR_NONE;
+}
+
+VIGEM_ERROR vigem_target_x360_get_output_state(
+    PVIGEM_CLIENT vigem,
+    PVIGEM_TARGET target,
+    PUCHAR largeMotor,
+    PUCHAR smallMotor,
+    PUCHAR ledNumber
+)
+{
+    VIGEM_OUTPUT_STATE state;
+
+    const auto error = vigem_internal_read_output_state(vigem, target, Xbox360Wired, &state);
+
+    if (!VIGEM_SUCCESS(error))
+        return error;
+
+    if (largeMotor)
+        *largeMotor = state.LargeMotor;
+    if (smallMotor)
+        *smallMotor = state.SmallMotor;
+    if (ledNumber)
+        *ledNumber = state.LedNumber;
+
+    return VIGEM_ERROR_NONE;
+}
+
+VIGEM_ERROR vigem_target_ds4_get_output_state(
+    PVIGEM_CLIENT vigem,
+    PVIGEM_TARGET target,
+    PUCHAR largeMotor,
+    PUCHAR smallMotor,
+    PDS4_LIGHTBAR_COLOR lightbarColor
+)
+{
+    VIGEM_OUTPUT_STATE state;
+
+    const auto error = vigem_internal_read_output_state(vigem, target, DualShock4Wired, &state);
+
+    if (!VIGEM_SUCCESS(error))
+        return error;
+
+    if (largeMotor)
+        *largeMotor = state.LargeMotor;
+    if (smallMotor)
+        *smallMotor = state.SmallMotor;
+    if (lightbarColor)
+        *lightbarColor = state.LightbarColor;
+
+    return VIGEM_ERROR_NONE;
+}
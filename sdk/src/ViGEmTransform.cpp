@@ -0,0 +1,312 @@
+/*
+MIT License
+
+Copyright (c) 2017-2019 Nefarius Software Solutions e.U. and Contributors
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+//
+// WinAPI
+// 
+#include <Windows.h>
+
+//
+// Driver shared
+// 
+#include "ViGEm/km/BusShared.h"
+#include "ViGEm/Client.h"
+
+//
+// STL
+// 
+#include <cstdlib>
+#include <climits>
+#include <cmath>
+
+//
+// Internal
+// 
+#include "Internal.h"
+
+//
+// Buttons a transform may remap; the low nibble of DS4 wButtons holds the D-Pad
+// 
+#define VIGEM_TRANSFORM_X360_BUTTONS    0xF7FF
+#define VIGEM_TRANSFORM_DS4_BUTTONS     0xFFF0
+#define VIGEM_TRANSFORM_DS4_DPAD        0x000F
+
+static double vigem_internal_transform_curve(const VIGEM_TRANSFORM_AXIS_SPEC* spec, double magnitude)
+{
+	if (magnitude <= spec->Deadzone)
+		return 0.0;
+
+	const auto scaled = (magnitude - spec->Deadzone) / (spec->Saturation - spec->Deadzone);
+
+	if (scaled >= 1.0)
+		return 1.0;
+
+	return pow(scaled, spec->Exponent);
+}
+
+//
+// Maps a stick value of the given center and extents through the axis spec
+// 
+static LONG vigem_internal_transform_stick(const VIGEM_TRANSFORM_AXIS_SPEC* spec, LONG value, LONG center, LONG negative, LONG positive)
+{
+	const auto deflection = value - center;
+	const auto magnitude = deflection < 0
+		                       ? static_cast<double>(-deflection) / negative
+		                       : static_cast<double>(deflection) / positive;
+	const auto shaped = vigem_internal_transform_curve(spec, magnitude);
+
+	if ((deflection < 0) != (spec->Invert != FALSE))
+		return center - static_cast<LONG>(floor(shaped * negative + 0.5));
+
+	return center + static_cast<LONG>(floor(shaped * positive + 0.5));
+}
+
+static UCHAR vigem_internal_transform_trigger(const VIGEM_TRANSFORM_AXIS_SPEC* spec, ULONG value)
+{
+	const auto shaped = static_cast<LONG>(floor(vigem_internal_transform_curve(spec, value / 255.0) * 255.0 + 0.5));
+
+	return static_cast<UCHAR>(spec->Invert ? 255 - shaped : shaped);
+}
+
+//
+// Splits the button remap into one table per wButtons byte, passThrough bits are copied as is
+// 
+static void vigem_internal_transform_buttons(const USHORT* mapping, USHORT passThrough, USHORT tables[2][UCHAR_MAX + 1])
+{
+	for (ULONG value = 0; value <= UCHAR_MAX; value++)
+	{
+		USHORT low = value & passThrough;
+		USHORT high = (value << 8) & passThrough;
+
+		for (ULONG bit = 0; bit < 8; bit++)
+		{
+			if (!(value & (1 << bit)))
+				continue;
+
+			if (!(passThrough & (1 << bit)))
+				low |= mapping[bit];
+			if (!(passThrough & (1 << (bit + 8))))
+				high |= mapping[bit + 8];
+		}
+
+		tables[0][value] = low;
+		tables[1][value] = high;
+	}
+}
+
+static void vigem_internal_transform_compile_x360(PVIGEM_TRANSFORM transform)
+{
+	for (ULONG axis = VIGEM_TRANSFORM_AXIS_LEFT_X; axis <= VIGEM_TRANSFORM_AXIS_RIGHT_Y; axis++)
+		for (LONG value = SHRT_MIN; value <= SHRT_MAX; value++)
+			transform->X360Sticks[axis][static_cast<USHORT>(value)] = static_cast<SHORT>(
+				vigem_internal_transform_stick(&transform->Axes[axis], value, 0, 32768, 32767));
+
+	for (ULONG trigger = 0; trigger < 2; trigger++)
+		for (ULONG value = 0; value <= UCHAR_MAX; value++)
+			transform->X360Triggers[trigger][value] = vigem_internal_transform_trigger(
+				&transform->Axes[VIGEM_TRANSFORM_AXIS_LEFT_TRIGGER + trigger], value);
+
+	vigem_internal_transform_buttons(transform->X360Mapping, 0, transform->X360Buttons);
+
+	transform->X360Dirty = FALSE;
+}
+
+static void vigem_internal_transform_compile_ds4(PVIGEM_TRANSFORM transform)
+{
+	for (ULONG axis = VIGEM_TRANSFORM_AXIS_LEFT_X; axis <= VIGEM_TRANSFORM_AXIS_RIGHT_Y; axis++)
+		for (LONG value = 0; value <= UCHAR_MAX; value++)
+			transform->Ds4Sticks[axis][value] = static_cast<UCHAR>(
+				vigem_internal_transform_stick(&transform->Axes[axis], value, 0x80, 128, 127));
+
+	for (ULONG trigger = 0; trigger < 2; trigger++)
+		for (ULONG value = 0; value <= UCHAR_MAX; value++)
+			transform->Ds4Triggers[trigger][value] = vigem_internal_transform_trigger(
+				&transform->Axes[VIGEM_TRANSFORM_AXIS_LEFT_TRIGGER + trigger], value);
+
+	vigem_internal_transform_buttons(transform->Ds4Mapping, VIGEM_TRANSFORM_DS4_DPAD, transform->Ds4Buttons);
+
+	transform->Ds4Dirty = FALSE;
+}
+
+PVIGEM_TRANSFORM vigem_transform_alloc(void)
+{
+	const auto transform = static_cast<PVIGEM_TRANSFORM>(malloc(sizeof(VIGEM_TRANSFORM)));
+
+	if (!transform)
+		return nullptr;
+
+	RtlZeroMemory(transform, sizeof(VIGEM_TRANSFORM));
+
+	for (auto& axis : transform->Axes)
+	{
+		axis.Saturation = 1.0;
+		axis.Exponent = 1.0;
+	}
+
+	for (ULONG bit = 0; bit < 16; bit++)
+	{
+		transform->X360Mapping[bit] = static_cast<USHORT>(1 << bit);
+		transform->Ds4Mapping[bit] = static_cast<USHORT>(1 << bit);
+	}
+
+	transform->X360Dirty = TRUE;
+	transform->Ds4Dirty = TRUE;
+
+	return transform;
+}
+
+void vigem_transform_free(PVIGEM_TRANSFORM transform)
+{
+	if (transform)
+		free(transform);
+}
+
+VIGEM_ERROR vigem_transform_set_axis(
+	PVIGEM_TRANSFORM transform,
+	VIGEM_TRANSFORM_AXIS axis,
+	float deadzone,
+	float saturation,
+	float exponent,
+	BOOL invert
+)
+{
+	if (!transform)
+		return VIGEM_ERROR_INVALID_PARAMETER;
+
+	//
+	// Negated comparisons also turn away NaN
+	// 
+	if (axis < VIGEM_TRANSFORM_AXIS_LEFT_X || axis >= VIGEM_TRANSFORM_AXIS_COUNT
+		|| !(deadzone >= 0.0f && deadzone < saturation && saturation <= 1.0f)
+		|| !(exponent > 0.0f && exponent < HUGE_VALF))
+		return VIGEM_ERROR_INVALID_PARAMETER;
+
+	transform->Axes[axis].Deadzone = deadzone;
+	transform->Axes[axis].Saturation = saturation;
+	transform->Axes[axis].Exponent = exponent;
+	transform->Axes[axis].Invert = invert;
+
+	transform->X360Dirty = TRUE;
+	transform->Ds4Dirty = TRUE;
+
+	return VIGEM_ERROR_NONE;
+}
+
+static VIGEM_ERROR vigem_internal_transform_remap(PUSHORT mappings, USHORT valid, USHORT button, USHORT mapping)
+{
+	//
+	// Exactly one valid source button, any combination of valid targets
+	// 
+	if (!button || (button & (button - 1)) || (button & ~valid) || (mapping & ~valid))
+		return VIGEM_ERROR_INVALID_PARAMETER;
+
+	ULONG bit = 0;
+
+	while (!(button & (1 << bit)))
+		bit++;
+
+	mappings[bit] = mapping;
+
+	return VIGEM_ERROR_NONE;
+}
+
+VIGEM_ERROR vigem_transform_remap_x360_button(PVIGEM_TRANSFORM transform, USHORT button, USHORT mapping)
+{
+	if (!transform)
+		return VIGEM_ERROR_INVALID_PARAMETER;
+
+	const auto error = vigem_internal_transform_remap(transform->X360Mapping, VIGEM_TRANSFORM_X360_BUTTONS, button, mapping);
+
+	if (VIGEM_SUCCESS(error))
+		transform->X360Dirty = TRUE;
+
+	return error;
+}
+
+VIGEM_ERROR vigem_transform_remap_ds4_button(PVIGEM_TRANSFORM transform, USHORT button, USHORT mapping)
+{
+	if (!transform)
+		return VIGEM_ERROR_INVALID_PARAMETER;
+
+	const auto error = vigem_internal_transform_remap(transform->Ds4Mapping, VIGEM_TRANSFORM_DS4_BUTTONS, button, mapping);
+
+	if (VIGEM_SUCCESS(error))
+		transform->Ds4Dirty = TRUE;
+
+	return error;
+}
+
+VIGEM_ERROR vigem_transform_apply_x360(PVIGEM_TRANSFORM transform, PXUSB_REPORT reports, ULONG count)
+{
+	if (!transform || (!reports && count > 0))
+		return VIGEM_ERROR_INVALID_PARAMETER;
+
+	if (transform->X360Dirty)
+		vigem_internal_transform_compile_x360(transform);
+
+	//
+	// Table lookups only, no branches per report
+	// 
+	for (ULONG index = 0; index < count; index++)
+	{
+		auto& report = reports[index];
+
+		report.wButtons = transform->X360Buttons[0][report.wButtons & 0xFF]
+			| transform->X360Buttons[1][report.wButtons >> 8];
+		report.bLeftTrigger = transform->X360Triggers[0][report.bLeftTrigger];
+		report.bRightTrigger = transform->X360Triggers[1][report.bRightTrigger];
+		report.sThumbLX = transform->X360Sticks[VIGEM_TRANSFORM_AXIS_LEFT_X][static_cast<USHORT>(report.sThumbLX)];
+		report.sThumbLY = transform->X360Sticks[VIGEM_TRANSFORM_AXIS_LEFT_Y][static_cast<USHORT>(report.sThumbLY)];
+		report.sThumbRX = transform->X360Sticks[VIGEM_TRANSFORM_AXIS_RIGHT_X][static_cast<USHORT>(report.sThumbRX)];
+		report.sThumbRY = transform->X360Sticks[VIGEM_TRANSFORM_AXIS_RIGHT_Y][static_cast<USHORT>(report.sThumbRY)];
+	}
+
+	return VIGEM_ERROR_NONE;
+}
+
+VIGEM_ERROR vigem_transform_apply_ds4(PVIGEM_TRANSFORM transform, PDS4_REPORT_EX reports, ULONG count)
+{
+	if (!transform || (!reports && count > 0))
+		return VIGEM_ERROR_INVALID_PARAMETER;
+
+	if (transform->Ds4Dirty)
+		vigem_internal_transform_compile_ds4(transform);
+
+	for (ULONG index = 0; index < count; index++)
+	{
+		auto& report = reports[index].Report;
+
+		report.bThumbLX = transform->Ds4Sticks[VIGEM_TRANSFORM_AXIS_LEFT_X][report.bThumbLX];
+		report.bThumbLY = transform->Ds4Sticks[VIGEM_TRANSFORM_AXIS_LEFT_Y][report.bThumbLY];
+		report.bThumbRX = transform->Ds4Sticks[VIGEM_TRANSFORM_AXIS_RIGHT_X][report.bThumbRX];
+		report.bThumbRY = transform->Ds4Sticks[VIGEM_TRANSFORM_AXIS_RIGHT_Y][report.bThumbRY];
+		report.wButtons = transform->Ds4Buttons[0][report.wButtons & 0xFF]
+			| transform->Ds4Buttons[1][report.wButtons >> 8];
+		report.bTriggerL = transform->Ds4Triggers[0][report.bTriggerL];
+		report.bTriggerR = transform->Ds4Triggers[1][report.bTriggerR];
+	}
+
+	return VIGEM_ERROR_NONE;
+}
@@ -0,0 +1,110 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+namespace ViGEm::Bus::Core
+{
+	//
+	// Records when a target first reached each VIGEM_BOOT_PHASE, relative to
+	// VigemBootPhasePlugIn. Fixed point only; callers provide the timestamps.
+	// 
+	class BootTimeline
+	{
+	public:
+		//
+		// Records Phase at Now (counter ticks, Frequency ticks per second), repeated calls are ignored
+		// 
+		void Mark(VIGEM_BOOT_PHASE Phase, LONGLONG Now, LONGLONG Frequency)
+		{
+			if (Phase < 0 || Phase >= VigemBootPhaseMax)
+				return;
+
+			const LONG bit = 1L << Phase;
+
+			if (this->_Reached & bit)
+				return;
+
+			if (Phase == VigemBootPhasePlugIn)
+				this->_Origin = Now;
+
+			const auto delta = (Now > this->_Origin) ? Now - this->_Origin : 0;
+
+			const auto elapsed = (Frequency > 0)
+				? (delta / Frequency) * 1000000 + ((delta % Frequency) * 1000000) / Frequency
+				: 0;
+
+			this->_Time[Phase] = (elapsed > MAXULONG) ? MAXULONG : static_cast<ULONG>(elapsed);
+
+			//
+			// Phases get marked from different dispatch paths
+			// 
+			InterlockedOr(&this->_Reached, bit);
+		}
+
+		bool Reached(VIGEM_BOOT_PHASE Phase) const
+		{
+			return (Phase >= 0 && Phase < VigemBootPhaseMax && (this->_Reached & (1L << Phase)));
+		}
+
+		void CountInitTransfer()
+		{
+			this->_InitTransfers++;
+		}
+
+		void Get(PVIGEM_BOOT_TIMELINE Timeline) const
+		{
+			const auto reached = this->_Reached;
+
+			Timeline->ReachedPhases = static_cast<ULONG>(reached);
+
+			for (int phase = 0; phase < VigemBootPhaseMax; phase++)
+			{
+				Timeline->PhaseTime[phase] = (reached & (1L << phase)) ? this->_Time[phase] : 0;
+			}
+
+			Timeline->InitTransfers = this->_InitTransfers;
+		}
+
+	private:
+		LONGLONG _Origin{};
+
+		volatile LONG _Reached{};
+
+		ULONG _Time[VigemBootPhaseMax]{};
+
+		ULONG _InitTransfers{};
+	};
+}
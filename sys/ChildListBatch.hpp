@@ -0,0 +1,103 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "EmulationTargetPDO.hpp"
+
+namespace ViGEm::Bus::Core
+{
+	//
+	// Walks the default child list of the bus. Changes made while a batch is
+	// alive are held back by the framework and reported to the PnP manager
+	// as one bus relations update when the batch goes out of scope.
+	// 
+	class ChildListBatch
+	{
+	public:
+		explicit ChildListBatch(WDFDEVICE Device, ULONG Flags = WdfRetrievePresentChildren)
+			: _List(WdfFdoGetDefaultChildList(Device))
+		{
+			WDF_CHILD_LIST_ITERATOR_INIT(&this->_Iterator, Flags);
+
+			WdfChildListBeginIteration(this->_List, &this->_Iterator);
+		}
+
+		~ChildListBatch()
+		{
+			WdfChildListEndIteration(this->_List, &this->_Iterator);
+		}
+
+		ChildListBatch(const ChildListBatch&) = delete;
+
+		ChildListBatch& operator=(const ChildListBatch&) = delete;
+
+		//
+		// Retrieves the next child, Child is NULL if its PDO doesn't exist (yet)
+		// 
+		bool Next(PPDO_IDENTIFICATION_DESCRIPTION Description, WDFDEVICE* Child)
+		{
+			WDF_CHILD_RETRIEVE_INFO childInfo;
+
+			WDF_CHILD_RETRIEVE_INFO_INIT(&childInfo, &Description->Header);
+			WDF_CHILD_IDENTIFICATION_DESCRIPTION_HEADER_INIT(&Description->Header, sizeof(*Description));
+
+			const auto status = WdfChildListRetrieveNextDevice(this->_List, &this->_Iterator, Child, &childInfo);
+
+			if (!NT_SUCCESS(status) || status == STATUS_NO_MORE_ENTRIES)
+				return false;
+
+			if (childInfo.Status != WdfChildListRetrieveDeviceSuccess)
+				*Child = nullptr;
+
+			return true;
+		}
+
+		NTSTATUS AddAsPresent(PPDO_IDENTIFICATION_DESCRIPTION Description)
+		{
+			return WdfChildListAddOrUpdateChildDescriptionAsPresent(this->_List, &Description->Header, nullptr);
+		}
+
+		NTSTATUS MarkAsMissing(PPDO_IDENTIFICATION_DESCRIPTION Description)
+		{
+			return WdfChildListUpdateChildDescriptionAsMissing(this->_List, &Description->Header);
+		}
+
+	private:
+		WDFCHILDLIST _List;
+
+		WDF_CHILD_LIST_ITERATOR _Iterator;
+	};
+}
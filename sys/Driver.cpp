@@ -43,6 +43,7 @@
 #pragma alloc_text (PAGE, Bus_EvtDeviceAdd)
 #pragma alloc_text (PAGE, Bus_DeviceFileCreate)
 #pragma alloc_text (PAGE, Bus_FileClose)
+#pragma alloc_text (PAGE, Bus_FileCleanup)
 #pragma alloc_text (PAGE, Bus_EvtDriverContextCleanup)
 #endif
 
@@ -50,6 +51,7 @@
 #include "EmulationTargetPDO.hpp"
 #include "XusbPdo.hpp"
 #include "Ds4Pdo.hpp"
+#include "ChildListBatch.hpp"
 
 #include "Debugging.hpp"
 
@@ -57,6 +59,9 @@ using ViGEm::Bus::Core::PDO_IDENTIFICATION_DESCRIPTION;
 using ViGEm::Bus::Core::EmulationTargetPDO;
 using ViGEm::Bus::Targets::EmulationTargetXUSB;
 using ViGEm::Bus::Targets::EmulationTargetDS4;
+using ViGEm::Bus::Core::ScheduledReportHeap;
+using ViGEm::Bus::Core::NotificationFanoutQueue;
+using ViGEm::Bus::Core::ChildListBatch;
 
 
 EXTERN_C_START
@@ -91,10 +96,25 @@ NTSTATUS DriverEntry(IN PDRIVER_OBJECT DriverObject, IN PUNICODE_STRING Registry
 
     WDF_DRIVER_CONFIG_INIT(&config, Bus_EvtDeviceAdd);
 
+    //
+    // Target objects get recycled across plug/unplug cycles
+    // 
+    if (!NT_SUCCESS(status = EmulationTargetXUSB::InitializeLookaside())
+        || !NT_SUCCESS(status = EmulationTargetDS4::InitializeLookaside())
+        || !NT_SUCCESS(status = ScheduledReportHeap::InitializeLookaside())
+        || !NT_SUCCESS(status = NotificationFanoutQueue::InitializeLookaside()))
+    {
+        Bus_DeleteLookasideLists();
+        WPP_CLEANUP(DriverObject);
+        KdPrint((DRIVERNAME "ExInitializeLookasideListEx failed with status 0x%x\n", status));
+        return status;
+    }
+
     status = WdfDriverCreate(DriverObject, RegistryPath, &attributes, &config, &driver);
 
     if (!NT_SUCCESS(status))
     {
+        Bus_DeleteLookasideLists();
         WPP_CLEANUP(DriverObject);
         KdPrint((DRIVERNAME "WdfDriverCreate failed with status 0x%x\n", status));
     }
@@ -118,8 +138,11 @@ NTSTATUS Bus_EvtDeviceAdd(IN WDFDRIVER Driver, IN PWDFDEVICE_INIT DeviceInit)
     WDF_OBJECT_ATTRIBUTES       fileHandleAttributes;
     PFDO_DEVICE_DATA            pFDOData;
     PWSTR                       pSymbolicNameList;
-
-    UNREFERENCED_PARAMETER(Driver);
+    WDFKEY                      hParamsKey;
+    WDF_WORKITEM_CONFIG         workItemConfig;
+    WDF_OBJECT_ATTRIBUTES       workItemAttributes;
+    WDF_TIMER_CONFIG            timerConfig;
+    WDF_OBJECT_ATTRIBUTES       timerAttributes;
 
     PAGED_CODE();
 
@@ -183,7 +206,7 @@ NTSTATUS Bus_EvtDeviceAdd(IN WDFDRIVER Driver, IN PWDFDEVICE_INIT DeviceInit)
 
 #pragma region Assign File Object Configuration
 
-    WDF_FILEOBJECT_CONFIG_INIT(&foConfig, Bus_DeviceFileCreate, Bus_FileClose, NULL);
+    WDF_FILEOBJECT_CONFIG_INIT(&foConfig, Bus_DeviceFileCreate, Bus_FileClose, Bus_FileCleanup);
 
     WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&fileHandleAttributes, FDO_FILE_DATA);
 
@@ -217,6 +240,12 @@ NTSTATUS Bus_EvtDeviceAdd(IN WDFDRIVER Driver, IN PWDFDEVICE_INIT DeviceInit)
 
     pFDOData->InterfaceReferenceCounter = 0;
     pFDOData->NextSessionId = FDO_FIRST_SESSION_ID;
+    pFDOData->TargetTokens.Initialize();
+    KeInitializeSpinLock(&pFDOData->FrameLock);
+    InitializeListHead(&pFDOData->StagedTargets);
+    pFDOData->FrameEpoch = 0;
+    KeInitializeSpinLock(&pFDOData->OutputStateLock);
+    InitializeListHead(&pFDOData->OutputStateSessions);
 
 #pragma endregion
 
@@ -264,6 +293,89 @@ NTSTATUS Bus_EvtDeviceAdd(IN WDFDRIVER Driver, IN PWDFDEVICE_INIT DeviceInit)
 
     WdfDeviceSetBusInformationForChildren(device, &busInfo);
 
+#pragma endregion
+
+#pragma region Lease expiry timer
+
+    WDF_TIMER_CONFIG_INIT(&timerConfig, Bus_EvtLeaseExpiryTimer);
+    timerConfig.AutomaticSerialization = FALSE;
+
+    //
+    // Unplugging needs to happen at PASSIVE_LEVEL
+    // 
+    WDF_OBJECT_ATTRIBUTES_INIT(&timerAttributes);
+    timerAttributes.ParentObject = device;
+    timerAttributes.ExecutionLevel = WdfExecutionLevelPassive;
+
+    status = WdfTimerCreate(&timerConfig, &timerAttributes, &pFDOData->LeaseExpiryTimer);
+
+    if (!NT_SUCCESS(status))
+    {
+        TraceEvents(TRACE_LEVEL_ERROR,
+            TRACE_DRIVER,
+            "WdfTimerCreate failed with status %!STATUS!",
+            status);
+        return status;
+    }
+
+#pragma endregion
+
+#pragma region Standby target pool
+
+    DECLARE_CONST_UNICODE_STRING(standbyXusbValue, L"StandbyXusbTargets");
+    DECLARE_CONST_UNICODE_STRING(standbyDs4Value, L"StandbyDs4Targets");
+
+    //
+    // Disabled by default, idle pads occupy slots visible to the host
+    // 
+    pFDOData->StandbyRefillWorkItem = NULL;
+    pFDOData->StandbyXusbTargets = 0;
+    pFDOData->StandbyDs4Targets = 0;
+
+    if (NT_SUCCESS(WdfDriverOpenParametersRegistryKey(
+        Driver,
+        KEY_READ,
+        WDF_NO_OBJECT_ATTRIBUTES,
+        &hParamsKey
+    )))
+    {
+        (void)WdfRegistryQueryULong(hParamsKey, &standbyXusbValue, &pFDOData->StandbyXusbTargets);
+        (void)WdfRegistryQueryULong(hParamsKey, &standbyDs4Value, &pFDOData->StandbyDs4Targets);
+
+        WdfRegistryClose(hParamsKey);
+    }
+
+    pFDOData->StandbyXusbTargets = min(pFDOData->StandbyXusbTargets, FDO_MAX_STANDBY_TARGETS);
+    pFDOData->StandbyDs4Targets = min(pFDOData->StandbyDs4Targets, FDO_MAX_STANDBY_TARGETS);
+
+    if (pFDOData->StandbyXusbTargets > 0 || pFDOData->StandbyDs4Targets > 0)
+    {
+        WDF_WORKITEM_CONFIG_INIT(&workItemConfig, Bus_EvtStandbyRefillWorkItem);
+        workItemConfig.AutomaticSerialization = FALSE;
+
+        WDF_OBJECT_ATTRIBUTES_INIT(&workItemAttributes);
+        workItemAttributes.ParentObject = device;
+
+        status = WdfWorkItemCreate(&workItemConfig, &workItemAttributes, &pFDOData->StandbyRefillWorkItem);
+
+        if (!NT_SUCCESS(status))
+        {
+            TraceEvents(TRACE_LEVEL_ERROR,
+                TRACE_DRIVER,
+                "WdfWorkItemCreate failed with status %!STATUS!",
+                status);
+            return status;
+        }
+
+        TraceEvents(TRACE_LEVEL_INFORMATION,
+            TRACE_DRIVER,
+            "Standby pool enabled (XUSB: %d, DS4: %d)",
+            pFDOData->StandbyXusbTargets,
+            pFDOData->StandbyDs4Targets);
+
+        WdfWorkItemEnqueue(pFDOData->StandbyRefillWorkItem);
+    }
+
 #pragma endregion
 
     TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_DRIVER, "%!FUNC! Exit with status %!STATUS!", status);
@@ -319,6 +431,7 @@ Bus_DeviceFileCreate(
             sessionId = InterlockedIncrement(&pFDOData->NextSessionId);
 
             pFileData->SessionId = sessionId;
+            InitializeListHead(&pFileData->OutputStateLink);
             status = STATUS_SUCCESS;
 
             TraceEvents(TRACE_LEVEL_INFORMATION,
@@ -344,14 +457,12 @@ Bus_FileClose(
 {
     WDFDEVICE                      device;
     WDFDEVICE                      hChild;
-    NTSTATUS                       status;
-    WDFCHILDLIST                   list;
-    WDF_CHILD_LIST_ITERATOR        iterator;
-    WDF_CHILD_RETRIEVE_INFO        childInfo;
+    NTSTATUS                       status = STATUS_SUCCESS;
     PDO_IDENTIFICATION_DESCRIPTION description;
     PFDO_FILE_DATA                 pFileData = NULL;
     PFDO_DEVICE_DATA               pFDOData = NULL;
     LONG                           refCount = 0;
+    ULONG                          orphanedCount = 0;
 
     PAGED_CODE();
 
@@ -387,62 +498,100 @@ Bus_FileClose(
             TRACE_DRIVER,
             "Device ref. count = %d",
             (int)refCount);
-    }
-
-    list = WdfFdoGetDefaultChildList(device);
 
-    WDF_CHILD_LIST_ITERATOR_INIT(&iterator, WdfRetrievePresentChildren);
+        //
+        // Tokens die with the handle they were issued to
+        // 
+        pFDOData->TargetTokens.ReleaseByOwner(FileObject);
 
-    WdfChildListBeginIteration(list, &iterator);
+        //
+        // Uncommitted reports of this handle are discarded
+        // 
+        EmulationTargetPDO::DiscardStagedReports(device, FileObject);
+    }
 
-    for (;;)
     {
-        WDF_CHILD_RETRIEVE_INFO_INIT(&childInfo, &description.Header);
-        WDF_CHILD_IDENTIFICATION_DESCRIPTION_HEADER_INIT(&description.Header, sizeof(description));
+        //
+        // Process teardown takes all targets of the session down with a single bus relations update
+        // 
+        ChildListBatch batch(device);
 
-        status = WdfChildListRetrieveNextDevice(list, &iterator, &hChild, &childInfo);
-        if (!NT_SUCCESS(status) || status == STATUS_NO_MORE_ENTRIES)
+        while (batch.Next(&description, &hChild))
         {
-            break;
-        }
-
-        //TraceEvents(TRACE_LEVEL_VERBOSE,
-        //    TRACE_DRIVER,
-        //    "PDO properties: status = %!STATUS!, pdoPID = %d, curPID = %d, pdoSID = %d, curSID = %d, internal = %d",
-        //    (int)childInfo.Status,
-        //    (int)description.OwnerProcessId,
-        //    (int)CURRENT_PROCESS_ID(),
-        //    (int)description.SessionId,
-        //    (int)pFileData->SessionId,
-        //    (int)description.OwnerIsDriver
-        //);
-
-        // Only unplug devices with matching session id
-        if (childInfo.Status == WdfChildListRetrieveDeviceSuccess
-            && description.SessionId == pFileData->SessionId)
-        {
-            TraceEvents(TRACE_LEVEL_INFORMATION,
-                TRACE_DRIVER,
-                "Unplugging device with serial %d",
-                description.SerialNo);
+            //
+            // Input fusion writers and subscribers of this handle stop participating
+            // 
+            if (hChild != NULL)
+            {
+                description.Target->DetachWriters(FileObject);
+                description.Target->UnsubscribeAll(FileObject);
+            }
 
-            // "Unplug" child
-            status = WdfChildListUpdateChildDescriptionAsMissing(list, &description.Header);
-            if (!NT_SUCCESS(status))
+            // Only unplug devices with matching session id (claimed standby targets changed owner after plug-in)
+            if (hChild != NULL
+                && description.Target->GetSessionId() == pFileData->SessionId)
             {
-                TraceEvents(TRACE_LEVEL_ERROR,
+                //
+                // Leased targets stay until reclaimed or expired
+                // 
+                if (description.Target->OrphanLease(pFileData->SessionId))
+                {
+                    TraceEvents(TRACE_LEVEL_INFORMATION,
+                        TRACE_DRIVER,
+                        "Keeping leased device with serial %d",
+                        description.SerialNo);
+
+                    orphanedCount++;
+                    continue;
+                }
+
+                TraceEvents(TRACE_LEVEL_INFORMATION,
                     TRACE_DRIVER,
-                    "WdfChildListUpdateChildDescriptionAsMissing failed with status %!STATUS!",
-                    status);
+                    "Unplugging device with serial %d",
+                    description.SerialNo);
+
+                // "Unplug" child
+                status = batch.MarkAsMissing(&description);
+                if (!NT_SUCCESS(status))
+                {
+                    TraceEvents(TRACE_LEVEL_ERROR,
+                        TRACE_DRIVER,
+                        "WdfChildListUpdateChildDescriptionAsMissing failed with status %!STATUS!",
+                        status);
+                }
             }
         }
     }
 
-    WdfChildListEndIteration(list, &iterator);
+    if (orphanedCount > 0 && pFDOData != NULL)
+    {
+        WdfTimerStart(pFDOData->LeaseExpiryTimer, WDF_REL_TIMEOUT_IN_MS(FDO_LEASE_EXPIRY_CHECK_INTERVAL_MS));
+    }
 
     TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_DRIVER, "%!FUNC! Exit with status %!STATUS!", status);
 }
 
+//
+// Gets called when the last handle got closed, pending I/O may still be in flight.
+// 
+_Use_decl_annotations_
+VOID
+Bus_FileCleanup(
+    WDFFILEOBJECT FileObject
+)
+{
+    PAGED_CODE();
+
+    TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_DRIVER, "%!FUNC! Entry");
+
+    //
+    // The pending page request would otherwise keep the handle from closing
+    // 
+    Bus_UnmapOutputState(FileObject);
+
+    TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_DRIVER, "%!FUNC! Exit");
+}
+
 VOID
 Bus_EvtDriverContextCleanup(
     _In_ WDFOBJECT DriverObject
@@ -468,6 +617,8 @@ Return Value:
 
     TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_DRIVER, "%!FUNC! Entry");
 
+    Bus_DeleteLookasideLists();
+
     //
     // Stop WPP Tracing
     //
@@ -475,4 +626,15 @@ Return Value:
 
 }
 
+//
+// Frees the lookaside lists backing target allocations.
+// 
+VOID Bus_DeleteLookasideLists(VOID)
+{
+    EmulationTargetXUSB::DeleteLookaside();
+    EmulationTargetDS4::DeleteLookaside();
+    ScheduledReportHeap::DeleteLookaside();
+    NotificationFanoutQueue::DeleteLookaside();
+}
+
 EXTERN_C_END
@@ -43,6 +43,8 @@
 #define NTSTRSAFE_LIB
 #include <ntstrsafe.h>
 
+#include "TargetTokenTable.hpp"
+
 
 #pragma region Macros
 
@@ -50,6 +52,11 @@
 
 #pragma endregion
 
+//
+// Defined in BusShared.h
+// 
+typedef struct _VIGEM_OUTPUT_STATE_PAGE* PVIGEM_OUTPUT_STATE_PAGE;
+
 //
 // FDO (bus device) context data
 // 
@@ -65,10 +72,61 @@ typedef struct _FDO_DEVICE_DATA
     // 
     LONG NextSessionId;
 
+    //
+    // Handles issued to file objects for fast target lookup
+    // 
+    ViGEm::Bus::Core::TargetTokenTable TargetTokens;
+
+    //
+    // Serializes frame staging and commits, target report locks nest inside
+    // 
+    KSPIN_LOCK FrameLock;
+
+    //
+    // Targets with a staged report waiting for commit (protected by FrameLock)
+    // 
+    LIST_ENTRY StagedTargets;
+
+    //
+    // Sequence number of the last frame commit (protected by FrameLock)
+    // 
+    LONGLONG FrameEpoch;
+
+    //
+    // Plugs in booted, unowned targets for instant claims (NULL if pool is disabled)
+    // 
+    WDFWORKITEM StandbyRefillWorkItem;
+
+    //
+    // Configured standby pool size per target type
+    // 
+    ULONG StandbyXusbTargets;
+
+    ULONG StandbyDs4Targets;
+
+    //
+    // Unplugs leased targets nobody reclaimed within their grace period
+    // 
+    WDFTIMER LeaseExpiryTimer;
+
+    //
+    // Protects OutputStateSessions and the pages linked into it
+    // 
+    KSPIN_LOCK OutputStateLock;
+
+    //
+    // File objects with a mapped output state page (FDO_FILE_DATA::OutputStateLink)
+    // 
+    LIST_ENTRY OutputStateSessions;
+
 } FDO_DEVICE_DATA, * PFDO_DEVICE_DATA;
 
 #define FDO_FIRST_SESSION_ID 100
 
+#define FDO_MAX_STANDBY_TARGETS 4
+
+#define FDO_LEASE_EXPIRY_CHECK_INTERVAL_MS 250
+
 WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(FDO_DEVICE_DATA, FdoGetData)
 
 // 
@@ -81,6 +139,32 @@ typedef struct _FDO_FILE_DATA
     // 
     LONG SessionId;
 
+    //
+    // Entry in FDO_DEVICE_DATA::OutputStateSessions (protected by OutputStateLock)
+    // 
+    LIST_ENTRY OutputStateLink;
+
+    //
+    // Pending IOCTL_VIGEM_MAP_OUTPUT_STATE request keeping the page locked
+    // 
+    WDFREQUEST OutputStateRequest;
+
+    //
+    // System address of the page described by OutputStateRequest
+    // 
+    PVIGEM_OUTPUT_STATE_PAGE OutputState;
+
+    //
+    // Serial number owning each entry of OutputState. The session can write to
+    // the page, so entries are never looked up by what it holds.
+    // 
+    ULONG OutputStateSerials[VIGEM_OUTPUT_STATE_MAX_TARGETS];
+
+    //
+    // Sequence lock value of each entry of OutputState
+    // 
+    LONG OutputStateSequences[VIGEM_OUTPUT_STATE_MAX_TARGETS];
+
 } FDO_FILE_DATA, * PFDO_FILE_DATA;
 
 WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(FDO_FILE_DATA, FileObjectGetData)
@@ -98,10 +182,27 @@ EVT_WDF_DEVICE_FILE_CREATE Bus_DeviceFileCreate;
 
 EVT_WDF_FILE_CLOSE Bus_FileClose;
 
+EVT_WDF_FILE_CLEANUP Bus_FileCleanup;
+
 EVT_WDF_CHILD_LIST_CREATE_DEVICE Bus_EvtDeviceListCreatePdo;
 
 EVT_WDF_OBJECT_CONTEXT_CLEANUP Bus_EvtDriverContextCleanup;
 
+EVT_WDF_WORKITEM Bus_EvtStandbyRefillWorkItem;
+
+EVT_WDF_TIMER Bus_EvtLeaseExpiryTimer;
+
+EVT_WDF_REQUEST_CANCEL Bus_EvtOutputStateRequestCancel;
+
+#pragma endregion
+
+#pragma region Driver-wide resources
+
+VOID
+Bus_DeleteLookasideLists(
+    VOID
+);
+
 #pragma endregion
 
 #pragma region Bus enumeration-specific functions
@@ -122,6 +223,52 @@ Bus_UnPlugDevice(
     _Out_ size_t* Transferred
 );
 
+NTSTATUS
+Bus_ClaimStandbyTarget(
+    _In_ WDFDEVICE Device,
+    _In_ WDFREQUEST Request,
+    _Out_ size_t* Transferred
+);
+
+NTSTATUS
+Bus_ReclaimLeasedTarget(
+    _In_ WDFDEVICE Device,
+    _In_ WDFREQUEST Request,
+    _Out_ size_t* Transferred
+);
+
+NTSTATUS
+Bus_ClaimTransferredTarget(
+    _In_ WDFDEVICE Device,
+    _In_ WDFREQUEST Request,
+    _Out_ size_t* Transferred
+);
+
+NTSTATUS
+Bus_AttachInputWriter(
+    _In_ WDFDEVICE Device,
+    _In_ WDFREQUEST Request,
+    _Out_ size_t* Transferred
+);
+
+NTSTATUS
+Bus_SubscribeNotifications(
+    _In_ WDFDEVICE Device,
+    _In_ WDFREQUEST Request,
+    _Out_ size_t* Transferred
+);
+
+NTSTATUS
+Bus_MapOutputState(
+    _In_ WDFDEVICE Device,
+    _In_ WDFREQUEST Request
+);
+
+VOID
+Bus_UnmapOutputState(
+    _In_ WDFFILEOBJECT FileObject
+);
+
 #pragma endregion
 
 EXTERN_C_END
@@ -35,6 +35,7 @@
 
 #include <ntifs.h>
 #include "Ds4Pdo.hpp"
+#include "Ds4Descriptors.hpp"
 #include "trace.h"
 #include "Ds4Pdo.tmh"
 #define NTSTRSAFE_LIB
@@ -50,7 +51,8 @@ ViGEm::Bus::Targets::EmulationTargetDS4::EmulationTargetDS4(ULONG Serial, LONG S
 	Serial, SessionId, VendorId, ProductId)
 {
 	this->_TargetType = DualShock4Wired;
-	this->_UsbConfigurationDescriptionSize = DS4_DESCRIPTOR_SIZE;
+	this->_UsbConfigurationDescriptionSize = sizeof(Ds4DescriptorData);
+	this->_ObjectSize = sizeof(EmulationTargetDS4);
 
 	//
 	// Set PNP Capabilities
@@ -64,6 +66,11 @@ ViGEm::Bus::Targets::EmulationTargetDS4::EmulationTargetDS4(ULONG Serial, LONG S
 	this->_PowerCapabilities.WakeFromD0 = WdfTrue;
 }
 
+ViGEm::Bus::Targets::EmulationTargetDS4::~EmulationTargetDS4()
+{
+	delete this->_Imu;
+}
+
 NTSTATUS ViGEm::Bus::Targets::EmulationTargetDS4::PdoPrepareDevice(PWDFDEVICE_INIT DeviceInit,
 	PUNICODE_STRING DeviceId, PUNICODE_STRING DeviceDescription)
 {
@@ -354,55 +361,12 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetDS4::PdoInitContext()
 
 VOID ViGEm::Bus::Targets::EmulationTargetDS4::GetConfigurationDescriptorType(PUCHAR Buffer, ULONG Length)
 {
-	UCHAR Ds4DescriptorData[DS4_DESCRIPTOR_SIZE] =
-	{
-		0x09,        // bLength
-		0x02,        // bDescriptorType (Configuration)
-		0x29, 0x00,  // wTotalLength 41
-		0x01,        // bNumInterfaces 1
-		0x01,        // bConfigurationValue
-		0x00,        // iConfiguration (String Index)
-		0xC0,        // bmAttributes Self Powered
-		0xFA,        // bMaxPower 500mA
-
-		0x09,        // bLength
-		0x04,        // bDescriptorType (Interface)
-		0x00,        // bInterfaceNumber 0
-		0x00,        // bAlternateSetting
-		0x02,        // bNumEndpoints 2
-		0x03,        // bInterfaceClass
-		0x00,        // bInterfaceSubClass
-		0x00,        // bInterfaceProtocol
-		0x00,        // iInterface (String Index)
-
-		0x09,        // bLength
-		0x21,        // bDescriptorType (HID)
-		0x11, 0x01,  // bcdHID 1.11
-		0x00,        // bCountryCode
-		0x01,        // bNumDescriptors
-		0x22,        // bDescriptorType[0] (HID)
-		0xD3, 0x01,  // wDescriptorLength[0] 467
-
-		0x07,        // bLength
-		0x05,        // bDescriptorType (Endpoint)
-		0x84,        // bEndpointAddress (IN/D2H)
-		0x03,        // bmAttributes (Interrupt)
-		0x40, 0x00,  // wMaxPacketSize 64
-		0x05,        // bInterval 5 (unit depends on device speed)
-
-		0x07,        // bLength
-		0x05,        // bDescriptorType (Endpoint)
-		0x03,        // bEndpointAddress (OUT/H2D)
-		0x03,        // bmAttributes (Interrupt)
-		0x40, 0x00,  // wMaxPacketSize 64
-		0x05,        // bInterval 5 (unit depends on device speed)
-
-					 // 41 bytes
-
-					 // best guess: USB Standard Descriptor
-	};
-
 	RtlCopyBytes(Buffer, Ds4DescriptorData, Length);
+
+	if (this->_PollingInterval)
+	{
+		Core::usb_patch_interrupt_intervals(Buffer, Length, this->_PollingInterval);
+	}
 }
 
 NTSTATUS ViGEm::Bus::Targets::EmulationTargetDS4::UsbGetDeviceDescriptorType(PUSB_DEVICE_DESCRIPTOR pDescriptor)
@@ -454,7 +418,7 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetDS4::SelectConfiguration(PURB Urb)
 	pInfo->Pipes[0].MaximumTransferSize = 0x00400000;
 	pInfo->Pipes[0].MaximumPacketSize = 0x40;
 	pInfo->Pipes[0].EndpointAddress = 0x84;
-	pInfo->Pipes[0].Interval = 0x05;
+	pInfo->Pipes[0].Interval = this->EndpointInterval(0x05);
 	pInfo->Pipes[0].PipeType = static_cast<USBD_PIPE_TYPE>(0x03);
 	pInfo->Pipes[0].PipeHandle = reinterpret_cast<USBD_PIPE_HANDLE>(0xFFFF0084);
 	pInfo->Pipes[0].PipeFlags = 0x00;
@@ -462,7 +426,7 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetDS4::SelectConfiguration(PURB Urb)
 	pInfo->Pipes[1].MaximumTransferSize = 0x00400000;
 	pInfo->Pipes[1].MaximumPacketSize = 0x40;
 	pInfo->Pipes[1].EndpointAddress = 0x03;
-	pInfo->Pipes[1].Interval = 0x05;
+	pInfo->Pipes[1].Interval = this->EndpointInterval(0x05);
 	pInfo->Pipes[1].PipeType = static_cast<USBD_PIPE_TYPE>(0x03);
 	pInfo->Pipes[1].PipeHandle = reinterpret_cast<USBD_PIPE_HANDLE>(0xFFFF0003);
 	pInfo->Pipes[1].PipeFlags = 0x00;
@@ -648,239 +612,6 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetDS4::UsbClassInterface(PURB Urb)
 NTSTATUS ViGEm::Bus::Targets::EmulationTargetDS4::UsbGetDescriptorFromInterface(PURB Urb)
 {
 	NTSTATUS status = STATUS_INVALID_PARAMETER;
-	UCHAR Ds4HidReportDescriptor[] =
-	{
-		0x05, 0x01,        // Usage Page (Generic Desktop Ctrls)
-		0x09, 0x05,        // Usage (Game Pad)
-		0xA1, 0x01,        // Collection (Application)
-		0x85, 0x01,        //   Report ID (1)
-		0x09, 0x30,        //   Usage (X)
-		0x09, 0x31,        //   Usage (Y)
-		0x09, 0x32,        //   Usage (Z)
-		0x09, 0x35,        //   Usage (Rz)
-		0x15, 0x00,        //   Logical Minimum (0)
-		0x26, 0xFF, 0x00,  //   Logical Maximum (255)
-		0x75, 0x08,        //   Report Size (8)
-		0x95, 0x04,        //   Report Count (4)
-		0x81, 0x02,        //   Input (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position)
-		0x09, 0x39,        //   Usage (Hat switch)
-		0x15, 0x00,        //   Logical Minimum (0)
-		0x25, 0x07,        //   Logical Maximum (7)
-		0x35, 0x00,        //   Physical Minimum (0)
-		0x46, 0x3B, 0x01,  //   Physical Maximum (315)
-		0x65, 0x14,        //   Unit (System: English Rotation, Length: Centimeter)
-		0x75, 0x04,        //   Report Size (4)
-		0x95, 0x01,        //   Report Count (1)
-		0x81, 0x42,        //   Input (Data,Var,Abs,No Wrap,Linear,Preferred State,Null State)
-		0x65, 0x00,        //   Unit (None)
-		0x05, 0x09,        //   Usage Page (Button)
-		0x19, 0x01,        //   Usage Minimum (0x01)
-		0x29, 0x0E,        //   Usage Maximum (0x0E)
-		0x15, 0x00,        //   Logical Minimum (0)
-		0x25, 0x01,        //   Logical Maximum (1)
-		0x75, 0x01,        //   Report Size (1)
-		0x95, 0x0E,        //   Report Count (14)
-		0x81, 0x02,        //   Input (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position)
-		0x06, 0x00, 0xFF,  //   Usage Page (Vendor Defined 0xFF00)
-		0x09, 0x20,        //   Usage (0x20)
-		0x75, 0x06,        //   Report Size (6)
-		0x95, 0x01,        //   Report Count (1)
-		0x15, 0x00,        //   Logical Minimum (0)
-		0x25, 0x7F,        //   Logical Maximum (127)
-		0x81, 0x02,        //   Input (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position)
-		0x05, 0x01,        //   Usage Page (Generic Desktop Ctrls)
-		0x09, 0x33,        //   Usage (Rx)
-		0x09, 0x34,        //   Usage (Ry)
-		0x15, 0x00,        //   Logical Minimum (0)
-		0x26, 0xFF, 0x00,  //   Logical Maximum (255)
-		0x75, 0x08,        //   Report Size (8)
-		0x95, 0x02,        //   Report Count (2)
-		0x81, 0x02,        //   Input (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position)
-		0x06, 0x00, 0xFF,  //   Usage Page (Vendor Defined 0xFF00)
-		0x09, 0x21,        //   Usage (0x21)
-		0x95, 0x36,        //   Report Count (54)
-		0x81, 0x02,        //   Input (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position)
-		0x85, 0x05,        //   Report ID (5)
-		0x09, 0x22,        //   Usage (0x22)
-		0x95, 0x1F,        //   Report Count (31)
-		0x91, 0x02,        //   Output (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0x04,        //   Report ID (4)
-		0x09, 0x23,        //   Usage (0x23)
-		0x95, 0x24,        //   Report Count (36)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0x02,        //   Report ID (2)
-		0x09, 0x24,        //   Usage (0x24)
-		0x95, 0x24,        //   Report Count (36)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0x08,        //   Report ID (8)
-		0x09, 0x25,        //   Usage (0x25)
-		0x95, 0x03,        //   Report Count (3)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0x10,        //   Report ID (16)
-		0x09, 0x26,        //   Usage (0x26)
-		0x95, 0x04,        //   Report Count (4)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0x11,        //   Report ID (17)
-		0x09, 0x27,        //   Usage (0x27)
-		0x95, 0x02,        //   Report Count (2)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0x12,        //   Report ID (18)
-		0x06, 0x02, 0xFF,  //   Usage Page (Vendor Defined 0xFF02)
-		0x09, 0x21,        //   Usage (0x21)
-		0x95, 0x0F,        //   Report Count (15)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0x13,        //   Report ID (19)
-		0x09, 0x22,        //   Usage (0x22)
-		0x95, 0x16,        //   Report Count (22)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0x14,        //   Report ID (20)
-		0x06, 0x05, 0xFF,  //   Usage Page (Vendor Defined 0xFF05)
-		0x09, 0x20,        //   Usage (0x20)
-		0x95, 0x10,        //   Report Count (16)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0x15,        //   Report ID (21)
-		0x09, 0x21,        //   Usage (0x21)
-		0x95, 0x2C,        //   Report Count (44)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x06, 0x80, 0xFF,  //   Usage Page (Vendor Defined 0xFF80)
-		0x85, 0x80,        //   Report ID (128)
-		0x09, 0x20,        //   Usage (0x20)
-		0x95, 0x06,        //   Report Count (6)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0x81,        //   Report ID (129)
-		0x09, 0x21,        //   Usage (0x21)
-		0x95, 0x06,        //   Report Count (6)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0x82,        //   Report ID (130)
-		0x09, 0x22,        //   Usage (0x22)
-		0x95, 0x05,        //   Report Count (5)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0x83,        //   Report ID (131)
-		0x09, 0x23,        //   Usage (0x23)
-		0x95, 0x01,        //   Report Count (1)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0x84,        //   Report ID (132)
-		0x09, 0x24,        //   Usage (0x24)
-		0x95, 0x04,        //   Report Count (4)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0x85,        //   Report ID (133)
-		0x09, 0x25,        //   Usage (0x25)
-		0x95, 0x06,        //   Report Count (6)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0x86,        //   Report ID (134)
-		0x09, 0x26,        //   Usage (0x26)
-		0x95, 0x06,        //   Report Count (6)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0x87,        //   Report ID (135)
-		0x09, 0x27,        //   Usage (0x27)
-		0x95, 0x23,        //   Report Count (35)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0x88,        //   Report ID (136)
-		0x09, 0x28,        //   Usage (0x28)
-		0x95, 0x22,        //   Report Count (34)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0x89,        //   Report ID (137)
-		0x09, 0x29,        //   Usage (0x29)
-		0x95, 0x02,        //   Report Count (2)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0x90,        //   Report ID (144)
-		0x09, 0x30,        //   Usage (0x30)
-		0x95, 0x05,        //   Report Count (5)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0x91,        //   Report ID (145)
-		0x09, 0x31,        //   Usage (0x31)
-		0x95, 0x03,        //   Report Count (3)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0x92,        //   Report ID (146)
-		0x09, 0x32,        //   Usage (0x32)
-		0x95, 0x03,        //   Report Count (3)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0x93,        //   Report ID (147)
-		0x09, 0x33,        //   Usage (0x33)
-		0x95, 0x0C,        //   Report Count (12)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0xA0,        //   Report ID (160)
-		0x09, 0x40,        //   Usage (0x40)
-		0x95, 0x06,        //   Report Count (6)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0xA1,        //   Report ID (161)
-		0x09, 0x41,        //   Usage (0x41)
-		0x95, 0x01,        //   Report Count (1)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0xA2,        //   Report ID (162)
-		0x09, 0x42,        //   Usage (0x42)
-		0x95, 0x01,        //   Report Count (1)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0xA3,        //   Report ID (163)
-		0x09, 0x43,        //   Usage (0x43)
-		0x95, 0x30,        //   Report Count (48)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0xA4,        //   Report ID (164)
-		0x09, 0x44,        //   Usage (0x44)
-		0x95, 0x0D,        //   Report Count (13)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0xA5,        //   Report ID (165)
-		0x09, 0x45,        //   Usage (0x45)
-		0x95, 0x15,        //   Report Count (21)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0xA6,        //   Report ID (166)
-		0x09, 0x46,        //   Usage (0x46)
-		0x95, 0x15,        //   Report Count (21)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0xF0,        //   Report ID (240)
-		0x09, 0x47,        //   Usage (0x47)
-		0x95, 0x3F,        //   Report Count (63)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0xF1,        //   Report ID (241)
-		0x09, 0x48,        //   Usage (0x48)
-		0x95, 0x3F,        //   Report Count (63)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0xF2,        //   Report ID (242)
-		0x09, 0x49,        //   Usage (0x49)
-		0x95, 0x0F,        //   Report Count (15)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0xA7,        //   Report ID (167)
-		0x09, 0x4A,        //   Usage (0x4A)
-		0x95, 0x01,        //   Report Count (1)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0xA8,        //   Report ID (168)
-		0x09, 0x4B,        //   Usage (0x4B)
-		0x95, 0x01,        //   Report Count (1)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0xA9,        //   Report ID (169)
-		0x09, 0x4C,        //   Usage (0x4C)
-		0x95, 0x08,        //   Report Count (8)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0xAA,        //   Report ID (170)
-		0x09, 0x4E,        //   Usage (0x4E)
-		0x95, 0x01,        //   Report Count (1)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0xAB,        //   Report ID (171)
-		0x09, 0x4F,        //   Usage (0x4F)
-		0x95, 0x39,        //   Report Count (57)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0xAC,        //   Report ID (172)
-		0x09, 0x50,        //   Usage (0x50)
-		0x95, 0x39,        //   Report Count (57)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0xAD,        //   Report ID (173)
-		0x09, 0x51,        //   Usage (0x51)
-		0x95, 0x0B,        //   Report Count (11)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0xAE,        //   Report ID (174)
-		0x09, 0x52,        //   Usage (0x52)
-		0x95, 0x01,        //   Report Count (1)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0xAF,        //   Report ID (175)
-		0x09, 0x53,        //   Usage (0x53)
-		0x95, 0x02,        //   Report Count (2)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0x85, 0xB0,        //   Report ID (176)
-		0x09, 0x54,        //   Usage (0x54)
-		0x95, 0x3F,        //   Report Count (63)
-		0xB1, 0x02,        //   Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-		0xC0,              // End Collection
-	};
 
 	struct _URB_CONTROL_DESCRIPTOR_REQUEST* pRequest = &Urb->UrbControlDescriptorRequest;
 
@@ -889,15 +620,15 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetDS4::UsbGetDescriptorFromInterface(
 		">> >> >> _URB_CONTROL_DESCRIPTOR_REQUEST: Buffer Length %d",
 		pRequest->TransferBufferLength);
 
-	if (pRequest->TransferBufferLength >= ARRAYSIZE(Ds4HidReportDescriptor))
+	if (pRequest->TransferBufferLength >= sizeof(Ds4HidReportDescriptor))
 	{
-		RtlCopyMemory(pRequest->TransferBuffer, Ds4HidReportDescriptor, ARRAYSIZE(Ds4HidReportDescriptor));
+		RtlCopyMemory(pRequest->TransferBuffer, Ds4HidReportDescriptor, sizeof(Ds4HidReportDescriptor));
 		status = STATUS_SUCCESS;
 
 		//
 		// Notify client library that PDO is ready
 		// 
-		KeSetEvent(&this->_PdoBootNotificationEvent, 0, FALSE);
+		this->NotifyBooted();
 	}
 
 	return status;
@@ -921,14 +652,8 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetDS4::UsbGetStringDescriptorType(PUR
 	{
 	case 0:
 	{
-		// "American English"
-		UCHAR LangId[] =
-		{
-			0x04, 0x03, 0x09, 0x04
-		};
-
-		Urb->UrbControlDescriptorRequest.TransferBufferLength = ARRAYSIZE(LangId);
-		RtlCopyBytes(Urb->UrbControlDescriptorRequest.TransferBuffer, LangId, ARRAYSIZE(LangId));
+		Urb->UrbControlDescriptorRequest.TransferBufferLength = sizeof(Core::UsbLanguageIdDescriptor);
+		RtlCopyBytes(Urb->UrbControlDescriptorRequest.TransferBuffer, Core::UsbLanguageIdDescriptor, sizeof(Core::UsbLanguageIdDescriptor));
 
 		break;
 	}
@@ -939,27 +664,15 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetDS4::UsbGetStringDescriptorType(PUR
 			"LanguageId = 0x%X",
 			Urb->UrbControlDescriptorRequest.LanguageId);
 
-		if (Urb->UrbControlDescriptorRequest.TransferBufferLength < DS4_MANUFACTURER_NAME_LENGTH)
+		if (Urb->UrbControlDescriptorRequest.TransferBufferLength < Ds4ManufacturerString.Size)
 		{
 			auto pDesc = static_cast<PUSB_STRING_DESCRIPTOR>(Urb->UrbControlDescriptorRequest.TransferBuffer);
-			pDesc->bLength = DS4_MANUFACTURER_NAME_LENGTH;
+			pDesc->bLength = static_cast<UCHAR>(Ds4ManufacturerString.Size);
 			break;
 		}
 
-		// "Sony Computer Entertainment"
-		UCHAR ManufacturerString[DS4_MANUFACTURER_NAME_LENGTH] =
-		{
-			0x38, 0x03, 0x53, 0x00, 0x6F, 0x00, 0x6E, 0x00,
-			0x79, 0x00, 0x20, 0x00, 0x43, 0x00, 0x6F, 0x00,
-			0x6D, 0x00, 0x70, 0x00, 0x75, 0x00, 0x74, 0x00,
-			0x65, 0x00, 0x72, 0x00, 0x20, 0x00, 0x45, 0x00,
-			0x6E, 0x00, 0x74, 0x00, 0x65, 0x00, 0x72, 0x00,
-			0x74, 0x00, 0x61, 0x00, 0x69, 0x00, 0x6E, 0x00,
-			0x6D, 0x00, 0x65, 0x00, 0x6E, 0x00, 0x74, 0x00
-		};
-
-		Urb->UrbControlDescriptorRequest.TransferBufferLength = DS4_MANUFACTURER_NAME_LENGTH;
-		RtlCopyBytes(Urb->UrbControlDescriptorRequest.TransferBuffer, ManufacturerString, DS4_MANUFACTURER_NAME_LENGTH);
+		Urb->UrbControlDescriptorRequest.TransferBufferLength = Ds4ManufacturerString.Size;
+		RtlCopyBytes(Urb->UrbControlDescriptorRequest.TransferBuffer, Ds4ManufacturerString.Data, Ds4ManufacturerString.Size);
 
 		break;
 	}
@@ -970,25 +683,15 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetDS4::UsbGetStringDescriptorType(PUR
 			"LanguageId = 0x%X",
 			Urb->UrbControlDescriptorRequest.LanguageId);
 
-		if (Urb->UrbControlDescriptorRequest.TransferBufferLength < DS4_PRODUCT_NAME_LENGTH)
+		if (Urb->UrbControlDescriptorRequest.TransferBufferLength < Ds4ProductString.Size)
 		{
 			auto pDesc = static_cast<PUSB_STRING_DESCRIPTOR>(Urb->UrbControlDescriptorRequest.TransferBuffer);
-			pDesc->bLength = DS4_PRODUCT_NAME_LENGTH;
+			pDesc->bLength = static_cast<UCHAR>(Ds4ProductString.Size);
 			break;
 		}
 
-		// "Wireless Controller"
-		UCHAR ProductString[DS4_PRODUCT_NAME_LENGTH] =
-		{
-			0x28, 0x03, 0x57, 0x00, 0x69, 0x00, 0x72, 0x00,
-			0x65, 0x00, 0x6C, 0x00, 0x65, 0x00, 0x73, 0x00,
-			0x73, 0x00, 0x20, 0x00, 0x43, 0x00, 0x6F, 0x00,
-			0x6E, 0x00, 0x74, 0x00, 0x72, 0x00, 0x6F, 0x00,
-			0x6C, 0x00, 0x6C, 0x00, 0x65, 0x00, 0x72, 0x00
-		};
-
-		Urb->UrbControlDescriptorRequest.TransferBufferLength = DS4_PRODUCT_NAME_LENGTH;
-		RtlCopyBytes(Urb->UrbControlDescriptorRequest.TransferBuffer, ProductString, DS4_PRODUCT_NAME_LENGTH);
+		Urb->UrbControlDescriptorRequest.TransferBufferLength = Ds4ProductString.Size;
+		RtlCopyBytes(Urb->UrbControlDescriptorRequest.TransferBuffer, Ds4ProductString.Data, Ds4ProductString.Size);
 
 		break;
 	}
@@ -1017,6 +720,9 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetDS4::UsbBulkOrInterruptTransfer(_UR
 		   The request gets completed as soon as the "feeder" sent an update. */
 		status = WdfRequestForwardToIoQueue(Request, this->_PendingUsbInRequests);
 
+		if (NT_SUCCESS(status))
+			this->InterruptInRequestQueued();
+
 		return (NT_SUCCESS(status)) ? STATUS_PENDING : status;
 	}
 
@@ -1025,6 +731,28 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetDS4::UsbBulkOrInterruptTransfer(_UR
 		static_cast<PUCHAR>(pTransfer->TransferBuffer) + DS4_OUTPUT_BUFFER_OFFSET,
 		DS4_OUTPUT_BUFFER_LENGTH);
 
+	//
+	// Games resend the same rumble and lightbar values many times per second
+	// 
+	if (this->IsDuplicateOutput(&this->_OutputReport, DS4_OUTPUT_BUFFER_LENGTH))
+		return status;
+
+	//
+	// Only what somebody received may suppress the next resend
+	// 
+	bool delivered;
+
+	{
+		DS4_REQUEST_NOTIFICATION subscriberNotify;
+
+		DS4_REQUEST_NOTIFICATION_INIT(&subscriberNotify, this->_SerialNo);
+		subscriberNotify.Report = this->_OutputReport;
+
+		delivered = this->PublishNotification(&subscriberNotify, sizeof(DS4_REQUEST_NOTIFICATION));
+	}
+
+	this->PublishOutputState();
+
 	if (NT_SUCCESS(WdfIoQueueRetrieveNextRequest(
 		this->_PendingNotificationRequests,
 		&notifyRequest)))
@@ -1051,6 +779,8 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetDS4::UsbBulkOrInterruptTransfer(_UR
 			);
 
 			WdfRequestCompleteWithInformation(notifyRequest, status, notify->Size);
+
+			delivered = true;
 		}
 		else
 		{
@@ -1060,29 +790,13 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetDS4::UsbBulkOrInterruptTransfer(_UR
 			            status);
 		}
 	}
-	else
+	else if (this->QueueOutput(&this->_OutputReport, DS4_OUTPUT_BUFFER_LENGTH))
 	{
-		PVOID clientBuffer, contextBuffer;
-
-		if (NT_SUCCESS(DMF_BufferQueue_Fetch(
-			this->_UsbInterruptOutBufferQueue,
-			&clientBuffer,
-			&contextBuffer
-		)))
-		{
-			RtlCopyMemory(
-				clientBuffer,
-				&this->_OutputReport,
-				DS4_OUTPUT_BUFFER_LENGTH
-			);
-
-			*static_cast<size_t*>(contextBuffer) = DS4_OUTPUT_BUFFER_LENGTH;
-
-			TraceDbg(TRACE_USBPDO, "Queued %Iu bytes", DS4_OUTPUT_BUFFER_LENGTH);
-
-			DMF_BufferQueue_Enqueue(this->_UsbInterruptOutBufferQueue, clientBuffer);
-		}
+		delivered = true;
 	}
+
+	if (delivered)
+		this->RememberOutput(&this->_OutputReport, DS4_OUTPUT_BUFFER_LENGTH);
 	
 	return status;
 }
@@ -1115,11 +829,45 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetDS4::UsbControlTransfer(PURB Urb)
 	return status;
 }
 
-NTSTATUS ViGEm::Bus::Targets::EmulationTargetDS4::SubmitReportImpl(PVOID NewReport)
+NTSTATUS ViGEm::Bus::Targets::EmulationTargetDS4::SubmitReportImpl(PVOID NewReport, ULONG Writer)
+{
+	KIRQL					irql;
+
+	// Cast to expected struct
+	const auto pSubmit = static_cast<PDS4_SUBMIT_REPORT>(NewReport);
+
+	//
+	// Partial reports build on the owner's latest report, delivered or not
+	// 
+	if (this->_PartialReports && Writer == OWNER_WRITER)
+	{
+		KeAcquireSpinLock(&this->_ReportLock, &irql);
+
+		RtlCopyBytes(
+			&this->_PartialBase,
+			&pSubmit->Report,
+			(pSubmit->Size == sizeof(DS4_SUBMIT_REPORT_EX)) ? sizeof(DS4_REPORT_EX) : sizeof(DS4_REPORT)
+		);
+
+		KeReleaseSpinLock(&this->_ReportLock, irql);
+
+		//
+		// Same as partial submits, whichever delivery comes last carries the newest base
+		// 
+		return this->DeliverReport(nullptr, Writer);
+	}
+
+	return this->DeliverReport(NewReport, Writer);
+}
+
+NTSTATUS ViGEm::Bus::Targets::EmulationTargetDS4::DeliverReport(PVOID NewReport, ULONG Writer)
 {
 	NTSTATUS				status;
 	WDFREQUEST				usbRequest;
-	
+	KIRQL					irql;
+	Core::TARGET_REPORT		fused;
+	DS4_SUBMIT_REPORT_EX	partial;
+
 	/*
 	 * The logic here is unusual to keep backwards compatibility with the 
 	 * original API that didn't allow submitting the full report.
@@ -1130,19 +878,20 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetDS4::SubmitReportImpl(PVOID NewRepo
 	if (!NT_SUCCESS(status))
 		return status;
 
-	// Get pending IRP
-	PIRP pendingIrp = WdfRequestWdmGetIrp(usbRequest);
-
-	// Get USB request block
-	const auto urb = static_cast<PURB>(URB_FROM_IRP(pendingIrp));
+	KeAcquireSpinLock(&this->_ReportLock, &irql);
 
-	// Get transfer buffer
-	const auto buffer = static_cast<PUCHAR>(urb->UrbBulkOrInterruptTransfer.TransferBuffer);
+	//
+	// Read the base only now: a partial submit overtaken by a later one still
+	// delivers the later state instead of rolling the host back
+	// 
+	if (!NewReport)
+	{
+		DS4_SUBMIT_REPORT_EX_INIT(&partial, this->_SerialNo);
+		partial.Report = this->_PartialBase;
 
-	// Set correct buffer size
-	urb->UrbBulkOrInterruptTransfer.TransferBufferLength = DS4_REPORT_SIZE;
+		NewReport = &partial;
+	}
 
-	// Cast to expected struct
 	const auto pSubmit = static_cast<PDS4_SUBMIT_REPORT>(NewReport);
 
 	/*
@@ -1150,10 +899,26 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetDS4::SubmitReportImpl(PVOID NewRepo
 	 * Skip first byte as it contains the never changing report ID
 	 */
 
+	//
+	// Combine with other writers, if any (a partial report only updates its part)
+	// 
+	if (this->FuseReportLocked(
+		Writer,
+		&pSubmit->Report,
+		(pSubmit->Size == sizeof(DS4_SUBMIT_REPORT_EX))
+			? sizeof(DS4_REPORT_EX)
+			: (pSubmit->Size == sizeof(DS4_SUBMIT_REPORT)) ? sizeof(DS4_REPORT) : 0,
+		&fused))
+	{
+		TraceDbg(TRACE_DS4, "Received update from writer %d, fused", Writer);
+
+		this->ApplyReport(&fused);
+	}
+
 	//
 	// "Old" API which only allows to update partial report
 	// 
-	if (pSubmit->Size == sizeof(DS4_SUBMIT_REPORT))
+	else if (pSubmit->Size == sizeof(DS4_SUBMIT_REPORT))
 	{
 		TraceDbg(TRACE_DS4, "Received DS4_SUBMIT_REPORT update");
 		
@@ -1167,7 +932,7 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetDS4::SubmitReportImpl(PVOID NewRepo
 	//
 	// "Extended" API allowing complete report update
 	// 
-	if (pSubmit->Size == sizeof(DS4_SUBMIT_REPORT_EX))
+	else if (pSubmit->Size == sizeof(DS4_SUBMIT_REPORT_EX))
 	{
 		TraceDbg(TRACE_DS4, "Received DS4_SUBMIT_REPORT_EX update");
 		
@@ -1177,9 +942,10 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetDS4::SubmitReportImpl(PVOID NewRepo
 			sizeof((static_cast<PDS4_SUBMIT_REPORT_EX>(NewReport))->Report)
 		);
 	}
-	
-	if (buffer)
-		RtlCopyBytes(buffer, this->_Report, DS4_REPORT_SIZE);
+
+	this->CopyCachedReport(usbRequest);
+
+	KeReleaseSpinLock(&this->_ReportLock, irql);
 
 	// Complete pending request
 	WdfRequestComplete(usbRequest, status);
@@ -1187,6 +953,158 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetDS4::SubmitReportImpl(PVOID NewRepo
 	return status;
 }
 
+NTSTATUS ViGEm::Bus::Targets::EmulationTargetDS4::SubmitPartialReport(PDS4_SUBMIT_PARTIAL_REPORT Report)
+{
+	KIRQL irql;
+
+	KeAcquireSpinLock(&this->_ReportLock, &irql);
+
+	//
+	// The first partial report starts from what the host currently sees
+	// 
+	if (!this->_PartialReports)
+	{
+		RtlCopyBytes(&this->_PartialBase, &this->_Report[1], sizeof(DS4_REPORT_EX));
+		this->_PartialReports = true;
+	}
+
+	const auto merged = DS4_SUBMIT_PARTIAL_REPORT_MERGE(Report, &this->_PartialBase);
+
+	KeReleaseSpinLock(&this->_ReportLock, irql);
+
+	if (!merged)
+		return STATUS_INVALID_PARAMETER;
+
+	TraceDbg(TRACE_DS4, "Received partial update with fields 0x%X", Report->FieldMask);
+
+	//
+	// The base already holds the merged report, SubmitReportImpl would store a
+	// copy back which a concurrent partial submit may have moved past
+	// 
+	return this->DeliverReport(nullptr, OWNER_WRITER);
+}
+
+NTSTATUS ViGEm::Bus::Targets::EmulationTargetDS4::SubmitImuSamples(PDS4_SUBMIT_IMU_SAMPLES Samples)
+{
+	KIRQL irql;
+
+	//
+	// Only targets which actually stream motion pay for the buffer
+	// 
+	if (!this->_Imu)
+	{
+		const auto imu = new Core::ImuResampler();
+
+		if (!imu)
+			return STATUS_INSUFFICIENT_RESOURCES;
+
+		if (InterlockedCompareExchangePointer(
+			reinterpret_cast<PVOID volatile*>(&this->_Imu),
+			imu,
+			nullptr
+		) != nullptr)
+		{
+			delete imu;
+		}
+	}
+
+	KeAcquireSpinLock(&this->_ReportLock, &irql);
+
+	this->_ImuDelay = (Samples->Delay) ? Samples->Delay : DS4_IMU_DEFAULT_DELAY;
+
+	const auto taken = this->_Imu->Push(Samples->Samples, Samples->Count);
+	const auto underruns = this->_Imu->Underruns();
+
+	KeReleaseSpinLock(&this->_ReportLock, irql);
+
+	TraceDbg(TRACE_DS4, "Queued %d of %d motion samples (%d underruns so far)", taken, Samples->Count, underruns);
+
+	return STATUS_SUCCESS;
+}
+
+VOID ViGEm::Bus::Targets::EmulationTargetDS4::ApplyImuSampleLocked()
+{
+	LARGE_INTEGER frequency;
+	DS4_IMU_SAMPLE sample;
+
+	const auto now = KeQueryPerformanceCounter(&frequency).QuadPart;
+
+	//
+	// The host sees the motion a fixed delay late, giving samples time to arrive
+	// 
+	const auto time = now - (static_cast<LONGLONG>(this->_ImuDelay) * frequency.QuadPart) / 1000000;
+	const auto hold = (static_cast<LONGLONG>(DS4_IMU_HOLD_PERIOD) * frequency.QuadPart) / 1000000;
+
+	if (!this->_Imu->Resample(time, hold, &sample))
+		return;
+
+	const auto micros = (time / frequency.QuadPart) * 1000000
+		+ ((time % frequency.QuadPart) * 1000000) / frequency.QuadPart;
+
+	const auto report = reinterpret_cast<PDS4_REPORT_EX>(&this->_Report[1]);
+
+	// Timestamp counts in steps of 16/3 microseconds
+	report->Report.wTimestamp = static_cast<USHORT>((micros * 3) / 16);
+
+	report->Report.wGyroX = sample.wGyroX;
+	report->Report.wGyroY = sample.wGyroY;
+	report->Report.wGyroZ = sample.wGyroZ;
+	report->Report.wAccelX = sample.wAccelX;
+	report->Report.wAccelY = sample.wAccelY;
+	report->Report.wAccelZ = sample.wAccelZ;
+}
+
+VOID ViGEm::Bus::Targets::EmulationTargetDS4::ApplyReport(const Core::TARGET_REPORT* Report)
+{
+	// Skip first byte as it contains the never changing report ID
+	RtlCopyBytes(&this->_Report[1], &Report->Ds4, sizeof(Report->Ds4));
+}
+
+VOID ViGEm::Bus::Targets::EmulationTargetDS4::CopyCachedReport(WDFREQUEST Request)
+{
+	// Get pending IRP
+	PIRP pendingIrp = WdfRequestWdmGetIrp(Request);
+
+	// Get USB request block
+	const auto urb = static_cast<PURB>(URB_FROM_IRP(pendingIrp));
+
+	// Get transfer buffer
+	const auto buffer = static_cast<PUCHAR>(urb->UrbBulkOrInterruptTransfer.TransferBuffer);
+
+	// Set correct buffer size
+	urb->UrbBulkOrInterruptTransfer.TransferBufferLength = DS4_REPORT_SIZE;
+
+	//
+	// Streamed motion overrides whatever the last report carried, once per poll
+	// 
+	if (this->_Imu)
+		this->ApplyImuSampleLocked();
+
+	//
+	// Stamped last so every delivery gets its own time and counter values
+	// 
+	if (this->_DriverCounters)
+	{
+		LARGE_INTEGER frequency;
+
+		const auto now = KeQueryPerformanceCounter(&frequency).QuadPart;
+
+		this->_Counters.Advance(now, frequency.QuadPart, reinterpret_cast<PDS4_REPORT_EX>(&this->_Report[1]));
+	}
+
+	if (buffer)
+		RtlCopyBytes(buffer, this->_Report, DS4_REPORT_SIZE);
+
+	this->MarkBootPhase(VigemBootPhaseFirstReport);
+}
+
+VOID ViGEm::Bus::Targets::EmulationTargetDS4::GetOutputState(PVIGEM_OUTPUT_STATE State)
+{
+	State->LargeMotor = this->_OutputReport.LargeMotor;
+	State->SmallMotor = this->_OutputReport.SmallMotor;
+	State->LightbarColor = this->_OutputReport.LightbarColor;
+}
+
 VOID ViGEm::Bus::Targets::EmulationTargetDS4::ReverseByteArray(PUCHAR Array, INT Length)
 {
 	const auto s = static_cast<PUCHAR>(ExAllocatePoolWithTag(
@@ -1297,36 +1215,10 @@ VOID ViGEm::Bus::Targets::EmulationTargetDS4::PendingUsbRequestsTimerFunc(
 	const auto ctx = reinterpret_cast<EmulationTargetDS4*>(Core::EmulationTargetPdoGetContext(
 		WdfTimerGetParentObject(Timer))->Target);
 
-	WDFREQUEST usbRequest;
-
 	TraceDbg(TRACE_DS4, "%!FUNC! Entry");
 
-	// Get pending USB request
-	const auto status = WdfIoQueueRetrieveNextRequest(ctx->_PendingUsbInRequests, &usbRequest);
-
-	if (NT_SUCCESS(status))
-	{
-		// Get pending IRP
-		const auto pendingIrp = WdfRequestWdmGetIrp(usbRequest);
-
-		const auto irpStack = IoGetCurrentIrpStackLocation(pendingIrp);
-
-		// Get USB request block
-		const auto urb = static_cast<PURB>(irpStack->Parameters.Others.Argument1);
-
-		// Get transfer buffer
-		const auto buffer = static_cast<PUCHAR>(urb->UrbBulkOrInterruptTransfer.TransferBuffer);
-
-		// Set buffer length to report size
-		urb->UrbBulkOrInterruptTransfer.TransferBufferLength = DS4_REPORT_SIZE;
-
-		// Copy cached report to transfer buffer 
-		if (buffer)
-			RtlCopyBytes(buffer, ctx->_Report, DS4_REPORT_SIZE);
-
-		// Complete pending request
-		WdfRequestComplete(usbRequest, status);
-	}
+	// Complete pending USB request with cached report
+	const auto status = ctx->CompleteInRequestFromCache();
 
 	TraceDbg(TRACE_DS4, "%!FUNC! Exit with status %!STATUS!", status);
 }
@@ -37,10 +37,14 @@
 
 #include "EmulationTargetPDO.hpp"
 #include <ViGEm/km/BusShared.h>
+#include "ImuResampler.hpp"
+#include "Ds4ReportCounters.hpp"
 
 
 namespace ViGEm::Bus::Targets
 {
+	constexpr auto DS4_POOL_TAG = '4DiV';
+
 	//
 	// Represents a MAC address.
 	//
@@ -64,11 +68,15 @@ namespace ViGEm::Bus::Targets
 		return (pReq->Value >> 8) & 0xFF;
 	}
 
-	class EmulationTargetDS4 : public Core::EmulationTargetPDO
+	class EmulationTargetDS4 :
+		public Core::EmulationTargetPDO,
+		public Core::LookasideAllocated<EmulationTargetDS4, DS4_POOL_TAG>
 	{
 	public:
 		EmulationTargetDS4(ULONG Serial, LONG SessionId, USHORT VendorId = 0x054C, USHORT ProductId = 0x05C4);
 
+		~EmulationTargetDS4();
+
 		NTSTATUS PdoPrepareDevice(PWDFDEVICE_INIT DeviceInit,
 		                          PUNICODE_STRING DeviceId,
 		                          PUNICODE_STRING DeviceDescription) override;
@@ -97,7 +105,11 @@ namespace ViGEm::Bus::Targets
 		
 		NTSTATUS UsbControlTransfer(PURB Urb) override;
 		
-		NTSTATUS SubmitReportImpl(PVOID NewReport) override;
+		NTSTATUS SubmitReportImpl(PVOID NewReport, ULONG Writer) override;
+
+		NTSTATUS SubmitPartialReport(PDS4_SUBMIT_PARTIAL_REPORT Report);
+
+		NTSTATUS SubmitImuSamples(PDS4_SUBMIT_IMU_SAMPLES Samples);
 		
 	private:
 		static EVT_WDF_TIMER PendingUsbRequestsTimerFunc;
@@ -106,8 +118,21 @@ namespace ViGEm::Bus::Targets
 
 		static VOID GenerateRandomMacAddress(PMAC_ADDRESS Address);
 
+		VOID ApplyImuSampleLocked();
+
+		//
+		// Hands NewReport to a pending host request; nullptr delivers the latest partial base
+		// 
+		NTSTATUS DeliverReport(PVOID NewReport, ULONG Writer);
+
 	protected:
 		void ProcessPendingNotification(WDFQUEUE Queue) override;
+
+		VOID ApplyReport(const Core::TARGET_REPORT* Report) override;
+
+		VOID CopyCachedReport(WDFREQUEST Request) override;
+
+		VOID GetOutputState(PVIGEM_OUTPUT_STATE State) override;
 	private:
 		static PCWSTR _deviceDescription;
 
@@ -121,21 +146,23 @@ namespace ViGEm::Bus::Targets
 		static const int HID_REPORT_ID_3 = 0x13;
 		static const int HID_REPORT_ID_4 = 0x14;
 
-		static const int DS4_DESCRIPTOR_SIZE = 0x0029;
 #if defined(_X86_)
 		static const int DS4_CONFIGURATION_SIZE = 0x0050;
 #else
 		static const int DS4_CONFIGURATION_SIZE = 0x0070;
 #endif
 
-		static const int DS4_MANUFACTURER_NAME_LENGTH = 0x38;
-		static const int DS4_PRODUCT_NAME_LENGTH = 0x28;
 		static const int DS4_OUTPUT_BUFFER_OFFSET = 0x04;
 		static const int DS4_OUTPUT_BUFFER_LENGTH = 0x05;
 
 		static const int DS4_REPORT_SIZE = 0x40;
 		static const int DS4_QUEUE_FLUSH_PERIOD = 0x05;
 
+		//
+		// Time the latest motion sample is repeated for once the stream runs dry, in microseconds
+		// 
+		static const int DS4_IMU_HOLD_PERIOD = 100000;
+
 		//
 		// HID Input Report buffer
 		//
@@ -146,6 +173,31 @@ namespace ViGEm::Bus::Targets
 		//
 		DS4_OUTPUT_REPORT _OutputReport;
 
+		//
+		// Owner's latest report partial reports get merged into (protected by the report lock)
+		// 
+		DS4_REPORT_EX _PartialBase;
+
+		//
+		// Set with the first partial report, until then full reports skip tracking the base
+		// 
+		bool _PartialReports{};
+
+		//
+		// Streamed motion samples, allocated on first use (protected by the report lock)
+		// 
+		Core::ImuResampler* _Imu{};
+
+		//
+		// Playout delay of the motion stream in microseconds
+		// 
+		ULONG _ImuDelay{};
+
+		//
+		// Running report fields, if maintained by the bus (protected by the report lock)
+		// 
+		Core::Ds4ReportCounters _Counters;
+
 		//
 		// Timer for dispatching interrupt transfer
 		//
@@ -0,0 +1,143 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+namespace ViGEm::Bus::Core
+{
+	//
+	// Advances the running fields of DualShock 4 input reports like the 
+	// hardware does. No kernel dependencies; callers provide the timestamps.
+	// 
+	class Ds4ReportCounters
+	{
+	public:
+		//
+		// Stamps Report as handed to the host at Now (counter ticks, Frequency ticks per second)
+		// 
+		void Advance(LONGLONG Now, LONGLONG Frequency, DS4_REPORT_EX* Report)
+		{
+			if (!this->_Started)
+			{
+				this->_Epoch = Now;
+				this->_Started = true;
+			}
+
+			const auto elapsed = (Now > this->_Epoch && Frequency > 0) ? Now - this->_Epoch : 0;
+
+			//
+			// Steps of 16/3 microseconds, wrapping at 16 bits
+			// 
+			const auto steps = (Frequency > 0)
+				? (elapsed / Frequency) * TIMESTAMP_RATE + ((elapsed % Frequency) * TIMESTAMP_RATE) / Frequency
+				: 0;
+
+			Report->Report.wTimestamp = static_cast<USHORT>(steps);
+
+			//
+			// Upper six bits of bSpecial count reports, the lower two are buttons
+			// 
+			Report->Report.bSpecial = static_cast<BYTE>((Report->Report.bSpecial & SPECIAL_BUTTON_MASK) | (this->_Frame << 2));
+
+			this->_Frame = (this->_Frame + 1) & FRAME_COUNTER_MASK;
+
+			//
+			// New touch data gets the next packet number, repeats keep theirs
+			// 
+			if (Report->Report.bTouchPacketsN > 0)
+			{
+				if (!this->_TouchSeen || !SameTouch(&Report->Report.sCurrentTouch, &this->_LastTouch))
+				{
+					this->_TouchPacket++;
+					this->_LastTouch = Report->Report.sCurrentTouch;
+					this->_TouchSeen = true;
+				}
+
+				Report->Report.sCurrentTouch.bPacketCounter = this->_TouchPacket;
+			}
+		}
+
+		void Reset()
+		{
+			*this = Ds4ReportCounters();
+		}
+
+		UCHAR Frame() const
+		{
+			return this->_Frame;
+		}
+
+		UCHAR TouchPacket() const
+		{
+			return this->_TouchPacket;
+		}
+
+	private:
+		static const LONGLONG TIMESTAMP_RATE = 187500;
+
+		static const UCHAR SPECIAL_BUTTON_MASK = 0x03;
+
+		static const UCHAR FRAME_COUNTER_MASK = 0x3F;
+
+		//
+		// Compares everything but the packet counter
+		// 
+		static bool SameTouch(const DS4_TOUCH* A, const DS4_TOUCH* B)
+		{
+			const auto a = reinterpret_cast<const UCHAR*>(A);
+			const auto b = reinterpret_cast<const UCHAR*>(B);
+
+			for (ULONG index = sizeof(A->bPacketCounter); index < sizeof(DS4_TOUCH); index++)
+			{
+				if (a[index] != b[index])
+					return false;
+			}
+
+			return true;
+		}
+
+		LONGLONG _Epoch{};
+
+		DS4_TOUCH _LastTouch{};
+
+		UCHAR _Frame{};
+
+		UCHAR _TouchPacket{};
+
+		bool _Started{};
+
+		bool _TouchSeen{};
+	};
+}
@@ -0,0 +1,122 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+namespace ViGEm::Bus::Core
+{
+	//
+	// Holds the last few output packets the host sent before anybody asked for
+	// notifications, so the first listener still sees the boot LED or lightbar.
+	// Oldest packets are dropped first. No kernel dependencies; callers 
+	// serialize access.
+	// 
+	template <ULONG Capacity, ULONG PacketSize>
+	class EarlyOutputBuffer
+	{
+		static_assert(Capacity > 0, "Capacity must not be zero");
+
+	public:
+		bool Store(const VOID* Data, ULONG Length)
+		{
+			if (Length > PacketSize)
+				return false;
+
+			if (this->_Count == Capacity)
+			{
+				this->_First = (this->_First + 1) % Capacity;
+				this->_Count--;
+				this->_Dropped++;
+			}
+
+			const auto packet = &this->_Packets[(this->_First + this->_Count) % Capacity];
+
+			RtlCopyMemory(packet->Data, Data, Length);
+			packet->Length = Length;
+
+			this->_Count++;
+
+			return true;
+		}
+
+		//
+		// Hands the stored packets to Deliver(Data, Length) oldest first and empties
+		// the buffer; returns the number of packets delivered
+		// 
+		template <typename Sink>
+		ULONG Replay(Sink&& Deliver)
+		{
+			const auto count = this->_Count;
+
+			for (ULONG index = 0; index < count; index++)
+			{
+				const auto packet = &this->_Packets[(this->_First + index) % Capacity];
+
+				Deliver(static_cast<const VOID*>(packet->Data), packet->Length);
+			}
+
+			this->_First = 0;
+			this->_Count = 0;
+
+			return count;
+		}
+
+		ULONG Count() const
+		{
+			return this->_Count;
+		}
+
+		//
+		// Packets pushed out by newer ones before they could be replayed
+		// 
+		ULONG Dropped() const
+		{
+			return this->_Dropped;
+		}
+
+	private:
+		struct
+		{
+			ULONG Length;
+
+			UCHAR Data[PacketSize];
+		} _Packets[Capacity]{};
+
+		ULONG _First{};
+
+		ULONG _Count{};
+
+		ULONG _Dropped{};
+	};
+}
@@ -33,6 +33,7 @@
 */
 
 
+#include "Driver.h"
 #include "EmulationTargetPDO.hpp"
 #include "CRTCPP.hpp"
 #include "trace.h"
@@ -41,6 +42,10 @@
 #include <ntstrsafe.h>
 #include <usbioctl.h>
 #include <usbiodef.h>
+#include <bcrypt.h>
+
+#include <ViGEm/km/BusShared.h>
+#include <ViGEm/Util.h>
 
 #include "Debugging.hpp"
 
@@ -58,6 +63,7 @@ NTSTATUS ViGEm::Bus::Core::EmulationTargetPDO::PdoCreateDevice(WDFDEVICE ParentD
 	WDF_OBJECT_ATTRIBUTES attributes;
 	WDF_IO_QUEUE_CONFIG usbInQueueConfig;
 	WDF_IO_QUEUE_CONFIG notificationsQueueConfig;
+	WDF_TIMER_CONFIG scheduledReportsTimerConfig;
 	PEMULATION_TARGET_PDO_CONTEXT pPdoContext;
 
 	TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_BUSPDO, "%!FUNC! Entry");
@@ -154,6 +160,7 @@ NTSTATUS ViGEm::Bus::Core::EmulationTargetPDO::PdoCreateDevice(WDFDEVICE ParentD
 		WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&pdoAttributes, EMULATION_TARGET_PDO_CONTEXT);
 
 		pdoAttributes.EvtCleanupCallback = EvtDeviceContextCleanup;
+		pdoAttributes.EvtDestroyCallback = EvtDeviceContextDestroy;
 
 		status = WdfDeviceCreate(&DeviceInit, &pdoAttributes, &this->_PdoDevice);
 		if (!NT_SUCCESS(status))
@@ -260,144 +267,1790 @@ NTSTATUS ViGEm::Bus::Core::EmulationTargetPDO::PdoCreateDevice(WDFDEVICE ParentD
 			EvtWdfIoPendingNotificationQueueState,
 			this
 		);
-		if (!NT_SUCCESS(status))
+		if (!NT_SUCCESS(status))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+				TRACE_BUSPDO,
+				"WdfIoQueueReadyNotify (PendingNotificationRequests) failed with status %!STATUS!",
+				status);
+			break;
+		}
+
+		WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+		attributes.ParentObject = this->_PdoDevice;
+
+		// One-shot timer for scheduled report delivery, re-armed on demand
+		WDF_TIMER_CONFIG_INIT(&scheduledReportsTimerConfig, EvtScheduledReportsTimerFunc);
+		scheduledReportsTimerConfig.UseHighResolutionTimer = WdfTrue;
+
+		status = WdfTimerCreate(
+			&scheduledReportsTimerConfig,
+			&attributes,
+			&this->_ScheduledReportsTimer
+		);
+		if (!NT_SUCCESS(status))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+				TRACE_BUSPDO,
+				"WdfTimerCreate (ScheduledReportsTimer) failed with status %!STATUS!",
+				status);
+			break;
+		}
+
+#pragma endregion
+
+#pragma region Default I/O queue setup
+
+		WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+		attributes.ParentObject = this->_PdoDevice;
+
+		WDF_IO_QUEUE_CONFIG_INIT_DEFAULT_QUEUE(&defaultPdoQueueConfig, WdfIoQueueDispatchParallel);
+
+		defaultPdoQueueConfig.EvtIoInternalDeviceControl = EvtIoInternalDeviceControl;
+
+		status = WdfIoQueueCreate(
+			this->_PdoDevice,
+			&defaultPdoQueueConfig,
+			WDF_NO_OBJECT_ATTRIBUTES,
+			&defaultPdoQueue
+		);
+		if (!NT_SUCCESS(status))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+				TRACE_BUSPDO,
+				"WdfIoQueueCreate (Default) failed with status %!STATUS!",
+				status);
+			break;
+		}
+
+#pragma endregion
+
+#pragma region PNP capabilities
+
+		//
+		// Other capabilities initialized in derived class
+		// 
+
+		this->_PnpCapabilities.Address = this->_SerialNo;
+		this->_PnpCapabilities.UINumber = this->_SerialNo;
+
+		WdfDeviceSetPnpCapabilities(this->_PdoDevice, &this->_PnpCapabilities);
+
+#pragma endregion
+
+#pragma region Power capabilities
+
+		//
+		// Capabilities initialized in derived class
+		// 
+
+		WdfDeviceSetPowerCapabilities(this->_PdoDevice, &this->_PowerCapabilities);
+
+#pragma endregion
+	} while (FALSE);
+
+	TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_BUSPDO, "%!FUNC! Exit with status %!STATUS!", status);
+
+	return status;
+}
+
+VOID ViGEm::Bus::Core::EmulationTargetPDO::EvtDeviceContextCleanup(
+	IN WDFOBJECT Device
+)
+{
+	TraceEvents(TRACE_LEVEL_VERBOSE, TRACE_BUSPDO, "%!FUNC! Entry");
+
+	const auto ctx = EmulationTargetPdoGetContext(Device);
+
+	ctx->Target->PdoUnprepare();
+
+	//
+	// Output buffers are parented to the FDO as well
+	// 
+	DMFMODULE outQueue;
+
+	{
+		KIRQL irql;
+
+		KeAcquireSpinLock(&ctx->Target->_OutputQueueLock, &irql);
+
+		outQueue = static_cast<DMFMODULE>(InterlockedExchangePointer(
+			reinterpret_cast<PVOID volatile*>(&ctx->Target->_UsbInterruptOutBufferQueue),
+			nullptr
+		));
+
+		KeReleaseSpinLock(&ctx->Target->_OutputQueueLock, irql);
+	}
+
+	if (outQueue)
+	{
+		WdfObjectDelete(outQueue);
+	}
+
+	//
+	// Wait for thread to finish, if active
+	// 
+	if (ctx->Target->_WaitDeviceReadyCompletionWorkerThreadHandle)
+	{
+		NTSTATUS status = KeWaitForSingleObject(
+			&ctx->Target->_WaitDeviceReadyCompletionWorkerThreadHandle,
+			Executive,
+			KernelMode,
+			FALSE,
+			nullptr
+		);
+
+		if (NT_SUCCESS(status))
+		{
+			ZwClose(ctx->Target->_WaitDeviceReadyCompletionWorkerThreadHandle);
+			ctx->Target->_WaitDeviceReadyCompletionWorkerThreadHandle = nullptr;
+		}
+		else
+		{
+			TraceEvents(TRACE_LEVEL_WARNING,
+				TRACE_BUSPDO,
+				"KeWaitForSingleObject failed with status %!STATUS!",
+				status
+			);
+		}
+	}
+	
+	//
+	// Make sure no delivery pass is in flight
+	// 
+	if (ctx->Target->_ScheduledReportsTimer)
+	{
+		WdfTimerStop(ctx->Target->_ScheduledReportsTimer, TRUE);
+	}
+
+	//
+	// Drop out of any pending frame commit
+	// 
+	{
+		const auto pFdoData = FdoGetData(WdfPdoGetParent(static_cast<WDFDEVICE>(Device)));
+		KIRQL irql;
+
+		KeAcquireSpinLock(&pFdoData->FrameLock, &irql);
+
+		RemoveEntryList(&ctx->Target->_StagedLink);
+		InitializeListHead(&ctx->Target->_StagedLink);
+		ctx->Target->_Staged.Discard();
+
+		const auto request = ctx->Target->_CommittedInRequest;
+		ctx->Target->_CommittedInRequest = nullptr;
+
+		KeReleaseSpinLock(&pFdoData->FrameLock, irql);
+
+		if (request)
+			WdfRequestComplete(request, STATUS_CANCELLED);
+	}
+
+	//
+	// Subscriber queues are parented to the FDO as well
+	// 
+	for (ULONG subscriber = 0; subscriber < NotificationFanoutQueue::MAX_SUBSCRIBERS; subscriber++)
+	{
+		ctx->Target->Unsubscribe(subscriber);
+	}
+
+	//
+	// Disappear from mapped output state pages
+	// 
+	ctx->Target->WriteOutputState(nullptr);
+
+	//
+	// Invalidate handles, if any got issued
+	// 
+	FdoGetData(WdfPdoGetParent(static_cast<WDFDEVICE>(Device)))->TargetTokens.Release(ctx->Target);
+	FdoGetData(WdfPdoGetParent(static_cast<WDFDEVICE>(Device)))->TargetTokens.ReleaseSecondaries(ctx->Target);
+
+	TraceEvents(TRACE_LEVEL_VERBOSE, TRACE_BUSPDO, "%!FUNC! Exit");
+}
+
+VOID ViGEm::Bus::Core::EmulationTargetPDO::EvtDeviceContextDestroy(
+	IN WDFOBJECT Device
+)
+{
+	TraceEvents(TRACE_LEVEL_VERBOSE, TRACE_BUSPDO, "%!FUNC! Entry");
+
+	const auto ctx = EmulationTargetPdoGetContext(Device);
+
+	//
+	// Last reference gone (token lookups hold one), free context object 
+	// 
+	delete ctx->Target;
+
+	TraceEvents(TRACE_LEVEL_VERBOSE, TRACE_BUSPDO, "%!FUNC! Exit");
+}
+
+NTSTATUS ViGEm::Bus::Core::EmulationTargetPDO::SubmitReport(PVOID NewReport)
+{
+	return (this->IsOwnerProcess())
+		? this->SubmitReportImpl(NewReport, OWNER_WRITER)
+		: STATUS_ACCESS_DENIED;
+}
+
+NTSTATUS ViGEm::Bus::Core::EmulationTargetPDO::SubmitReportValidated(PVOID NewReport, ULONG Writer)
+{
+	//
+	// Caller identity has already been established via token lookup
+	// 
+	return this->SubmitReportImpl(NewReport, Writer);
+}
+
+NTSTATUS ViGEm::Bus::Core::EmulationTargetPDO::SubmitReportTranslated(VIGEM_TARGET_TYPE Format, PVOID NewReport, ULONG Writer)
+{
+	XUSB_SUBMIT_REPORT xusbSubmit;
+	DS4_SUBMIT_REPORT ds4Submit;
+
+	if (Format == this->_TargetType)
+		return this->SubmitReportValidated(NewReport, Writer);
+
+	switch (this->_TargetType)
+	{
+	case DualShock4Wired:
+		//
+		// Only the DS4_REPORT part gets updated, motion and touch stay as they are
+		// 
+		DS4_SUBMIT_REPORT_INIT(&ds4Submit, this->_SerialNo);
+		XUSB_TO_DS4(&static_cast<PXUSB_SUBMIT_REPORT>(NewReport)->Report, &ds4Submit.Report);
+
+		return this->SubmitReportImpl(&ds4Submit, Writer);
+
+	case Xbox360Wired:
+		//
+		// DS4_SUBMIT_REPORT_EX starts with the same fields as DS4_SUBMIT_REPORT
+		// 
+		XUSB_SUBMIT_REPORT_INIT(&xusbSubmit, this->_SerialNo);
+		DS4_TO_XUSB(&static_cast<PDS4_SUBMIT_REPORT>(NewReport)->Report, &xusbSubmit.Report);
+
+		return this->SubmitReportImpl(&xusbSubmit, Writer);
+
+	default:
+		return STATUS_NOT_SUPPORTED;
+	}
+}
+
+NTSTATUS ViGEm::Bus::Core::EmulationTargetPDO::SubmitScheduledReport(PVIGEM_SUBMIT_SCHEDULED_REPORT Report)
+{
+	SCHEDULED_REPORT entry;
+	bool queued;
+	KIRQL irql;
+
+	if (!this->_ScheduledReportsTimer)
+		return STATUS_INVALID_DEVICE_STATE;
+
+	entry.DueTime = Report->DueTime;
+	entry.Sequence = static_cast<ULONG>(InterlockedIncrement(&this->_ScheduledReportsSequence));
+	entry.Retries = 0;
+
+	switch (this->_TargetType)
+	{
+	case Xbox360Wired:
+		entry.Report.Xusb = Report->Report.Xusb;
+		break;
+	case DualShock4Wired:
+		entry.Report.Ds4 = Report->Report.Ds4;
+		break;
+	default:
+		return STATUS_NOT_SUPPORTED;
+	}
+
+	//
+	// Only targets which actually schedule reports pay for the storage
+	// 
+	if (!this->_ScheduledReports)
+	{
+		const auto heap = new ScheduledReportHeap();
+
+		if (!heap)
+			return STATUS_INSUFFICIENT_RESOURCES;
+
+		if (InterlockedCompareExchangePointer(
+			reinterpret_cast<PVOID volatile*>(&this->_ScheduledReports),
+			heap,
+			nullptr
+		) != nullptr)
+		{
+			delete heap;
+		}
+	}
+
+	KeAcquireSpinLock(&this->_ScheduledReportsLock, &irql);
+	queued = this->_ScheduledReports->Push(entry);
+	KeReleaseSpinLock(&this->_ScheduledReportsLock, irql);
+
+	if (!queued)
+	{
+		TraceEvents(TRACE_LEVEL_WARNING,
+			TRACE_BUSPDO,
+			"Scheduled report queue of serial %d is full",
+			this->_SerialNo);
+
+		return STATUS_DEVICE_BUSY;
+	}
+
+	//
+	// Delivers right away if already due, otherwise (re-)arms the timer
+	// 
+	this->DeliverScheduledReports();
+
+	return STATUS_SUCCESS;
+}
+
+VOID ViGEm::Bus::Core::EmulationTargetPDO::DeliverScheduledReports()
+{
+	//
+	// Retry interval if the host has no IN request pending (milliseconds)
+	// 
+	static const LONGLONG retryInterval = 1;
+
+	LARGE_INTEGER frequency;
+	LONGLONG nextDueIn;
+	LONGLONG dueIn;
+	SCHEDULED_REPORT entry;
+	XUSB_SUBMIT_REPORT xusbSubmit;
+	DS4_SUBMIT_REPORT_EX ds4Submit;
+	NTSTATUS status;
+	KIRQL irql;
+
+	if (!this->_ScheduledReports)
+		return;
+
+	//
+	// Concurrent callers just leave a note for the active pass to run again
+	// 
+	if (InterlockedIncrement(&this->_ScheduledReportsDeliveryRequests) > 1)
+		return;
+
+	do
+	{
+		nextDueIn = 0;
+
+		for (;;)
+		{
+			KeAcquireSpinLock(&this->_ScheduledReportsLock, &irql);
+
+			const auto now = KeQueryPerformanceCounter(&frequency).QuadPart;
+			const auto due = this->_ScheduledReports->PopDue(now, &entry, &dueIn);
+
+			KeReleaseSpinLock(&this->_ScheduledReportsLock, irql);
+
+			if (!due)
+			{
+				if (dueIn > 0)
+				{
+					//
+					// Ticks to microseconds without overflowing on far away due times
+					// 
+					nextDueIn = (dueIn / frequency.QuadPart) * 1000000
+						+ ((dueIn % frequency.QuadPart) * 1000000) / frequency.QuadPart;
+
+					if (nextDueIn == 0)
+						nextDueIn = 1;
+				}
+
+				break;
+			}
+
+			if (this->_TargetType == Xbox360Wired)
+			{
+				XUSB_SUBMIT_REPORT_INIT(&xusbSubmit, this->_SerialNo);
+				xusbSubmit.Report = entry.Report.Xusb;
+
+				status = this->SubmitReportImpl(&xusbSubmit, OWNER_WRITER);
+			}
+			else
+			{
+				DS4_SUBMIT_REPORT_EX_INIT(&ds4Submit, this->_SerialNo);
+				ds4Submit.Report = entry.Report.Ds4;
+
+				status = this->SubmitReportImpl(&ds4Submit, OWNER_WRITER);
+			}
+
+			//
+			// No IN request pending; keep the report at the head, it goes out
+			// with the next request the host sends or on the retry timer. A host
+			// that stopped polling doesn't get retried forever.
+			// 
+			if (status == STATUS_NO_MORE_ENTRIES)
+			{
+				KeAcquireSpinLock(&this->_ScheduledReportsLock, &irql);
+				const auto requeued = this->_ScheduledReports->Retry(entry);
+				KeReleaseSpinLock(&this->_ScheduledReportsLock, irql);
+
+				if (requeued)
+				{
+					nextDueIn = retryInterval * 1000;
+					break;
+				}
+
+				TraceEvents(TRACE_LEVEL_WARNING,
+					TRACE_BUSPDO,
+					"Dropped scheduled report of serial %d, no IN request after %d retries",
+					this->_SerialNo,
+					MAX_SCHEDULED_REPORT_RETRIES);
+
+				continue;
+			}
+
+			if (!NT_SUCCESS(status))
+			{
+				TraceEvents(TRACE_LEVEL_WARNING,
+					TRACE_BUSPDO,
+					"Dropped scheduled report, SubmitReportImpl failed with status %!STATUS!",
+					status);
+			}
+		}
+
+		if (nextDueIn > 0)
+		{
+			WdfTimerStart(this->_ScheduledReportsTimer, WDF_REL_TIMEOUT_IN_US(nextDueIn));
+		}
+	} while (InterlockedDecrement(&this->_ScheduledReportsDeliveryRequests) > 0);
+}
+
+VOID ViGEm::Bus::Core::EmulationTargetPDO::InterruptInRequestQueued()
+{
+	LARGE_INTEGER frequency;
+	WDFREQUEST usbRequest;
+	KIRQL irql;
+
+	const auto now = KeQueryPerformanceCounter(&frequency).QuadPart;
+
+	this->_PollInterval.Sample(now, frequency.QuadPart);
+
+	//
+	// Wake up feeders first so they get the most time to submit
+	// 
+	this->CompletePollRequests();
+
+	//
+	// A fresh IN request may be what a held back report was waiting for. The flag 
+	// is checked and cleared under the lock CommitStagedReports sets it under, 
+	// together with copying the committed report.
+	// 
+	KeAcquireSpinLock(&this->_ReportLock, &irql);
+
+	if (this->_CommittedReportPending
+		&& NT_SUCCESS(WdfIoQueueRetrieveNextRequest(this->_PendingUsbInRequests, &usbRequest)))
+	{
+		this->CopyCachedReport(usbRequest);
+		this->_CommittedReportPending = false;
+	}
+	else
+	{
+		usbRequest = nullptr;
+	}
+
+	KeReleaseSpinLock(&this->_ReportLock, irql);
+
+	if (usbRequest)
+		WdfRequestComplete(usbRequest, STATUS_SUCCESS);
+
+	this->DeliverScheduledReports();
+}
+
+NTSTATUS ViGEm::Bus::Core::EmulationTargetPDO::EnqueueAwaitPoll(WDFREQUEST Request)
+{
+	ULONG queuedUsbInRequests = 0;
+
+	if (!this->_PendingPollRequests)
+		return STATUS_INVALID_DEVICE_STATE;
+
+	const auto status = WdfRequestForwardToIoQueue(Request, this->_PendingPollRequests);
+
+	if (!NT_SUCCESS(status))
+		return status;
+
+	//
+	// Host is already waiting, don't hold the feeder back. Checked after
+	// queuing so a transfer arriving in between isn't missed.
+	// 
+	WdfIoQueueGetState(this->_PendingUsbInRequests, &queuedUsbInRequests, nullptr);
+
+	if (queuedUsbInRequests > 0)
+	{
+		this->CompletePollRequests();
+	}
+
+	return STATUS_PENDING;
+}
+
+VOID ViGEm::Bus::Core::EmulationTargetPDO::CompletePollRequests()
+{
+	WDFREQUEST pollRequest;
+	PVIGEM_AWAIT_POLL pAwaitPoll;
+	size_t length;
+
+	if (!this->_PendingPollRequests)
+		return;
+
+	while (NT_SUCCESS(WdfIoQueueRetrieveNextRequest(this->_PendingPollRequests, &pollRequest)))
+	{
+		auto status = WdfRequestRetrieveOutputBuffer(
+			pollRequest,
+			sizeof(VIGEM_AWAIT_POLL),
+			reinterpret_cast<PVOID*>(&pAwaitPoll),
+			&length
+		);
+
+		if (NT_SUCCESS(status))
+		{
+			pAwaitPoll->PollTime = this->_PollInterval.LastArrival();
+			pAwaitPoll->PollInterval = this->_PollInterval.Last();
+		}
+		else
+		{
+			length = 0;
+		}
+
+		WdfRequestCompleteWithInformation(pollRequest, status, length);
+	}
+}
+
+VOID ViGEm::Bus::Core::EmulationTargetPDO::GetStatistics(PVIGEM_TARGET_STATISTICS Statistics) const
+{
+	//
+	// Unsynchronized snapshot, individual fields are consistent
+	// 
+	Statistics->Polling.LastInterval = this->_PollInterval.Last();
+	Statistics->Polling.AverageInterval = this->_PollInterval.Average();
+	Statistics->Polling.MinimumInterval = this->_PollInterval.Minimum();
+	Statistics->Polling.MaximumInterval = this->_PollInterval.Maximum();
+	Statistics->Polling.Count = this->_PollInterval.Count();
+
+	const auto outQueue = this->OutputBufferQueue();
+
+	Statistics->Memory.TargetSize = this->_ObjectSize;
+	Statistics->Memory.OutputBufferCount = (outQueue) ? this->_OutputBufferCount : 0;
+	Statistics->Memory.OutputBufferBytes = Statistics->Memory.OutputBufferCount
+		* static_cast<ULONG>(MAX_OUT_BUFFER_QUEUE_SIZE + sizeof(size_t));
+
+	this->_BootTimeline.Get(&Statistics->Boot);
+
+	Statistics->Output.Received = static_cast<ULONG>(this->_ReceivedOutputs);
+	Statistics->Output.Suppressed = static_cast<ULONG>(this->_SuppressedOutputs);
+}
+
+NTSTATUS ViGEm::Bus::Core::EmulationTargetPDO::CompleteInRequestFromCache()
+{
+	WDFREQUEST usbRequest;
+	KIRQL irql;
+
+	const auto status = WdfIoQueueRetrieveNextRequest(this->_PendingUsbInRequests, &usbRequest);
+
+	if (!NT_SUCCESS(status))
+		return status;
+
+	KeAcquireSpinLock(&this->_ReportLock, &irql);
+	this->CopyCachedReport(usbRequest);
+	KeReleaseSpinLock(&this->_ReportLock, irql);
+
+	WdfRequestComplete(usbRequest, status);
+
+	return status;
+}
+
+NTSTATUS ViGEm::Bus::Core::EmulationTargetPDO::StageReport(PVIGEM_STAGE_REPORT Report, WDFFILEOBJECT Owner)
+{
+	TARGET_REPORT report;
+	KIRQL irql;
+
+	if (!this->_PdoDevice)
+		return STATUS_INVALID_DEVICE_STATE;
+
+	switch (this->_TargetType)
+	{
+	case Xbox360Wired:
+		report.Xusb = Report->Report.Xusb;
+		break;
+	case DualShock4Wired:
+		report.Ds4 = Report->Report.Ds4;
+		break;
+	default:
+		return STATUS_NOT_SUPPORTED;
+	}
+
+	const auto pFdoData = FdoGetData(WdfPdoGetParent(this->_PdoDevice));
+
+	//
+	// Staging leaves the cached report alone, the report lock isn't needed
+	// 
+	KeAcquireSpinLock(&pFdoData->FrameLock, &irql);
+
+	this->_Staged.Stage(report, Owner);
+
+	if (IsListEmpty(&this->_StagedLink))
+	{
+		InsertTailList(&pFdoData->StagedTargets, &this->_StagedLink);
+	}
+
+	KeReleaseSpinLock(&pFdoData->FrameLock, irql);
+
+	return STATUS_SUCCESS;
+}
+
+NTSTATUS ViGEm::Bus::Core::EmulationTargetPDO::CommitStagedReports(
+	WDFDEVICE ParentDevice,
+	WDFFILEOBJECT Owner,
+	PULONG TargetCount,
+	PLONGLONG Epoch
+)
+{
+	const auto pFdoData = FdoGetData(ParentDevice);
+	LIST_ENTRY committed;
+	WDFREQUEST usbRequest;
+	ULONG count = 0;
+	KIRQL irql;
+
+	InitializeListHead(&committed);
+
+	KeAcquireSpinLock(&pFdoData->FrameLock, &irql);
+
+	const auto epoch = ++pFdoData->FrameEpoch;
+
+	for (auto entry = pFdoData->StagedTargets.Flink; entry != &pFdoData->StagedTargets;)
+	{
+		const auto target = CONTAINING_RECORD(entry, EmulationTargetPDO, _StagedLink);
+
+		entry = entry->Flink;
+
+		if (!target->_Staged.IsStagedBy(Owner))
+			continue;
+
+		RemoveEntryList(&target->_StagedLink);
+		InsertTailList(&committed, &target->_StagedLink);
+	}
+
+	const auto forEach = [&committed](auto&& Function)
+	{
+		for (auto entry = committed.Flink; entry != &committed; entry = entry->Flink)
+		{
+			Function(CONTAINING_RECORD(entry, EmulationTargetPDO, _StagedLink));
+		}
+	};
+
+	//
+	// Only the report locks of this frame's targets are held, all at once, so no IN 
+	// request can observe a mix of the previous and this frame
+	// 
+	CommitFrame(
+		forEach,
+		[](EmulationTargetPDO* Target)
+		{
+			KeAcquireSpinLockAtDpcLevel(&Target->_ReportLock);
+		},
+		[&count](EmulationTargetPDO* Target)
+		{
+			const auto staged = Target->_Staged.Take();
+			TARGET_REPORT fused;
+			WDFREQUEST request;
+
+			Target->ApplyReport(Target->FuseReportLocked(OWNER_WRITER, staged, sizeof(TARGET_REPORT), &fused)
+				? &fused
+				: staged);
+
+			if (NT_SUCCESS(WdfIoQueueRetrieveNextRequest(Target->_PendingUsbInRequests, &request)))
+			{
+				Target->CopyCachedReport(request);
+				Target->_CommittedInRequest = request;
+				Target->_CommittedReportPending = false;
+			}
+			else
+			{
+				Target->_CommittedReportPending = true;
+			}
+
+			count++;
+		},
+		[](EmulationTargetPDO* Target)
+		{
+			KeReleaseSpinLockFromDpcLevel(&Target->_ReportLock);
+		}
+	);
+
+	KeReleaseSpinLock(&pFdoData->FrameLock, irql);
+
+	//
+	// Completion may loop back into the target, so it happens unlocked
+	// 
+	for (;;)
+	{
+		KeAcquireSpinLock(&pFdoData->FrameLock, &irql);
+
+		if (IsListEmpty(&committed))
+		{
+			KeReleaseSpinLock(&pFdoData->FrameLock, irql);
+			break;
+		}
+
+		const auto target = CONTAINING_RECORD(RemoveHeadList(&committed), EmulationTargetPDO, _StagedLink);
+
+		//
+		// Staged again meanwhile, waits for the next commit
+		// 
+		if (target->_Staged.IsStaged())
+			InsertTailList(&pFdoData->StagedTargets, &target->_StagedLink);
+		else
+			InitializeListHead(&target->_StagedLink);
+
+		usbRequest = target->_CommittedInRequest;
+		target->_CommittedInRequest = nullptr;
+
+		KeReleaseSpinLock(&pFdoData->FrameLock, irql);
+
+		if (usbRequest)
+			WdfRequestComplete(usbRequest, STATUS_SUCCESS);
+	}
+
+	*TargetCount = count;
+	*Epoch = epoch;
+
+	return STATUS_SUCCESS;
+}
+
+VOID ViGEm::Bus::Core::EmulationTargetPDO::DiscardStagedReports(WDFDEVICE ParentDevice, WDFFILEOBJECT Owner)
+{
+	const auto pFdoData = FdoGetData(ParentDevice);
+	KIRQL irql;
+
+	KeAcquireSpinLock(&pFdoData->FrameLock, &irql);
+
+	for (auto entry = pFdoData->StagedTargets.Flink; entry != &pFdoData->StagedTargets;)
+	{
+		const auto target = CONTAINING_RECORD(entry, EmulationTargetPDO, _StagedLink);
+
+		entry = entry->Flink;
+
+		if (!target->_Staged.IsStagedBy(Owner))
+			continue;
+
+		RemoveEntryList(&target->_StagedLink);
+		InitializeListHead(&target->_StagedLink);
+		target->_Staged.Discard();
+	}
+
+	KeReleaseSpinLock(&pFdoData->FrameLock, irql);
+}
+
+void ViGEm::Bus::Core::EmulationTargetPDO::EvtScheduledReportsTimerFunc(
+	_In_ WDFTIMER Timer
+)
+{
+	const auto ctx = EmulationTargetPdoGetContext(WdfTimerGetParentObject(Timer));
+
+	ctx->Target->DeliverScheduledReports();
+}
+
+NTSTATUS ViGEm::Bus::Core::EmulationTargetPDO::EnqueueNotification(WDFREQUEST Request)
+{
+	if (!this->IsOwnerProcess())
+		return STATUS_ACCESS_DENIED;
+
+	//
+	// Output reports only need buffering once somebody listens
+	// 
+	const auto status = this->CreateOutputBufferQueue();
+
+	if (!NT_SUCCESS(status))
+		return status;
+
+	return WdfRequestForwardToIoQueue(Request, this->_PendingNotificationRequests);
+}
+
+NTSTATUS ViGEm::Bus::Core::EmulationTargetPDO::CreateOutputBufferQueue()
+{
+	NTSTATUS status;
+	WDF_OBJECT_ATTRIBUTES attributes;
+	DMF_MODULE_ATTRIBUTES moduleAttributes;
+	DMF_CONFIG_BufferQueue dmfBufferCfg;
+	DMFMODULE outQueue;
+
+	if (this->OutputBufferQueue())
+		return STATUS_SUCCESS;
+
+	WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+	attributes.ParentObject = this->_ParentDevice;
+
+	DMF_CONFIG_BufferQueue_AND_ATTRIBUTES_INIT(
+		&dmfBufferCfg,
+		&moduleAttributes
+	);
+
+	// Don't auto-grow; start dropping packets on overrun
+	dmfBufferCfg.SourceSettings.EnableLookAside = FALSE;
+	// Maximum number of buffers to be filled and kept queued
+	dmfBufferCfg.SourceSettings.BufferCount = this->_OutputBufferCount;
+	// Maximum byte count per buffer
+	dmfBufferCfg.SourceSettings.BufferSize = MAX_OUT_BUFFER_QUEUE_SIZE;
+	// Field to store real buffer content length
+	dmfBufferCfg.SourceSettings.BufferContextSize = sizeof(size_t);
+	// "Expensive" memory ;)
+	dmfBufferCfg.SourceSettings.PoolType = NonPagedPoolNx;
+
+	status = DMF_BufferQueue_Create(
+		this->_ParentDevice,
+		&moduleAttributes,
+		&attributes,
+		&outQueue
+	);
+
+	if (!NT_SUCCESS(status))
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+		            TRACE_BUSPDO,
+		            "DMF_BufferQueue_Create failed with status %!STATUS!",
+		            status
+		);
+		return status;
+	}
+
+	KIRQL irql;
+	KeAcquireSpinLock(&this->_OutputQueueLock, &irql);
+
+	//
+	// Concurrent notification requests may race here, first one wins
+	// 
+	const auto published = (InterlockedCompareExchangePointer(
+		reinterpret_cast<PVOID volatile*>(&this->_UsbInterruptOutBufferQueue),
+		outQueue,
+		nullptr
+	) == nullptr);
+
+	//
+	// Replay what the host sent before anybody listened (boot LED, initial 
+	// lightbar) ahead of any packet buffered after the lock is dropped
+	// 
+	if (published)
+	{
+		const auto replayed = this->_EarlyOutput.Replay([outQueue](const VOID* Buffer, ULONG Length)
+		{
+			PVOID clientBuffer, contextBuffer;
+
+			if (NT_SUCCESS(DMF_BufferQueue_Fetch(outQueue, &clientBuffer, &contextBuffer)))
+			{
+				RtlCopyMemory(clientBuffer, Buffer, Length);
+				*static_cast<size_t*>(contextBuffer) = Length;
+
+				DMF_BufferQueue_Enqueue(outQueue, clientBuffer);
+			}
+		});
+
+		TraceDbg(TRACE_BUSPDO, "Replayed %d early output packets", replayed);
+
+		//
+		// The new listener gets the next packet even if it repeats the last one
+		// 
+		this->_LastOutput.Forget();
+	}
+
+	KeReleaseSpinLock(&this->_OutputQueueLock, irql);
+
+	if (!published)
+	{
+		WdfObjectDelete(outQueue);
+	}
+
+	return STATUS_SUCCESS;
+}
+
+bool ViGEm::Bus::Core::EmulationTargetPDO::IsOwnerProcess() const
+{
+	return this->_OwnerProcessId == current_process_id();
+}
+
+VIGEM_TARGET_TYPE ViGEm::Bus::Core::EmulationTargetPDO::GetType() const
+{
+	return this->_TargetType;
+}
+
+LONG ViGEm::Bus::Core::EmulationTargetPDO::GetSessionId() const
+{
+	return this->_SessionId;
+}
+
+ULONG ViGEm::Bus::Core::EmulationTargetPDO::GetToken() const
+{
+	return this->_Token;
+}
+
+void ViGEm::Bus::Core::EmulationTargetPDO::SetToken(ULONG Token)
+{
+	this->_Token = Token;
+}
+
+bool ViGEm::Bus::Core::EmulationTargetPDO::Reference()
+{
+	if (!this->_PdoDevice)
+		return false;
+
+	WdfObjectReference(this->_PdoDevice);
+
+	return true;
+}
+
+VOID ViGEm::Bus::Core::EmulationTargetPDO::Dereference()
+{
+	WdfObjectDereference(this->_PdoDevice);
+}
+
+void ViGEm::Bus::Core::EmulationTargetPDO::SetPollingInterval(UCHAR Interval)
+{
+	this->_PollingInterval = Interval;
+}
+
+UCHAR ViGEm::Bus::Core::EmulationTargetPDO::EndpointInterval(UCHAR Default) const
+{
+	return (this->_PollingInterval) ? this->_PollingInterval : Default;
+}
+
+void ViGEm::Bus::Core::EmulationTargetPDO::SetOutputBufferCount(ULONG Count)
+{
+	if (Count == 0)
+		this->_OutputBufferCount = MAX_OUT_BUFFER_QUEUE_COUNT;
+	else
+		this->_OutputBufferCount = min(Count, static_cast<ULONG>(MAX_OUT_BUFFER_QUEUE_COUNT_LIMIT));
+}
+
+NTSTATUS ViGEm::Bus::Core::EmulationTargetPDO::GrantLease(ULONG GracePeriodMs, PULONG LeaseKey)
+{
+	if (GracePeriodMs == 0 || GracePeriodMs > MAX_LEASE_GRACE_PERIOD_MS)
+		return STATUS_INVALID_PARAMETER;
+
+	//
+	// Keep the key if the owner only changes the grace period
+	// 
+	ULONG key = this->_Lease.Key();
+
+	if (key == 0)
+	{
+		const auto status = draw_secret_key(&key);
+
+		if (!NT_SUCCESS(status))
+			return status;
+	}
+
+	//
+	// Interrupt time ticks are 100ns
+	// 
+	if (!this->_Lease.Grant(key, static_cast<LONGLONG>(GracePeriodMs) * 10000))
+		return STATUS_INVALID_DEVICE_STATE;
+
+	*LeaseKey = key;
+
+	return STATUS_SUCCESS;
+}
+
+bool ViGEm::Bus::Core::EmulationTargetPDO::OrphanLease(LONG SessionId)
+{
+	bool orphaned = false;
+	KIRQL irql;
+
+	KeAcquireSpinLock(&this->_OwnerLock, &irql);
+
+	//
+	// A transfer claimed since the caller looked keeps the target with its new owner
+	// 
+	if (this->_SessionId == SessionId && this->_Lease.IsHeld())
+	{
+		this->_SessionId = ORPHANED_SESSION_ID;
+		this->_OwnerProcessId = 0;
+
+		//
+		// Only the lease key may bring an orphaned target back
+		// 
+		InterlockedExchange(&this->_TransferTicket, 0);
+
+		orphaned = this->_Lease.Orphan(static_cast<LONGLONG>(KeQueryInterruptTime()));
+	}
+
+	KeReleaseSpinLock(&this->_OwnerLock, irql);
+
+	return orphaned;
+}
+
+bool ViGEm::Bus::Core::EmulationTargetPDO::ReclaimLease(LONG SessionId, ULONG LeaseKey)
+{
+	const auto processId = current_process_id();
+	KIRQL irql;
+
+	KeAcquireSpinLock(&this->_OwnerLock, &irql);
+
+	const auto reclaimed = this->_Lease.Reclaim(LeaseKey);
+
+	if (reclaimed)
+	{
+		this->_SessionId = SessionId;
+		this->_OwnerProcessId = processId;
+	}
+
+	KeReleaseSpinLock(&this->_OwnerLock, irql);
+
+	if (reclaimed)
+		this->ForgetOutput();
+
+	return reclaimed;
+}
+
+bool ViGEm::Bus::Core::EmulationTargetPDO::ExpireLease()
+{
+	return this->_Lease.Expire(static_cast<LONGLONG>(KeQueryInterruptTime()));
+}
+
+bool ViGEm::Bus::Core::EmulationTargetPDO::IsLeaseOrphaned() const
+{
+	return this->_Lease.IsOrphaned();
+}
+
+NTSTATUS ViGEm::Bus::Core::EmulationTargetPDO::IssueTransferTicket(PULONG Ticket)
+{
+	ULONG ticket;
+
+	const auto status = draw_secret_key(&ticket);
+
+	if (!NT_SUCCESS(status))
+		return status;
+
+	//
+	// A new ticket invalidates the previous one
+	// 
+	InterlockedExchange(&this->_TransferTicket, static_cast<LONG>(ticket));
+
+	*Ticket = ticket;
+
+	return STATUS_SUCCESS;
+}
+
+bool ViGEm::Bus::Core::EmulationTargetPDO::ClaimTransfer(LONG SessionId, ULONG Ticket)
+{
+	const auto processId = current_process_id();
+	WDFREQUEST request;
+	KIRQL irql;
+
+	if (Ticket == 0)
+		return false;
+
+	//
+	// Same lock as the lease paths, OrphanLease voids the ticket under it
+	// 
+	KeAcquireSpinLock(&this->_OwnerLock, &irql);
+
+	//
+	// Tickets are single use, first claim wins
+	// 
+	const auto issued = this->_TransferTicket;
+
+	const auto claimed = secret_key_equals(static_cast<ULONG>(issued), Ticket)
+		&& InterlockedCompareExchange(&this->_TransferTicket, 0, issued) == issued;
+
+	if (claimed)
+	{
+		this->_SessionId = SessionId;
+		this->_OwnerProcessId = processId;
+
+		//
+		// The previous owner's lease key must not bring the target back to it
+		// 
+		this->_Lease.Revoke();
+
+		//
+		// Nor may its fusion key or the writers it let in keep feeding the target
+		// 
+		InterlockedExchange(&this->_FusionKey, 0);
+
+		KeAcquireSpinLockAtDpcLevel(&this->_ReportLock);
+
+		for (ULONG writer = OWNER_WRITER + 1; writer < InputFusion::MAX_WRITERS; writer++)
+			this->_FusionWriters[writer] = nullptr;
+
+		this->_FusionWriterMask = 0;
+		this->_FusionReportedMask = 0;
+
+		KeReleaseSpinLockFromDpcLevel(&this->_ReportLock);
+	}
+
+	KeReleaseSpinLock(&this->_OwnerLock, irql);
+
+	if (!claimed)
+		return false;
+
+	//
+	// A report staged by the previous owner must not be committed on its behalf
+	// 
+	if (this->_PdoDevice)
+	{
+		const auto pFdoData = FdoGetData(WdfPdoGetParent(this->_PdoDevice));
+
+		KeAcquireSpinLock(&pFdoData->FrameLock, &irql);
+
+		RemoveEntryList(&this->_StagedLink);
+		InitializeListHead(&this->_StagedLink);
+		this->_Staged.Discard();
+
+		KeReleaseSpinLock(&pFdoData->FrameLock, irql);
+	}
+
+	//
+	// Notification requests of the previous owner end, buffered output reports
+	// stay queued for the new owner
+	// 
+	while (NT_SUCCESS(WdfIoQueueRetrieveNextRequest(this->_PendingNotificationRequests, &request)))
+	{
+		WdfRequestComplete(request, STATUS_CANCELLED);
+	}
+
+	//
+	// Nor may a resend be dropped because the previous owner got it
+	// 
+	this->ForgetOutput();
+
+	return true;
+}
+
+NTSTATUS ViGEm::Bus::Core::EmulationTargetPDO::EnableInputFusion(VIGEM_FUSION_POLICY Policy, UCHAR OwnerPriority, PULONG WriterKey)
+{
+	ULONG key;
+	KIRQL irql;
+
+	if (Policy < 0 || Policy >= VigemFusionPolicyMax)
+		return STATUS_INVALID_PARAMETER;
+
+	if (!this->_PdoDevice)
+		return STATUS_INVALID_DEVICE_STATE;
+
+	const auto status = draw_secret_key(&key);
+
+	if (!NT_SUCCESS(status))
+		return status;
+
+	KeAcquireSpinLock(&this->_ReportLock, &irql);
+
+	this->_FusionPolicy = Policy;
+	this->_FusionPriorities[OWNER_WRITER] = OwnerPriority;
+
+	KeReleaseSpinLock(&this->_ReportLock, irql);
+
+	//
+	// Calling again hands out a new key, attached writers stay
+	// 
+	InterlockedExchange(&this->_FusionKey, static_cast<LONG>(key));
+
+	*WriterKey = key;
+
+	return STATUS_SUCCESS;
+}
+
+NTSTATUS ViGEm::Bus::Core::EmulationTargetPDO::AttachWriter(ULONG WriterKey, WDFFILEOBJECT FileObject, UCHAR Priority, PULONG Writer)
+{
+	NTSTATUS status = STATUS_INSUFFICIENT_RESOURCES;
+	KIRQL irql;
+
+	if (!secret_key_equals(static_cast<ULONG>(this->_FusionKey), WriterKey))
+		return STATUS_ACCESS_DENIED;
+
+	KeAcquireSpinLock(&this->_ReportLock, &irql);
+
+	for (ULONG writer = OWNER_WRITER + 1; writer < InputFusion::MAX_WRITERS; writer++)
+	{
+		if (this->_FusionWriters[writer] != nullptr)
+			continue;
+
+		this->_FusionWriters[writer] = FileObject;
+		this->_FusionPriorities[writer] = Priority;
+
+		//
+		// Neutral until the writer submits something (DS4 legacy reports only cover a part)
+		// 
+		RtlZeroMemory(&this->_FusionReports[writer], sizeof(TARGET_REPORT));
+
+		if (this->_TargetType == DualShock4Wired)
+			DS4_REPORT_INIT(reinterpret_cast<PDS4_REPORT>(&this->_FusionReports[writer].Ds4.Report));
+
+		this->_FusionReportedMask &= ~(1UL << writer);
+		this->_FusionWriterMask |= (1UL << writer);
+
+		*Writer = writer;
+		status = STATUS_SUCCESS;
+		break;
+	}
+
+	KeReleaseSpinLock(&this->_ReportLock, irql);
+
+	return status;
+}
+
+void ViGEm::Bus::Core::EmulationTargetPDO::DetachWriter(ULONG Writer)
+{
+	KIRQL irql;
+
+	if (Writer == OWNER_WRITER || Writer >= InputFusion::MAX_WRITERS)
+		return;
+
+	KeAcquireSpinLock(&this->_ReportLock, &irql);
+
+	//
+	// Its last report stays in the cache until the next submission re-fuses
+	// 
+	this->_FusionWriters[Writer] = nullptr;
+	this->_FusionWriterMask &= ~(1UL << Writer);
+	this->_FusionReportedMask &= ~(1UL << Writer);
+
+	KeReleaseSpinLock(&this->_ReportLock, irql);
+}
+
+void ViGEm::Bus::Core::EmulationTargetPDO::DetachWriters(WDFFILEOBJECT FileObject)
+{
+	for (ULONG writer = OWNER_WRITER + 1; writer < InputFusion::MAX_WRITERS; writer++)
+	{
+		if (this->_FusionWriters[writer] == FileObject)
+			this->DetachWriter(writer);
+	}
+}
+
+bool ViGEm::Bus::Core::EmulationTargetPDO::FuseReportLocked(ULONG Writer, const VOID* Report, SIZE_T Length, PTARGET_REPORT Fused)
+{
+	const XUSB_REPORT* xusbReports[InputFusion::MAX_WRITERS];
+	const DS4_REPORT_EX* ds4Reports[InputFusion::MAX_WRITERS];
+
+	//
+	// Single writer, report goes through untouched
+	// 
+	if (this->_FusionWriterMask == 0 || Writer >= InputFusion::MAX_WRITERS || Length == 0)
+		return false;
+
+	RtlCopyMemory(&this->_FusionReports[Writer], Report, min(Length, sizeof(TARGET_REPORT)));
+	this->_FusionReportedMask |= (1UL << Writer);
+
+	const ULONG active = this->_FusionReportedMask & (this->_FusionWriterMask | (1UL << OWNER_WRITER));
+
+	for (ULONG writer = 0; writer < InputFusion::MAX_WRITERS; writer++)
+	{
+		const bool isActive = (active & (1UL << writer)) != 0;
+
+		xusbReports[writer] = isActive ? &this->_FusionReports[writer].Xusb : nullptr;
+		ds4Reports[writer] = isActive ? &this->_FusionReports[writer].Ds4 : nullptr;
+	}
+
+	switch (this->_TargetType)
+	{
+	case Xbox360Wired:
+		InputFusion::FuseXusb(xusbReports, this->_FusionPriorities, this->_FusionPolicy, &Fused->Xusb);
+		return true;
+	case DualShock4Wired:
+		InputFusion::FuseDs4(ds4Reports, this->_FusionPriorities, this->_FusionPolicy, &Fused->Ds4);
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool ViGEm::Bus::Core::EmulationTargetPDO::AdmitsSubscriber(LONG SessionId, ULONG AccessKey)
+{
+	KIRQL irql;
+
+	//
+	// The owner or whoever it handed its lease key or a transfer ticket to
+	// 
+	KeAcquireSpinLock(&this->_OwnerLock, &irql);
+
+	const auto admitted = this->_SessionId == SessionId
+		|| (this->_Lease.IsHeld() && secret_key_equals(this->_Lease.Key(), AccessKey))
+		|| secret_key_equals(static_cast<ULONG>(this->_TransferTicket), AccessKey);
+
+	KeReleaseSpinLock(&this->_OwnerLock, irql);
+
+	return admitted;
+}
+
+NTSTATUS ViGEm::Bus::Core::EmulationTargetPDO::Subscribe(WDFFILEOBJECT FileObject, PULONG Subscriber)
+{
+	NTSTATUS status;
+	WDF_IO_QUEUE_CONFIG queueConfig;
+	WDFQUEUE queue;
+	KIRQL irql;
+	bool subscribed;
+
+	PAGED_CODE();
+
+	if (!this->_ParentDevice)
+		return STATUS_INVALID_DEVICE_STATE;
+
+	//
+	// Only targets somebody subscribes to pay for the packet storage
+	// 
+	if (!ReadPointerAcquire(reinterpret_cast<PVOID const volatile*>(&this->_Fanout)))
+	{
+		const auto fanout = new NotificationFanoutQueue();
+
+		if (!fanout)
+			return STATUS_INSUFFICIENT_RESOURCES;
+
+		if (InterlockedCompareExchangePointer(
+			reinterpret_cast<PVOID volatile*>(&this->_Fanout),
+			fanout,
+			nullptr
+		) != nullptr)
+		{
+			delete fanout;
+		}
+	}
+
+	//
+	// Requests arrive on the FDO so their queue has to live there too
+	// 
+	WDF_IO_QUEUE_CONFIG_INIT(&queueConfig, WdfIoQueueDispatchManual);
+
+	status = WdfIoQueueCreate(
+		this->_ParentDevice,
+		&queueConfig,
+		WDF_NO_OBJECT_ATTRIBUTES,
+		&queue
+	);
+	if (!NT_SUCCESS(status))
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSPDO,
+			"WdfIoQueueCreate (SubscriberRequests) failed with status %!STATUS!",
+			status);
+		return status;
+	}
+
+	KeAcquireSpinLock(&this->_FanoutLock, &irql);
+
+	subscribed = this->_Fanout->Subscribe(Subscriber);
+
+	if (subscribed)
+	{
+		this->_SubscriberOwners[*Subscriber] = FileObject;
+		this->_SubscriberRequests[*Subscriber] = queue;
+	}
+
+	KeReleaseSpinLock(&this->_FanoutLock, irql);
+
+	if (!subscribed)
+	{
+		WdfObjectDelete(queue);
+		return STATUS_INSUFFICIENT_RESOURCES;
+	}
+
+	//
+	// Current rumble and LED values reach the new subscriber with the next resend
+	// 
+	this->ForgetOutput();
+
+	return STATUS_SUCCESS;
+}
+
+void ViGEm::Bus::Core::EmulationTargetPDO::Unsubscribe(ULONG Subscriber)
+{
+	WDFQUEUE queue;
+	KIRQL irql;
+
+	PAGED_CODE();
+
+	if (!this->_Fanout || Subscriber >= NotificationFanoutQueue::MAX_SUBSCRIBERS)
+		return;
+
+	KeAcquireSpinLock(&this->_FanoutLock, &irql);
+
+	//
+	// Unread packets lose their reference to this subscriber
+	// 
+	this->_Fanout->Unsubscribe(Subscriber);
+
+	queue = this->_SubscriberRequests[Subscriber];
+	this->_SubscriberRequests[Subscriber] = nullptr;
+	this->_SubscriberOwners[Subscriber] = nullptr;
+
+	KeReleaseSpinLock(&this->_FanoutLock, irql);
+
+	if (queue)
+	{
+		WdfIoQueuePurgeSynchronously(queue);
+		WdfObjectDelete(queue);
+	}
+}
+
+void ViGEm::Bus::Core::EmulationTargetPDO::UnsubscribeAll(WDFFILEOBJECT FileObject)
+{
+	PAGED_CODE();
+
+	for (ULONG subscriber = 0; subscriber < NotificationFanoutQueue::MAX_SUBSCRIBERS; subscriber++)
+	{
+		if (this->_SubscriberOwners[subscriber] == FileObject)
+			this->Unsubscribe(subscriber);
+	}
+}
+
+NTSTATUS ViGEm::Bus::Core::EmulationTargetPDO::EnqueueSubscriberNotification(ULONG Subscriber, WDFREQUEST Request)
+{
+	NTSTATUS status;
+	KIRQL irql;
+
+	if (!ReadPointerAcquire(reinterpret_cast<PVOID const volatile*>(&this->_Fanout))
+		|| Subscriber >= NotificationFanoutQueue::MAX_SUBSCRIBERS)
+		return STATUS_INVALID_DEVICE_STATE;
+
+	//
+	// Unsubscribe clears the queue handle under the same lock before deleting it,
+	// so a request forwarded here is purged with the queue instead of racing it
+	// 
+	KeAcquireSpinLock(&this->_FanoutLock, &irql);
+
+	const auto queue = this->_SubscriberRequests[Subscriber];
+
+	status = queue ? WdfRequestForwardToIoQueue(Request, queue) : STATUS_INVALID_DEVICE_STATE;
+
+	KeReleaseSpinLock(&this->_FanoutLock, irql);
+
+	if (!NT_SUCCESS(status))
+		return status;
+
+	//
+	// Packets may already be waiting
+	// 
+	this->CompleteSubscriberRequests(Subscriber);
+
+	return STATUS_PENDING;
+}
+
+bool ViGEm::Bus::Core::EmulationTargetPDO::PublishNotification(const VOID* Notification, ULONG Length)
+{
+	KIRQL irql;
+	ULONG subscribers;
+
+	const auto fanout = static_cast<NotificationFanoutQueue*>(ReadPointerAcquire(
+		reinterpret_cast<PVOID const volatile*>(&this->_Fanout)
+	));
+
+	if (!fanout)
+		return false;
+
+	KeAcquireSpinLock(&this->_FanoutLock, &irql);
+
+	//
+	// Stored once, every subscriber references the same packet
+	// 
+	subscribers = (fanout->Publish(Notification, Length) > 0) ? fanout->Subscribers() : 0;
+
+	KeReleaseSpinLock(&this->_FanoutLock, irql);
+
+	const auto delivered = subscribers != 0;
+
+	for (ULONG subscriber = 0; subscribers; subscriber++, subscribers >>= 1)
+	{
+		if (subscribers & 1)
+			this->CompleteSubscriberRequests(subscriber);
+	}
+
+	return delivered;
+}
+
+VOID ViGEm::Bus::Core::EmulationTargetPDO::CompleteSubscriberRequests(ULONG Subscriber)
+{
+	WDFREQUEST request;
+	PVIGEM_AWAIT_NOTIFICATION pAwaitNotification;
+	NTSTATUS status;
+	KIRQL irql;
+
+	static_assert(sizeof(pAwaitNotification->Data) >= MAX_FANOUT_PACKET_SIZE, "VIGEM_AWAIT_NOTIFICATION::Data too small");
+
+	for (;;)
+	{
+		KeAcquireSpinLock(&this->_FanoutLock, &irql);
+
+		const auto packet = this->_Fanout->Peek(Subscriber);
+		const auto queue = this->_SubscriberRequests[Subscriber];
+
+		if (!packet || !queue || !NT_SUCCESS(WdfIoQueueRetrieveNextRequest(queue, &request)))
+		{
+			KeReleaseSpinLock(&this->_FanoutLock, irql);
+			break;
+		}
+
+		status = WdfRequestRetrieveOutputBuffer(
+			request,
+			sizeof(VIGEM_AWAIT_NOTIFICATION),
+			reinterpret_cast<PVOID*>(&pAwaitNotification),
+			nullptr
+		);
+
+		if (NT_SUCCESS(status))
 		{
-			TraceEvents(TRACE_LEVEL_ERROR,
-				TRACE_BUSPDO,
-				"WdfIoQueueReadyNotify (PendingNotificationRequests) failed with status %!STATUS!",
-				status);
-			break;
+			pAwaitNotification->Dropped = this->_Fanout->TakeDropped(Subscriber);
+			pAwaitNotification->Length = packet->Length;
+
+			RtlCopyMemory(pAwaitNotification->Data, packet->Data, packet->Length);
 		}
 
-#pragma endregion
+		this->_Fanout->Release(Subscriber);
 
-#pragma region Default I/O queue setup
+		KeReleaseSpinLock(&this->_FanoutLock, irql);
 
-		WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
-		attributes.ParentObject = this->_PdoDevice;
+		WdfRequestCompleteWithInformation(request, status, NT_SUCCESS(status) ? sizeof(VIGEM_AWAIT_NOTIFICATION) : 0);
+	}
+}
 
-		WDF_IO_QUEUE_CONFIG_INIT_DEFAULT_QUEUE(&defaultPdoQueueConfig, WdfIoQueueDispatchParallel);
+VOID ViGEm::Bus::Core::EmulationTargetPDO::PublishOutputState()
+{
+	VIGEM_OUTPUT_STATE state;
 
-		defaultPdoQueueConfig.EvtIoInternalDeviceControl = EvtIoInternalDeviceControl;
+	RtlZeroMemory(&state, sizeof(VIGEM_OUTPUT_STATE));
 
-		status = WdfIoQueueCreate(
-			this->_PdoDevice,
-			&defaultPdoQueueConfig,
-			WDF_NO_OBJECT_ATTRIBUTES,
-			&defaultPdoQueue
-		);
-		if (!NT_SUCCESS(status))
+	state.SerialNo = this->_SerialNo;
+	state.TargetType = this->_TargetType;
+
+	this->GetOutputState(&state);
+
+	this->WriteOutputState(&state);
+}
+
+VOID ViGEm::Bus::Core::EmulationTargetPDO::WriteOutputState(PVIGEM_OUTPUT_STATE State)
+{
+	static const VIGEM_OUTPUT_STATE unused = {};
+	KIRQL irql;
+
+	if (!this->_ParentDevice)
+		return;
+
+	const auto pFdoData = FdoGetData(this->_ParentDevice);
+
+	KeAcquireSpinLock(&pFdoData->OutputStateLock, &irql);
+
+	for (auto entry = pFdoData->OutputStateSessions.Flink;
+	     entry != &pFdoData->OutputStateSessions;
+	     entry = entry->Flink)
+	{
+		const auto pFileData = CONTAINING_RECORD(entry, FDO_FILE_DATA, OutputStateLink);
+		const auto owned = State && pFileData->SessionId == this->_SessionId;
+		ULONG slot = VIGEM_OUTPUT_STATE_MAX_TARGETS;
+
+		//
+		// Keep the existing entry, claim a free one only in the owner's page
+		// 
+		for (ULONG index = 0; index < VIGEM_OUTPUT_STATE_MAX_TARGETS; index++)
 		{
-			TraceEvents(TRACE_LEVEL_ERROR,
-				TRACE_BUSPDO,
-				"WdfIoQueueCreate (Default) failed with status %!STATUS!",
-				status);
-			break;
-		}
+			if (pFileData->OutputStateSerials[index] == this->_SerialNo)
+			{
+				slot = index;
+				break;
+			}
 
-#pragma endregion
+			if (owned && slot == VIGEM_OUTPUT_STATE_MAX_TARGETS && pFileData->OutputStateSerials[index] == 0)
+				slot = index;
+		}
 
-#pragma region PNP capabilities
+		if (slot == VIGEM_OUTPUT_STATE_MAX_TARGETS)
+			continue;
 
 		//
-		// Other capabilities initialized in derived class
+		// Pages of former owners lose the entry (transfers, unplug)
 		// 
+		pFileData->OutputStateSerials[slot] = owned ? this->_SerialNo : 0;
 
-		this->_PnpCapabilities.Address = this->_SerialNo;
-		this->_PnpCapabilities.UINumber = this->_SerialNo;
+		VIGEM_OUTPUT_STATE_WRITE(
+			&pFileData->OutputState->Targets[slot],
+			&pFileData->OutputStateSequences[slot],
+			owned ? State : &unused
+		);
+	}
 
-		WdfDeviceSetPnpCapabilities(this->_PdoDevice, &this->_PnpCapabilities);
+	KeReleaseSpinLock(&pFdoData->OutputStateLock, irql);
+}
 
-#pragma endregion
+void ViGEm::Bus::Core::EmulationTargetPDO::SetFastBoot(bool Enabled)
+{
+	this->_FastBoot = Enabled;
+}
 
-#pragma region Power capabilities
+void ViGEm::Bus::Core::EmulationTargetPDO::SetKeepDuplicateOutput(bool Enabled)
+{
+	this->_KeepDuplicateOutput = Enabled;
+}
 
-		//
-		// Capabilities initialized in derived class
-		// 
+void ViGEm::Bus::Core::EmulationTargetPDO::SetDriverCounters(bool Enabled)
+{
+	this->_DriverCounters = Enabled;
+}
 
-		WdfDeviceSetPowerCapabilities(this->_PdoDevice, &this->_PowerCapabilities);
+bool ViGEm::Bus::Core::EmulationTargetPDO::IsDuplicateOutput(const VOID* Buffer, ULONG Length)
+{
+	KIRQL irql;
 
-#pragma endregion
-	} while (FALSE);
+	InterlockedIncrement(&this->_ReceivedOutputs);
 
-	TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_BUSPDO, "%!FUNC! Exit with status %!STATUS!", status);
+	if (this->_KeepDuplicateOutput)
+		return false;
 
-	return status;
+	KeAcquireSpinLock(&this->_OutputQueueLock, &irql);
+
+	const auto duplicate = this->_LastOutput.IsDuplicate(Buffer, Length);
+
+	KeReleaseSpinLock(&this->_OutputQueueLock, irql);
+
+	if (duplicate)
+		InterlockedIncrement(&this->_SuppressedOutputs);
+
+	return duplicate;
 }
 
-VOID ViGEm::Bus::Core::EmulationTargetPDO::EvtDeviceContextCleanup(
-	IN WDFOBJECT Device
-)
+VOID ViGEm::Bus::Core::EmulationTargetPDO::RememberOutput(const VOID* Buffer, ULONG Length)
 {
-	TraceEvents(TRACE_LEVEL_VERBOSE, TRACE_BUSPDO, "%!FUNC! Entry");
+	KIRQL irql;
 
-	const auto ctx = EmulationTargetPdoGetContext(Device);
+	if (this->_KeepDuplicateOutput)
+		return;
+
+	KeAcquireSpinLock(&this->_OutputQueueLock, &irql);
+
+	this->_LastOutput.Remember(Buffer, Length);
+
+	KeReleaseSpinLock(&this->_OutputQueueLock, irql);
+}
+
+VOID ViGEm::Bus::Core::EmulationTargetPDO::ForgetOutput()
+{
+	KIRQL irql;
+
+	KeAcquireSpinLock(&this->_OutputQueueLock, &irql);
+
+	this->_LastOutput.Forget();
+
+	KeReleaseSpinLock(&this->_OutputQueueLock, irql);
+}
+
+VOID ViGEm::Bus::Core::EmulationTargetPDO::MarkBootPhase(VIGEM_BOOT_PHASE Phase)
+{
+	LARGE_INTEGER frequency;
 
 	//
-	// This queues parent is the FDO so explicitly free memory
+	// Called on every report for VigemBootPhaseFirstReport, skip the counter query
+	// 
+	if (this->_BootTimeline.Reached(Phase))
+		return;
+
+	const auto now = KeQueryPerformanceCounter(&frequency).QuadPart;
+
+	this->_BootTimeline.Mark(Phase, now, frequency.QuadPart);
+}
+
+bool ViGEm::Bus::Core::EmulationTargetPDO::IsBooted() const
+{
+	return this->_Booted;
+}
+
+bool ViGEm::Bus::Core::EmulationTargetPDO::IsStandby() const
+{
+	return this->_SessionId == STANDBY_SESSION_ID;
+}
+
+bool ViGEm::Bus::Core::EmulationTargetPDO::ClaimStandby(LONG SessionId, USHORT VendorId, USHORT ProductId)
+{
+	if (!this->_Booted)
+		return false;
+
 	//
-	WdfIoQueuePurgeSynchronously(ctx->Target->_WaitDeviceReadyRequests);
-	WdfObjectDelete(ctx->Target->_WaitDeviceReadyRequests);
+	// Zero IDs request the type defaults, same as on plug-in
+	// 
+	if (VendorId != 0 && ProductId != 0
+		&& (this->_VendorId != VendorId || this->_ProductId != ProductId))
+		return false;
+
+	const auto processId = current_process_id();
+	KIRQL irql;
+
+	KeAcquireSpinLock(&this->_OwnerLock, &irql);
 
 	//
-	// Wait for thread to finish, if active
+	// Concurrent claims race here, first one wins
 	// 
-	if (ctx->Target->_WaitDeviceReadyCompletionWorkerThreadHandle)
-	{
-		NTSTATUS status = KeWaitForSingleObject(
-			&ctx->Target->_WaitDeviceReadyCompletionWorkerThreadHandle,
-			Executive,
-			KernelMode,
-			FALSE,
-			nullptr
-		);
+	const auto claimed = this->_SessionId == STANDBY_SESSION_ID;
 
-		if (NT_SUCCESS(status))
-		{
-			ZwClose(ctx->Target->_WaitDeviceReadyCompletionWorkerThreadHandle);
-			ctx->Target->_WaitDeviceReadyCompletionWorkerThreadHandle = nullptr;
-		}
-		else
-		{
-			TraceEvents(TRACE_LEVEL_WARNING,
-				TRACE_BUSPDO,
-				"KeWaitForSingleObject failed with status %!STATUS!",
-				status
-			);
-		}
+	if (claimed)
+	{
+		this->_SessionId = SessionId;
+		this->_OwnerProcessId = processId;
 	}
-	
+
+	KeReleaseSpinLock(&this->_OwnerLock, irql);
+
 	//
-	// PDO device object getting disposed, free context object 
+	// The new owner never got what the host sent while the target stood by
 	// 
-	delete ctx->Target;
+	if (claimed)
+		this->ForgetOutput();
 
-	TraceEvents(TRACE_LEVEL_VERBOSE, TRACE_BUSPDO, "%!FUNC! Exit");
+	return claimed;
 }
 
-NTSTATUS ViGEm::Bus::Core::EmulationTargetPDO::SubmitReport(PVOID NewReport)
+VOID ViGEm::Bus::Core::EmulationTargetPDO::NotifyBooted()
 {
-	return (this->IsOwnerProcess())
-		? this->SubmitReportImpl(NewReport)
-		: STATUS_ACCESS_DENIED;
-}
+	this->_Booted = true;
 
-NTSTATUS ViGEm::Bus::Core::EmulationTargetPDO::EnqueueNotification(WDFREQUEST Request) const
-{
-	return (this->IsOwnerProcess())
-		? WdfRequestForwardToIoQueue(Request, this->_PendingNotificationRequests)
-		: STATUS_ACCESS_DENIED;
+	this->MarkBootPhase(VigemBootPhaseReady);
+
+	//
+	// Notify client library that PDO is ready
+	// 
+	KeSetEvent(&this->_PdoBootNotificationEvent, 0, FALSE);
 }
 
-bool ViGEm::Bus::Core::EmulationTargetPDO::IsOwnerProcess() const
+DMFMODULE ViGEm::Bus::Core::EmulationTargetPDO::OutputBufferQueue() const
 {
-	return this->_OwnerProcessId == current_process_id();
+	return static_cast<DMFMODULE>(ReadPointerAcquire(
+		reinterpret_cast<PVOID const volatile*>(&this->_UsbInterruptOutBufferQueue)
+	));
 }
 
-VIGEM_TARGET_TYPE ViGEm::Bus::Core::EmulationTargetPDO::GetType() const
+bool ViGEm::Bus::Core::EmulationTargetPDO::QueueOutput(const VOID* Buffer, size_t Length)
 {
-	return this->_TargetType;
+	KIRQL irql;
+	PVOID clientBuffer, contextBuffer;
+	bool queued = false;
+
+	if (Length > MAX_OUT_BUFFER_QUEUE_SIZE)
+		return false;
+
+	KeAcquireSpinLock(&this->_OutputQueueLock, &irql);
+
+	const auto outQueue = this->OutputBufferQueue();
+
+	if (outQueue == nullptr)
+	{
+		//
+		// Nobody asked for notifications yet, keep it for the first request
+		// 
+		queued = this->_EarlyOutput.Store(Buffer, static_cast<ULONG>(Length));
+
+		if (!queued)
+		{
+			TraceEvents(TRACE_LEVEL_WARNING,
+			            TRACE_BUSPDO,
+			            "Output packet of %Iu bytes too large to hold back",
+			            Length);
+		}
+	}
+	else if (NT_SUCCESS(DMF_BufferQueue_Fetch(
+		outQueue,
+		&clientBuffer,
+		&contextBuffer
+	)))
+	{
+		RtlCopyMemory(clientBuffer, Buffer, Length);
+
+		*static_cast<size_t*>(contextBuffer) = Length;
+
+		TraceDbg(TRACE_BUSPDO, "Queued %Iu bytes", Length);
+
+		DMF_BufferQueue_Enqueue(outQueue, clientBuffer);
+
+		queued = true;
+	}
+
+	KeReleaseSpinLock(&this->_OutputQueueLock, irql);
+
+	return queued;
 }
 
 NTSTATUS ViGEm::Bus::Core::EmulationTargetPDO::EnqueueWaitDeviceReady(WDFREQUEST Request)
@@ -479,9 +2132,12 @@ NTSTATUS ViGEm::Bus::Core::EmulationTargetPDO::PdoPrepare(WDFDEVICE ParentDevice
 	NTSTATUS status;
 	WDF_OBJECT_ATTRIBUTES attributes;
 	WDF_IO_QUEUE_CONFIG plugInQueueConfig;
-	DMF_MODULE_ATTRIBUTES moduleAttributes;
-	DMF_CONFIG_BufferQueue dmfBufferCfg;
+	WDF_IO_QUEUE_CONFIG pollQueueConfig;
 	
+	this->_ParentDevice = ParentDevice;
+
+	this->MarkBootPhase(VigemBootPhasePlugIn);
+
 	WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
 	attributes.ParentObject = ParentDevice;
 
@@ -500,51 +2156,90 @@ NTSTATUS ViGEm::Bus::Core::EmulationTargetPDO::PdoPrepare(WDFDEVICE ParentDevice
 			TRACE_BUSPDO,
 			"WdfIoQueueCreate (PendingPlugInRequests) failed with status %!STATUS!",
 			status);
-	}
 
-	WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
-	attributes.ParentObject = ParentDevice;
+		this->_WaitDeviceReadyRequests = nullptr;
 
-	DMF_CONFIG_BufferQueue_AND_ATTRIBUTES_INIT(
-		&dmfBufferCfg,
-		&moduleAttributes
-	);
+		return status;
+	}
 
-	// Don't auto-grow; start dropping packets on overrun
-	dmfBufferCfg.SourceSettings.EnableLookAside = FALSE;
-	// Maximum number of buffers to be filled and kept queued
-	dmfBufferCfg.SourceSettings.BufferCount = MAX_OUT_BUFFER_QUEUE_COUNT;
-	// Maximum byte count per buffer
-	dmfBufferCfg.SourceSettings.BufferSize = MAX_OUT_BUFFER_QUEUE_SIZE;
-	// Field to store real buffer content length
-	dmfBufferCfg.SourceSettings.BufferContextSize = sizeof(size_t);
-	// "Expensive" memory ;)
-	dmfBufferCfg.SourceSettings.PoolType = NonPagedPoolNx;
+	// Create and assign queue for feeders waiting on host polls
+	WDF_IO_QUEUE_CONFIG_INIT(&pollQueueConfig, WdfIoQueueDispatchManual);
 
-	status = DMF_BufferQueue_Create(
+	status = WdfIoQueueCreate(
 		ParentDevice,
-		&moduleAttributes,
-		&attributes,
-		&this->_UsbInterruptOutBufferQueue
+		&pollQueueConfig,
+		WDF_NO_OBJECT_ATTRIBUTES,
+		&this->_PendingPollRequests
 	);
-
 	if (!NT_SUCCESS(status))
 	{
 		TraceEvents(TRACE_LEVEL_ERROR,
-		            TRACE_BUSPDO,
-		            "DMF_BufferQueue_Create failed with status %!STATUS!",
-		            status
-		);
+			TRACE_BUSPDO,
+			"WdfIoQueueCreate (PendingPollRequests) failed with status %!STATUS!",
+			status);
+
+		this->_PendingPollRequests = nullptr;
+
+		//
+		// Don't leave a half prepared target behind
+		// 
+		this->PdoUnprepare();
+
+		return status;
 	}
 
 	return status;
 }
 
+VOID ViGEm::Bus::Core::EmulationTargetPDO::PdoUnprepare()
+{
+	//
+	// These queues parent is the FDO so explicitly free memory
+	//
+	if (this->_WaitDeviceReadyRequests)
+	{
+		WdfIoQueuePurgeSynchronously(this->_WaitDeviceReadyRequests);
+		WdfObjectDelete(this->_WaitDeviceReadyRequests);
+		this->_WaitDeviceReadyRequests = nullptr;
+	}
+
+	if (this->_PendingPollRequests)
+	{
+		WdfIoQueuePurgeSynchronously(this->_PendingPollRequests);
+		WdfObjectDelete(this->_PendingPollRequests);
+		this->_PendingPollRequests = nullptr;
+	}
+}
+
 unsigned long ViGEm::Bus::Core::EmulationTargetPDO::current_process_id()
 {
 	return static_cast<DWORD>(reinterpret_cast<DWORD_PTR>(PsGetCurrentProcessId()) & 0xFFFFFFFF);
 }
 
+NTSTATUS ViGEm::Bus::Core::EmulationTargetPDO::draw_secret_key(PULONG Key)
+{
+	NTSTATUS status = STATUS_SUCCESS;
+
+	const auto generated = Core::generate_secret_key([&status](PUCHAR Buffer, ULONG Length)
+	{
+		status = BCryptGenRandom(nullptr, Buffer, Length, BCRYPT_USE_SYSTEM_PREFERRED_RNG);
+
+		return NT_SUCCESS(status);
+	}, Key);
+
+	if (!generated)
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+		            TRACE_BUSPDO,
+		            "BCryptGenRandom failed with status %!STATUS!",
+		            status);
+
+		return NT_SUCCESS(status) ? STATUS_UNSUCCESSFUL : status;
+	}
+
+	return STATUS_SUCCESS;
+}
+
 #pragma region USB Interface Functions
 
 BOOLEAN USB_BUSIFFN ViGEm::Bus::Core::EmulationTargetPDO::UsbInterfaceIsDeviceHighSpeed(IN PVOID BusContext)
@@ -764,7 +2459,12 @@ NTSTATUS ViGEm::Bus::Core::EmulationTargetPDO::UsbSelectConfiguration(PURB Urb)
 		return STATUS_SUCCESS;
 	}
 
-	return this->SelectConfiguration(Urb);
+	const auto status = this->SelectConfiguration(Urb);
+
+	if (NT_SUCCESS(status))
+		this->MarkBootPhase(VigemBootPhaseConfigurationSelected);
+
+	return status;
 }
 
 ViGEm::Bus::Core::EmulationTargetPDO::
@@ -778,6 +2478,19 @@ _ProductId(ProductId)
 
 	WDF_DEVICE_PNP_CAPABILITIES_INIT(&this->_PnpCapabilities);
 	WDF_DEVICE_POWER_CAPABILITIES_INIT(&this->_PowerCapabilities);
+
+	KeInitializeSpinLock(&this->_ScheduledReportsLock);
+	KeInitializeSpinLock(&this->_FanoutLock);
+	KeInitializeSpinLock(&this->_OwnerLock);
+	KeInitializeSpinLock(&this->_ReportLock);
+	KeInitializeSpinLock(&this->_OutputQueueLock);
+	InitializeListHead(&this->_StagedLink);
+}
+
+ViGEm::Bus::Core::EmulationTargetPDO::~EmulationTargetPDO()
+{
+	delete this->_ScheduledReports;
+	delete this->_Fanout;
 }
 
 bool ViGEm::Bus::Core::EmulationTargetPDO::GetPdoBySerial(
@@ -911,6 +2624,8 @@ NTSTATUS ViGEm::Bus::Core::EmulationTargetPDO::EvtDevicePrepareHardware(
 
 	const auto ctx = EmulationTargetPdoGetContext(Device);
 
+	ctx->Target->MarkBootPhase(VigemBootPhasePnpStart);
+
 	NTSTATUS status = ctx->Target->PdoPrepareHardware();
 
 	TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_BUSPDO, "%!FUNC! Exit with status %!STATUS!", status);
@@ -1179,7 +2894,9 @@ void ViGEm::Bus::Core::EmulationTargetPDO::EvtWdfIoPendingNotificationQueueState
 	//
 	// No buffer available to answer the request with, leave queued
 	// 
-	if (DMF_BufferQueue_Count(pThis->_UsbInterruptOutBufferQueue) == 0)
+	const auto outQueue = pThis->OutputBufferQueue();
+
+	if (outQueue == nullptr || DMF_BufferQueue_Count(outQueue) == 0)
 	{
 		return;
 	}
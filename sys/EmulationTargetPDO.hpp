@@ -47,6 +47,19 @@
 
 #include <ViGEm/Common.h>
 
+#include "BootTimeline.hpp"
+#include "EarlyOutputBuffer.hpp"
+#include "FrameCommit.hpp"
+#include "InputFusion.hpp"
+#include "LookasideAllocator.hpp"
+#include "NotificationFanout.hpp"
+#include "OutputDeduplicator.hpp"
+#include "PollIntervalEstimator.hpp"
+#include "ScheduledReportQueue.hpp"
+#include "SecretKey.hpp"
+#include "TargetLease.hpp"
+#include "UsbDescriptor.hpp"
+
 //
 // Some insane macro-magic =3
 // 
@@ -54,16 +67,111 @@
 #define COPY_BYTE_ARRAY(_dst_, _bytes_)   do {BYTE b[] = _bytes_; \
                                             RtlCopyMemory(_dst_, b, RTL_NUMBER_OF_V1(b)); } while (0)
 
+//
+// Defined in BusShared.h
+// 
+typedef struct _VIGEM_SUBMIT_SCHEDULED_REPORT* PVIGEM_SUBMIT_SCHEDULED_REPORT;
+typedef struct _VIGEM_STAGE_REPORT* PVIGEM_STAGE_REPORT;
+typedef struct _VIGEM_TARGET_STATISTICS* PVIGEM_TARGET_STATISTICS;
+typedef struct _VIGEM_OUTPUT_STATE* PVIGEM_OUTPUT_STATE;
+
 namespace ViGEm::Bus::Core
 {
 	typedef struct _PDO_IDENTIFICATION_DESCRIPTION* PPDO_IDENTIFICATION_DESCRIPTION;
 
+	//
+	// Input report of any supported target type
+	// 
+	typedef union _TARGET_REPORT
+	{
+		XUSB_REPORT Xusb;
+
+		DS4_REPORT_EX Ds4;
+	} TARGET_REPORT, * PTARGET_REPORT;
+
+	//
+	// Report held back until its due time has passed
+	// 
+	typedef struct _SCHEDULED_REPORT
+	{
+		//
+		// Performance counter value the report is due at
+		// 
+		LONGLONG DueTime;
+
+		//
+		// Submission order, breaks ties between equal due times
+		// 
+		ULONG Sequence;
+
+		//
+		// Delivery attempts that found no IN request pending
+		// 
+		UCHAR Retries;
+
+		TARGET_REPORT Report;
+
+		bool operator<(const _SCHEDULED_REPORT& other) const
+		{
+			return (this->DueTime != other.DueTime)
+				? (this->DueTime < other.DueTime)
+				: (static_cast<LONG>(this->Sequence - other.Sequence) < 0);
+		}
+	} SCHEDULED_REPORT, * PSCHEDULED_REPORT;
+
+	constexpr ULONG MAX_SCHEDULED_REPORTS = 64;
+
+	//
+	// Retries (1 ms apart) of a due report before it gets dropped, enough for 
+	// polling intervals of up to 32 ms
+	// 
+	constexpr UCHAR MAX_SCHEDULED_REPORT_RETRIES = 32;
+
+	constexpr auto SCHEDULED_REPORTS_POOL_TAG = 'RSiV';
+
+	//
+	// Per-target storage of scheduled reports, recycled across targets
+	// 
+	class ScheduledReportHeap :
+		public ScheduledReportQueue<SCHEDULED_REPORT, MAX_SCHEDULED_REPORTS, MAX_SCHEDULED_REPORT_RETRIES>,
+		public LookasideAllocated<ScheduledReportHeap, SCHEDULED_REPORTS_POOL_TAG>
+	{
+	};
+
+	//
+	// Output packets kept until the first notification request creates the queue
+	// 
+	constexpr ULONG MAX_EARLY_OUTPUT_PACKETS = 4;
+
+	//
+	// Large enough for every XUSB and DS4 output transfer that gets buffered
+	// 
+	constexpr ULONG MAX_EARLY_OUTPUT_SIZE = 32;
+
+	constexpr ULONG MAX_FANOUT_PACKETS = 32;
+
+	//
+	// Large enough for XUSB_REQUEST_NOTIFICATION and DS4_REQUEST_NOTIFICATION
+	// 
+	constexpr ULONG MAX_FANOUT_PACKET_SIZE = 32;
+
+	constexpr auto NOTIFICATION_FANOUT_POOL_TAG = 'FNiV';
+
+	//
+	// Per-target notification packets of subscribers, recycled across targets
+	// 
+	class NotificationFanoutQueue :
+		public NotificationFanout<MAX_FANOUT_PACKETS, MAX_FANOUT_PACKET_SIZE>,
+		public LookasideAllocated<NotificationFanoutQueue, NOTIFICATION_FANOUT_POOL_TAG>
+	{
+	};
+
 	class EmulationTargetPDO
 	{
 	public:
 		EmulationTargetPDO(ULONG Serial, LONG SessionId, USHORT VendorId, USHORT ProductId);
 
-		virtual ~EmulationTargetPDO() = default;
+		virtual ~EmulationTargetPDO();
 
 		static bool GetPdoByTypeAndSerial(
 			IN WDFDEVICE ParentDevice,
@@ -72,6 +180,12 @@ namespace ViGEm::Bus::Core
 			OUT EmulationTargetPDO** Object
 		);
 
+		static bool GetPdoBySerial(
+			IN WDFDEVICE ParentDevice,
+			IN ULONG SerialNo,
+			OUT EmulationTargetPDO** Object
+		);
+
 		static NTSTATUS EnqueueWaitDeviceReady(
 			WDFDEVICE ParentDevice,
 			ULONG SerialNo,
@@ -118,38 +232,303 @@ namespace ViGEm::Bus::Core
 
 		NTSTATUS SubmitReport(PVOID NewReport);
 
-		NTSTATUS EnqueueNotification(WDFREQUEST Request) const;
+		NTSTATUS SubmitReportValidated(PVOID NewReport, ULONG Writer);
+
+		NTSTATUS SubmitReportTranslated(VIGEM_TARGET_TYPE Format, PVOID NewReport, ULONG Writer);
+
+		NTSTATUS SubmitScheduledReport(PVIGEM_SUBMIT_SCHEDULED_REPORT Report);
+
+		NTSTATUS StageReport(PVIGEM_STAGE_REPORT Report, WDFFILEOBJECT Owner);
+
+		NTSTATUS EnqueueAwaitPoll(WDFREQUEST Request);
+
+		VOID GetStatistics(PVIGEM_TARGET_STATISTICS Statistics) const;
+
+		static NTSTATUS CommitStagedReports(
+			IN WDFDEVICE ParentDevice,
+			IN WDFFILEOBJECT Owner,
+			OUT PULONG TargetCount,
+			OUT PLONGLONG Epoch
+		);
+
+		static VOID DiscardStagedReports(
+			IN WDFDEVICE ParentDevice,
+			IN WDFFILEOBJECT Owner
+		);
+
+		NTSTATUS EnqueueNotification(WDFREQUEST Request);
 
 		bool IsOwnerProcess() const;
 
 		VIGEM_TARGET_TYPE GetType() const;
 
+		LONG GetSessionId() const;
+
+		ULONG GetToken() const;
+
+		void SetToken(ULONG Token);
+
+		//
+		// Keeps the object alive past PDO removal, false if there is no PDO
+		// 
+		bool Reference();
+
+		VOID Dereference();
+
+		void SetPollingInterval(UCHAR Interval);
+
+		void SetOutputBufferCount(ULONG Count);
+
+		void SetFastBoot(bool Enabled);
+
+		void SetKeepDuplicateOutput(bool Enabled);
+
+		void SetDriverCounters(bool Enabled);
+
+		bool IsBooted() const;
+
+		bool IsStandby() const;
+
+		bool ClaimStandby(LONG SessionId, USHORT VendorId, USHORT ProductId);
+
+		//
+		// Session ID of targets kept ready in the bus standby pool
+		// 
+		static const LONG STANDBY_SESSION_ID = 0;
+
+		NTSTATUS GrantLease(ULONG GracePeriodMs, PULONG LeaseKey);
+
+		bool OrphanLease(LONG SessionId);
+
+		bool ReclaimLease(LONG SessionId, ULONG LeaseKey);
+
+		bool ExpireLease();
+
+		bool IsLeaseOrphaned() const;
+
+		//
+		// Session ID of leased targets whose owner went away
+		// 
+		static const LONG ORPHANED_SESSION_ID = -1;
+
+		static const ULONG MAX_LEASE_GRACE_PERIOD_MS = 60000;
+
+		NTSTATUS IssueTransferTicket(PULONG Ticket);
+
+		bool ClaimTransfer(LONG SessionId, ULONG Ticket);
+
+		NTSTATUS EnableInputFusion(VIGEM_FUSION_POLICY Policy, UCHAR OwnerPriority, PULONG WriterKey);
+
+		NTSTATUS AttachWriter(ULONG WriterKey, WDFFILEOBJECT FileObject, UCHAR Priority, PULONG Writer);
+
+		void DetachWriter(ULONG Writer);
+
+		void DetachWriters(WDFFILEOBJECT FileObject);
+
+		bool AdmitsSubscriber(LONG SessionId, ULONG AccessKey);
+
+		NTSTATUS Subscribe(WDFFILEOBJECT FileObject, PULONG Subscriber);
+
+		void Unsubscribe(ULONG Subscriber);
+
+		void UnsubscribeAll(WDFFILEOBJECT FileObject);
+
+		NTSTATUS EnqueueSubscriberNotification(ULONG Subscriber, WDFREQUEST Request);
+
+		//
+		// Writes the current output values to the state page of the owning session
+		// 
+		VOID PublishOutputState();
+
+		//
+		// Input fusion writer slot of the owner
+		// 
+		static const ULONG OWNER_WRITER = 0;
+
 		NTSTATUS PdoPrepare(WDFDEVICE ParentDevice);
 
+		//
+		// Frees what PdoPrepare created, for targets that never got a PDO
+		// 
+		VOID PdoUnprepare();
+
 	private:
 		static unsigned long current_process_id();
 
+		//
+		// Non-zero key from the system preferred RNG for leases, tickets and fusion
+		// 
+		static NTSTATUS draw_secret_key(PULONG Key);
+
 		static EVT_WDF_DEVICE_CONTEXT_CLEANUP EvtDeviceContextCleanup;
 
-		static bool GetPdoBySerial(
-			IN WDFDEVICE ParentDevice,
-			IN ULONG SerialNo,
-			OUT EmulationTargetPDO** Object
-		);
+		static EVT_WDF_DEVICE_CONTEXT_DESTROY EvtDeviceContextDestroy;
+
+		static EVT_WDF_TIMER EvtScheduledReportsTimerFunc;
 
 		NTSTATUS EnqueueWaitDeviceReady(WDFREQUEST Request);
+
+		VOID DeliverScheduledReports();
+
+		NTSTATUS CreateOutputBufferQueue();
 		
 		HANDLE _WaitDeviceReadyCompletionWorkerThreadHandle{};
 
+		//
+		// Handle issued by the bus token table (0 if none)
+		// 
+		ULONG _Token{};
+
+		//
+		// Reports waiting for their due time (allocated on first use)
+		// 
+		ScheduledReportHeap* _ScheduledReports{};
+
+		//
+		// Protects _ScheduledReports
+		// 
+		KSPIN_LOCK _ScheduledReportsLock;
+
+		//
+		// Fires when the earliest scheduled report becomes due
+		// 
+		WDFTIMER _ScheduledReportsTimer{};
+
+		//
+		// Source of SCHEDULED_REPORT::Sequence
+		// 
+		LONG _ScheduledReportsSequence{};
+
+		//
+		// Number of outstanding delivery passes, only one runs at a time
+		// 
+		LONG _ScheduledReportsDeliveryRequests{};
+
+		//
+		// Link in FDO_DEVICE_DATA::StagedTargets (points to itself if not staged)
+		// 
+		LIST_ENTRY _StagedLink;
+
+		//
+		// Report waiting for the next frame commit of the file object which staged it
+		// (protected by FDO_DEVICE_DATA::FrameLock)
+		// 
+		FrameStage<TARGET_REPORT, WDFFILEOBJECT> _Staged;
+
+		//
+		// IN request prepared during commit, completed after the frame lock got dropped
+		// 
+		WDFREQUEST _CommittedInRequest{};
+
+		//
+		// Committed report didn't find an IN request, hand it to the next one
+		// 
+		bool _CommittedReportPending{};
+
+		//
+		// Requests waiting for the host to post an interrupt IN transfer
+		// 
+		WDFQUEUE _PendingPollRequests{};
+
+		//
+		// Arrival statistics of interrupt IN transfers
+		// 
+		PollIntervalEstimator _PollInterval;
+
+		VOID CompletePollRequests();
+
+		//
+		// FDO the PDO got plugged into
+		// 
+		WDFDEVICE _ParentDevice{};
+
+		//
+		// Depth of _UsbInterruptOutBufferQueue once it gets created
+		// 
+		ULONG _OutputBufferCount{ MAX_OUT_BUFFER_QUEUE_COUNT };
+
+		//
+		// Host finished the boot sequence (never reset, unlike _PdoBootNotificationEvent)
+		// 
+		volatile bool _Booted{};
+
+		//
+		// Keeps the target plugged in across owner restarts if granted
+		// 
+		TargetLease _Lease;
+
+		//
+		// Outstanding ownership transfer ticket, 0 if none
+		// 
+		volatile LONG _TransferTicket{};
+
+		//
+		// Latest report of every input fusion writer, slot 0 belongs to the owner
+		// 
+		TARGET_REPORT _FusionReports[InputFusion::MAX_WRITERS]{};
+
+		//
+		// File objects of the attached secondary writers
+		// 
+		WDFFILEOBJECT _FusionWriters[InputFusion::MAX_WRITERS]{};
+
+		UCHAR _FusionPriorities[InputFusion::MAX_WRITERS]{};
+
+		//
+		// Bit per writer slot attached besides the owner, 0 skips fusion entirely
+		// 
+		ULONG _FusionWriterMask{};
+
+		//
+		// Bit per writer slot holding a report
+		// 
+		ULONG _FusionReportedMask{};
+
+		VIGEM_FUSION_POLICY _FusionPolicy{};
+
+		VOID CompleteSubscriberRequests(ULONG Subscriber);
+
+		//
+		// Notifications of read-only subscribers (allocated on first subscription)
+		// 
+		NotificationFanoutQueue* _Fanout{};
+
+		//
+		// Protects _Fanout and the subscriber slots
+		// 
+		KSPIN_LOCK _FanoutLock;
+
+		//
+		// File objects subscribed to notifications
+		// 
+		WDFFILEOBJECT _SubscriberOwners[NotificationFanoutQueue::MAX_SUBSCRIBERS]{};
+
+		//
+		// Pending IOCTL_VIGEM_AWAIT_NOTIFICATION requests of every subscriber
+		// 
+		WDFQUEUE _SubscriberRequests[NotificationFanoutQueue::MAX_SUBSCRIBERS]{};
+
+		//
+		// Key secondary writers present to attach, 0 if fusion isn't enabled
+		// 
+		volatile LONG _FusionKey{};
+
 	protected:
 		static const ULONG _maxHardwareIdLength = 0xFF;
 
 		static const int MAX_INSTANCE_ID_LEN = 80;
 
 		static const size_t MAX_OUT_BUFFER_QUEUE_COUNT = 64;
+
+		static const size_t MAX_OUT_BUFFER_QUEUE_COUNT_LIMIT = 1024;
 		
 		static const size_t MAX_OUT_BUFFER_QUEUE_SIZE = 128;
 
+		//
+		// Longer output transfers are never considered duplicates
+		// 
+		static const ULONG MAX_DEDUP_OUTPUT_SIZE = 16;
+
 		static PCWSTR _deviceLocation;
 
 		static BOOLEAN USB_BUSIFFN UsbInterfaceIsDeviceHighSpeed(IN PVOID BusContext);
@@ -188,10 +567,74 @@ namespace ViGEm::Bus::Core
 
 		virtual void AbortPipe() = 0;
 
-		virtual NTSTATUS SubmitReportImpl(PVOID NewReport) = 0;
+		virtual NTSTATUS SubmitReportImpl(PVOID NewReport, ULONG Writer) = 0;
 
 		virtual VOID ProcessPendingNotification(WDFQUEUE Queue) = 0;
 
+		VOID InterruptInRequestQueued();
+
+		UCHAR EndpointInterval(UCHAR Default) const;
+
+		VOID NotifyBooted();
+
+		VOID MarkBootPhase(VIGEM_BOOT_PHASE Phase);
+
+		//
+		// Stores the report of Writer and fuses all writers into Fused, false
+		// if nobody else writes to this target (called with the report lock held)
+		// 
+		bool FuseReportLocked(ULONG Writer, const VOID* Report, SIZE_T Length, PTARGET_REPORT Fused);
+
+		//
+		// Hands a copy of the owner's notification to every subscriber, false if there was none
+		// 
+		bool PublishNotification(const VOID* Notification, ULONG Length);
+
+		//
+		// Counts the output transfer, true if it repeats the last delivered one and can be dropped
+		// 
+		bool IsDuplicateOutput(const VOID* Buffer, ULONG Length);
+
+		//
+		// Records an output transfer somebody received as the one to compare against
+		// 
+		VOID RememberOutput(const VOID* Buffer, ULONG Length);
+
+		//
+		// Lets the next output transfer through even if it repeats the last one
+		// 
+		VOID ForgetOutput();
+
+		//
+		// Fills in the type specific output values (rumble, LED, lightbar)
+		// 
+		virtual VOID GetOutputState(PVIGEM_OUTPUT_STATE State) = 0;
+
+		//
+		// Updates this target's entry in every mapped page, nullptr removes it
+		// 
+		VOID WriteOutputState(PVIGEM_OUTPUT_STATE State);
+
+		DMFMODULE OutputBufferQueue() const;
+
+		//
+		// Buffers an output packet for user-land, held back until the queue exists;
+		// false if it got dropped
+		// 
+		bool QueueOutput(const VOID* Buffer, size_t Length);
+
+		NTSTATUS CompleteInRequestFromCache();
+
+		//
+		// Stores a committed report in the cache (called with the report lock held)
+		// 
+		virtual VOID ApplyReport(const TARGET_REPORT* Report) = 0;
+
+		//
+		// Copies the cached report to an IN request (called with the report lock held)
+		// 
+		virtual VOID CopyCachedReport(WDFREQUEST Request) = 0;
+
 		//
 		// PNP Capabilities may differ from device to device
 		// 
@@ -217,6 +660,12 @@ namespace ViGEm::Bus::Core
 		// 
 		LONG _SessionId{};
 
+		//
+		// Protects ownership changes of _SessionId and _OwnerProcessId, the report
+		// lock nests inside
+		// 
+		KSPIN_LOCK _OwnerLock;
+
 		//
 		// Device type this PDO is emulating
 		// 
@@ -263,9 +712,68 @@ namespace ViGEm::Bus::Core
 		KEVENT _PdoBootNotificationEvent;
 
 		//
-		// Queue for interrupt out requests delivered to user-land
+		// Queue for interrupt out requests delivered to user-land (created 
+		// with the first notification request, read via OutputBufferQueue)
 		// 
 		DMFMODULE _UsbInterruptOutBufferQueue{};
+
+		//
+		// Serializes buffering output packets against creating the queue, protects _LastOutput
+		// 
+		KSPIN_LOCK _OutputQueueLock;
+
+		//
+		// Output packets sent before the queue existed (protected by the output queue lock)
+		// 
+		EarlyOutputBuffer<MAX_EARLY_OUTPUT_PACKETS, MAX_EARLY_OUTPUT_SIZE> _EarlyOutput;
+
+		//
+		// Size of the derived object (populated by derived class)
+		// 
+		ULONG _ObjectSize{};
+
+		//
+		// Guards the cached report and input fusion state; frame commits hold it for
+		// every target of the frame at once (nested in FDO_DEVICE_DATA::FrameLock)
+		// 
+		KSPIN_LOCK _ReportLock;
+
+		//
+		// If set, overrides bInterval of all interrupt endpoints
+		// 
+		UCHAR _PollingInterval{};
+
+		//
+		// If set, boot handshakes get compressed into as few transfers as possible
+		// 
+		bool _FastBoot{};
+
+		//
+		// If set, repeated identical output transfers are still delivered
+		// 
+		bool _KeepDuplicateOutput{};
+
+		//
+		// If set, the target fills running counters of reports at delivery time
+		// 
+		bool _DriverCounters{};
+
+		//
+		// Payload of the last delivered output transfer
+		// 
+		OutputDeduplicator<MAX_DEDUP_OUTPUT_SIZE> _LastOutput;
+
+		//
+		// Output transfers received from the host and dropped as duplicates
+		// 
+		LONG _ReceivedOutputs{};
+
+		LONG _SuppressedOutputs{};
+
+		//
+		// Time-to-first-input milestones
+		// 
+		BootTimeline _BootTimeline;
 	};
 
 	typedef struct _PDO_IDENTIFICATION_DESCRIPTION
@@ -0,0 +1,132 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+namespace ViGEm::Bus::Core
+{
+	//
+	// Fixed capacity binary min-heap; never allocates, caller provides locking
+	// 
+	template <typename T, ULONG Capacity>
+	class FixedMinHeap
+	{
+	public:
+		bool Push(const T& Item)
+		{
+			if (this->_Count >= Capacity)
+				return false;
+
+			ULONG index = this->_Count++;
+
+			//
+			// Sift up
+			// 
+			while (index > 0)
+			{
+				const ULONG parent = (index - 1) / 2;
+
+				if (!(Item < this->_Items[parent]))
+					break;
+
+				this->_Items[index] = this->_Items[parent];
+				index = parent;
+			}
+
+			this->_Items[index] = Item;
+
+			return true;
+		}
+
+		bool Pop(T* Item)
+		{
+			if (this->_Count == 0)
+				return false;
+
+			if (Item)
+				*Item = this->_Items[0];
+
+			if (--this->_Count == 0)
+				return true;
+
+			const T last = this->_Items[this->_Count];
+			ULONG index = 0;
+
+			//
+			// Sift down
+			// 
+			for (;;)
+			{
+				ULONG child = 2 * index + 1;
+
+				if (child >= this->_Count)
+					break;
+
+				if (child + 1 < this->_Count && this->_Items[child + 1] < this->_Items[child])
+					child++;
+
+				if (!(this->_Items[child] < last))
+					break;
+
+				this->_Items[index] = this->_Items[child];
+				index = child;
+			}
+
+			this->_Items[index] = last;
+
+			return true;
+		}
+
+		const T* Top() const
+		{
+			return (this->_Count > 0) ? &this->_Items[0] : nullptr;
+		}
+
+		ULONG Count() const
+		{
+			return this->_Count;
+		}
+
+		void Clear()
+		{
+			this->_Count = 0;
+		}
+
+	private:
+		ULONG _Count{};
+
+		T _Items[Capacity];
+	};
+}
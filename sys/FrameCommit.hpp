@@ -0,0 +1,104 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+namespace ViGEm::Bus::Core
+{
+	//
+	// Report of one target waiting for the frame commit of its owner; caller provides 
+	// locking (the staging lock)
+	// 
+	template <typename TReport, typename TOwner>
+	class FrameStage
+	{
+	public:
+		//
+		// Restaging before commit simply replaces the report
+		// 
+		void Stage(const TReport& Report, TOwner Owner)
+		{
+			this->_Report = Report;
+			this->_Owner = Owner;
+		}
+
+		bool IsStaged() const
+		{
+			return this->_Owner != nullptr;
+		}
+
+		bool IsStagedBy(TOwner Owner) const
+		{
+			return this->_Owner != nullptr && this->_Owner == Owner;
+		}
+
+		//
+		// Removes the report from staging, it stays readable until staged again
+		// 
+		const TReport* Take()
+		{
+			this->_Owner = nullptr;
+
+			return &this->_Report;
+		}
+
+		void Discard()
+		{
+			this->_Owner = nullptr;
+		}
+
+	private:
+		TReport _Report{};
+
+		TOwner _Owner{};
+	};
+
+	//
+	// Makes a frame of staged reports visible at once. All report locks of the frame's 
+	// targets are held while the reports get applied, so a reader of any target sees 
+	// the whole frame or none of it, while targets outside the frame aren't held up.
+	// Commits must be serialized by the caller (the staging lock), which also keeps 
+	// two commits from taking the same locks in a different order.
+	// 
+	// ForEach(Function) calls Function(Target) for every target of the frame, in the
+	// same order on every call.
+	// 
+	template <typename TForEach, typename TLock, typename TApply, typename TUnlock>
+	void CommitFrame(TForEach&& ForEach, TLock&& Lock, TApply&& Apply, TUnlock&& Unlock)
+	{
+		ForEach(Lock);
+		ForEach(Apply);
+		ForEach(Unlock);
+	}
+}
@@ -0,0 +1,178 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+namespace ViGEm::Bus::Core
+{
+	//
+	// Buffers timestamped motion samples and interpolates them at the instants
+	// the host polls. No kernel dependencies; callers provide the timestamps 
+	// and serialize access.
+	// 
+	class ImuResampler
+	{
+	public:
+		static const ULONG CAPACITY = 256;
+
+		//
+		// Appends samples, skipping those not newer than the latest one. 
+		// A full buffer drops its oldest samples. Returns the number taken.
+		// 
+		ULONG Push(const DS4_IMU_SAMPLE* Samples, ULONG Count)
+		{
+			ULONG taken = 0;
+
+			for (ULONG index = 0; index < Count; index++)
+			{
+				if (this->_Count > 0 && Samples[index].Timestamp <= this->At(this->_Count - 1).Timestamp)
+					continue;
+
+				if (this->_Count == CAPACITY)
+				{
+					this->_Head = (this->_Head + 1) & (CAPACITY - 1);
+					this->_Count--;
+				}
+
+				this->_Samples[(this->_Head + this->_Count) & (CAPACITY - 1)] = Samples[index];
+				this->_Count++;
+				taken++;
+			}
+
+			return taken;
+		}
+
+		//
+		// Produces the motion at Time (same units as the sample timestamps). 
+		// Before the first sample that one is used, past the last sample it 
+		// is held for up to Hold ticks. Returns false once there's nothing left.
+		// 
+		bool Resample(LONGLONG Time, LONGLONG Hold, PDS4_IMU_SAMPLE Sample)
+		{
+			//
+			// Samples are consumed once the following one is due
+			// 
+			while (this->_Count >= 2 && this->At(1).Timestamp <= Time)
+			{
+				this->_Head = (this->_Head + 1) & (CAPACITY - 1);
+				this->_Count--;
+			}
+
+			if (this->_Count == 0)
+				return false;
+
+			const auto& first = this->At(0);
+
+			if (Time <= first.Timestamp)
+			{
+				*Sample = first;
+			}
+			else if (this->_Count == 1)
+			{
+				if (Time - first.Timestamp > Hold)
+				{
+					this->Reset();
+					return false;
+				}
+
+				this->_Underruns++;
+				*Sample = first;
+			}
+			else
+			{
+				const auto& second = this->At(1);
+
+				const auto num = Time - first.Timestamp;
+				const auto den = second.Timestamp - first.Timestamp;
+
+				Sample->wGyroX = Lerp(first.wGyroX, second.wGyroX, num, den);
+				Sample->wGyroY = Lerp(first.wGyroY, second.wGyroY, num, den);
+				Sample->wGyroZ = Lerp(first.wGyroZ, second.wGyroZ, num, den);
+				Sample->wAccelX = Lerp(first.wAccelX, second.wAccelX, num, den);
+				Sample->wAccelY = Lerp(first.wAccelY, second.wAccelY, num, den);
+				Sample->wAccelZ = Lerp(first.wAccelZ, second.wAccelZ, num, den);
+			}
+
+			Sample->Timestamp = Time;
+
+			return true;
+		}
+
+		void Reset()
+		{
+			this->_Head = 0;
+			this->_Count = 0;
+		}
+
+		ULONG Count() const
+		{
+			return this->_Count;
+		}
+
+		//
+		// Polls which had to repeat the latest sample
+		// 
+		ULONG Underruns() const
+		{
+			return this->_Underruns;
+		}
+
+	private:
+		const DS4_IMU_SAMPLE& At(ULONG Index) const
+		{
+			return this->_Samples[(this->_Head + Index) & (CAPACITY - 1)];
+		}
+
+		//
+		// A + (B - A) * Num / Den, rounded to nearest; 0 <= Num < Den
+		// 
+		static SHORT Lerp(SHORT A, SHORT B, LONGLONG Num, LONGLONG Den)
+		{
+			auto delta = (static_cast<LONGLONG>(B) - A) * Num;
+
+			delta = (delta >= 0) ? (delta + Den / 2) / Den : (delta - Den / 2) / Den;
+
+			return static_cast<SHORT>(A + delta);
+		}
+
+		DS4_IMU_SAMPLE _Samples[CAPACITY];
+
+		ULONG _Head{};
+
+		ULONG _Count{};
+
+		ULONG _Underruns{};
+	};
+}
@@ -0,0 +1,201 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+namespace ViGEm::Bus::Core
+{
+	//
+	// Combines the last reports of several writers into the one handed to the
+	// host. No kernel dependencies; inactive writers are passed as nullptr.
+	// Slot order breaks ties, so the owner (slot 0) wins those.
+	// 
+	class InputFusion
+	{
+	public:
+		static const ULONG MAX_WRITERS = 4;
+
+		static void FuseXusb(
+			const XUSB_REPORT* const Reports[MAX_WRITERS],
+			const UCHAR Priorities[MAX_WRITERS],
+			VIGEM_FUSION_POLICY Policy,
+			XUSB_REPORT* Fused
+		)
+		{
+			const bool byPriority = (Policy == VigemFusionPolicyPriority);
+
+			ULONG buttons = 0;
+			LONGLONG leftKey = 0, rightKey = 0, leftTriggerKey = 0, rightTriggerKey = 0;
+			LONG lx = 0, ly = 0, rx = 0, ry = 0, lt = 0, rt = 0;
+
+			for (ULONG i = 0; i < MAX_WRITERS; i++)
+			{
+				const auto report = Reports[i];
+
+				if (!report)
+					continue;
+
+				buttons |= report->wButtons;
+
+				Take(Key(byPriority, Priorities[i], Magnitude(report->sThumbLX, report->sThumbLY)),
+					leftKey, report->sThumbLX, lx, report->sThumbLY, ly);
+				Take(Key(byPriority, Priorities[i], Magnitude(report->sThumbRX, report->sThumbRY)),
+					rightKey, report->sThumbRX, rx, report->sThumbRY, ry);
+				Take(Key(byPriority, Priorities[i], report->bLeftTrigger),
+					leftTriggerKey, report->bLeftTrigger, lt);
+				Take(Key(byPriority, Priorities[i], report->bRightTrigger),
+					rightTriggerKey, report->bRightTrigger, rt);
+			}
+
+			Fused->wButtons = static_cast<USHORT>(buttons);
+			Fused->bLeftTrigger = static_cast<BYTE>(lt);
+			Fused->bRightTrigger = static_cast<BYTE>(rt);
+			Fused->sThumbLX = static_cast<SHORT>(lx);
+			Fused->sThumbLY = static_cast<SHORT>(ly);
+			Fused->sThumbRX = static_cast<SHORT>(rx);
+			Fused->sThumbRY = static_cast<SHORT>(ry);
+		}
+
+		//
+		// Motion, touch and battery fields come from the highest priority writer
+		// 
+		static void FuseDs4(
+			const DS4_REPORT_EX* const Reports[MAX_WRITERS],
+			const UCHAR Priorities[MAX_WRITERS],
+			VIGEM_FUSION_POLICY Policy,
+			DS4_REPORT_EX* Fused
+		)
+		{
+			const bool byPriority = (Policy == VigemFusionPolicyPriority);
+
+			ULONG buttons = 0, special = 0;
+			LONGLONG primaryKey = 0, leftKey = 0, rightKey = 0, leftTriggerKey = 0, rightTriggerKey = 0, dpadKey = 0;
+			LONG lx = DS4_AXIS_CENTER, ly = DS4_AXIS_CENTER, rx = DS4_AXIS_CENTER, ry = DS4_AXIS_CENTER;
+			LONG lt = 0, rt = 0, dpad = DS4_BUTTON_DPAD_NONE;
+			LONG primary = 0;
+
+			for (ULONG i = 0; i < MAX_WRITERS; i++)
+			{
+				if (!Reports[i])
+					continue;
+
+				const auto report = &Reports[i]->Report;
+
+				const LONG hat = report->wButtons & DS4_DPAD_MASK;
+
+				buttons |= report->wButtons;
+				special |= report->bSpecial;
+
+				Take(Key(true, Priorities[i], 1), primaryKey, static_cast<LONG>(i), primary);
+
+				Take(Key(byPriority, Priorities[i], Magnitude(
+						report->bThumbLX - DS4_AXIS_CENTER, report->bThumbLY - DS4_AXIS_CENTER)),
+					leftKey, report->bThumbLX, lx, report->bThumbLY, ly);
+				Take(Key(byPriority, Priorities[i], Magnitude(
+						report->bThumbRX - DS4_AXIS_CENTER, report->bThumbRY - DS4_AXIS_CENTER)),
+					rightKey, report->bThumbRX, rx, report->bThumbRY, ry);
+				Take(Key(byPriority, Priorities[i], report->bTriggerL),
+					leftTriggerKey, report->bTriggerL, lt);
+				Take(Key(byPriority, Priorities[i], report->bTriggerR),
+					rightTriggerKey, report->bTriggerR, rt);
+				Take(Key(byPriority, Priorities[i], (hat != DS4_BUTTON_DPAD_NONE)),
+					dpadKey, hat, dpad);
+			}
+
+			if (!primaryKey)
+				return;
+
+			*Fused = *Reports[primary];
+
+			//
+			// The hat nibble is an enumeration, OR-ing it would make up directions
+			// 
+			Fused->Report.wButtons = static_cast<USHORT>((buttons & ~DS4_DPAD_MASK) | dpad);
+			Fused->Report.bSpecial = static_cast<BYTE>(special);
+			Fused->Report.bTriggerL = static_cast<BYTE>(lt);
+			Fused->Report.bTriggerR = static_cast<BYTE>(rt);
+			Fused->Report.bThumbLX = static_cast<BYTE>(lx);
+			Fused->Report.bThumbLY = static_cast<BYTE>(ly);
+			Fused->Report.bThumbRX = static_cast<BYTE>(rx);
+			Fused->Report.bThumbRY = static_cast<BYTE>(ry);
+		}
+
+	private:
+		static const LONG DS4_AXIS_CENTER = 0x80;
+
+		static const LONG DS4_DPAD_MASK = 0xF;
+
+		static const LONG DS4_BUTTON_DPAD_NONE = 0x8;
+
+		//
+		// Squared deflection of a stick
+		// 
+		static LONGLONG Magnitude(LONG X, LONG Y)
+		{
+			return static_cast<LONGLONG>(X) * X + static_cast<LONGLONG>(Y) * Y;
+		}
+
+		//
+		// Ranks a deflection; 0 if not deflected, otherwise the priority (if used) before the magnitude
+		// 
+		static LONGLONG Key(bool ByPriority, UCHAR Priority, LONGLONG Magnitude)
+		{
+			const LONGLONG deflected = (Magnitude != 0);
+
+			return ((static_cast<LONGLONG>(Priority) + 1) << 40) * (deflected & ByPriority) | Magnitude;
+		}
+
+		//
+		// Branch free select of the candidate if it ranks higher than the current best
+		// 
+
+		static void Take(LONGLONG Key, LONGLONG& Best, LONG Value, LONG& Current)
+		{
+			const LONG mask = -static_cast<LONG>(Key > Best);
+
+			Current = (Current & ~mask) | (Value & mask);
+			Best = (Key > Best) ? Key : Best;
+		}
+
+		static void Take(LONGLONG Key, LONGLONG& Best, LONG X, LONG& CurrentX, LONG Y, LONG& CurrentY)
+		{
+			const LONG mask = -static_cast<LONG>(Key > Best);
+
+			CurrentX = (CurrentX & ~mask) | (X & mask);
+			CurrentY = (CurrentY & ~mask) | (Y & mask);
+			Best = (Key > Best) ? Key : Best;
+		}
+	};
+}
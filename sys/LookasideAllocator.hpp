@@ -0,0 +1,138 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+namespace ViGEm::Bus::Core
+{
+	//
+	// Mixin routing operator new/delete of T through a driver-wide lookaside 
+	// list, so plug/unplug churn recycles the same fixed-size blocks instead 
+	// of fragmenting non-paged pool. InitializeLookaside and DeleteLookaside 
+	// bracket the driver lifetime; every block taken from the list must be 
+	// freed before DeleteLookaside.
+	// 
+	template <typename T, ULONG Tag>
+	class LookasideAllocated
+	{
+	public:
+		static NTSTATUS InitializeLookaside()
+		{
+			const auto status = ExInitializeLookasideListEx(
+				&_Lookaside,
+				nullptr,
+				nullptr,
+				NonPagedPoolNx,
+				0,
+				sizeof(T),
+				Tag,
+				0
+			);
+
+			_LookasideInitialized = NT_SUCCESS(status);
+
+			return status;
+		}
+
+		static VOID DeleteLookaside()
+		{
+			if (!_LookasideInitialized)
+				return;
+
+			//
+			// A block freed after this point would go to the pool it never came from,
+			// keep the list alive for it instead
+			// 
+			if (_Outstanding != 0)
+			{
+				NT_ASSERTMSG("Lookaside blocks still allocated on delete", FALSE);
+				return;
+			}
+
+			_LookasideInitialized = false;
+
+			ExDeleteLookasideListEx(&_Lookaside);
+		}
+
+		static LONG Outstanding()
+		{
+			return _Outstanding;
+		}
+
+		void* operator new(size_t Size)
+		{
+			//
+			// Only blocks of exactly T come from the list, anything deriving further goes to the pool
+			// 
+			if (Size == sizeof(T) && _LookasideInitialized)
+			{
+				const auto block = ExAllocateFromLookasideListEx(&_Lookaside);
+
+				if (block)
+					InterlockedIncrement(&_Outstanding);
+
+				return block;
+			}
+
+			return ExAllocatePoolWithTag(NonPagedPoolNx, Size, Tag);
+		}
+
+		void operator delete(void* What, size_t Size)
+		{
+			if (What == nullptr)
+				return;
+
+			if (Size == sizeof(T) && _LookasideInitialized)
+			{
+				ExFreeToLookasideListEx(&_Lookaside, What);
+				InterlockedDecrement(&_Outstanding);
+			}
+			else
+			{
+				ExFreePoolWithTag(What, Tag);
+			}
+		}
+
+	private:
+		static inline LOOKASIDE_LIST_EX _Lookaside{};
+
+		static inline bool _LookasideInitialized{};
+
+		//
+		// Blocks handed out by the list and not yet returned
+		// 
+		static inline volatile LONG _Outstanding{};
+	};
+}
@@ -0,0 +1,208 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+namespace ViGEm::Bus::Core
+{
+	//
+	// Ring of output packets shared by up to MAX_SUBSCRIBERS readers. Each packet
+	// is stored once and reference counted; every subscriber advances its own
+	// cursor. Publishing over a packet somebody hasn't read yet drops it for the
+	// lagging subscribers. No kernel dependencies; callers serialize access.
+	// 
+	template <ULONG Capacity, ULONG PacketSize>
+	class NotificationFanout
+	{
+		static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+	public:
+		static const ULONG MAX_SUBSCRIBERS = 16;
+
+		typedef struct _PACKET
+		{
+			//
+			// Subscribers yet to read this packet
+			// 
+			LONG References;
+
+			ULONG Length;
+
+			UCHAR Data[PacketSize];
+
+		} PACKET, *PPACKET;
+
+		bool Subscribe(PULONG Subscriber)
+		{
+			for (ULONG index = 0; index < MAX_SUBSCRIBERS; index++)
+			{
+				if (this->_Subscribers & (1UL << index))
+					continue;
+
+				//
+				// Only packets published from now on
+				// 
+				this->_Cursor[index] = this->_Head;
+				this->_Dropped[index] = 0;
+				this->_Subscribers |= (1UL << index);
+
+				*Subscriber = index;
+				return true;
+			}
+
+			return false;
+		}
+
+		void Unsubscribe(ULONG Subscriber)
+		{
+			if (!this->IsSubscribed(Subscriber))
+				return;
+
+			while (this->_Cursor[Subscriber] != this->_Head)
+				this->Release(Subscriber);
+
+			this->_Subscribers &= ~(1UL << Subscriber);
+		}
+
+		bool IsSubscribed(ULONG Subscriber) const
+		{
+			return (Subscriber < MAX_SUBSCRIBERS) && (this->_Subscribers & (1UL << Subscriber));
+		}
+
+		ULONG Subscribers() const
+		{
+			return this->_Subscribers;
+		}
+
+		//
+		// Returns the number of subscribers the packet got handed to
+		// 
+		ULONG Publish(const VOID* Data, ULONG Length)
+		{
+			if (this->_Subscribers == 0 || Length > PacketSize)
+				return 0;
+
+			const auto packet = &this->_Packets[this->_Head & (Capacity - 1)];
+
+			//
+			// Slot still holds the oldest packet, which only the subscribers
+			// a full ring behind haven't read yet
+			// 
+			if (packet->References > 0)
+			{
+				const ULONG oldest = this->_Head - Capacity;
+
+				for (ULONG index = 0; index < MAX_SUBSCRIBERS; index++)
+				{
+					if (this->IsSubscribed(index) && this->_Cursor[index] == oldest)
+					{
+						this->_Cursor[index]++;
+						this->_Dropped[index]++;
+					}
+				}
+			}
+
+			ULONG count = 0;
+
+			for (ULONG mask = this->_Subscribers; mask; mask &= (mask - 1))
+				count++;
+
+			RtlCopyMemory(packet->Data, Data, Length);
+			packet->Length = Length;
+			packet->References = static_cast<LONG>(count);
+
+			this->_Head++;
+
+			return count;
+		}
+
+		//
+		// Oldest packet the subscriber hasn't read, nullptr if none
+		// 
+		const PACKET* Peek(ULONG Subscriber) const
+		{
+			if (!this->IsSubscribed(Subscriber) || this->_Cursor[Subscriber] == this->_Head)
+				return nullptr;
+
+			return &this->_Packets[this->_Cursor[Subscriber] & (Capacity - 1)];
+		}
+
+		//
+		// Marks the packet returned by Peek as read
+		// 
+		void Release(ULONG Subscriber)
+		{
+			if (!this->IsSubscribed(Subscriber) || this->_Cursor[Subscriber] == this->_Head)
+				return;
+
+			this->_Packets[this->_Cursor[Subscriber] & (Capacity - 1)].References--;
+			this->_Cursor[Subscriber]++;
+		}
+
+		//
+		// Packets lost to overruns since the last call
+		// 
+		ULONG TakeDropped(ULONG Subscriber)
+		{
+			if (!this->IsSubscribed(Subscriber))
+				return 0;
+
+			const auto dropped = this->_Dropped[Subscriber];
+			this->_Dropped[Subscriber] = 0;
+
+			return dropped;
+		}
+
+	private:
+		PACKET _Packets[Capacity]{};
+
+		//
+		// Sequence number of the next packet published
+		// 
+		ULONG _Head{};
+
+		//
+		// Sequence number of the next packet each subscriber reads
+		// 
+		ULONG _Cursor[MAX_SUBSCRIBERS]{};
+
+		ULONG _Dropped[MAX_SUBSCRIBERS]{};
+
+		//
+		// Bit per subscribed slot
+		// 
+		ULONG _Subscribers{};
+	};
+}
@@ -0,0 +1,86 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+namespace ViGEm::Bus::Core
+{
+	//
+	// Remembers the last output packet somebody actually received, so an
+	// identical resend can be dropped. Packets nobody got must not be
+	// remembered, or the first listener never sees them. Longer packets are
+	// never considered duplicates. No kernel dependencies; callers serialize
+	// access.
+	// 
+	template <ULONG MaxSize>
+	class OutputDeduplicator
+	{
+	public:
+		bool IsDuplicate(const VOID* Data, ULONG Length) const
+		{
+			return Length != 0
+				&& Length == this->_Length
+				&& RtlEqualMemory(this->_Packet, Data, Length);
+		}
+
+		//
+		// Called once the packet got delivered or queued for a reader
+		// 
+		void Remember(const VOID* Data, ULONG Length)
+		{
+			if (Length > MaxSize)
+			{
+				this->_Length = 0;
+				return;
+			}
+
+			RtlCopyMemory(this->_Packet, Data, Length);
+			this->_Length = Length;
+		}
+
+		//
+		// A new listener or owner gets the next packet even if it repeats
+		// 
+		void Forget()
+		{
+			this->_Length = 0;
+		}
+
+	private:
+		UCHAR _Packet[MaxSize]{};
+
+		ULONG _Length{};
+	};
+}
@@ -0,0 +1,143 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+namespace ViGEm::Bus::Core
+{
+	//
+	// Tracks the time between consecutive host transfers. Fixed point only, 
+	// no kernel dependencies; callers provide the timestamps.
+	// 
+	class PollIntervalEstimator
+	{
+	public:
+		//
+		// Records a transfer arriving at Now (counter ticks, Frequency ticks per second)
+		// 
+		void Sample(LONGLONG Now, LONGLONG Frequency)
+		{
+			if (this->_LastArrival != 0 && Now > this->_LastArrival && Frequency > 0)
+			{
+				const auto delta = Now - this->_LastArrival;
+
+				const auto interval = (delta / Frequency) * 1000000
+					+ ((delta % Frequency) * 1000000) / Frequency;
+
+				this->_Last = (interval > MAXULONG) ? MAXULONG : static_cast<ULONG>(interval);
+
+				if (this->_Count == 0)
+				{
+					this->_Minimum = this->_Maximum = this->_Last;
+					this->_ScaledAverage = static_cast<LONGLONG>(this->_Last) << EWMA_SHIFT;
+				}
+				else
+				{
+					if (this->_Last < this->_Minimum)
+						this->_Minimum = this->_Last;
+
+					if (this->_Last > this->_Maximum)
+						this->_Maximum = this->_Last;
+
+					//
+					// avg += (sample - avg) / 2^EWMA_SHIFT
+					// 
+					this->_ScaledAverage += static_cast<LONGLONG>(this->_Last) - (this->_ScaledAverage >> EWMA_SHIFT);
+				}
+
+				this->_Count++;
+			}
+
+			this->_LastArrival = Now;
+		}
+
+		void Reset()
+		{
+			*this = PollIntervalEstimator();
+		}
+
+		LONGLONG LastArrival() const
+		{
+			return this->_LastArrival;
+		}
+
+		//
+		// All intervals in microseconds, 0 until two transfers have been seen
+		// 
+
+		ULONG Last() const
+		{
+			return this->_Last;
+		}
+
+		ULONG Average() const
+		{
+			return static_cast<ULONG>(this->_ScaledAverage >> EWMA_SHIFT);
+		}
+
+		ULONG Minimum() const
+		{
+			return this->_Minimum;
+		}
+
+		ULONG Maximum() const
+		{
+			return this->_Maximum;
+		}
+
+		ULONG Count() const
+		{
+			return this->_Count;
+		}
+
+	private:
+		//
+		// Smoothing factor of 1/8
+		// 
+		static const int EWMA_SHIFT = 3;
+
+		LONGLONG _LastArrival{};
+
+		LONGLONG _ScaledAverage{};
+
+		ULONG _Last{};
+
+		ULONG _Minimum{};
+
+		ULONG _Maximum{};
+
+		ULONG _Count{};
+	};
+}
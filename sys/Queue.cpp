@@ -45,6 +45,7 @@
 
 using ViGEm::Bus::Core::PDO_IDENTIFICATION_DESCRIPTION;
 using ViGEm::Bus::Core::EmulationTargetPDO;
+using ViGEm::Bus::Core::TargetTokenTable;
 using ViGEm::Bus::Targets::EmulationTargetXUSB;
 using ViGEm::Bus::Targets::EmulationTargetDS4;
 
@@ -72,7 +73,24 @@ VOID Bus_EvtIoDeviceControl(
 	PVIGEM_CHECK_VERSION pCheckVersion = nullptr;
 	PVIGEM_WAIT_DEVICE_READY pWaitDeviceReady = nullptr;
 	PXUSB_GET_USER_INDEX pXusbGetUserIndex = nullptr;
+	PVIGEM_GET_TARGET_TOKEN pGetTargetToken = nullptr;
+	PVIGEM_SUBMIT_SCHEDULED_REPORT pScheduledReport = nullptr;
+	PVIGEM_STAGE_REPORT pStageReport = nullptr;
+	PVIGEM_COMMIT_FRAME pCommitFrame = nullptr;
+	PVIGEM_AWAIT_POLL pAwaitPoll = nullptr;
+	PVIGEM_TARGET_STATISTICS pTargetStatistics = nullptr;
+	PVIGEM_GRANT_TARGET_LEASE pGrantTargetLease = nullptr;
+	PVIGEM_ISSUE_TRANSFER_TICKET pIssueTransferTicket = nullptr;
+	PVIGEM_ENABLE_INPUT_FUSION pEnableInputFusion = nullptr;
+	PVIGEM_DETACH_INPUT_WRITER pDetachInputWriter = nullptr;
+	PVIGEM_AWAIT_NOTIFICATION pAwaitNotification = nullptr;
+	PDS4_SUBMIT_PARTIAL_REPORT pDs4PartialReport = nullptr;
+	PDS4_SUBMIT_IMU_SAMPLES pDs4ImuSamples = nullptr;
+	ULONG subscriber = 0;
+	ULONG writer = 0;
+	WDFFILEOBJECT fileObject;
 	EmulationTargetPDO* pdo;
+	EmulationTargetPDO* referencedPdo = nullptr;
 
 	Device = WdfIoQueueGetDevice(Queue);
 
@@ -176,6 +194,275 @@ VOID Bus_EvtIoDeviceControl(
 
 #pragma endregion
 
+#pragma region IOCTL_VIGEM_CLAIM_STANDBY_TARGET
+
+	case IOCTL_VIGEM_CLAIM_STANDBY_TARGET:
+
+		TraceDbg(TRACE_QUEUE, "IOCTL_VIGEM_CLAIM_STANDBY_TARGET");
+
+		// Don't accept the request if the output buffer can't hold the results
+		if (OutputBufferLength < sizeof(VIGEM_CLAIM_STANDBY_TARGET))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "Output buffer %d too small, require at least %d",
+			            static_cast<int>(OutputBufferLength), static_cast<int>(sizeof(VIGEM_CLAIM_STANDBY_TARGET)));
+			break;
+		}
+
+		status = Bus_ClaimStandbyTarget(Device, Request, &length);
+
+		break;
+
+#pragma endregion
+
+#pragma region IOCTL_VIGEM_RECLAIM_LEASED_TARGET
+
+	case IOCTL_VIGEM_RECLAIM_LEASED_TARGET:
+
+		TraceDbg(TRACE_QUEUE, "IOCTL_VIGEM_RECLAIM_LEASED_TARGET");
+
+		// Don't accept the request if the output buffer can't hold the results
+		if (OutputBufferLength < sizeof(VIGEM_RECLAIM_LEASED_TARGET))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "Output buffer %d too small, require at least %d",
+			            static_cast<int>(OutputBufferLength), static_cast<int>(sizeof(VIGEM_RECLAIM_LEASED_TARGET)));
+			break;
+		}
+
+		status = Bus_ReclaimLeasedTarget(Device, Request, &length);
+
+		break;
+
+#pragma endregion
+
+#pragma region IOCTL_VIGEM_CLAIM_TRANSFERRED_TARGET
+
+	case IOCTL_VIGEM_CLAIM_TRANSFERRED_TARGET:
+
+		TraceDbg(TRACE_QUEUE, "IOCTL_VIGEM_CLAIM_TRANSFERRED_TARGET");
+
+		// Don't accept the request if the output buffer can't hold the results
+		if (OutputBufferLength < sizeof(VIGEM_CLAIM_TRANSFERRED_TARGET))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "Output buffer %d too small, require at least %d",
+			            static_cast<int>(OutputBufferLength), static_cast<int>(sizeof(VIGEM_CLAIM_TRANSFERRED_TARGET)));
+			break;
+		}
+
+		status = Bus_ClaimTransferredTarget(Device, Request, &length);
+
+		break;
+
+#pragma endregion
+
+#pragma region IOCTL_VIGEM_ATTACH_INPUT_WRITER
+
+	case IOCTL_VIGEM_ATTACH_INPUT_WRITER:
+
+		TraceDbg(TRACE_QUEUE, "IOCTL_VIGEM_ATTACH_INPUT_WRITER");
+
+		// Don't accept the request if the output buffer can't hold the results
+		if (OutputBufferLength < sizeof(VIGEM_ATTACH_INPUT_WRITER))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "Output buffer %d too small, require at least %d",
+			            static_cast<int>(OutputBufferLength), static_cast<int>(sizeof(VIGEM_ATTACH_INPUT_WRITER)));
+			break;
+		}
+
+		status = Bus_AttachInputWriter(Device, Request, &length);
+
+		break;
+
+#pragma endregion
+
+#pragma region IOCTL_VIGEM_SUBSCRIBE_NOTIFICATIONS
+
+	case IOCTL_VIGEM_SUBSCRIBE_NOTIFICATIONS:
+
+		TraceDbg(TRACE_QUEUE, "IOCTL_VIGEM_SUBSCRIBE_NOTIFICATIONS");
+
+		// Don't accept the request if the output buffer can't hold the results
+		if (OutputBufferLength < sizeof(VIGEM_SUBSCRIBE_NOTIFICATIONS))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "Output buffer %d too small, require at least %d",
+			            static_cast<int>(OutputBufferLength), static_cast<int>(sizeof(VIGEM_SUBSCRIBE_NOTIFICATIONS)));
+			break;
+		}
+
+		status = Bus_SubscribeNotifications(Device, Request, &length);
+
+		break;
+
+#pragma endregion
+
+#pragma region IOCTL_VIGEM_MAP_OUTPUT_STATE
+
+	case IOCTL_VIGEM_MAP_OUTPUT_STATE:
+
+		TraceDbg(TRACE_QUEUE, "IOCTL_VIGEM_MAP_OUTPUT_STATE");
+
+		// Don't accept the request if the output buffer can't hold the page
+		if (OutputBufferLength < sizeof(VIGEM_OUTPUT_STATE_PAGE))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "Output buffer %d too small, require at least %d",
+			            static_cast<int>(OutputBufferLength), static_cast<int>(sizeof(VIGEM_OUTPUT_STATE_PAGE)));
+			break;
+		}
+
+		status = Bus_MapOutputState(Device, Request);
+
+		break;
+
+#pragma endregion
+
+#pragma region IOCTL_VIGEM_GET_TARGET_TOKEN
+
+	case IOCTL_VIGEM_GET_TARGET_TOKEN:
+
+		TraceDbg(TRACE_QUEUE, "IOCTL_VIGEM_GET_TARGET_TOKEN");
+
+		// Don't accept the request if the output buffer can't hold the results
+		if (OutputBufferLength < sizeof(VIGEM_GET_TARGET_TOKEN))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "Output buffer %d too small, require at least %d",
+			            static_cast<int>(OutputBufferLength), static_cast<int>(sizeof(VIGEM_GET_TARGET_TOKEN)));
+			break;
+		}
+
+		status = WdfRequestRetrieveInputBuffer(
+			Request,
+			sizeof(VIGEM_GET_TARGET_TOKEN),
+			reinterpret_cast<PVOID*>(&pGetTargetToken),
+			&length
+		);
+
+		if (!NT_SUCCESS(status))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "WdfRequestRetrieveInputBuffer failed with status %!STATUS!",
+			            status);
+			break;
+		}
+
+		if ((sizeof(VIGEM_GET_TARGET_TOKEN) != pGetTargetToken->Size) || (length != InputBufferLength))
+		{
+			status = STATUS_INVALID_PARAMETER;
+			break;
+		}
+
+		// This request only supports a single PDO at a time
+		if (pGetTargetToken->SerialNo == 0)
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "Invalid serial 0 submitted");
+
+			status = STATUS_INVALID_PARAMETER;
+			break;
+		}
+
+		if (!EmulationTargetPDO::GetPdoBySerial(Device, pGetTargetToken->SerialNo, &pdo))
+		{
+			status = STATUS_DEVICE_DOES_NOT_EXIST;
+			break;
+		}
+
+		fileObject = WdfRequestGetFileObject(Request);
+
+		//
+		// Tokens are only issued to the session owning the target
+		// 
+		if (fileObject == nullptr || FileObjectGetData(fileObject)->SessionId != pdo->GetSessionId())
+		{
+			status = STATUS_ACCESS_DENIED;
+			break;
+		}
+
+		status = FdoGetData(Device)->TargetTokens.Acquire(pdo, fileObject, &pGetTargetToken->Token);
+
+		if (!NT_SUCCESS(status))
+		{
+			TraceEvents(TRACE_LEVEL_WARNING,
+			            TRACE_QUEUE,
+			            "TargetTokens.Acquire failed with status %!STATUS!",
+			            status);
+		}
+
+		break;
+
+#pragma endregion
+
+#pragma region IOCTL_VIGEM_COMMIT_FRAME
+
+	case IOCTL_VIGEM_COMMIT_FRAME:
+
+		TraceDbg(TRACE_QUEUE, "IOCTL_VIGEM_COMMIT_FRAME");
+
+		// Don't accept the request if the output buffer can't hold the results
+		if (OutputBufferLength < sizeof(VIGEM_COMMIT_FRAME))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "Output buffer %d too small, require at least %d",
+			            static_cast<int>(OutputBufferLength), static_cast<int>(sizeof(VIGEM_COMMIT_FRAME)));
+			break;
+		}
+
+		status = WdfRequestRetrieveInputBuffer(
+			Request,
+			sizeof(VIGEM_COMMIT_FRAME),
+			reinterpret_cast<PVOID*>(&pCommitFrame),
+			&length
+		);
+
+		if (!NT_SUCCESS(status))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "WdfRequestRetrieveInputBuffer failed with status %!STATUS!",
+			            status);
+			break;
+		}
+
+		if ((sizeof(VIGEM_COMMIT_FRAME) != pCommitFrame->Size) || (length != InputBufferLength))
+		{
+			status = STATUS_INVALID_PARAMETER;
+			break;
+		}
+
+		fileObject = WdfRequestGetFileObject(Request);
+
+		if (fileObject == nullptr)
+		{
+			status = STATUS_ACCESS_DENIED;
+			break;
+		}
+
+		status = EmulationTargetPDO::CommitStagedReports(
+			Device,
+			fileObject,
+			&pCommitFrame->TargetCount,
+			&pCommitFrame->Epoch
+		);
+
+		break;
+
+#pragma endregion
+
 #pragma region IOCTL_XUSB_SUBMIT_REPORT
 
 	case IOCTL_XUSB_SUBMIT_REPORT:
@@ -460,13 +747,642 @@ VOID Bus_EvtIoDeviceControl(
 
 #pragma endregion
 
-	default:
+#pragma region IOCTL_XUSB_SUBMIT_REPORT_BY_TOKEN
 
-		TraceEvents(TRACE_LEVEL_WARNING,
-		            TRACE_QUEUE,
-		            "Unknown I/O control code 0x%X", IoControlCode);
+	case IOCTL_XUSB_SUBMIT_REPORT_BY_TOKEN:
 
-		break; // default status is STATUS_INVALID_PARAMETER
+		TraceDbg(TRACE_QUEUE, "IOCTL_XUSB_SUBMIT_REPORT_BY_TOKEN");
+
+		status = WdfRequestRetrieveInputBuffer(
+			Request,
+			sizeof(XUSB_SUBMIT_REPORT),
+			reinterpret_cast<PVOID*>(&xusbSubmit),
+			&length
+		);
+
+		if (!NT_SUCCESS(status))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "WdfRequestRetrieveInputBuffer failed with status %!STATUS!",
+			            status);
+			break;
+		}
+
+		if ((sizeof(XUSB_SUBMIT_REPORT) != xusbSubmit->Size) || (length != InputBufferLength))
+		{
+			status = STATUS_INVALID_PARAMETER;
+			break;
+		}
+
+		//
+		// SerialNo carries the token, no serial or owner process resolution required.
+		// Input fusion writers submit with their own token.
+		// 
+		pdo = referencedPdo = FdoGetData(Device)->TargetTokens.LookupWriter(xusbSubmit->SerialNo, WdfRequestGetFileObject(Request), &writer);
+
+		if (pdo == nullptr)
+			status = STATUS_ACCESS_DENIED;
+		else
+			status = pdo->SubmitReportTranslated(Xbox360Wired, xusbSubmit, writer);
+
+		break;
+
+#pragma endregion
+
+#pragma region IOCTL_DS4_SUBMIT_REPORT_BY_TOKEN
+
+	case IOCTL_DS4_SUBMIT_REPORT_BY_TOKEN:
+
+		TraceDbg(TRACE_QUEUE, "IOCTL_DS4_SUBMIT_REPORT_BY_TOKEN");
+
+		status = WdfRequestRetrieveInputBuffer(
+			Request,
+			sizeof(DS4_SUBMIT_REPORT),
+			reinterpret_cast<PVOID*>(&ds4Submit),
+			&length
+		);
+
+		if (!NT_SUCCESS(status))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "WdfRequestRetrieveInputBuffer failed with status %!STATUS!",
+			            status);
+			break;
+		}
+
+		//
+		// Both DS4_SUBMIT_REPORT and DS4_SUBMIT_REPORT_EX are accepted
+		// 
+		if (length < sizeof(DS4_SUBMIT_REPORT) || length > sizeof(DS4_SUBMIT_REPORT_EX) || length != ds4Submit->Size)
+		{
+			status = STATUS_INVALID_BUFFER_SIZE;
+			break;
+		}
+
+		pdo = referencedPdo = FdoGetData(Device)->TargetTokens.LookupWriter(ds4Submit->SerialNo, WdfRequestGetFileObject(Request), &writer);
+
+		if (pdo == nullptr)
+			status = STATUS_ACCESS_DENIED;
+		else
+			status = pdo->SubmitReportTranslated(DualShock4Wired, ds4Submit, writer);
+
+		break;
+
+#pragma endregion
+
+#pragma region IOCTL_DS4_SUBMIT_PARTIAL_REPORT
+
+	case IOCTL_DS4_SUBMIT_PARTIAL_REPORT:
+
+		TraceDbg(TRACE_QUEUE, "IOCTL_DS4_SUBMIT_PARTIAL_REPORT");
+
+		status = WdfRequestRetrieveInputBuffer(
+			Request,
+			FIELD_OFFSET(DS4_SUBMIT_PARTIAL_REPORT, Data),
+			reinterpret_cast<PVOID*>(&pDs4PartialReport),
+			&length
+		);
+
+		if (!NT_SUCCESS(status))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "WdfRequestRetrieveInputBuffer failed with status %!STATUS!",
+			            status);
+			break;
+		}
+
+		//
+		// Only the packed fields are transferred, the size varies with the mask
+		// 
+		if (length > sizeof(DS4_SUBMIT_PARTIAL_REPORT) || length != pDs4PartialReport->Size)
+		{
+			status = STATUS_INVALID_BUFFER_SIZE;
+			break;
+		}
+
+		pdo = referencedPdo = FdoGetData(Device)->TargetTokens.Lookup(pDs4PartialReport->Token, WdfRequestGetFileObject(Request));
+
+		if (pdo == nullptr || pdo->GetType() != DualShock4Wired)
+			status = STATUS_ACCESS_DENIED;
+		else
+			status = static_cast<EmulationTargetDS4*>(pdo)->SubmitPartialReport(pDs4PartialReport);
+
+		break;
+
+#pragma endregion
+
+#pragma region IOCTL_DS4_SUBMIT_IMU_SAMPLES
+
+	case IOCTL_DS4_SUBMIT_IMU_SAMPLES:
+
+		TraceDbg(TRACE_QUEUE, "IOCTL_DS4_SUBMIT_IMU_SAMPLES");
+
+		status = WdfRequestRetrieveInputBuffer(
+			Request,
+			FIELD_OFFSET(DS4_SUBMIT_IMU_SAMPLES, Samples),
+			reinterpret_cast<PVOID*>(&pDs4ImuSamples),
+			&length
+		);
+
+		if (!NT_SUCCESS(status))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "WdfRequestRetrieveInputBuffer failed with status %!STATUS!",
+			            status);
+			break;
+		}
+
+		//
+		// Only the used samples are transferred, the size varies with the count
+		// 
+		if (pDs4ImuSamples->Count > DS4_IMU_MAX_SAMPLES
+			|| length != pDs4ImuSamples->Size
+			|| length != FIELD_OFFSET(DS4_SUBMIT_IMU_SAMPLES, Samples) + pDs4ImuSamples->Count * sizeof(DS4_IMU_SAMPLE))
+		{
+			status = STATUS_INVALID_BUFFER_SIZE;
+			break;
+		}
+
+		pdo = referencedPdo = FdoGetData(Device)->TargetTokens.Lookup(pDs4ImuSamples->Token, WdfRequestGetFileObject(Request));
+
+		if (pdo == nullptr || pdo->GetType() != DualShock4Wired)
+			status = STATUS_ACCESS_DENIED;
+		else
+			status = static_cast<EmulationTargetDS4*>(pdo)->SubmitImuSamples(pDs4ImuSamples);
+
+		break;
+
+#pragma endregion
+
+#pragma region IOCTL_VIGEM_SUBMIT_SCHEDULED_REPORT
+
+	case IOCTL_VIGEM_SUBMIT_SCHEDULED_REPORT:
+
+		TraceDbg(TRACE_QUEUE, "IOCTL_VIGEM_SUBMIT_SCHEDULED_REPORT");
+
+		status = WdfRequestRetrieveInputBuffer(
+			Request,
+			sizeof(VIGEM_SUBMIT_SCHEDULED_REPORT),
+			reinterpret_cast<PVOID*>(&pScheduledReport),
+			&length
+		);
+
+		if (!NT_SUCCESS(status))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "WdfRequestRetrieveInputBuffer failed with status %!STATUS!",
+			            status);
+			break;
+		}
+
+		if (length != sizeof(VIGEM_SUBMIT_SCHEDULED_REPORT) || pScheduledReport->Size != length)
+		{
+			status = STATUS_INVALID_BUFFER_SIZE;
+			break;
+		}
+
+		pdo = referencedPdo = FdoGetData(Device)->TargetTokens.Lookup(pScheduledReport->Token, WdfRequestGetFileObject(Request));
+
+		if (pdo == nullptr)
+			status = STATUS_ACCESS_DENIED;
+		else
+			status = pdo->SubmitScheduledReport(pScheduledReport);
+
+		break;
+
+#pragma endregion
+
+#pragma region IOCTL_VIGEM_STAGE_REPORT
+
+	case IOCTL_VIGEM_STAGE_REPORT:
+
+		TraceDbg(TRACE_QUEUE, "IOCTL_VIGEM_STAGE_REPORT");
+
+		status = WdfRequestRetrieveInputBuffer(
+			Request,
+			sizeof(VIGEM_STAGE_REPORT),
+			reinterpret_cast<PVOID*>(&pStageReport),
+			&length
+		);
+
+		if (!NT_SUCCESS(status))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "WdfRequestRetrieveInputBuffer failed with status %!STATUS!",
+			            status);
+			break;
+		}
+
+		if (length != sizeof(VIGEM_STAGE_REPORT) || pStageReport->Size != length)
+		{
+			status = STATUS_INVALID_BUFFER_SIZE;
+			break;
+		}
+
+		fileObject = WdfRequestGetFileObject(Request);
+
+		pdo = referencedPdo = FdoGetData(Device)->TargetTokens.Lookup(pStageReport->Token, fileObject);
+
+		if (pdo == nullptr)
+			status = STATUS_ACCESS_DENIED;
+		else
+			status = pdo->StageReport(pStageReport, fileObject);
+
+		break;
+
+#pragma endregion
+
+#pragma region IOCTL_VIGEM_AWAIT_POLL
+
+	case IOCTL_VIGEM_AWAIT_POLL:
+
+		TraceDbg(TRACE_QUEUE, "IOCTL_VIGEM_AWAIT_POLL");
+
+		// Don't accept the request if the output buffer can't hold the results
+		if (OutputBufferLength < sizeof(VIGEM_AWAIT_POLL))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "Output buffer %d too small, require at least %d",
+			            static_cast<int>(OutputBufferLength), static_cast<int>(sizeof(VIGEM_AWAIT_POLL)));
+			break;
+		}
+
+		status = WdfRequestRetrieveInputBuffer(
+			Request,
+			sizeof(VIGEM_AWAIT_POLL),
+			reinterpret_cast<PVOID*>(&pAwaitPoll),
+			&length
+		);
+
+		if (!NT_SUCCESS(status))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "WdfRequestRetrieveInputBuffer failed with status %!STATUS!",
+			            status);
+			break;
+		}
+
+		if ((sizeof(VIGEM_AWAIT_POLL) != pAwaitPoll->Size) || (length != InputBufferLength))
+		{
+			status = STATUS_INVALID_PARAMETER;
+			break;
+		}
+
+		pdo = referencedPdo = FdoGetData(Device)->TargetTokens.Lookup(pAwaitPoll->Token, WdfRequestGetFileObject(Request));
+
+		if (pdo == nullptr)
+		{
+			status = STATUS_ACCESS_DENIED;
+			break;
+		}
+
+		status = pdo->EnqueueAwaitPoll(Request);
+
+		break;
+
+#pragma endregion
+
+#pragma region IOCTL_VIGEM_GET_TARGET_STATISTICS
+
+	case IOCTL_VIGEM_GET_TARGET_STATISTICS:
+
+		TraceDbg(TRACE_QUEUE, "IOCTL_VIGEM_GET_TARGET_STATISTICS");
+
+		// Don't accept the request if the output buffer can't hold the results
+		if (OutputBufferLength < sizeof(VIGEM_TARGET_STATISTICS))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "Output buffer %d too small, require at least %d",
+			            static_cast<int>(OutputBufferLength), static_cast<int>(sizeof(VIGEM_TARGET_STATISTICS)));
+			break;
+		}
+
+		status = WdfRequestRetrieveInputBuffer(
+			Request,
+			sizeof(VIGEM_TARGET_STATISTICS),
+			reinterpret_cast<PVOID*>(&pTargetStatistics),
+			&length
+		);
+
+		if (!NT_SUCCESS(status))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "WdfRequestRetrieveInputBuffer failed with status %!STATUS!",
+			            status);
+			break;
+		}
+
+		if ((sizeof(VIGEM_TARGET_STATISTICS) != pTargetStatistics->Size) || (length != InputBufferLength))
+		{
+			status = STATUS_INVALID_PARAMETER;
+			break;
+		}
+
+		pdo = referencedPdo = FdoGetData(Device)->TargetTokens.Lookup(pTargetStatistics->Token, WdfRequestGetFileObject(Request));
+
+		if (pdo == nullptr)
+		{
+			status = STATUS_ACCESS_DENIED;
+			break;
+		}
+
+		pdo->GetStatistics(pTargetStatistics);
+
+		break;
+
+#pragma endregion
+
+#pragma region IOCTL_VIGEM_GRANT_TARGET_LEASE
+
+	case IOCTL_VIGEM_GRANT_TARGET_LEASE:
+
+		TraceDbg(TRACE_QUEUE, "IOCTL_VIGEM_GRANT_TARGET_LEASE");
+
+		// Don't accept the request if the output buffer can't hold the results
+		if (OutputBufferLength < sizeof(VIGEM_GRANT_TARGET_LEASE))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "Output buffer %d too small, require at least %d",
+			            static_cast<int>(OutputBufferLength), static_cast<int>(sizeof(VIGEM_GRANT_TARGET_LEASE)));
+			break;
+		}
+
+		status = WdfRequestRetrieveInputBuffer(
+			Request,
+			sizeof(VIGEM_GRANT_TARGET_LEASE),
+			reinterpret_cast<PVOID*>(&pGrantTargetLease),
+			&length
+		);
+
+		if (!NT_SUCCESS(status))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "WdfRequestRetrieveInputBuffer failed with status %!STATUS!",
+			            status);
+			break;
+		}
+
+		if ((sizeof(VIGEM_GRANT_TARGET_LEASE) != pGrantTargetLease->Size) || (length != InputBufferLength))
+		{
+			status = STATUS_INVALID_PARAMETER;
+			break;
+		}
+
+		pdo = referencedPdo = FdoGetData(Device)->TargetTokens.Lookup(pGrantTargetLease->Token, WdfRequestGetFileObject(Request));
+
+		if (pdo == nullptr)
+		{
+			status = STATUS_ACCESS_DENIED;
+			break;
+		}
+
+		status = pdo->GrantLease(pGrantTargetLease->GracePeriod, &pGrantTargetLease->LeaseKey);
+
+		break;
+
+#pragma endregion
+
+#pragma region IOCTL_VIGEM_ISSUE_TRANSFER_TICKET
+
+	case IOCTL_VIGEM_ISSUE_TRANSFER_TICKET:
+
+		TraceDbg(TRACE_QUEUE, "IOCTL_VIGEM_ISSUE_TRANSFER_TICKET");
+
+		// Don't accept the request if the output buffer can't hold the results
+		if (OutputBufferLength < sizeof(VIGEM_ISSUE_TRANSFER_TICKET))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "Output buffer %d too small, require at least %d",
+			            static_cast<int>(OutputBufferLength), static_cast<int>(sizeof(VIGEM_ISSUE_TRANSFER_TICKET)));
+			break;
+		}
+
+		status = WdfRequestRetrieveInputBuffer(
+			Request,
+			sizeof(VIGEM_ISSUE_TRANSFER_TICKET),
+			reinterpret_cast<PVOID*>(&pIssueTransferTicket),
+			&length
+		);
+
+		if (!NT_SUCCESS(status))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "WdfRequestRetrieveInputBuffer failed with status %!STATUS!",
+			            status);
+			break;
+		}
+
+		if ((sizeof(VIGEM_ISSUE_TRANSFER_TICKET) != pIssueTransferTicket->Size) || (length != InputBufferLength))
+		{
+			status = STATUS_INVALID_PARAMETER;
+			break;
+		}
+
+		//
+		// Only the current owner holds a resolving token
+		// 
+		pdo = referencedPdo = FdoGetData(Device)->TargetTokens.Lookup(pIssueTransferTicket->Token, WdfRequestGetFileObject(Request));
+
+		if (pdo == nullptr)
+		{
+			status = STATUS_ACCESS_DENIED;
+			break;
+		}
+
+		status = pdo->IssueTransferTicket(&pIssueTransferTicket->Ticket);
+
+		break;
+
+#pragma endregion
+
+#pragma region IOCTL_VIGEM_ENABLE_INPUT_FUSION
+
+	case IOCTL_VIGEM_ENABLE_INPUT_FUSION:
+
+		TraceDbg(TRACE_QUEUE, "IOCTL_VIGEM_ENABLE_INPUT_FUSION");
+
+		// Don't accept the request if the output buffer can't hold the results
+		if (OutputBufferLength < sizeof(VIGEM_ENABLE_INPUT_FUSION))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "Output buffer %d too small, require at least %d",
+			            static_cast<int>(OutputBufferLength), static_cast<int>(sizeof(VIGEM_ENABLE_INPUT_FUSION)));
+			break;
+		}
+
+		status = WdfRequestRetrieveInputBuffer(
+			Request,
+			sizeof(VIGEM_ENABLE_INPUT_FUSION),
+			reinterpret_cast<PVOID*>(&pEnableInputFusion),
+			&length
+		);
+
+		if (!NT_SUCCESS(status))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "WdfRequestRetrieveInputBuffer failed with status %!STATUS!",
+			            status);
+			break;
+		}
+
+		if ((sizeof(VIGEM_ENABLE_INPUT_FUSION) != pEnableInputFusion->Size) || (length != InputBufferLength))
+		{
+			status = STATUS_INVALID_PARAMETER;
+			break;
+		}
+
+		pdo = referencedPdo = FdoGetData(Device)->TargetTokens.Lookup(pEnableInputFusion->Token, WdfRequestGetFileObject(Request));
+
+		if (pdo == nullptr)
+		{
+			status = STATUS_ACCESS_DENIED;
+			break;
+		}
+
+		status = pdo->EnableInputFusion(
+			pEnableInputFusion->Policy,
+			pEnableInputFusion->OwnerPriority,
+			&pEnableInputFusion->WriterKey
+		);
+
+		break;
+
+#pragma endregion
+
+#pragma region IOCTL_VIGEM_DETACH_INPUT_WRITER
+
+	case IOCTL_VIGEM_DETACH_INPUT_WRITER:
+
+		TraceDbg(TRACE_QUEUE, "IOCTL_VIGEM_DETACH_INPUT_WRITER");
+
+		status = WdfRequestRetrieveInputBuffer(
+			Request,
+			sizeof(VIGEM_DETACH_INPUT_WRITER),
+			reinterpret_cast<PVOID*>(&pDetachInputWriter),
+			&length
+		);
+
+		if (!NT_SUCCESS(status))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "WdfRequestRetrieveInputBuffer failed with status %!STATUS!",
+			            status);
+			break;
+		}
+
+		if ((sizeof(VIGEM_DETACH_INPUT_WRITER) != pDetachInputWriter->Size) || (length != InputBufferLength))
+		{
+			status = STATUS_INVALID_PARAMETER;
+			break;
+		}
+
+		pdo = referencedPdo = FdoGetData(Device)->TargetTokens.LookupWriter(pDetachInputWriter->Token, WdfRequestGetFileObject(Request), &writer);
+
+		//
+		// Owner tokens can't be detached
+		// 
+		if (pdo == nullptr || writer == EmulationTargetPDO::OWNER_WRITER)
+		{
+			status = STATUS_ACCESS_DENIED;
+			break;
+		}
+
+		pdo->DetachWriter(writer);
+		FdoGetData(Device)->TargetTokens.ReleaseSecondary(pDetachInputWriter->Token, WdfRequestGetFileObject(Request));
+
+		length = 0;
+
+		break;
+
+#pragma endregion
+
+#pragma region IOCTL_VIGEM_AWAIT_NOTIFICATION
+
+	case IOCTL_VIGEM_AWAIT_NOTIFICATION:
+
+		TraceDbg(TRACE_QUEUE, "IOCTL_VIGEM_AWAIT_NOTIFICATION");
+
+		// Don't accept the request if the output buffer can't hold the results
+		if (OutputBufferLength < sizeof(VIGEM_AWAIT_NOTIFICATION))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "Output buffer %d too small, require at least %d",
+			            static_cast<int>(OutputBufferLength), static_cast<int>(sizeof(VIGEM_AWAIT_NOTIFICATION)));
+			break;
+		}
+
+		status = WdfRequestRetrieveInputBuffer(
+			Request,
+			sizeof(VIGEM_AWAIT_NOTIFICATION),
+			reinterpret_cast<PVOID*>(&pAwaitNotification),
+			&length
+		);
+
+		if (!NT_SUCCESS(status))
+		{
+			TraceEvents(TRACE_LEVEL_ERROR,
+			            TRACE_QUEUE,
+			            "WdfRequestRetrieveInputBuffer failed with status %!STATUS!",
+			            status);
+			break;
+		}
+
+		if ((sizeof(VIGEM_AWAIT_NOTIFICATION) != pAwaitNotification->Size) || (length != InputBufferLength))
+		{
+			status = STATUS_INVALID_PARAMETER;
+			break;
+		}
+
+		//
+		// Read-only handle, only subscriber tokens resolve
+		// 
+		pdo = referencedPdo = FdoGetData(Device)->TargetTokens.LookupSubscriber(pAwaitNotification->Token, WdfRequestGetFileObject(Request), &subscriber);
+
+		if (pdo == nullptr)
+		{
+			status = STATUS_ACCESS_DENIED;
+			break;
+		}
+
+		status = pdo->EnqueueSubscriberNotification(subscriber, Request);
+
+		break;
+
+#pragma endregion
+
+	default:
+
+		TraceEvents(TRACE_LEVEL_WARNING,
+		            TRACE_QUEUE,
+		            "Unknown I/O control code 0x%X", IoControlCode);
+
+		break; // default status is STATUS_INVALID_PARAMETER
+	}
+
+	//
+	// Token lookups keep the target alive for the duration of the request handler
+	// 
+	if (referencedPdo)
+	{
+		TargetTokenTable::Dereference(referencedPdo);
 	}
 
 	if (status != STATUS_PENDING)
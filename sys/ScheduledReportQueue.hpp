@@ -0,0 +1,100 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "FixedMinHeap.hpp"
+
+namespace ViGEm::Bus::Core
+{
+	//
+	// Reports ordered by due time, each put back a bounded number of times when the 
+	// host had nothing to receive it; never allocates, caller provides locking
+	// 
+	// T needs LONGLONG DueTime, UCHAR Retries and operator<
+	// 
+	template <typename T, ULONG Capacity, UCHAR MaxRetries>
+	class ScheduledReportQueue : public FixedMinHeap<T, Capacity>
+	{
+	public:
+		//
+		// Takes the earliest report if it is due at Now, otherwise returns the ticks 
+		// until it will be in DueIn (0 if empty)
+		// 
+		bool PopDue(LONGLONG Now, T* Item, LONGLONG* DueIn)
+		{
+			const auto top = this->Top();
+
+			*DueIn = 0;
+
+			if (top == nullptr)
+				return false;
+
+			if (top->DueTime > Now)
+			{
+				*DueIn = top->DueTime - Now;
+				return false;
+			}
+
+			return this->Pop(Item);
+		}
+
+		//
+		// Puts back a report that couldn't be delivered; once out of retries (or if 
+		// the queue filled up meanwhile) it is dropped and counted instead
+		// 
+		bool Retry(T Item)
+		{
+			if (Item.Retries < MaxRetries)
+			{
+				Item.Retries++;
+
+				if (this->Push(Item))
+					return true;
+			}
+
+			this->_Dropped++;
+
+			return false;
+		}
+
+		ULONG Dropped() const
+		{
+			return this->_Dropped;
+		}
+
+	private:
+		ULONG _Dropped{};
+	};
+}
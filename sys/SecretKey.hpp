@@ -0,0 +1,79 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+namespace ViGEm::Bus::Core
+{
+	//
+	// Upper bound of draws for a non-zero key; a working RNG returns zero
+	// with a chance of 2^-32 per draw
+	// 
+	constexpr ULONG MAX_SECRET_KEY_DRAWS = 4;
+
+	//
+	// Draws a non-zero key from Fill(PUCHAR Buffer, ULONG Length), which returns
+	// false if the random source failed. Zero stays reserved for "no key".
+	// 
+	template <typename Source>
+	bool generate_secret_key(Source&& Fill, PULONG Key)
+	{
+		for (ULONG draw = 0; draw < MAX_SECRET_KEY_DRAWS; draw++)
+		{
+			ULONG key = 0;
+
+			if (!Fill(reinterpret_cast<PUCHAR>(&key), static_cast<ULONG>(sizeof(key))))
+				return false;
+
+			if (key != 0)
+			{
+				*Key = key;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	//
+	// Compares a presented key without branching on its bits; a zero expected
+	// key never matches
+	// 
+	inline bool secret_key_equals(ULONG Expected, ULONG Presented)
+	{
+		volatile ULONG difference = Expected ^ Presented;
+
+		return (difference | static_cast<ULONG>(Expected == 0)) == 0;
+	}
+}
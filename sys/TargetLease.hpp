@@ -0,0 +1,140 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "SecretKey.hpp"
+
+namespace ViGEm::Bus::Core
+{
+	//
+	// Keeps a target plugged in for a grace period after its owner went away
+	// so a new session presenting the key can take it over. No kernel
+	// dependencies; callers provide the time (any monotonic clock, grace
+	// period in the same unit).
+	// 
+	class TargetLease
+	{
+	public:
+		//
+		// Called by the owner, a granted lease can be re-granted with a new grace period
+		// 
+		bool Grant(ULONG Key, LONGLONG GracePeriod)
+		{
+			if (this->_State == Orphaned || this->_State == Expired)
+				return false;
+
+			this->_Key = Key;
+			this->_GracePeriod = GracePeriod;
+
+			InterlockedExchange(&this->_State, Held);
+
+			return true;
+		}
+
+		bool IsHeld() const
+		{
+			return this->_State == Held;
+		}
+
+		bool IsOrphaned() const
+		{
+			return this->_State == Orphaned;
+		}
+
+		ULONG Key() const
+		{
+			return this->_Key;
+		}
+
+		//
+		// Owner went away, false if no lease was granted
+		// 
+		bool Orphan(LONGLONG Now)
+		{
+			this->_Expiry = Now + this->_GracePeriod;
+
+			return InterlockedCompareExchange(&this->_State, Orphaned, Held) == Held;
+		}
+
+		//
+		// New owner presents Key, only one of concurrent reclaims succeeds
+		// 
+		bool Reclaim(ULONG Key)
+		{
+			if (this->_State != Orphaned || !secret_key_equals(this->_Key, Key))
+				return false;
+
+			return InterlockedCompareExchange(&this->_State, Held, Orphaned) == Orphaned;
+		}
+
+		//
+		// Ownership moved on without the lease, the new owner grants its own
+		// 
+		void Revoke()
+		{
+			if (InterlockedCompareExchange(&this->_State, None, Held) == Held)
+				this->_Key = 0;
+		}
+
+		//
+		// True once if the grace period ran out before a reclaim
+		// 
+		bool Expire(LONGLONG Now)
+		{
+			if (this->_State != Orphaned || Now < this->_Expiry)
+				return false;
+
+			return InterlockedCompareExchange(&this->_State, Expired, Orphaned) == Orphaned;
+		}
+
+	private:
+		enum : LONG
+		{
+			None = 0,
+			Held,
+			Orphaned,
+			Expired
+		};
+
+		volatile LONG _State{ None };
+
+		ULONG _Key{};
+
+		LONGLONG _GracePeriod{};
+
+		LONGLONG _Expiry{};
+	};
+}
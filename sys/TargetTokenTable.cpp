@@ -0,0 +1,252 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "TargetTokenTable.hpp"
+#include "EmulationTargetPDO.hpp"
+
+
+VOID ViGEm::Bus::Core::TargetTokenTable::Initialize()
+{
+	this->_Lock = 0;
+	this->_Slots.Initialize();
+}
+
+NTSTATUS ViGEm::Bus::Core::TargetTokenTable::Acquire(
+	EmulationTargetPDO* Target,
+	WDFFILEOBJECT Owner,
+	PULONG Token
+)
+{
+	NTSTATUS status = STATUS_SUCCESS;
+
+	const KIRQL irql = ExAcquireSpinLockExclusive(&this->_Lock);
+
+	//
+	// Hand out the existing token if it is still valid for this owner
+	// 
+	const ULONG current = Target->GetToken();
+
+	if (current != 0 && this->_Slots.IsIssued(current, Target, Owner, TokenRoleOwner))
+	{
+		*Token = current;
+	}
+	else if (this->_Slots.Issue(Target, Owner, TokenRoleOwner, 0, Token))
+	{
+		Target->SetToken(*Token);
+	}
+	else
+	{
+		status = STATUS_INSUFFICIENT_RESOURCES;
+	}
+
+	ExReleaseSpinLockExclusive(&this->_Lock, irql);
+
+	return status;
+}
+
+ViGEm::Bus::Core::EmulationTargetPDO* ViGEm::Bus::Core::TargetTokenTable::LookupReferenced(
+	ULONG Token,
+	WDFFILEOBJECT Owner,
+	ULONG Roles,
+	PULONG RoleIndex
+)
+{
+	const KIRQL irql = ExAcquireSpinLockShared(&this->_Lock);
+
+	auto target = this->_Slots.Resolve(Token, Owner, Roles, RoleIndex);
+
+	//
+	// Taken while the slot still resolves; once the PDO is gone the object may 
+	// be recycled for another target, so it must not be freed under the caller
+	// 
+	if (target && !target->Reference())
+		target = nullptr;
+
+	ExReleaseSpinLockShared(&this->_Lock, irql);
+
+	return target;
+}
+
+ViGEm::Bus::Core::EmulationTargetPDO* ViGEm::Bus::Core::TargetTokenTable::Lookup(
+	ULONG Token,
+	WDFFILEOBJECT Owner
+)
+{
+	//
+	// Writer and subscriber tokens only grant what their own lookup checks for
+	// 
+	return this->LookupReferenced(Token, Owner, SLOTS::RoleMask(TokenRoleOwner), nullptr);
+}
+
+NTSTATUS ViGEm::Bus::Core::TargetTokenTable::AcquireWriter(
+	EmulationTargetPDO* Target,
+	WDFFILEOBJECT Owner,
+	ULONG Writer,
+	PULONG Token
+)
+{
+	return this->AcquireSecondary(Target, Owner, TokenRoleWriter, Writer, Token);
+}
+
+NTSTATUS ViGEm::Bus::Core::TargetTokenTable::AcquireSubscriber(
+	EmulationTargetPDO* Target,
+	WDFFILEOBJECT Owner,
+	ULONG Subscriber,
+	PULONG Token
+)
+{
+	return this->AcquireSecondary(Target, Owner, TokenRoleSubscriber, Subscriber, Token);
+}
+
+NTSTATUS ViGEm::Bus::Core::TargetTokenTable::AcquireSecondary(
+	EmulationTargetPDO* Target,
+	WDFFILEOBJECT Owner,
+	TOKEN_ROLE Role,
+	ULONG RoleIndex,
+	PULONG Token
+)
+{
+	if (RoleIndex > MAXUCHAR)
+		return STATUS_INVALID_PARAMETER;
+
+	const KIRQL irql = ExAcquireSpinLockExclusive(&this->_Lock);
+
+	//
+	// Not stored in the target, that one belongs to the owner
+	// 
+	const auto issued = this->_Slots.Issue(Target, Owner, static_cast<UCHAR>(Role), static_cast<UCHAR>(RoleIndex), Token);
+
+	ExReleaseSpinLockExclusive(&this->_Lock, irql);
+
+	return issued ? STATUS_SUCCESS : STATUS_INSUFFICIENT_RESOURCES;
+}
+
+ViGEm::Bus::Core::EmulationTargetPDO* ViGEm::Bus::Core::TargetTokenTable::LookupWriter(
+	ULONG Token,
+	WDFFILEOBJECT Owner,
+	PULONG Writer
+)
+{
+	*Writer = 0;
+
+	//
+	// The owner submits as writer 0
+	// 
+	return this->LookupReferenced(
+		Token,
+		Owner,
+		SLOTS::RoleMask(TokenRoleOwner) | SLOTS::RoleMask(TokenRoleWriter),
+		Writer
+	);
+}
+
+ViGEm::Bus::Core::EmulationTargetPDO* ViGEm::Bus::Core::TargetTokenTable::LookupSubscriber(
+	ULONG Token,
+	WDFFILEOBJECT Owner,
+	PULONG Subscriber
+)
+{
+	*Subscriber = 0;
+
+	return this->LookupReferenced(Token, Owner, SLOTS::RoleMask(TokenRoleSubscriber), Subscriber);
+}
+
+VOID ViGEm::Bus::Core::TargetTokenTable::Dereference(EmulationTargetPDO* Target)
+{
+	Target->Dereference();
+}
+
+VOID ViGEm::Bus::Core::TargetTokenTable::Release(EmulationTargetPDO* Target)
+{
+	const ULONG token = Target->GetToken();
+
+	if (token == 0)
+		return;
+
+	const KIRQL irql = ExAcquireSpinLockExclusive(&this->_Lock);
+
+	//
+	// Slot might have been recycled already (owner closed handle)
+	// 
+	this->_Slots.RevokeIssued(token, Target, SLOTS::RoleMask(TokenRoleOwner));
+
+	Target->SetToken(0);
+
+	ExReleaseSpinLockExclusive(&this->_Lock, irql);
+}
+
+VOID ViGEm::Bus::Core::TargetTokenTable::ReleaseSecondary(ULONG Token, WDFFILEOBJECT Owner)
+{
+	const KIRQL irql = ExAcquireSpinLockExclusive(&this->_Lock);
+
+	if (this->_Slots.Resolve(
+		Token,
+		Owner,
+		SLOTS::RoleMask(TokenRoleWriter) | SLOTS::RoleMask(TokenRoleSubscriber),
+		nullptr
+	))
+	{
+		this->_Slots.Revoke(Token);
+	}
+
+	ExReleaseSpinLockExclusive(&this->_Lock, irql);
+}
+
+VOID ViGEm::Bus::Core::TargetTokenTable::ReleaseSecondaries(EmulationTargetPDO* Target)
+{
+	const KIRQL irql = ExAcquireSpinLockExclusive(&this->_Lock);
+
+	this->_Slots.RevokeTarget(Target, SLOTS::RoleMask(TokenRoleWriter) | SLOTS::RoleMask(TokenRoleSubscriber));
+
+	ExReleaseSpinLockExclusive(&this->_Lock, irql);
+}
+
+VOID ViGEm::Bus::Core::TargetTokenTable::ReleaseWriters(EmulationTargetPDO* Target)
+{
+	const KIRQL irql = ExAcquireSpinLockExclusive(&this->_Lock);
+
+	this->_Slots.RevokeTarget(Target, SLOTS::RoleMask(TokenRoleWriter));
+
+	ExReleaseSpinLockExclusive(&this->_Lock, irql);
+}
+
+VOID ViGEm::Bus::Core::TargetTokenTable::ReleaseByOwner(WDFFILEOBJECT Owner)
+{
+	const KIRQL irql = ExAcquireSpinLockExclusive(&this->_Lock);
+
+	this->_Slots.RevokeOwner(Owner);
+
+	ExReleaseSpinLockExclusive(&this->_Lock, irql);
+}
@@ -0,0 +1,154 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include <ntddk.h>
+#include <wdf.h>
+
+#include "TokenSlotTable.hpp"
+
+namespace ViGEm::Bus::Core
+{
+	class EmulationTargetPDO;
+
+	//
+	// Hands out opaque target handles (slot index + generation) bound to a file object
+	// 
+	class TargetTokenTable
+	{
+	public:
+		//
+		// Upper limit of simultaneously issued tokens
+		// 
+		static const USHORT MAX_TOKENS = 0x0200;
+
+		VOID Initialize();
+
+		NTSTATUS Acquire(
+			_In_ EmulationTargetPDO* Target,
+			_In_ WDFFILEOBJECT Owner,
+			_Out_ PULONG Token
+		);
+
+		NTSTATUS AcquireWriter(
+			_In_ EmulationTargetPDO* Target,
+			_In_ WDFFILEOBJECT Owner,
+			_In_ ULONG Writer,
+			_Out_ PULONG Token
+		);
+
+		NTSTATUS AcquireSubscriber(
+			_In_ EmulationTargetPDO* Target,
+			_In_ WDFFILEOBJECT Owner,
+			_In_ ULONG Subscriber,
+			_Out_ PULONG Token
+		);
+
+		//
+		// Lookups return the target referenced, release it with Dereference
+		// 
+		EmulationTargetPDO* Lookup(
+			_In_ ULONG Token,
+			_In_ WDFFILEOBJECT Owner
+		);
+
+		EmulationTargetPDO* LookupWriter(
+			_In_ ULONG Token,
+			_In_ WDFFILEOBJECT Owner,
+			_Out_ PULONG Writer
+		);
+
+		EmulationTargetPDO* LookupSubscriber(
+			_In_ ULONG Token,
+			_In_ WDFFILEOBJECT Owner,
+			_Out_ PULONG Subscriber
+		);
+
+		static VOID Dereference(_In_ EmulationTargetPDO* Target);
+
+		VOID Release(_In_ EmulationTargetPDO* Target);
+
+		VOID ReleaseSecondary(_In_ ULONG Token, _In_ WDFFILEOBJECT Owner);
+
+		VOID ReleaseSecondaries(_In_ EmulationTargetPDO* Target);
+
+		VOID ReleaseWriters(_In_ EmulationTargetPDO* Target);
+
+		VOID ReleaseByOwner(_In_ WDFFILEOBJECT Owner);
+
+	private:
+		typedef enum _TOKEN_ROLE
+		{
+			//
+			// Full control over the target
+			// 
+			TokenRoleOwner = 0,
+			//
+			// Submitting reports only
+			// 
+			TokenRoleWriter,
+			//
+			// Receiving notifications only
+			// 
+			TokenRoleSubscriber
+
+		} TOKEN_ROLE;
+
+		typedef TokenSlotTable<EmulationTargetPDO, WDFFILEOBJECT, MAX_TOKENS> SLOTS;
+
+		NTSTATUS AcquireSecondary(
+			EmulationTargetPDO* Target,
+			WDFFILEOBJECT Owner,
+			TOKEN_ROLE Role,
+			ULONG RoleIndex,
+			PULONG Token
+		);
+
+		EmulationTargetPDO* LookupReferenced(
+			ULONG Token,
+			WDFFILEOBJECT Owner,
+			ULONG Roles,
+			PULONG RoleIndex
+		);
+
+		//
+		// Shared for lookups, exclusive for modifications
+		// 
+		EX_SPIN_LOCK _Lock;
+
+		SLOTS _Slots;
+	};
+}
@@ -0,0 +1,265 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+namespace ViGEm::Bus::Core
+{
+	//
+	// Issues opaque tokens (slot index + generation) resolving to a target for one 
+	// owner; never allocates, caller provides locking
+	// 
+	template <typename TTarget, typename TOwner, USHORT Capacity>
+	class TokenSlotTable
+	{
+	public:
+		static_assert(Capacity > 0 && Capacity < 0xFFFF, "Capacity must fit a token index");
+
+		void Initialize()
+		{
+			for (USHORT index = 0; index < Capacity; index++)
+			{
+				this->_Slots[index].Target = nullptr;
+				this->_Slots[index].Owner = nullptr;
+				this->_Slots[index].Role = 0;
+				this->_Slots[index].RoleIndex = 0;
+				//
+				// Generation 0 is never issued so a token can't be 0
+				// 
+				this->_Slots[index].Generation = 1;
+				this->_Slots[index].NextFree = static_cast<USHORT>(index + 1);
+			}
+
+			this->_FreeHead = 0;
+		}
+
+		static constexpr ULONG MakeToken(USHORT Index, USHORT Generation)
+		{
+			return (static_cast<ULONG>(Generation) << 16) | Index;
+		}
+
+		static constexpr USHORT TokenIndex(ULONG Token)
+		{
+			return static_cast<USHORT>(Token & 0xFFFF);
+		}
+
+		static constexpr USHORT TokenGeneration(ULONG Token)
+		{
+			return static_cast<USHORT>(Token >> 16);
+		}
+
+		static constexpr ULONG RoleMask(UCHAR Role)
+		{
+			return 1UL << Role;
+		}
+
+		bool Issue(TTarget* Target, TOwner Owner, UCHAR Role, UCHAR RoleIndex, PULONG Token)
+		{
+			if (this->_FreeHead >= Capacity)
+				return false;
+
+			const USHORT index = this->_FreeHead;
+			auto& slot = this->_Slots[index];
+
+			this->_FreeHead = slot.NextFree;
+
+			slot.Target = Target;
+			slot.Owner = Owner;
+			slot.Role = Role;
+			slot.RoleIndex = RoleIndex;
+
+			*Token = MakeToken(index, slot.Generation);
+
+			return true;
+		}
+
+		//
+		// Returns the target if Token is current, issued to Owner and its role is in RoleMask
+		// 
+		TTarget* Resolve(ULONG Token, TOwner Owner, ULONG Roles, PULONG RoleIndex) const
+		{
+			const auto slot = this->Find(Token);
+
+			if (!slot || slot->Owner != Owner || !(Roles & RoleMask(slot->Role)))
+				return nullptr;
+
+			if (RoleIndex)
+				*RoleIndex = slot->RoleIndex;
+
+			return slot->Target;
+		}
+
+		//
+		// Whether Token is current and was issued for exactly this target, owner and role
+		// 
+		bool IsIssued(ULONG Token, const TTarget* Target, TOwner Owner, UCHAR Role) const
+		{
+			const auto slot = this->Find(Token);
+
+			return slot && slot->Target == Target && slot->Owner == Owner && slot->Role == Role;
+		}
+
+		bool Revoke(ULONG Token)
+		{
+			if (!this->Find(Token))
+				return false;
+
+			this->Free(TokenIndex(Token));
+
+			return true;
+		}
+
+		//
+		// Revokes Token only if it is current for Target with a role in Roles
+		// 
+		bool RevokeIssued(ULONG Token, const TTarget* Target, ULONG Roles)
+		{
+			const auto slot = this->Find(Token);
+
+			if (!slot || slot->Target != Target || !(Roles & RoleMask(slot->Role)))
+				return false;
+
+			this->Free(TokenIndex(Token));
+
+			return true;
+		}
+
+		//
+		// Revokes every token of Target whose role is in Roles
+		// 
+		ULONG RevokeTarget(const TTarget* Target, ULONG Roles)
+		{
+			ULONG count = 0;
+
+			for (USHORT index = 0; index < Capacity; index++)
+			{
+				if (this->_Slots[index].Target == Target && (Roles & RoleMask(this->_Slots[index].Role)))
+				{
+					this->Free(index);
+					count++;
+				}
+			}
+
+			return count;
+		}
+
+		ULONG RevokeOwner(TOwner Owner)
+		{
+			ULONG count = 0;
+
+			for (USHORT index = 0; index < Capacity; index++)
+			{
+				if (this->_Slots[index].Target != nullptr && this->_Slots[index].Owner == Owner)
+				{
+					this->Free(index);
+					count++;
+				}
+			}
+
+			return count;
+		}
+
+	private:
+		struct Slot
+		{
+			//
+			// Target this slot resolves to, NULL if free
+			// 
+			TTarget* Target;
+
+			//
+			// Owner the token has been issued to
+			// 
+			TOwner Owner;
+
+			//
+			// Bumped on every release so stale tokens never match again
+			// 
+			USHORT Generation;
+
+			//
+			// Next entry in the free list
+			// 
+			USHORT NextFree;
+
+			//
+			// What the token grants, meaning defined by the user of the table
+			// 
+			UCHAR Role;
+
+			//
+			// Role specific slot, e.g. an input fusion writer
+			// 
+			UCHAR RoleIndex;
+		};
+
+		const Slot* Find(ULONG Token) const
+		{
+			const USHORT index = TokenIndex(Token);
+
+			if (index >= Capacity
+				|| this->_Slots[index].Target == nullptr
+				|| this->_Slots[index].Generation != TokenGeneration(Token))
+				return nullptr;
+
+			return &this->_Slots[index];
+		}
+
+		void Free(USHORT Index)
+		{
+			auto& slot = this->_Slots[Index];
+
+			slot.Target = nullptr;
+			slot.Owner = nullptr;
+			slot.Role = 0;
+			slot.RoleIndex = 0;
+
+			//
+			// Invalidate every token issued for this slot so far
+			// 
+			if (++slot.Generation == 0)
+				slot.Generation = 1;
+
+			slot.NextFree = this->_FreeHead;
+			this->_FreeHead = Index;
+		}
+
+		//
+		// Head of the free slot list (Capacity if exhausted)
+		// 
+		USHORT _FreeHead{};
+
+		Slot _Slots[Capacity];
+	};
+}
@@ -0,0 +1,227 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+namespace ViGEm::Bus::Core
+{
+	constexpr UCHAR USB_DESCRIPTOR_TYPE_CONFIGURATION = 0x02;
+
+	constexpr UCHAR USB_DESCRIPTOR_TYPE_STRING = 0x03;
+
+	constexpr UCHAR USB_DESCRIPTOR_TYPE_INTERFACE = 0x04;
+
+	constexpr UCHAR USB_DESCRIPTOR_TYPE_ENDPOINT = 0x05;
+
+	constexpr UCHAR USB_DESCRIPTOR_TYPE_HID = 0x21;
+
+	constexpr UCHAR USB_DESCRIPTOR_TYPE_HID_REPORT = 0x22;
+
+	constexpr UCHAR USB_ENDPOINT_TRANSFER_TYPE_MASK = 0x03;
+
+	constexpr UCHAR USB_ENDPOINT_TRANSFER_TYPE_INTERRUPT = 0x03;
+
+	//
+	// Walks a configuration descriptor blob and overwrites bInterval of every 
+	// interrupt endpoint. Returns the number of patched endpoints.
+	// 
+	constexpr ULONG usb_patch_interrupt_intervals(UCHAR* Descriptor, ULONG Length, UCHAR Interval)
+	{
+		ULONG patched = 0;
+
+		for (ULONG offset = 0; offset + 1 < Length;)
+		{
+			const UCHAR bLength = Descriptor[offset];
+
+			// Malformed or truncated, stop here
+			if (bLength < 2 || offset + bLength > Length)
+				break;
+
+			if (Descriptor[offset + 1] == USB_DESCRIPTOR_TYPE_ENDPOINT && bLength >= 7
+				&& (Descriptor[offset + 3] & USB_ENDPOINT_TRANSFER_TYPE_MASK) == USB_ENDPOINT_TRANSFER_TYPE_INTERRUPT)
+			{
+				Descriptor[offset + 6] = Interval;
+				patched++;
+			}
+
+			offset += bLength;
+		}
+
+		return patched;
+	}
+
+	//
+	// Read-only descriptor blob with its size known at compile time
+	// 
+	template <size_t N>
+	struct UsbDescriptorTable
+	{
+		UCHAR Data[N];
+
+		static constexpr ULONG Size = N;
+	};
+
+	//
+	// Builds a string descriptor (UTF-16LE) from a plain ASCII literal at compile time
+	// 
+	template <size_t N>
+	constexpr UsbDescriptorTable<2 + (N - 1) * 2> usb_make_string_descriptor(const char (&String)[N])
+	{
+		static_assert(2 + (N - 1) * 2 <= 0xFF, "String descriptor too long");
+
+		UsbDescriptorTable<2 + (N - 1) * 2> table{};
+
+		table.Data[0] = static_cast<UCHAR>(table.Size);
+		table.Data[1] = USB_DESCRIPTOR_TYPE_STRING;
+
+		for (size_t i = 0; i < N - 1; i++)
+		{
+			table.Data[2 + i * 2] = static_cast<UCHAR>(String[i]);
+			table.Data[3 + i * 2] = 0x00;
+		}
+
+		return table;
+	}
+
+	//
+	// String descriptor zero, "American English" is the only supported language
+	// 
+	constexpr UCHAR UsbLanguageIdDescriptor[] =
+	{
+		0x04, USB_DESCRIPTOR_TYPE_STRING, 0x09, 0x04
+	};
+
+	//
+	// Checks that a configuration descriptor blob is well-formed: wTotalLength 
+	// matches, the descriptor chain exactly covers the blob and the interface 
+	// and endpoint counts agree with what follows them.
+	// 
+	constexpr bool usb_is_valid_configuration_descriptor(const UCHAR* Descriptor, ULONG Length)
+	{
+		if (Length < 9 || Descriptor[0] != 9 || Descriptor[1] != USB_DESCRIPTOR_TYPE_CONFIGURATION)
+			return false;
+
+		if (static_cast<ULONG>(Descriptor[2] | (Descriptor[3] << 8)) != Length)
+			return false;
+
+		ULONG interfaces = 0;
+		ULONG endpoints = 0;
+		ULONG offset = Descriptor[0];
+
+		while (offset < Length)
+		{
+			const UCHAR bLength = Descriptor[offset];
+
+			if (bLength < 2 || offset + bLength > Length)
+				return false;
+
+			switch (Descriptor[offset + 1])
+			{
+			case USB_DESCRIPTOR_TYPE_INTERFACE:
+				// Previous interface is missing endpoints
+				if (bLength < 9 || endpoints != 0)
+					return false;
+				if (Descriptor[offset + 3] == 0)
+					interfaces++;
+				endpoints = Descriptor[offset + 4];
+				break;
+			case USB_DESCRIPTOR_TYPE_ENDPOINT:
+				if (bLength < 7 || endpoints == 0)
+					return false;
+				endpoints--;
+				break;
+			default:
+				break;
+			}
+
+			offset += bLength;
+		}
+
+		return endpoints == 0 && interfaces == Descriptor[4];
+	}
+
+	//
+	// Returns wDescriptorLength of the first HID report descriptor referenced 
+	// in a configuration descriptor blob, zero if there is none.
+	// 
+	constexpr ULONG usb_hid_report_descriptor_length(const UCHAR* Descriptor, ULONG Length)
+	{
+		for (ULONG offset = 0; offset + 1 < Length;)
+		{
+			const UCHAR bLength = Descriptor[offset];
+
+			if (bLength < 2 || offset + bLength > Length)
+				break;
+
+			if (Descriptor[offset + 1] == USB_DESCRIPTOR_TYPE_HID && bLength >= 9)
+			{
+				for (ULONG entry = offset + 6; entry + 2 < offset + bLength; entry += 3)
+				{
+					if (Descriptor[entry] == USB_DESCRIPTOR_TYPE_HID_REPORT)
+						return Descriptor[entry + 1] | (Descriptor[entry + 2] << 8);
+				}
+			}
+
+			offset += bLength;
+		}
+
+		return 0;
+	}
+
+	namespace Detail
+	{
+		constexpr bool usb_patch_interrupt_intervals_check()
+		{
+			UCHAR descriptor[] =
+			{
+				0x09, 0x02, 0x20, 0x00, 0x01, 0x01, 0x00, 0xA0, 0xFA, // Configuration
+				0x09, 0x04, 0x00, 0x00, 0x02, 0xFF, 0x5D, 0x01, 0x00, // Interface
+				0x07, 0x05, 0x81, 0x03, 0x20, 0x00, 0x04,             // Interrupt IN
+				0x07, 0x05, 0x02, 0x02, 0x20, 0x00, 0x00,             // Bulk OUT
+			};
+
+			const auto patched = usb_patch_interrupt_intervals(descriptor, sizeof(descriptor), 0x01);
+
+			return patched == 1 && descriptor[24] == 0x01 && descriptor[31] == 0x00;
+		}
+
+		static_assert(usb_patch_interrupt_intervals_check(), "usb_patch_interrupt_intervals is broken");
+
+		static_assert(usb_make_string_descriptor("AB").Size == 6
+			&& usb_make_string_descriptor("AB").Data[0] == 6
+			&& usb_make_string_descriptor("AB").Data[4] == 'B',
+			"usb_make_string_descriptor is broken");
+	}
+}
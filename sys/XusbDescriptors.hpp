@@ -0,0 +1,182 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+namespace ViGEm::Bus::Targets
+{
+	//
+	// USB descriptors of the emulated Xbox 360 wired controller
+	// 
+	constexpr UCHAR XusbDescriptorData[] =
+	{
+		0x09,        //   bLength
+		0x02,        //   bDescriptorType (Configuration)
+		0x99, 0x00,  //   wTotalLength 153
+		0x04,        //   bNumInterfaces 4
+		0x01,        //   bConfigurationValue
+		0x00,        //   iConfiguration (String Index)
+		0xA0,        //   bmAttributes Remote Wakeup
+		0xFA,        //   bMaxPower 500mA
+
+		0x09,        //   bLength
+		0x04,        //   bDescriptorType (Interface)
+		0x00,        //   bInterfaceNumber 0
+		0x00,        //   bAlternateSetting
+		0x02,        //   bNumEndpoints 2
+		0xFF,        //   bInterfaceClass
+		0x5D,        //   bInterfaceSubClass
+		0x01,        //   bInterfaceProtocol
+		0x00,        //   iInterface (String Index)
+
+		0x11,        //   bLength
+		0x21,        //   bDescriptorType (HID)
+		0x00, 0x01,  //   bcdHID 1.00
+		0x01,        //   bCountryCode
+		0x25,        //   bNumDescriptors
+		0x81,        //   bDescriptorType[0] (Unknown 0x81)
+		0x14, 0x00,  //   wDescriptorLength[0] 20
+		0x00,        //   bDescriptorType[1] (Unknown 0x00)
+		0x00, 0x00,  //   wDescriptorLength[1] 0
+		0x13,        //   bDescriptorType[2] (Unknown 0x13)
+		0x01, 0x08,  //   wDescriptorLength[2] 2049
+		0x00,        //   bDescriptorType[3] (Unknown 0x00)
+		0x00,
+		0x07,        //   bLength
+		0x05,        //   bDescriptorType (Endpoint)
+		0x81,        //   bEndpointAddress (IN/D2H)
+		0x03,        //   bmAttributes (Interrupt)
+		0x20, 0x00,  //   wMaxPacketSize 32
+		0x04,        //   bInterval 4 (unit depends on device speed)
+
+		0x07,        //   bLength
+		0x05,        //   bDescriptorType (Endpoint)
+		0x01,        //   bEndpointAddress (OUT/H2D)
+		0x03,        //   bmAttributes (Interrupt)
+		0x20, 0x00,  //   wMaxPacketSize 32
+		0x08,        //   bInterval 8 (unit depends on device speed)
+
+		0x09,        //   bLength
+		0x04,        //   bDescriptorType (Interface)
+		0x01,        //   bInterfaceNumber 1
+		0x00,        //   bAlternateSetting
+		0x04,        //   bNumEndpoints 4
+		0xFF,        //   bInterfaceClass
+		0x5D,        //   bInterfaceSubClass
+		0x03,        //   bInterfaceProtocol
+		0x00,        //   iInterface (String Index)
+
+		0x1B,        //   bLength
+		0x21,        //   bDescriptorType (HID)
+		0x00, 0x01,  //   bcdHID 1.00
+		0x01,        //   bCountryCode
+		0x01,        //   bNumDescriptors
+		0x82,        //   bDescriptorType[0] (Unknown 0x82)
+		0x40, 0x01,  //   wDescriptorLength[0] 320
+		0x02, 0x20, 0x16, 0x83, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x16, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x07,        //   bLength
+		0x05,        //   bDescriptorType (Endpoint)
+		0x82,        //   bEndpointAddress (IN/D2H)
+		0x03,        //   bmAttributes (Interrupt)
+		0x20, 0x00,  //   wMaxPacketSize 32
+		0x02,        //   bInterval 2 (unit depends on device speed)
+
+		0x07,        //   bLength
+		0x05,        //   bDescriptorType (Endpoint)
+		0x02,        //   bEndpointAddress (OUT/H2D)
+		0x03,        //   bmAttributes (Interrupt)
+		0x20, 0x00,  //   wMaxPacketSize 32
+		0x04,        //   bInterval 4 (unit depends on device speed)
+
+		0x07,        //   bLength
+		0x05,        //   bDescriptorType (Endpoint)
+		0x83,        //   bEndpointAddress (IN/D2H)
+		0x03,        //   bmAttributes (Interrupt)
+		0x20, 0x00,  //   wMaxPacketSize 32
+		0x40,        //   bInterval 64 (unit depends on device speed)
+
+		0x07,        //   bLength
+		0x05,        //   bDescriptorType (Endpoint)
+		0x03,        //   bEndpointAddress (OUT/H2D)
+		0x03,        //   bmAttributes (Interrupt)
+		0x20, 0x00,  //   wMaxPacketSize 32
+		0x10,        //   bInterval 16 (unit depends on device speed)
+
+		0x09,        //   bLength
+		0x04,        //   bDescriptorType (Interface)
+		0x02,        //   bInterfaceNumber 2
+		0x00,        //   bAlternateSetting
+		0x01,        //   bNumEndpoints 1
+		0xFF,        //   bInterfaceClass
+		0x5D,        //   bInterfaceSubClass
+		0x02,        //   bInterfaceProtocol
+		0x00,        //   iInterface (String Index)
+
+		0x09,        //   bLength
+		0x21,        //   bDescriptorType (HID)
+		0x00, 0x01,  //   bcdHID 1.00
+		0x01,        //   bCountryCode
+		0x22,        //   bNumDescriptors
+		0x84,        //   bDescriptorType[0] (Unknown 0x84)
+		0x07, 0x00,  //   wDescriptorLength[0] 7
+
+		0x07,        //   bLength
+		0x05,        //   bDescriptorType (Endpoint)
+		0x84,        //   bEndpointAddress (IN/D2H)
+		0x03,        //   bmAttributes (Interrupt)
+		0x20, 0x00,  //   wMaxPacketSize 32
+		0x10,        //   bInterval 16 (unit depends on device speed)
+
+		0x09,        //   bLength
+		0x04,        //   bDescriptorType (Interface)
+		0x03,        //   bInterfaceNumber 3
+		0x00,        //   bAlternateSetting
+		0x00,        //   bNumEndpoints 0
+		0xFF,        //   bInterfaceClass
+		0xFD,        //   bInterfaceSubClass
+		0x13,        //   bInterfaceProtocol
+		0x04,        //   iInterface (String Index)
+
+		0x06,        //   bLength
+		0x41,        //   bDescriptorType (Unknown)
+		0x00, 0x01, 0x01, 0x03,
+		// 153 bytes
+
+		// best guess: USB Standard Descriptor
+	};
+
+	static_assert(ViGEm::Bus::Core::usb_is_valid_configuration_descriptor(XusbDescriptorData, sizeof(XusbDescriptorData)),
+		"Malformed XUSB configuration descriptor");
+}
@@ -0,0 +1,91 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+namespace ViGEm::Bus::Targets
+{
+	//
+	// Packet sent on the data pipe during the "boot sequence"
+	// 
+	typedef struct _XUSB_INIT_STAGE
+	{
+		const UCHAR* Data;
+
+		ULONG Length;
+	} XUSB_INIT_STAGE;
+
+	constexpr UCHAR XusbInitStage0[] = { 0x01, 0x03, 0x0E };
+	constexpr UCHAR XusbInitStage1[] = { 0x02, 0x03, 0x00 };
+	constexpr UCHAR XusbInitStage2[] = { 0x03, 0x03, 0x03 };
+	constexpr UCHAR XusbInitStage3[] = { 0x08, 0x03, 0x00 };
+	constexpr UCHAR XusbInitStage4[] =
+	{
+		0x00, 0x14, 0x00, 0x00, 0x00, 0x00, 0xe4, 0xf2,
+		0xb3, 0xf8, 0x49, 0xf3, 0xb0, 0xfc, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00
+	};
+	constexpr UCHAR XusbInitStage5[] = { 0x01, 0x03, 0x03 };
+
+	//
+	// Stage 4 is served as an input packet: Id and Size followed by the report
+	// 
+	constexpr ULONG XusbInitPacketSize = 2 + sizeof(XUSB_REPORT);
+
+	static_assert(XusbInitPacketSize <= sizeof(XusbInitStage4),
+		"XUSB init stage 4 shorter than an input packet");
+
+	//
+	// Served in order on the data pipe before the first input report
+	// 
+	constexpr XUSB_INIT_STAGE XusbInitSequence[] =
+	{
+		{ XusbInitStage0, sizeof(XusbInitStage0) },
+		{ XusbInitStage1, sizeof(XusbInitStage1) },
+		{ XusbInitStage2, sizeof(XusbInitStage2) },
+		{ XusbInitStage3, sizeof(XusbInitStage3) },
+		{ XusbInitStage4, XusbInitPacketSize },
+		{ XusbInitStage5, sizeof(XusbInitStage5) },
+	};
+
+	//
+	// Required for XInputGetCapabilities to work
+	// 
+	constexpr UCHAR XusbCapabilities[] = { 0x05, 0x03, 0x00 };
+
+	//
+	// Xenon magic
+	// 
+	constexpr UCHAR XusbXenonMagic[] = { 0x31, 0x3F, 0xCF, 0xDC };
+}
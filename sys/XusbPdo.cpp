@@ -34,6 +34,8 @@
 
 #include "Driver.h"
 #include "XusbPdo.hpp"
+#include "XusbDescriptors.hpp"
+#include "XusbInitSequence.hpp"
 #include "trace.h"
 #include "XusbPdo.tmh"
 #define NTSTRSAFE_LIB
@@ -46,6 +48,16 @@
 #include "Debugging.hpp"
 
 
+#pragma region Init sequence checks
+
+static_assert(sizeof(ViGEm::Bus::Targets::XUSB_INTERRUPT_IN_PACKET) == ViGEm::Bus::Targets::XusbInitPacketSize,
+	"XUSB init packet size out of sync with the input packet");
+
+static_assert(ARRAYSIZE(ViGEm::Bus::Targets::XusbInitSequence) == VigemBootPhaseInitStage5 - VigemBootPhaseInitStage0 + 1,
+	"Every XUSB init stage needs a boot phase");
+
+#pragma endregion
+
 PCWSTR ViGEm::Bus::Targets::EmulationTargetXUSB::_deviceDescription = L"Virtual Xbox 360 Controller";
 
 ViGEm::Bus::Targets::EmulationTargetXUSB::EmulationTargetXUSB(ULONG Serial, LONG SessionId, USHORT VendorId,
@@ -53,7 +65,8 @@ ViGEm::Bus::Targets::EmulationTargetXUSB::EmulationTargetXUSB(ULONG Serial, LONG
 		Serial, SessionId, VendorId, ProductId)
 {
 	this->_TargetType = Xbox360Wired;
-	this->_UsbConfigurationDescriptionSize = XUSB_DESCRIPTOR_SIZE;
+	this->_UsbConfigurationDescriptionSize = sizeof(XusbDescriptorData);
+	this->_ObjectSize = sizeof(EmulationTargetXUSB);
 
 	//
 	// Set PNP Capabilities
@@ -209,12 +222,6 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::PdoPrepareHardware()
 
 NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::PdoInitContext()
 {
-	WDF_OBJECT_ATTRIBUTES attributes;
-	PUCHAR blobBuffer;
-
-	WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
-	attributes.ParentObject = this->_PdoDevice;
-
 	TraceEvents(TRACE_LEVEL_VERBOSE, TRACE_XUSB, "Initializing XUSB context...");
 
 	RtlZeroMemory(this->_Rumble, ARRAYSIZE(this->_Rumble));
@@ -230,53 +237,13 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::PdoInitContext()
 
 	this->_InterruptInitStage = 0;
 
-	// Allocate blob storage
-	NTSTATUS status = WdfMemoryCreate(
-		&attributes,
-		NonPagedPoolNx,
-		XUSB_POOL_TAG,
-		XUSB_BLOB_STORAGE_SIZE,
-		&this->_InterruptBlobStorage,
-		reinterpret_cast<PVOID*>(&blobBuffer)
-	);
-	if (!NT_SUCCESS(status))
-	{
-		TraceEvents(TRACE_LEVEL_ERROR,
-			TRACE_XUSB,
-			"WdfMemoryCreate failed with status %!STATUS!",
-			status);
-		return status;
-	}
-
-	// Fill blob storage
-	COPY_BYTE_ARRAY(blobBuffer, P99_PROTECT({
-		// 0
-		0x01, 0x03, 0x0E,
-		// 1
-		0x02, 0x03, 0x00,
-		// 2
-		0x03, 0x03, 0x03,
-		// 3
-		0x08, 0x03, 0x00,
-		// 4
-		0x00, 0x14, 0x00, 0x00, 0x00, 0x00, 0xe4, 0xf2,
-		0xb3, 0xf8, 0x49, 0xf3, 0xb0, 0xfc, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00,
-		// 5
-		0x01, 0x03, 0x03,
-		// 6
-		0x05, 0x03, 0x00,
-		// 7
-		0x31, 0x3F, 0xCF, 0xDC
-		}));
-
 	// I/O Queue for pending IRPs
 	WDF_IO_QUEUE_CONFIG holdingInQueueConfig;
 
 	// Create and assign queue for unhandled interrupt requests
 	WDF_IO_QUEUE_CONFIG_INIT(&holdingInQueueConfig, WdfIoQueueDispatchManual);
 
-	status = WdfIoQueueCreate(
+	NTSTATUS status = WdfIoQueueCreate(
 		this->_PdoDevice,
 		&holdingInQueueConfig,
 		WDF_NO_OBJECT_ATTRIBUTES,
@@ -296,144 +263,12 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::PdoInitContext()
 
 VOID ViGEm::Bus::Targets::EmulationTargetXUSB::GetConfigurationDescriptorType(PUCHAR Buffer, ULONG Length)
 {
-	UCHAR XusbDescriptorData[XUSB_DESCRIPTOR_SIZE] =
-	{
-		0x09,        //   bLength
-		0x02,        //   bDescriptorType (Configuration)
-		0x99, 0x00,  //   wTotalLength 153
-		0x04,        //   bNumInterfaces 4
-		0x01,        //   bConfigurationValue
-		0x00,        //   iConfiguration (String Index)
-		0xA0,        //   bmAttributes Remote Wakeup
-		0xFA,        //   bMaxPower 500mA
-
-		0x09,        //   bLength
-		0x04,        //   bDescriptorType (Interface)
-		0x00,        //   bInterfaceNumber 0
-		0x00,        //   bAlternateSetting
-		0x02,        //   bNumEndpoints 2
-		0xFF,        //   bInterfaceClass
-		0x5D,        //   bInterfaceSubClass
-		0x01,        //   bInterfaceProtocol
-		0x00,        //   iInterface (String Index)
-
-		0x11,        //   bLength
-		0x21,        //   bDescriptorType (HID)
-		0x00, 0x01,  //   bcdHID 1.00
-		0x01,        //   bCountryCode
-		0x25,        //   bNumDescriptors
-		0x81,        //   bDescriptorType[0] (Unknown 0x81)
-		0x14, 0x00,  //   wDescriptorLength[0] 20
-		0x00,        //   bDescriptorType[1] (Unknown 0x00)
-		0x00, 0x00,  //   wDescriptorLength[1] 0
-		0x13,        //   bDescriptorType[2] (Unknown 0x13)
-		0x01, 0x08,  //   wDescriptorLength[2] 2049
-		0x00,        //   bDescriptorType[3] (Unknown 0x00)
-		0x00,
-		0x07,        //   bLength
-		0x05,        //   bDescriptorType (Endpoint)
-		0x81,        //   bEndpointAddress (IN/D2H)
-		0x03,        //   bmAttributes (Interrupt)
-		0x20, 0x00,  //   wMaxPacketSize 32
-		0x04,        //   bInterval 4 (unit depends on device speed)
-
-		0x07,        //   bLength
-		0x05,        //   bDescriptorType (Endpoint)
-		0x01,        //   bEndpointAddress (OUT/H2D)
-		0x03,        //   bmAttributes (Interrupt)
-		0x20, 0x00,  //   wMaxPacketSize 32
-		0x08,        //   bInterval 8 (unit depends on device speed)
-
-		0x09,        //   bLength
-		0x04,        //   bDescriptorType (Interface)
-		0x01,        //   bInterfaceNumber 1
-		0x00,        //   bAlternateSetting
-		0x04,        //   bNumEndpoints 4
-		0xFF,        //   bInterfaceClass
-		0x5D,        //   bInterfaceSubClass
-		0x03,        //   bInterfaceProtocol
-		0x00,        //   iInterface (String Index)
-
-		0x1B,        //   bLength
-		0x21,        //   bDescriptorType (HID)
-		0x00, 0x01,  //   bcdHID 1.00
-		0x01,        //   bCountryCode
-		0x01,        //   bNumDescriptors
-		0x82,        //   bDescriptorType[0] (Unknown 0x82)
-		0x40, 0x01,  //   wDescriptorLength[0] 320
-		0x02, 0x20, 0x16, 0x83, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x16, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x07,        //   bLength
-		0x05,        //   bDescriptorType (Endpoint)
-		0x82,        //   bEndpointAddress (IN/D2H)
-		0x03,        //   bmAttributes (Interrupt)
-		0x20, 0x00,  //   wMaxPacketSize 32
-		0x02,        //   bInterval 2 (unit depends on device speed)
-
-		0x07,        //   bLength
-		0x05,        //   bDescriptorType (Endpoint)
-		0x02,        //   bEndpointAddress (OUT/H2D)
-		0x03,        //   bmAttributes (Interrupt)
-		0x20, 0x00,  //   wMaxPacketSize 32
-		0x04,        //   bInterval 4 (unit depends on device speed)
-
-		0x07,        //   bLength
-		0x05,        //   bDescriptorType (Endpoint)
-		0x83,        //   bEndpointAddress (IN/D2H)
-		0x03,        //   bmAttributes (Interrupt)
-		0x20, 0x00,  //   wMaxPacketSize 32
-		0x40,        //   bInterval 64 (unit depends on device speed)
-
-		0x07,        //   bLength
-		0x05,        //   bDescriptorType (Endpoint)
-		0x03,        //   bEndpointAddress (OUT/H2D)
-		0x03,        //   bmAttributes (Interrupt)
-		0x20, 0x00,  //   wMaxPacketSize 32
-		0x10,        //   bInterval 16 (unit depends on device speed)
-
-		0x09,        //   bLength
-		0x04,        //   bDescriptorType (Interface)
-		0x02,        //   bInterfaceNumber 2
-		0x00,        //   bAlternateSetting
-		0x01,        //   bNumEndpoints 1
-		0xFF,        //   bInterfaceClass
-		0x5D,        //   bInterfaceSubClass
-		0x02,        //   bInterfaceProtocol
-		0x00,        //   iInterface (String Index)
-
-		0x09,        //   bLength
-		0x21,        //   bDescriptorType (HID)
-		0x00, 0x01,  //   bcdHID 1.00
-		0x01,        //   bCountryCode
-		0x22,        //   bNumDescriptors
-		0x84,        //   bDescriptorType[0] (Unknown 0x84)
-		0x07, 0x00,  //   wDescriptorLength[0] 7
-
-		0x07,        //   bLength
-		0x05,        //   bDescriptorType (Endpoint)
-		0x84,        //   bEndpointAddress (IN/D2H)
-		0x03,        //   bmAttributes (Interrupt)
-		0x20, 0x00,  //   wMaxPacketSize 32
-		0x10,        //   bInterval 16 (unit depends on device speed)
-
-		0x09,        //   bLength
-		0x04,        //   bDescriptorType (Interface)
-		0x03,        //   bInterfaceNumber 3
-		0x00,        //   bAlternateSetting
-		0x00,        //   bNumEndpoints 0
-		0xFF,        //   bInterfaceClass
-		0xFD,        //   bInterfaceSubClass
-		0x13,        //   bInterfaceProtocol
-		0x04,        //   iInterface (String Index)
-
-		0x06,        //   bLength
-		0x41,        //   bDescriptorType (Unknown)
-		0x00, 0x01, 0x01, 0x03,
-		// 153 bytes
-
-		// best guess: USB Standard Descriptor
-	};
-
 	RtlCopyBytes(Buffer, XusbDescriptorData, Length);
+
+	if (this->_PollingInterval)
+	{
+		Core::usb_patch_interrupt_intervals(Buffer, Length, this->_PollingInterval);
+	}
 }
 
 NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::UsbGetDeviceDescriptorType(PUSB_DEVICE_DESCRIPTOR pDescriptor)
@@ -485,7 +320,7 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::SelectConfiguration(PURB Urb)
 	pInfo->Pipes[0].MaximumTransferSize = 0x00400000;
 	pInfo->Pipes[0].MaximumPacketSize = 0x20;
 	pInfo->Pipes[0].EndpointAddress = 0x81;
-	pInfo->Pipes[0].Interval = 0x04;
+	pInfo->Pipes[0].Interval = this->EndpointInterval(0x04);
 	pInfo->Pipes[0].PipeType = (USBD_PIPE_TYPE)0x03;
 	pInfo->Pipes[0].PipeHandle = (USBD_PIPE_HANDLE)0xFFFF0081;
 	pInfo->Pipes[0].PipeFlags = 0x00;
@@ -493,7 +328,7 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::SelectConfiguration(PURB Urb)
 	pInfo->Pipes[1].MaximumTransferSize = 0x00400000;
 	pInfo->Pipes[1].MaximumPacketSize = 0x20;
 	pInfo->Pipes[1].EndpointAddress = 0x01;
-	pInfo->Pipes[1].Interval = 0x08;
+	pInfo->Pipes[1].Interval = this->EndpointInterval(0x08);
 	pInfo->Pipes[1].PipeType = (USBD_PIPE_TYPE)0x03;
 	pInfo->Pipes[1].PipeHandle = (USBD_PIPE_HANDLE)0xFFFF0001;
 	pInfo->Pipes[1].PipeFlags = 0x00;
@@ -517,7 +352,7 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::SelectConfiguration(PURB Urb)
 	pInfo->Pipes[0].MaximumTransferSize = 0x00400000;
 	pInfo->Pipes[0].MaximumPacketSize = 0x20;
 	pInfo->Pipes[0].EndpointAddress = 0x82;
-	pInfo->Pipes[0].Interval = 0x04;
+	pInfo->Pipes[0].Interval = this->EndpointInterval(0x04);
 	pInfo->Pipes[0].PipeType = (USBD_PIPE_TYPE)0x03;
 	pInfo->Pipes[0].PipeHandle = (USBD_PIPE_HANDLE)0xFFFF0082;
 	pInfo->Pipes[0].PipeFlags = 0x00;
@@ -525,7 +360,7 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::SelectConfiguration(PURB Urb)
 	pInfo->Pipes[1].MaximumTransferSize = 0x00400000;
 	pInfo->Pipes[1].MaximumPacketSize = 0x20;
 	pInfo->Pipes[1].EndpointAddress = 0x02;
-	pInfo->Pipes[1].Interval = 0x08;
+	pInfo->Pipes[1].Interval = this->EndpointInterval(0x08);
 	pInfo->Pipes[1].PipeType = (USBD_PIPE_TYPE)0x03;
 	pInfo->Pipes[1].PipeHandle = (USBD_PIPE_HANDLE)0xFFFF0002;
 	pInfo->Pipes[1].PipeFlags = 0x00;
@@ -533,7 +368,7 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::SelectConfiguration(PURB Urb)
 	pInfo->Pipes[2].MaximumTransferSize = 0x00400000;
 	pInfo->Pipes[2].MaximumPacketSize = 0x20;
 	pInfo->Pipes[2].EndpointAddress = 0x83;
-	pInfo->Pipes[2].Interval = 0x08;
+	pInfo->Pipes[2].Interval = this->EndpointInterval(0x08);
 	pInfo->Pipes[2].PipeType = (USBD_PIPE_TYPE)0x03;
 	pInfo->Pipes[2].PipeHandle = (USBD_PIPE_HANDLE)0xFFFF0083;
 	pInfo->Pipes[2].PipeFlags = 0x00;
@@ -541,7 +376,7 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::SelectConfiguration(PURB Urb)
 	pInfo->Pipes[3].MaximumTransferSize = 0x00400000;
 	pInfo->Pipes[3].MaximumPacketSize = 0x20;
 	pInfo->Pipes[3].EndpointAddress = 0x03;
-	pInfo->Pipes[3].Interval = 0x08;
+	pInfo->Pipes[3].Interval = this->EndpointInterval(0x08);
 	pInfo->Pipes[3].PipeType = (USBD_PIPE_TYPE)0x03;
 	pInfo->Pipes[3].PipeHandle = (USBD_PIPE_HANDLE)0xFFFF0003;
 	pInfo->Pipes[3].PipeFlags = 0x00;
@@ -565,7 +400,7 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::SelectConfiguration(PURB Urb)
 	pInfo->Pipes[0].MaximumTransferSize = 0x00400000;
 	pInfo->Pipes[0].MaximumPacketSize = 0x20;
 	pInfo->Pipes[0].EndpointAddress = 0x84;
-	pInfo->Pipes[0].Interval = 0x04;
+	pInfo->Pipes[0].Interval = this->EndpointInterval(0x04);
 	pInfo->Pipes[0].PipeType = (USBD_PIPE_TYPE)0x03;
 	pInfo->Pipes[0].PipeHandle = (USBD_PIPE_HANDLE)0xFFFF0084;
 	pInfo->Pipes[0].PipeFlags = 0x00;
@@ -638,7 +473,7 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::UsbSelectInterface(PURB Urb)
 		pInfo[0].Pipes[0].MaximumTransferSize = 0x00400000;
 		pInfo[0].Pipes[0].MaximumPacketSize = 0x20;
 		pInfo[0].Pipes[0].EndpointAddress = 0x82;
-		pInfo[0].Pipes[0].Interval = 0x04;
+		pInfo[0].Pipes[0].Interval = this->EndpointInterval(0x04);
 		pInfo[0].Pipes[0].PipeType = (USBD_PIPE_TYPE)0x03;
 		pInfo[0].Pipes[0].PipeHandle = (USBD_PIPE_HANDLE)0xFFFF0082;
 		pInfo[0].Pipes[0].PipeFlags = 0x00;
@@ -646,7 +481,7 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::UsbSelectInterface(PURB Urb)
 		pInfo[0].Pipes[1].MaximumTransferSize = 0x00400000;
 		pInfo[0].Pipes[1].MaximumPacketSize = 0x20;
 		pInfo[0].Pipes[1].EndpointAddress = 0x02;
-		pInfo[0].Pipes[1].Interval = 0x08;
+		pInfo[0].Pipes[1].Interval = this->EndpointInterval(0x08);
 		pInfo[0].Pipes[1].PipeType = (USBD_PIPE_TYPE)0x03;
 		pInfo[0].Pipes[1].PipeHandle = (USBD_PIPE_HANDLE)0xFFFF0002;
 		pInfo[0].Pipes[1].PipeFlags = 0x00;
@@ -654,7 +489,7 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::UsbSelectInterface(PURB Urb)
 		pInfo[0].Pipes[2].MaximumTransferSize = 0x00400000;
 		pInfo[0].Pipes[2].MaximumPacketSize = 0x20;
 		pInfo[0].Pipes[2].EndpointAddress = 0x83;
-		pInfo[0].Pipes[2].Interval = 0x08;
+		pInfo[0].Pipes[2].Interval = this->EndpointInterval(0x08);
 		pInfo[0].Pipes[2].PipeType = (USBD_PIPE_TYPE)0x03;
 		pInfo[0].Pipes[2].PipeHandle = (USBD_PIPE_HANDLE)0xFFFF0083;
 		pInfo[0].Pipes[2].PipeFlags = 0x00;
@@ -662,7 +497,7 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::UsbSelectInterface(PURB Urb)
 		pInfo[0].Pipes[3].MaximumTransferSize = 0x00400000;
 		pInfo[0].Pipes[3].MaximumPacketSize = 0x20;
 		pInfo[0].Pipes[3].EndpointAddress = 0x03;
-		pInfo[0].Pipes[3].Interval = 0x08;
+		pInfo[0].Pipes[3].Interval = this->EndpointInterval(0x08);
 		pInfo[0].Pipes[3].PipeType = (USBD_PIPE_TYPE)0x03;
 		pInfo[0].Pipes[3].PipeHandle = (USBD_PIPE_HANDLE)0xFFFF0003;
 		pInfo[0].Pipes[3].PipeFlags = 0x00;
@@ -682,7 +517,7 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::UsbSelectInterface(PURB Urb)
 		pInfo[0].Pipes[0].MaximumTransferSize = 0x00400000;
 		pInfo[0].Pipes[0].MaximumPacketSize = 0x20;
 		pInfo[0].Pipes[0].EndpointAddress = 0x84;
-		pInfo[0].Pipes[0].Interval = 0x04;
+		pInfo[0].Pipes[0].Interval = this->EndpointInterval(0x04);
 		pInfo[0].Pipes[0].PipeType = (USBD_PIPE_TYPE)0x03;
 		pInfo[0].Pipes[0].PipeHandle = (USBD_PIPE_HANDLE)0xFFFF0084;
 		pInfo[0].Pipes[0].PipeFlags = 0x00;
@@ -712,87 +547,79 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::UsbBulkOrInterruptTransfer(_U
 			TRACE_USBPDO,
 			">> >> >> Incoming request, queuing...");
 
-		auto blobBuffer = static_cast<PUCHAR>(WdfMemoryGetBuffer(this->_InterruptBlobStorage, nullptr));
-
 		if (xusb_is_data_pipe(pTransfer))
 		{
 			//
 			// Send "boot sequence" first, then the actual inputs
 			// 
-			switch (this->_InterruptInitStage)
+			if (this->_InterruptInitStage < ARRAYSIZE(XusbInitSequence))
 			{
-			case 0:
-				pTransfer->TransferBufferLength = XUSB_INIT_STAGE_SIZE;
-				this->_InterruptInitStage++;
-				RtlCopyMemory(
-					pTransfer->TransferBuffer,
-					&blobBuffer[XUSB_BLOB_00_OFFSET],
-					XUSB_INIT_STAGE_SIZE
-				);
-				return STATUS_SUCCESS;
-			case 1:
-				pTransfer->TransferBufferLength = XUSB_INIT_STAGE_SIZE;
-				this->_InterruptInitStage++;
-				RtlCopyMemory(
-					pTransfer->TransferBuffer,
-					&blobBuffer[XUSB_BLOB_01_OFFSET],
-					XUSB_INIT_STAGE_SIZE
-				);
-				return STATUS_SUCCESS;
-			case 2:
-				pTransfer->TransferBufferLength = XUSB_INIT_STAGE_SIZE;
-				this->_InterruptInitStage++;
-				RtlCopyMemory(
-					pTransfer->TransferBuffer,
-					&blobBuffer[XUSB_BLOB_02_OFFSET],
-					XUSB_INIT_STAGE_SIZE
-				);
-				return STATUS_SUCCESS;
-			case 3:
-				pTransfer->TransferBufferLength = XUSB_INIT_STAGE_SIZE;
-				this->_InterruptInitStage++;
-				RtlCopyMemory(
-					pTransfer->TransferBuffer,
-					&blobBuffer[XUSB_BLOB_03_OFFSET],
-					XUSB_INIT_STAGE_SIZE
-				);
-				return STATUS_SUCCESS;
-			case 4:
-				pTransfer->TransferBufferLength = sizeof(XUSB_INTERRUPT_IN_PACKET);
-				this->_InterruptInitStage++;
-				RtlCopyMemory(
-					pTransfer->TransferBuffer,
-					&blobBuffer[XUSB_BLOB_04_OFFSET],
-					sizeof(XUSB_INTERRUPT_IN_PACKET)
-				);
-				return STATUS_SUCCESS;
-			case 5:
-				pTransfer->TransferBufferLength = XUSB_INIT_STAGE_SIZE;
-				this->_InterruptInitStage++;
-				RtlCopyMemory(
-					pTransfer->TransferBuffer,
-					&blobBuffer[XUSB_BLOB_05_OFFSET],
-					XUSB_INIT_STAGE_SIZE
-				);
-				return STATUS_SUCCESS;
-			default:
-				/* This request is sent periodically and relies on data the "feeder"
-				* has to supply, so we queue this request and return with STATUS_PENDING.
-				* The request gets completed as soon as the "feeder" sent an update. */
-				status = WdfRequestForwardToIoQueue(Request, this->_PendingUsbInRequests);
+				const auto buffer = static_cast<PUCHAR>(pTransfer->TransferBuffer);
+				ULONG length = 0;
+
+				//
+				// Fast boot appends following stages while they fit the transfer buffer
+				// 
+				do
+				{
+					const auto& stage = XusbInitSequence[this->_InterruptInitStage];
+
+					if (length + stage.Length > pTransfer->TransferBufferLength)
+					{
+						if (length > 0)
+							break;
+
+						//
+						// Stage stays pending for the next transfer
+						// 
+						TraceEvents(TRACE_LEVEL_ERROR,
+						            TRACE_USBPDO,
+						            "Transfer buffer of %d bytes too small for init stage %d",
+						            pTransfer->TransferBufferLength,
+						            this->_InterruptInitStage);
+
+						pTransfer->TransferBufferLength = 0;
+
+						return STATUS_BUFFER_TOO_SMALL;
+					}
+
+					RtlCopyMemory(
+						buffer + length,
+						stage.Data,
+						stage.Length
+					);
+					length += stage.Length;
+
+					this->MarkBootPhase(static_cast<VIGEM_BOOT_PHASE>(
+						VigemBootPhaseInitStage0 + this->_InterruptInitStage++));
+				} while (this->_FastBoot && this->_InterruptInitStage < ARRAYSIZE(XusbInitSequence));
+
+				pTransfer->TransferBufferLength = length;
+
+				this->_BootTimeline.CountInitTransfer();
 
-				return (NT_SUCCESS(status)) ? STATUS_PENDING : status;
+				return STATUS_SUCCESS;
 			}
+
+			/* This request is sent periodically and relies on data the "feeder"
+			* has to supply, so we queue this request and return with STATUS_PENDING.
+			* The request gets completed as soon as the "feeder" sent an update. */
+			status = WdfRequestForwardToIoQueue(Request, this->_PendingUsbInRequests);
+
+			if (NT_SUCCESS(status))
+				this->InterruptInRequestQueued();
+
+			return (NT_SUCCESS(status)) ? STATUS_PENDING : status;
 		}
 
 		if (xusb_is_control_pipe(pTransfer))
 		{
-			if (!this->_ReportedCapabilities && pTransfer->TransferBufferLength >= XUSB_INIT_STAGE_SIZE)
+			if (!this->_ReportedCapabilities && pTransfer->TransferBufferLength >= sizeof(XusbCapabilities))
 			{
 				RtlCopyMemory(
 					pTransfer->TransferBuffer,
-					&blobBuffer[XUSB_BLOB_06_OFFSET],
-					XUSB_INIT_STAGE_SIZE
+					XusbCapabilities,
+					sizeof(XusbCapabilities)
 				);
 
 				this->_ReportedCapabilities = TRUE;
@@ -842,7 +669,7 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::UsbBulkOrInterruptTransfer(_U
 		//
 		// Notify client library that PDO is ready
 		// 
-		KeSetEvent(&this->_PdoBootNotificationEvent, 0, FALSE);
+		this->NotifyBooted();
 	}
 
 	// Extract rumble (vibration) information
@@ -867,6 +694,34 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::UsbBulkOrInterruptTransfer(_U
 
 #pragma endregion
 
+	//
+	// Games resend the same rumble values many times per second
+	// 
+	if (this->IsDuplicateOutput(pTransfer->TransferBuffer, pTransfer->TransferBufferLength))
+		return status;
+
+	//
+	// Only what somebody received may suppress the next resend
+	// 
+	bool delivered = false;
+
+	if (pTransfer->TransferBufferLength == XUSB_LEDSET_SIZE || pTransfer->TransferBufferLength == XUSB_RUMBLE_SIZE)
+	{
+		XUSB_REQUEST_NOTIFICATION subscriberNotify;
+
+		//
+		// Subscribers see the same values the owner gets notified with
+		// 
+		XUSB_REQUEST_NOTIFICATION_INIT(&subscriberNotify, this->_SerialNo);
+		subscriberNotify.LargeMotor = this->_Rumble[3];
+		subscriberNotify.SmallMotor = this->_Rumble[4];
+		subscriberNotify.LedNumber = this->_LedNumber;
+
+		delivered = this->PublishNotification(&subscriberNotify, sizeof(XUSB_REQUEST_NOTIFICATION));
+
+		this->PublishOutputState();
+	}
+
 	if (NT_SUCCESS(WdfIoQueueRetrieveNextRequest(
 		this->_PendingNotificationRequests,
 		&notifyRequest
@@ -896,6 +751,8 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::UsbBulkOrInterruptTransfer(_U
 			);
 
 			WdfRequestCompleteWithInformation(notifyRequest, status, notify->Size);
+
+			delivered = true;
 		}
 		else
 		{
@@ -905,50 +762,32 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::UsbBulkOrInterruptTransfer(_U
 			            status);
 		}
 	}
-	else
+	else if (this->QueueOutput(pTransfer->TransferBuffer, pTransfer->TransferBufferLength))
 	{
-		PVOID clientBuffer, contextBuffer;
-
-		if (NT_SUCCESS(DMF_BufferQueue_Fetch(
-			this->_UsbInterruptOutBufferQueue,
-			&clientBuffer,
-			&contextBuffer
-		)) && pTransfer->TransferBufferLength <= MAX_OUT_BUFFER_QUEUE_SIZE)
-		{
-			RtlCopyMemory(
-				clientBuffer,
-				pTransfer->TransferBuffer,
-				pTransfer->TransferBufferLength
-			);
-
-			*static_cast<size_t*>(contextBuffer) = pTransfer->TransferBufferLength;
-
-			TraceDbg(TRACE_USBPDO, "Queued %Iu bytes", pTransfer->TransferBufferLength);
-
-			DMF_BufferQueue_Enqueue(this->_UsbInterruptOutBufferQueue, clientBuffer);
-		}
+		delivered = true;
 	}
 
+	if (delivered)
+		this->RememberOutput(pTransfer->TransferBuffer, pTransfer->TransferBufferLength);
+
 	return status;
 }
 
 NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::UsbControlTransfer(PURB Urb)
 {
 	NTSTATUS status;
-	PUCHAR   blobBuffer;
 
 	switch (Urb->UrbControlTransfer.SetupPacket[6])
 	{
 	case 0x04:
 
-		blobBuffer = static_cast<PUCHAR>(WdfMemoryGetBuffer(this->_InterruptBlobStorage, nullptr));
 		//
 		// Xenon magic
 		// 
 		RtlCopyMemory(
 			Urb->UrbControlTransfer.TransferBuffer,
-			&blobBuffer[XUSB_BLOB_07_OFFSET],
-			0x04
+			XusbXenonMagic,
+			sizeof(XusbXenonMagic)
 		);
 		status = STATUS_SUCCESS;
 
@@ -975,21 +814,32 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::UsbControlTransfer(PURB Urb)
 	return status;
 }
 
-NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::SubmitReportImpl(PVOID NewReport)
+NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::SubmitReportImpl(PVOID NewReport, ULONG Writer)
 {
 	TraceDbg(TRACE_BUSENUM, "%!FUNC! Entry");
 
-	NTSTATUS    status = STATUS_SUCCESS;
-	BOOLEAN     changed;
-	WDFREQUEST  usbRequest;
+	NTSTATUS            status = STATUS_SUCCESS;
+	BOOLEAN             changed;
+	WDFREQUEST          usbRequest;
+	KIRQL               irql;
+	Core::TARGET_REPORT fused;
+	const XUSB_REPORT*  report = &static_cast<PXUSB_SUBMIT_REPORT>(NewReport)->Report;
+
+	KeAcquireSpinLock(&this->_ReportLock, &irql);
+
+	// Combine with other writers, if any
+	if (this->FuseReportLocked(Writer, report, sizeof(XUSB_REPORT), &fused))
+		report = &fused.Xusb;
 
 	changed = (RtlCompareMemory(&this->_Packet.Report,
-		&static_cast<PXUSB_SUBMIT_REPORT>(NewReport)->Report,
+		report,
 		sizeof(XUSB_REPORT)) != sizeof(XUSB_REPORT));
 
 	// Don't waste pending IRP if input hasn't changed
 	if (!changed)
 	{
+		KeReleaseSpinLock(&this->_ReportLock, irql);
+
 		TraceDbg(
 			TRACE_BUSENUM,
 			"Input report hasn't changed since last update, aborting with %!STATUS!",
@@ -1004,10 +854,35 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::SubmitReportImpl(PVOID NewRep
 	status = WdfIoQueueRetrieveNextRequest(this->_PendingUsbInRequests, &usbRequest);
 
 	if (!NT_SUCCESS(status))
+	{
+		KeReleaseSpinLock(&this->_ReportLock, irql);
 		return status;
+	}
+
+	// Copy submitted report to cache
+	RtlCopyBytes(&this->_Packet.Report, report, sizeof(XUSB_REPORT));
+	// Copy cached report to URB transfer buffer
+	this->CopyCachedReport(usbRequest);
+
+	KeReleaseSpinLock(&this->_ReportLock, irql);
+
+	// Complete pending request
+	WdfRequestComplete(usbRequest, status);
+
+	TraceDbg(TRACE_BUSENUM, "%!FUNC! Exit with status %!STATUS!", status);
+
+	return status;
+}
 
+VOID ViGEm::Bus::Targets::EmulationTargetXUSB::ApplyReport(const Core::TARGET_REPORT* Report)
+{
+	RtlCopyBytes(&this->_Packet.Report, &Report->Xusb, sizeof(XUSB_REPORT));
+}
+
+VOID ViGEm::Bus::Targets::EmulationTargetXUSB::CopyCachedReport(WDFREQUEST Request)
+{
 	// Get pending IRP
-	PIRP pendingIrp = WdfRequestWdmGetIrp(usbRequest);
+	PIRP pendingIrp = WdfRequestWdmGetIrp(Request);
 
 	// Get USB request block
 	PURB urb = static_cast<PURB>(URB_FROM_IRP(pendingIrp));
@@ -1017,17 +892,16 @@ NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::SubmitReportImpl(PVOID NewRep
 
 	urb->UrbBulkOrInterruptTransfer.TransferBufferLength = sizeof(XUSB_INTERRUPT_IN_PACKET);
 
-	// Copy submitted report to cache
-	RtlCopyBytes(&this->_Packet.Report, &(static_cast<PXUSB_SUBMIT_REPORT>(NewReport))->Report, sizeof(XUSB_REPORT));
-	// Copy cached report to URB transfer buffer
 	RtlCopyBytes(Buffer, &this->_Packet, sizeof(XUSB_INTERRUPT_IN_PACKET));
 
-	// Complete pending request
-	WdfRequestComplete(usbRequest, status);
-
-	TraceDbg(TRACE_BUSENUM, "%!FUNC! Exit with status %!STATUS!", status);
+	this->MarkBootPhase(VigemBootPhaseFirstReport);
+}
 
-	return status;
+VOID ViGEm::Bus::Targets::EmulationTargetXUSB::GetOutputState(PVIGEM_OUTPUT_STATE State)
+{
+	State->LargeMotor = this->_Rumble[3];
+	State->SmallMotor = this->_Rumble[4];
+	State->LedNumber = static_cast<UCHAR>(this->_LedNumber);
 }
 
 NTSTATUS ViGEm::Bus::Targets::EmulationTargetXUSB::GetUserIndex(PULONG UserIndex) const
@@ -60,7 +60,9 @@ namespace ViGEm::Bus::Targets
 		return (pTransfer->PipeHandle == reinterpret_cast<USBD_PIPE_HANDLE>(0xFFFF0083));
 	}
 
-	class EmulationTargetXUSB : public Core::EmulationTargetPDO
+	class EmulationTargetXUSB :
+		public Core::EmulationTargetPDO,
+		public Core::LookasideAllocated<EmulationTargetXUSB, XUSB_POOL_TAG>
 	{
 	public:
 		EmulationTargetXUSB(ULONG Serial, LONG SessionId, USHORT VendorId = 0x045E, USHORT ProductId = 0x028E);
@@ -93,12 +95,18 @@ namespace ViGEm::Bus::Targets
 		
 		NTSTATUS UsbControlTransfer(PURB Urb) override;
 		
-		NTSTATUS SubmitReportImpl(PVOID NewReport) override;
+		NTSTATUS SubmitReportImpl(PVOID NewReport, ULONG Writer) override;
 
 		NTSTATUS GetUserIndex(PULONG UserIndex) const;
 
 	protected:
 		void ProcessPendingNotification(WDFQUEUE Queue) override;
+
+		VOID ApplyReport(const Core::TARGET_REPORT* Report) override;
+
+		VOID CopyCachedReport(WDFREQUEST Request) override;
+
+		VOID GetOutputState(PVIGEM_OUTPUT_STATE State) override;
 	private:
 		static PCWSTR _deviceDescription;
 
@@ -107,21 +115,9 @@ namespace ViGEm::Bus::Targets
 #else
 		static const int XUSB_CONFIGURATION_SIZE = 0x0130;
 #endif
-		static const int XUSB_DESCRIPTOR_SIZE = 0x0099;
 		static const int XUSB_RUMBLE_SIZE = 0x08;
 		static const int XUSB_LEDSET_SIZE = 0x03;
 		static const int XUSB_LEDNUM_SIZE = 0x01;
-		static const int XUSB_INIT_STAGE_SIZE = 0x03;
-		static const int XUSB_BLOB_STORAGE_SIZE = 0x2A;
-
-		static const int XUSB_BLOB_00_OFFSET = 0x00;
-		static const int XUSB_BLOB_01_OFFSET = 0x03;
-		static const int XUSB_BLOB_02_OFFSET = 0x06;
-		static const int XUSB_BLOB_03_OFFSET = 0x09;
-		static const int XUSB_BLOB_04_OFFSET = 0x0C;
-		static const int XUSB_BLOB_05_OFFSET = 0x20;
-		static const int XUSB_BLOB_06_OFFSET = 0x23;
-		static const int XUSB_BLOB_07_OFFSET = 0x26;
 
 		//
 		// Rumble buffer
@@ -152,10 +148,5 @@ namespace ViGEm::Bus::Targets
 		// Required for XInputGetCapabilities to work
 		// 
 		ULONG _InterruptInitStage;
-
-		//
-		// Storage of binary blobs (packets) for PDO initialization
-		// 
-		WDFMEMORY _InterruptBlobStorage;
 	};
 }
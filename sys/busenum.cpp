@@ -40,18 +40,87 @@
 #include "EmulationTargetPDO.hpp"
 #include "XusbPdo.hpp"
 #include "Ds4Pdo.hpp"
+#include "ChildListBatch.hpp"
 
 #include "Debugging.hpp"
 
 #ifdef ALLOC_PRAGMA
 #pragma alloc_text (PAGE, Bus_PlugInDevice)
 #pragma alloc_text (PAGE, Bus_UnPlugDevice)
+#pragma alloc_text (PAGE, Bus_ClaimStandbyTarget)
+#pragma alloc_text (PAGE, Bus_EvtStandbyRefillWorkItem)
+#pragma alloc_text (PAGE, Bus_ReclaimLeasedTarget)
+#pragma alloc_text (PAGE, Bus_EvtLeaseExpiryTimer)
+#pragma alloc_text (PAGE, Bus_ClaimTransferredTarget)
+#pragma alloc_text (PAGE, Bus_AttachInputWriter)
+#pragma alloc_text (PAGE, Bus_SubscribeNotifications)
+#pragma alloc_text (PAGE, Bus_MapOutputState)
+#pragma alloc_text (PAGE, Bus_UnmapOutputState)
 #endif
 
 using ViGEm::Bus::Core::PDO_IDENTIFICATION_DESCRIPTION;
 using ViGEm::Bus::Core::EmulationTargetPDO;
 using ViGEm::Bus::Targets::EmulationTargetXUSB;
 using ViGEm::Bus::Targets::EmulationTargetDS4;
+using ViGEm::Bus::Core::ChildListBatch;
+
+//
+// Serial numbers handed to standby targets start here (kept below 10000
+// as the DS4 serial registry path only fits four digits)
+// 
+#define STANDBY_FIRST_SERIAL_NO     4096
+
+//
+// Claimed targets keep their pool serial, leave room for those (one bit each in a ULONG)
+// 
+#define STANDBY_SERIAL_RANGE        32
+
+//
+// Serials the configured pool keeps for its idle targets; none if the pool is disabled
+// 
+static bool Bus_IsReservedStandbySerial(PFDO_DEVICE_DATA FdoData, ULONG SerialNo)
+{
+	const auto poolSize = FdoData->StandbyXusbTargets + FdoData->StandbyDs4Targets;
+
+	return (SerialNo >= STANDBY_FIRST_SERIAL_NO && SerialNo < STANDBY_FIRST_SERIAL_NO + poolSize);
+}
+
+static bool Bus_IsSupportedTargetType(VIGEM_TARGET_TYPE Type)
+{
+	return (Type == Xbox360Wired || Type == DualShock4Wired);
+}
+
+//
+// Allocates a target object, falls back to default IDs if supplied values are invalid
+// 
+static EmulationTargetPDO* Bus_CreateTarget(
+	VIGEM_TARGET_TYPE Type,
+	ULONG SerialNo,
+	LONG SessionId,
+	USHORT VendorId,
+	USHORT ProductId
+)
+{
+	const bool useDefaultIds = (VendorId == 0 || ProductId == 0);
+
+	switch (Type)
+	{
+	case Xbox360Wired:
+
+		return useDefaultIds
+			? new EmulationTargetXUSB(SerialNo, SessionId)
+			: new EmulationTargetXUSB(SerialNo, SessionId, VendorId, ProductId);
+
+	case DualShock4Wired:
+
+		return useDefaultIds
+			? new EmulationTargetDS4(SerialNo, SessionId)
+			: new EmulationTargetDS4(SerialNo, SessionId, VendorId, ProductId);
+
+	default:
+		return nullptr;
+	}
+}
 
 //
 // Simulates a device plug-in event.
@@ -90,7 +159,11 @@ EXTERN_C NTSTATUS Bus_PlugInDevice(
 		return status;
 	}
 
-	if ((sizeof(VIGEM_PLUGIN_TARGET) != plugIn->Size) || (length != plugIn->Size))
+	//
+	// VIGEM_PLUGIN_TARGET_EX extends VIGEM_PLUGIN_TARGET, both are accepted
+	// 
+	if ((sizeof(VIGEM_PLUGIN_TARGET) != plugIn->Size && sizeof(VIGEM_PLUGIN_TARGET_EX) != plugIn->Size)
+		|| (length != plugIn->Size))
 	{
 		TraceEvents(TRACE_LEVEL_ERROR,
 			TRACE_BUSENUM,
@@ -99,6 +172,10 @@ EXTERN_C NTSTATUS Bus_PlugInDevice(
 		return STATUS_INVALID_PARAMETER;
 	}
 
+	const auto plugInEx = (plugIn->Size == sizeof(VIGEM_PLUGIN_TARGET_EX))
+		? reinterpret_cast<PVIGEM_PLUGIN_TARGET_EX>(plugIn)
+		: nullptr;
+
 	if (plugIn->SerialNo == 0)
 	{
 		TraceEvents(TRACE_LEVEL_ERROR,
@@ -107,6 +184,21 @@ EXTERN_C NTSTATUS Bus_PlugInDevice(
 		return STATUS_INVALID_PARAMETER;
 	}
 
+	//
+	// Reserved for the standby pool; reported like a serial in use so the 
+	// client library moves on to the next one. Serials of claimed pool targets
+	// beyond the pool size are simply in use, and the refill skips serials
+	// other targets took.
+	// 
+	if (Bus_IsReservedStandbySerial(FdoGetData(Device), plugIn->SerialNo))
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"Serial no. %d is reserved for standby targets",
+			plugIn->SerialNo);
+		return STATUS_INVALID_PARAMETER;
+	}
+
 	*Transferred = length;
 
 	fileObject = WdfRequestGetFileObject(Request);
@@ -138,56 +230,41 @@ EXTERN_C NTSTATUS Bus_PlugInDevice(
 	description.SerialNo = plugIn->SerialNo;
 	description.SessionId = pFileData->SessionId;
 
-	// Set default IDs if supplied values are invalid
-	if (plugIn->VendorId == 0 || plugIn->ProductId == 0)
+	if (!Bus_IsSupportedTargetType(plugIn->TargetType))
 	{
-		switch (plugIn->TargetType)
-		{
-		case Xbox360Wired:
-
-			description.Target = new EmulationTargetXUSB(plugIn->SerialNo, pFileData->SessionId);
-
-			break;
-		case DualShock4Wired:
-
-			description.Target = new EmulationTargetDS4(plugIn->SerialNo, pFileData->SessionId);
-
-			break;
-		default:
-			return STATUS_NOT_SUPPORTED;
-		}
+		return STATUS_NOT_SUPPORTED;
 	}
-	else
-	{
-		switch (plugIn->TargetType)
-		{
-		case Xbox360Wired:
-
-			description.Target = new EmulationTargetXUSB(
-				plugIn->SerialNo,
-				pFileData->SessionId,
-				plugIn->VendorId,
-				plugIn->ProductId
-			);
 
-			break;
-		case DualShock4Wired:
+	description.Target = Bus_CreateTarget(
+		plugIn->TargetType,
+		plugIn->SerialNo,
+		pFileData->SessionId,
+		plugIn->VendorId,
+		plugIn->ProductId
+	);
 
-			description.Target = new EmulationTargetDS4(
-				plugIn->SerialNo,
-				pFileData->SessionId,
-				plugIn->VendorId,
-				plugIn->ProductId
-			);
+	if (description.Target == nullptr)
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"Target object allocation failed");
+		return STATUS_INSUFFICIENT_RESOURCES;
+	}
 
-			break;
-		default:
-			return STATUS_NOT_SUPPORTED;
-		}
+	if (plugInEx)
+	{
+		description.Target->SetPollingInterval(plugInEx->PollingInterval);
+		description.Target->SetOutputBufferCount(plugInEx->OutputBufferCount);
+		description.Target->SetFastBoot((plugInEx->Flags & VIGEM_PLUGIN_FLAG_FAST_BOOT) != 0);
+		description.Target->SetKeepDuplicateOutput((plugInEx->Flags & VIGEM_PLUGIN_FLAG_KEEP_DUPLICATE_OUTPUT) != 0);
+		description.Target->SetDriverCounters((plugInEx->Flags & VIGEM_PLUGIN_FLAG_DRIVER_COUNTERS) != 0);
 	}
 
-	if (!NT_SUCCESS(description.Target->PdoPrepare(Device)))
+	status = description.Target->PdoPrepare(Device);
+
+	if (!NT_SUCCESS(status))
 	{
+		delete description.Target;
 		goto pluginEnd;
 	}
 
@@ -204,7 +281,7 @@ EXTERN_C NTSTATUS Bus_PlugInDevice(
 			"WdfChildListAddOrUpdateChildDescriptionAsPresent failed with status %!STATUS!",
 			status);
 
-		goto pluginEnd;
+		goto pluginFailed;
 	}
 
 	//
@@ -219,9 +296,19 @@ EXTERN_C NTSTATUS Bus_PlugInDevice(
 			"The described PDO already exists (%!STATUS!)",
 			status);
 
-		goto pluginEnd;
+		goto pluginFailed;
 	}
 
+	goto pluginEnd;
+
+pluginFailed:
+
+	//
+	// No PDO got created, so its cleanup callback won't free the target
+	// 
+	description.Target->PdoUnprepare();
+	delete description.Target;
+
 pluginEnd:
 
 	TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_BUSENUM, "%!FUNC! Exit with status %!STATUS!", status);
@@ -240,9 +327,6 @@ EXTERN_C NTSTATUS Bus_UnPlugDevice(
 {
 	NTSTATUS                            status;
 	WDFDEVICE                           hChild;
-	WDFCHILDLIST                        list;
-	WDF_CHILD_LIST_ITERATOR             iterator;
-	WDF_CHILD_RETRIEVE_INFO             childInfo;
 	PDO_IDENTIFICATION_DESCRIPTION      description;
 	BOOLEAN                             unplugAll;
 	PVIGEM_UNPLUG_TARGET                unPlug;
@@ -306,78 +390,1009 @@ EXTERN_C NTSTATUS Bus_UnPlugDevice(
 		TRACE_BUSENUM,
 		"Starting child list traversal");
 
-	list = WdfFdoGetDefaultChildList(Device);
+	{
+		//
+		// Unplugging all children only costs a single bus relations update
+		// 
+		ChildListBatch batch(Device);
+
+		while (batch.Next(&description, &hChild))
+		{
+			// If unable to retrieve device
+			if (hChild == NULL)
+			{
+				continue;
+			}
+
+			// Child isn't the one we looked for, skip
+			if (!unplugAll && description.SerialNo != unPlug->SerialNo)
+			{
+				TraceEvents(TRACE_LEVEL_VERBOSE,
+					TRACE_BUSENUM,
+					"Seeking serial mismatch: %d != %d",
+					description.SerialNo,
+					unPlug->SerialNo);
+				continue;
+			}
+
+			TraceEvents(TRACE_LEVEL_VERBOSE,
+				TRACE_BUSENUM,
+				"SessionId = %d, pFileData->SessionId = %d",
+				description.Target->GetSessionId(),
+				pFileData->SessionId);
+
+			// Only unplug owned children (claimed standby targets changed owner after plug-in)
+			if (IsInternal || description.Target->GetSessionId() == pFileData->SessionId)
+			{
+				// Unplug child
+				status = batch.MarkAsMissing(&description);
+				if (!NT_SUCCESS(status))
+				{
+					TraceEvents(TRACE_LEVEL_ERROR,
+						TRACE_BUSENUM,
+						"WdfChildListUpdateChildDescriptionAsMissing failed with status %!STATUS!",
+						status);
+				}
+			}
+		}
+	}
+
+	TraceEvents(TRACE_LEVEL_VERBOSE,
+		TRACE_BUSENUM,
+		"Finished child list traversal");
+
+	TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_BUSENUM, "%!FUNC! Exit with status %!STATUS!", STATUS_SUCCESS);
+
+	return STATUS_SUCCESS;
+}
+
+//
+// Hands a booted standby target over to the requesting file handle.
+// 
+EXTERN_C NTSTATUS Bus_ClaimStandbyTarget(
+	_In_ WDFDEVICE Device,
+	_In_ WDFREQUEST Request,
+	_Out_ size_t* Transferred)
+{
+	NTSTATUS                            status;
+	WDFDEVICE                           hChild;
+	PDO_IDENTIFICATION_DESCRIPTION      description;
+	PVIGEM_CLAIM_STANDBY_TARGET         claim;
+	WDFFILEOBJECT                       fileObject;
+	PFDO_FILE_DATA                      pFileData;
+	PFDO_DEVICE_DATA                    pFdoData;
+	size_t                              length = 0;
+	NTSTATUS                            result = STATUS_NOT_FOUND;
+
+	PAGED_CODE();
+
+	TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_BUSENUM, "%!FUNC! Entry");
+
+	status = WdfRequestRetrieveInputBuffer(
+		Request,
+		sizeof(VIGEM_CLAIM_STANDBY_TARGET),
+		reinterpret_cast<PVOID*>(&claim),
+		&length
+	);
+	if (!NT_SUCCESS(status))
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"WdfRequestRetrieveInputBuffer failed with status %!STATUS!", status);
+		return status;
+	}
+
+	if ((sizeof(VIGEM_CLAIM_STANDBY_TARGET) != claim->Size) || (length != claim->Size))
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"sizeof(VIGEM_CLAIM_STANDBY_TARGET) buffer size mismatch [%d != %d]",
+			sizeof(VIGEM_CLAIM_STANDBY_TARGET), claim->Size);
+		return STATUS_INVALID_PARAMETER;
+	}
+
+	fileObject = WdfRequestGetFileObject(Request);
+	if (fileObject == NULL)
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"WdfRequestGetFileObject failed to fetch WDFFILEOBJECT from request 0x%p",
+			Request);
+		return STATUS_INVALID_PARAMETER;
+	}
+
+	pFileData = FileObjectGetData(fileObject);
+	if (pFileData == NULL)
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"FileObjectGetData failed to get context data for 0x%p",
+			fileObject);
+		return STATUS_INVALID_PARAMETER;
+	}
+
+	pFdoData = FdoGetData(Device);
+
+	//
+	// Pool disabled, don't bother walking the list
+	// 
+	if (pFdoData->StandbyRefillWorkItem == NULL)
+	{
+		return STATUS_NOT_FOUND;
+	}
+
+	{
+		ChildListBatch batch(Device);
+
+		while (batch.Next(&description, &hChild))
+		{
+			if (hChild == NULL || description.Target->GetType() != claim->TargetType)
+			{
+				continue;
+			}
+
+			if (description.Target->ClaimStandby(pFileData->SessionId, claim->VendorId, claim->ProductId))
+			{
+				claim->SerialNo = description.SerialNo;
+				result = STATUS_SUCCESS;
+				break;
+			}
+		}
+	}
+
+	if (NT_SUCCESS(result))
+	{
+		TraceEvents(TRACE_LEVEL_INFORMATION,
+			TRACE_BUSENUM,
+			"Claimed standby target with serial %d",
+			claim->SerialNo);
+
+		*Transferred = length;
+
+		//
+		// Replace the claimed target in the background
+		// 
+		WdfWorkItemEnqueue(pFdoData->StandbyRefillWorkItem);
+	}
+
+	TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_BUSENUM, "%!FUNC! Exit with status %!STATUS!", result);
+
+	return result;
+}
+
+//
+// Plugs in unowned targets until the configured standby pool size is reached.
+// 
+_Use_decl_annotations_
+VOID
+Bus_EvtStandbyRefillWorkItem(
+	WDFWORKITEM WorkItem
+)
+{
+	NTSTATUS                            status;
+	WDFDEVICE                           hChild;
+	PDO_IDENTIFICATION_DESCRIPTION      description;
+	ULONG                               xusbCount = 0;
+	ULONG                               ds4Count = 0;
+	ULONG                               usedSerials = 0;
+
+	PAGED_CODE();
+
+	const WDFDEVICE device = static_cast<WDFDEVICE>(WdfWorkItemGetParentObject(WorkItem));
+	const PFDO_DEVICE_DATA pFdoData = FdoGetData(device);
+
+	//
+	// All new targets get announced with a single bus relations update
+	// 
+	ChildListBatch batch(device, WdfRetrieveAddedChildren);
+
+	//
+	// Count idle targets and collect the pool serials still in use
+	// 
+	while (batch.Next(&description, &hChild))
+	{
+		if (description.SerialNo >= STANDBY_FIRST_SERIAL_NO
+			&& description.SerialNo < STANDBY_FIRST_SERIAL_NO + STANDBY_SERIAL_RANGE)
+		{
+			usedSerials |= (1UL << (description.SerialNo - STANDBY_FIRST_SERIAL_NO));
+		}
 
-	WDF_CHILD_LIST_ITERATOR_INIT(&iterator, WdfRetrievePresentChildren);
+		if (!description.Target->IsStandby())
+		{
+			continue;
+		}
 
-	WdfChildListBeginIteration(list, &iterator);
+		if (description.Target->GetType() == Xbox360Wired)
+		{
+			xusbCount++;
+		}
+		else if (description.Target->GetType() == DualShock4Wired)
+		{
+			ds4Count++;
+		}
+	}
 
-	for (;;)
+	for (ULONG index = 0; index < STANDBY_SERIAL_RANGE; index++)
 	{
-		WDF_CHILD_RETRIEVE_INFO_INIT(&childInfo, &description.Header);
+		VIGEM_TARGET_TYPE type;
+
+		if (xusbCount < pFdoData->StandbyXusbTargets)
+		{
+			type = Xbox360Wired;
+		}
+		else if (ds4Count < pFdoData->StandbyDs4Targets)
+		{
+			type = DualShock4Wired;
+		}
+		else
+		{
+			break;
+		}
+
+		if (usedSerials & (1UL << index))
+		{
+			continue;
+		}
+
 		WDF_CHILD_IDENTIFICATION_DESCRIPTION_HEADER_INIT(&description.Header, sizeof(description));
 
-		status = WdfChildListRetrieveNextDevice(list, &iterator, &hChild, &childInfo);
+		description.SerialNo = STANDBY_FIRST_SERIAL_NO + index;
+		description.SessionId = EmulationTargetPDO::STANDBY_SESSION_ID;
+		description.Target = Bus_CreateTarget(
+			type,
+			description.SerialNo,
+			EmulationTargetPDO::STANDBY_SESSION_ID,
+			0,
+			0
+		);
 
-		// Error or no more children, end loop
-		if (!NT_SUCCESS(status) || status == STATUS_NO_MORE_ENTRIES)
+		if (description.Target == nullptr)
 		{
-			TraceEvents(TRACE_LEVEL_VERBOSE,
+			TraceEvents(TRACE_LEVEL_ERROR,
 				TRACE_BUSENUM,
-				"WdfChildListRetrieveNextDevice returned with status %!STATUS!",
-				status);
+				"Target object allocation failed");
 			break;
 		}
 
-		// If unable to retrieve device
-		if (childInfo.Status != WdfChildListRetrieveDeviceSuccess)
+		status = description.Target->PdoPrepare(device);
+
+		if (NT_SUCCESS(status))
 		{
-			TraceEvents(TRACE_LEVEL_VERBOSE,
-				TRACE_BUSENUM,
-				"childInfo.Status = %d",
-				childInfo.Status);
-			continue;
+			status = batch.AddAsPresent(&description);
 		}
 
-		// Child isn't the one we looked for, skip
-		if (!unplugAll && description.SerialNo != unPlug->SerialNo)
+		if (!NT_SUCCESS(status) || status == STATUS_OBJECT_NAME_EXISTS)
 		{
-			TraceEvents(TRACE_LEVEL_VERBOSE,
+			TraceEvents(TRACE_LEVEL_ERROR,
 				TRACE_BUSENUM,
-				"Seeking serial mismatch: %d != %d",
+				"Adding standby target with serial %d failed with status %!STATUS!",
 				description.SerialNo,
-				unPlug->SerialNo);
-			continue;
+				status);
+
+			//
+			// No PDO got created, so its cleanup callback won't free the target
+			// 
+			description.Target->PdoUnprepare();
+			delete description.Target;
+			break;
 		}
 
-		TraceEvents(TRACE_LEVEL_VERBOSE,
+		TraceEvents(TRACE_LEVEL_INFORMATION,
 			TRACE_BUSENUM,
-			"description.SessionId = %d, pFileData->SessionId = %d",
-			description.SessionId,
-			pFileData->SessionId);
+			"Added standby target with serial %d",
+			description.SerialNo);
 
-		// Only unplug owned children
-		if (IsInternal || description.SessionId == pFileData->SessionId)
+		if (type == Xbox360Wired)
 		{
-			// Unplug child
-			status = WdfChildListUpdateChildDescriptionAsMissing(list, &description.Header);
-			if (!NT_SUCCESS(status))
-			{
-				TraceEvents(TRACE_LEVEL_ERROR,
-					TRACE_BUSENUM,
-					"WdfChildListUpdateChildDescriptionAsMissing failed with status %!STATUS!",
-					status);
-			}
+			xusbCount++;
+		}
+		else
+		{
+			ds4Count++;
 		}
 	}
+}
 
-	WdfChildListEndIteration(list, &iterator);
+//
+// Hands a leased target left behind by a closed handle over to the requesting file handle.
+// 
+EXTERN_C NTSTATUS Bus_ReclaimLeasedTarget(
+	_In_ WDFDEVICE Device,
+	_In_ WDFREQUEST Request,
+	_Out_ size_t* Transferred)
+{
+	NTSTATUS                            status;
+	WDFDEVICE                           hChild;
+	PDO_IDENTIFICATION_DESCRIPTION      description;
+	PVIGEM_RECLAIM_LEASED_TARGET        reclaim;
+	WDFFILEOBJECT                       fileObject;
+	PFDO_FILE_DATA                      pFileData;
+	size_t                              length = 0;
+	NTSTATUS                            result = STATUS_NOT_FOUND;
 
-	TraceEvents(TRACE_LEVEL_VERBOSE,
-		TRACE_BUSENUM,
-		"Finished child list traversal");
+	PAGED_CODE();
 
-	TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_BUSENUM, "%!FUNC! Exit with status %!STATUS!", STATUS_SUCCESS);
+	TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_BUSENUM, "%!FUNC! Entry");
 
-	return STATUS_SUCCESS;
+	status = WdfRequestRetrieveInputBuffer(
+		Request,
+		sizeof(VIGEM_RECLAIM_LEASED_TARGET),
+		reinterpret_cast<PVOID*>(&reclaim),
+		&length
+	);
+	if (!NT_SUCCESS(status))
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"WdfRequestRetrieveInputBuffer failed with status %!STATUS!", status);
+		return status;
+	}
+
+	if ((sizeof(VIGEM_RECLAIM_LEASED_TARGET) != reclaim->Size) || (length != reclaim->Size))
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"sizeof(VIGEM_RECLAIM_LEASED_TARGET) buffer size mismatch [%d != %d]",
+			sizeof(VIGEM_RECLAIM_LEASED_TARGET), reclaim->Size);
+		return STATUS_INVALID_PARAMETER;
+	}
+
+	if (reclaim->LeaseKey == 0)
+	{
+		return STATUS_INVALID_PARAMETER;
+	}
+
+	fileObject = WdfRequestGetFileObject(Request);
+	if (fileObject == NULL)
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"WdfRequestGetFileObject failed to fetch WDFFILEOBJECT from request 0x%p",
+			Request);
+		return STATUS_INVALID_PARAMETER;
+	}
+
+	pFileData = FileObjectGetData(fileObject);
+	if (pFileData == NULL)
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"FileObjectGetData failed to get context data for 0x%p",
+			fileObject);
+		return STATUS_INVALID_PARAMETER;
+	}
+
+	{
+		ChildListBatch batch(Device);
+
+		while (batch.Next(&description, &hChild))
+		{
+			if (hChild == NULL || !description.Target->IsLeaseOrphaned())
+			{
+				continue;
+			}
+
+			if (description.Target->ReclaimLease(pFileData->SessionId, reclaim->LeaseKey))
+			{
+				reclaim->SerialNo = description.SerialNo;
+				reclaim->TargetType = description.Target->GetType();
+				result = STATUS_SUCCESS;
+				break;
+			}
+		}
+	}
+
+	if (NT_SUCCESS(result))
+	{
+		TraceEvents(TRACE_LEVEL_INFORMATION,
+			TRACE_BUSENUM,
+			"Reclaimed leased target with serial %d",
+			reclaim->SerialNo);
+
+		*Transferred = length;
+	}
+
+	TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_BUSENUM, "%!FUNC! Exit with status %!STATUS!", result);
+
+	return result;
+}
+
+//
+// Moves a target to the requesting file handle in exchange for a ticket issued by its owner.
+// 
+EXTERN_C NTSTATUS Bus_ClaimTransferredTarget(
+	_In_ WDFDEVICE Device,
+	_In_ WDFREQUEST Request,
+	_Out_ size_t* Transferred)
+{
+	NTSTATUS                            status;
+	WDFDEVICE                           hChild;
+	PDO_IDENTIFICATION_DESCRIPTION      description;
+	PVIGEM_CLAIM_TRANSFERRED_TARGET     claim;
+	WDFFILEOBJECT                       fileObject;
+	PFDO_FILE_DATA                      pFileData;
+	size_t                              length = 0;
+	EmulationTargetPDO*                 target = nullptr;
+
+	PAGED_CODE();
+
+	TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_BUSENUM, "%!FUNC! Entry");
+
+	status = WdfRequestRetrieveInputBuffer(
+		Request,
+		sizeof(VIGEM_CLAIM_TRANSFERRED_TARGET),
+		reinterpret_cast<PVOID*>(&claim),
+		&length
+	);
+	if (!NT_SUCCESS(status))
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"WdfRequestRetrieveInputBuffer failed with status %!STATUS!", status);
+		return status;
+	}
+
+	if ((sizeof(VIGEM_CLAIM_TRANSFERRED_TARGET) != claim->Size) || (length != claim->Size))
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"sizeof(VIGEM_CLAIM_TRANSFERRED_TARGET) buffer size mismatch [%d != %d]",
+			sizeof(VIGEM_CLAIM_TRANSFERRED_TARGET), claim->Size);
+		return STATUS_INVALID_PARAMETER;
+	}
+
+	if (claim->Ticket == 0)
+	{
+		return STATUS_INVALID_PARAMETER;
+	}
+
+	fileObject = WdfRequestGetFileObject(Request);
+	if (fileObject == NULL)
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"WdfRequestGetFileObject failed to fetch WDFFILEOBJECT from request 0x%p",
+			Request);
+		return STATUS_INVALID_PARAMETER;
+	}
+
+	pFileData = FileObjectGetData(fileObject);
+	if (pFileData == NULL)
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"FileObjectGetData failed to get context data for 0x%p",
+			fileObject);
+		return STATUS_INVALID_PARAMETER;
+	}
+
+	{
+		ChildListBatch batch(Device);
+
+		while (batch.Next(&description, &hChild))
+		{
+			if (hChild != NULL && description.Target->ClaimTransfer(pFileData->SessionId, claim->Ticket))
+			{
+				target = description.Target;
+				break;
+			}
+		}
+	}
+
+	if (target == nullptr)
+	{
+		TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_BUSENUM, "%!FUNC! Exit with status %!STATUS!", STATUS_NOT_FOUND);
+
+		return STATUS_NOT_FOUND;
+	}
+
+	//
+	// Tokens of the previous owner and the writers it attached stop resolving
+	// 
+	FdoGetData(Device)->TargetTokens.Release(target);
+	FdoGetData(Device)->TargetTokens.ReleaseWriters(target);
+
+	claim->SerialNo = description.SerialNo;
+	claim->TargetType = target->GetType();
+
+	*Transferred = length;
+
+	TraceEvents(TRACE_LEVEL_INFORMATION,
+		TRACE_BUSENUM,
+		"Transferred target with serial %d to session %d",
+		claim->SerialNo,
+		pFileData->SessionId);
+
+	TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_BUSENUM, "%!FUNC! Exit with status %!STATUS!", STATUS_SUCCESS);
+
+	return STATUS_SUCCESS;
+}
+
+//
+// Lets the requesting file handle feed reports into a target owned by someone else.
+// 
+EXTERN_C NTSTATUS Bus_AttachInputWriter(
+	_In_ WDFDEVICE Device,
+	_In_ WDFREQUEST Request,
+	_Out_ size_t* Transferred)
+{
+	NTSTATUS                            status;
+	PVIGEM_ATTACH_INPUT_WRITER          attach;
+	WDFFILEOBJECT                       fileObject;
+	size_t                              length = 0;
+	ULONG                               writer = 0;
+	EmulationTargetPDO*                 target = nullptr;
+
+	PAGED_CODE();
+
+	TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_BUSENUM, "%!FUNC! Entry");
+
+	status = WdfRequestRetrieveInputBuffer(
+		Request,
+		sizeof(VIGEM_ATTACH_INPUT_WRITER),
+		reinterpret_cast<PVOID*>(&attach),
+		&length
+	);
+	if (!NT_SUCCESS(status))
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"WdfRequestRetrieveInputBuffer failed with status %!STATUS!", status);
+		return status;
+	}
+
+	if ((sizeof(VIGEM_ATTACH_INPUT_WRITER) != attach->Size) || (length != attach->Size))
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"sizeof(VIGEM_ATTACH_INPUT_WRITER) buffer size mismatch [%d != %d]",
+			sizeof(VIGEM_ATTACH_INPUT_WRITER), attach->Size);
+		return STATUS_INVALID_PARAMETER;
+	}
+
+	if (attach->SerialNo == 0 || attach->WriterKey == 0)
+	{
+		return STATUS_INVALID_PARAMETER;
+	}
+
+	fileObject = WdfRequestGetFileObject(Request);
+	if (fileObject == NULL)
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"WdfRequestGetFileObject failed to fetch WDFFILEOBJECT from request 0x%p",
+			Request);
+		return STATUS_INVALID_PARAMETER;
+	}
+
+	if (!EmulationTargetPDO::GetPdoBySerial(Device, attach->SerialNo, &target))
+	{
+		return STATUS_DEVICE_DOES_NOT_EXIST;
+	}
+
+	status = target->AttachWriter(attach->WriterKey, fileObject, attach->Priority, &writer);
+	if (!NT_SUCCESS(status))
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"AttachWriter failed with status %!STATUS!", status);
+		return status;
+	}
+
+	status = FdoGetData(Device)->TargetTokens.AcquireWriter(target, fileObject, writer, &attach->Token);
+	if (!NT_SUCCESS(status))
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"TargetTokens.AcquireWriter failed with status %!STATUS!", status);
+
+		target->DetachWriter(writer);
+		return status;
+	}
+
+	attach->TargetType = target->GetType();
+
+	*Transferred = length;
+
+	TraceEvents(TRACE_LEVEL_INFORMATION,
+		TRACE_BUSENUM,
+		"Attached writer %d to target with serial %d",
+		writer,
+		attach->SerialNo);
+
+	TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_BUSENUM, "%!FUNC! Exit with status %!STATUS!", status);
+
+	return status;
+}
+
+//
+// Lets the requesting file handle receive the notifications of a target, read-only.
+// Only the owner or a handle presenting its lease key or transfer ticket gets in.
+// 
+EXTERN_C NTSTATUS Bus_SubscribeNotifications(
+	_In_ WDFDEVICE Device,
+	_In_ WDFREQUEST Request,
+	_Out_ size_t* Transferred)
+{
+	NTSTATUS                            status;
+	PVIGEM_SUBSCRIBE_NOTIFICATIONS      subscribe;
+	WDFFILEOBJECT                       fileObject;
+	PFDO_FILE_DATA                      pFileData;
+	size_t                              length = 0;
+	ULONG                               subscriber = 0;
+	EmulationTargetPDO*                 target = nullptr;
+
+	PAGED_CODE();
+
+	TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_BUSENUM, "%!FUNC! Entry");
+
+	status = WdfRequestRetrieveInputBuffer(
+		Request,
+		sizeof(VIGEM_SUBSCRIBE_NOTIFICATIONS),
+		reinterpret_cast<PVOID*>(&subscribe),
+		&length
+	);
+	if (!NT_SUCCESS(status))
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"WdfRequestRetrieveInputBuffer failed with status %!STATUS!", status);
+		return status;
+	}
+
+	if ((sizeof(VIGEM_SUBSCRIBE_NOTIFICATIONS) != subscribe->Size) || (length != subscribe->Size))
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"sizeof(VIGEM_SUBSCRIBE_NOTIFICATIONS) buffer size mismatch [%d != %d]",
+			sizeof(VIGEM_SUBSCRIBE_NOTIFICATIONS), subscribe->Size);
+		return STATUS_INVALID_PARAMETER;
+	}
+
+	if (subscribe->SerialNo == 0)
+	{
+		return STATUS_INVALID_PARAMETER;
+	}
+
+	fileObject = WdfRequestGetFileObject(Request);
+	if (fileObject == NULL)
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"WdfRequestGetFileObject failed to fetch WDFFILEOBJECT from request 0x%p",
+			Request);
+		return STATUS_INVALID_PARAMETER;
+	}
+
+	pFileData = FileObjectGetData(fileObject);
+	if (pFileData == NULL)
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"FileObjectGetData failed to get context data for 0x%p",
+			fileObject);
+		return STATUS_INVALID_PARAMETER;
+	}
+
+	if (!EmulationTargetPDO::GetPdoBySerial(Device, subscribe->SerialNo, &target))
+	{
+		return STATUS_DEVICE_DOES_NOT_EXIST;
+	}
+
+	if (!target->AdmitsSubscriber(pFileData->SessionId, subscribe->AccessKey))
+	{
+		TraceEvents(TRACE_LEVEL_WARNING,
+			TRACE_BUSENUM,
+			"Session %d may not subscribe to target with serial %d",
+			pFileData->SessionId,
+			subscribe->SerialNo);
+		return STATUS_ACCESS_DENIED;
+	}
+
+	status = target->Subscribe(fileObject, &subscriber);
+	if (!NT_SUCCESS(status))
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"Subscribe failed with status %!STATUS!", status);
+		return status;
+	}
+
+	status = FdoGetData(Device)->TargetTokens.AcquireSubscriber(target, fileObject, subscriber, &subscribe->Token);
+	if (!NT_SUCCESS(status))
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"TargetTokens.AcquireSubscriber failed with status %!STATUS!", status);
+
+		target->Unsubscribe(subscriber);
+		return status;
+	}
+
+	subscribe->TargetType = target->GetType();
+
+	*Transferred = length;
+
+	TraceEvents(TRACE_LEVEL_INFORMATION,
+		TRACE_BUSENUM,
+		"Subscriber %d added to target with serial %d",
+		subscriber,
+		subscribe->SerialNo);
+
+	TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_BUSENUM, "%!FUNC! Exit with status %!STATUS!", status);
+
+	return status;
+}
+
+//
+// Unlinks the output state page of a session, returns the request that kept it locked.
+// With Expected set, only the page of that request gets unlinked.
+// 
+static WDFREQUEST Bus_DetachOutputState(
+	_In_ PFDO_DEVICE_DATA FdoData,
+	_In_ PFDO_FILE_DATA FileData,
+	_In_opt_ WDFREQUEST Expected)
+{
+	KIRQL irql;
+
+	KeAcquireSpinLock(&FdoData->OutputStateLock, &irql);
+
+	auto request = FileData->OutputStateRequest;
+
+	if (Expected && request != Expected)
+	{
+		request = NULL;
+	}
+
+	if (request)
+	{
+		//
+		// Readers stop trusting the page from here on
+		// 
+		InterlockedExchange(&FileData->OutputState->Active, FALSE);
+
+		RemoveEntryList(&FileData->OutputStateLink);
+		InitializeListHead(&FileData->OutputStateLink);
+
+		FileData->OutputStateRequest = NULL;
+		FileData->OutputState = NULL;
+	}
+
+	KeReleaseSpinLock(&FdoData->OutputStateLock, irql);
+
+	return request;
+}
+
+//
+// Keeps the output buffer of the request locked and updated until the session ends.
+// 
+EXTERN_C NTSTATUS Bus_MapOutputState(
+	_In_ WDFDEVICE Device,
+	_In_ WDFREQUEST Request)
+{
+	NTSTATUS                            status;
+	PVIGEM_MAP_OUTPUT_STATE             map;
+	PVIGEM_OUTPUT_STATE_PAGE            page;
+	WDFFILEOBJECT                       fileObject;
+	PFDO_FILE_DATA                      pFileData;
+	PFDO_DEVICE_DATA                    pFdoData;
+	PDO_IDENTIFICATION_DESCRIPTION      description;
+	WDFDEVICE                           hChild;
+	size_t                              length = 0;
+	KIRQL                               irql;
+
+	PAGED_CODE();
+
+	TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_BUSENUM, "%!FUNC! Entry");
+
+	status = WdfRequestRetrieveInputBuffer(
+		Request,
+		sizeof(VIGEM_MAP_OUTPUT_STATE),
+		reinterpret_cast<PVOID*>(&map),
+		&length
+	);
+	if (!NT_SUCCESS(status))
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"WdfRequestRetrieveInputBuffer failed with status %!STATUS!", status);
+		return status;
+	}
+
+	if ((sizeof(VIGEM_MAP_OUTPUT_STATE) != map->Size) || (length != map->Size))
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"sizeof(VIGEM_MAP_OUTPUT_STATE) buffer size mismatch [%d != %d]",
+			sizeof(VIGEM_MAP_OUTPUT_STATE), map->Size);
+		return STATUS_INVALID_PARAMETER;
+	}
+
+	//
+	// Direct I/O, this is the system address of the locked caller pages
+	// 
+	status = WdfRequestRetrieveOutputBuffer(
+		Request,
+		sizeof(VIGEM_OUTPUT_STATE_PAGE),
+		reinterpret_cast<PVOID*>(&page),
+		nullptr
+	);
+	if (!NT_SUCCESS(status))
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"WdfRequestRetrieveOutputBuffer failed with status %!STATUS!", status);
+		return status;
+	}
+
+	fileObject = WdfRequestGetFileObject(Request);
+	if (fileObject == NULL)
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"WdfRequestGetFileObject failed to fetch WDFFILEOBJECT from request 0x%p",
+			Request);
+		return STATUS_INVALID_PARAMETER;
+	}
+
+	pFileData = FileObjectGetData(fileObject);
+	pFdoData = FdoGetData(Device);
+
+	RtlZeroMemory(page, sizeof(VIGEM_OUTPUT_STATE_PAGE));
+	page->Size = sizeof(VIGEM_OUTPUT_STATE_PAGE);
+
+	KeAcquireSpinLock(&pFdoData->OutputStateLock, &irql);
+
+	//
+	// One page per session
+	// 
+	if (pFileData->OutputStateRequest != NULL)
+	{
+		status = STATUS_DEVICE_BUSY;
+	}
+	else
+	{
+		status = WdfRequestMarkCancelableEx(Request, Bus_EvtOutputStateRequestCancel);
+
+		if (NT_SUCCESS(status))
+		{
+			pFileData->OutputStateRequest = Request;
+			pFileData->OutputState = page;
+
+			RtlZeroMemory(pFileData->OutputStateSerials, sizeof(pFileData->OutputStateSerials));
+			RtlZeroMemory(pFileData->OutputStateSequences, sizeof(pFileData->OutputStateSequences));
+
+			//
+			// Tells the caller the page got accepted
+			// 
+			InterlockedExchange(&page->Active, TRUE);
+
+			InsertTailList(&pFdoData->OutputStateSessions, &pFileData->OutputStateLink);
+		}
+	}
+
+	KeReleaseSpinLock(&pFdoData->OutputStateLock, irql);
+
+	if (!NT_SUCCESS(status))
+	{
+		TraceEvents(TRACE_LEVEL_ERROR,
+			TRACE_BUSENUM,
+			"Mapping output state failed with status %!STATUS!", status);
+		return status;
+	}
+
+	{
+		//
+		// Targets of the session may have received output before the page existed
+		// 
+		ChildListBatch batch(Device);
+
+		while (batch.Next(&description, &hChild))
+		{
+			if (hChild != NULL && description.Target->GetSessionId() == pFileData->SessionId)
+			{
+				description.Target->PublishOutputState();
+			}
+		}
+	}
+
+	TraceEvents(TRACE_LEVEL_INFORMATION, TRACE_BUSENUM, "%!FUNC! Exit with status %!STATUS!", STATUS_PENDING);
+
+	return STATUS_PENDING;
+}
+
+//
+// Releases the output state page of a session, if any.
+// 
+EXTERN_C VOID Bus_UnmapOutputState(
+	_In_ WDFFILEOBJECT FileObject)
+{
+	PAGED_CODE();
+
+	const auto request = Bus_DetachOutputState(
+		FdoGetData(WdfFileObjectGetDevice(FileObject)),
+		FileObjectGetData(FileObject),
+		NULL
+	);
+
+	//
+	// The cancel routine completes it if it already fired
+	// 
+	if (request && NT_SUCCESS(WdfRequestUnmarkCancelable(request)))
+	{
+		WdfRequestComplete(request, STATUS_SUCCESS);
+	}
+}
+
+//
+// The issuing thread exited or cancelled the page request.
+// 
+EXTERN_C VOID Bus_EvtOutputStateRequestCancel(
+	_In_ WDFREQUEST Request)
+{
+	const auto fileObject = WdfRequestGetFileObject(Request);
+
+	//
+	// Once unmapped, the session may already have mapped a new page; a late 
+	// cancel of the old request must leave that one alone
+	// 
+	Bus_DetachOutputState(
+		FdoGetData(WdfFileObjectGetDevice(fileObject)),
+		FileObjectGetData(fileObject),
+		Request
+	);
+
+	WdfRequestComplete(Request, STATUS_CANCELLED);
+}
+
+//
+// Unplugs leased targets whose grace period ran out, re-arms while any are left.
+// 
+_Use_decl_annotations_
+VOID
+Bus_EvtLeaseExpiryTimer(
+	WDFTIMER Timer
+)
+{
+	NTSTATUS                            status;
+	WDFDEVICE                           hChild;
+	PDO_IDENTIFICATION_DESCRIPTION      description;
+	ULONG                               pendingCount = 0;
+
+	PAGED_CODE();
+
+	const WDFDEVICE device = static_cast<WDFDEVICE>(WdfTimerGetParentObject(Timer));
+
+	{
+		ChildListBatch batch(device);
+
+		while (batch.Next(&description, &hChild))
+		{
+			if (description.Target->ExpireLease())
+			{
+				TraceEvents(TRACE_LEVEL_INFORMATION,
+					TRACE_BUSENUM,
+					"Lease of device with serial %d expired, unplugging",
+					description.SerialNo);
+
+				status = batch.MarkAsMissing(&description);
+				if (!NT_SUCCESS(status))
+				{
+					TraceEvents(TRACE_LEVEL_ERROR,
+						TRACE_BUSENUM,
+						"WdfChildListUpdateChildDescriptionAsMissing failed with status %!STATUS!",
+						status);
+				}
+			}
+			else if (description.Target->IsLeaseOrphaned())
+			{
+				pendingCount++;
+			}
+		}
+	}
+
+	if (pendingCount > 0)
+	{
+		WdfTimerStart(Timer, WDF_REL_TIMEOUT_IN_MS(FDO_LEASE_EXPIRY_CHECK_INTERVAL_MS));
+	}
 }
@@ -0,0 +1,91 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Boot timeline a simulated host observes for an XUSB target, with and without
+// fast boot
+// 
+
+#include <Windows.h>
+#include <ViGEm/km/BusShared.h>
+
+#include "SimulatedBoot.hpp"
+
+#include <cstdio>
+
+static const char* const PHASE_NAMES[VigemBootPhaseMax] =
+{
+	"PlugIn",
+	"PnpStart",
+	"ConfigurationSelected",
+	"InitStage0",
+	"InitStage1",
+	"InitStage2",
+	"InitStage3",
+	"InitStage4",
+	"InitStage5",
+	"Ready",
+	"FirstReport",
+};
+
+int main()
+{
+	Simulation::XusbTarget regular(false);
+	Simulation::XusbTarget fast(true);
+	VIGEM_BOOT_TIMELINE regularTimeline{}, fastTimeline{};
+
+	Simulation::Boot(regular, Simulation::DEFAULT_HOST);
+	Simulation::Boot(fast, Simulation::DEFAULT_HOST);
+
+	regular.Timeline.Get(&regularTimeline);
+	fast.Timeline.Get(&fastTimeline);
+
+	printf("%-22s %12s %12s\n", "Phase", "Regular ms", "Fast boot ms");
+
+	for (int phase = 0; phase < VigemBootPhaseMax; phase++)
+	{
+		printf("%-22s %12.3f %12.3f\n",
+		       PHASE_NAMES[phase],
+		       regularTimeline.PhaseTime[phase] / 1000.0,
+		       fastTimeline.PhaseTime[phase] / 1000.0);
+	}
+
+	printf("%-22s %12lu %12lu\n",
+	       "Init transfers",
+	       static_cast<unsigned long>(regularTimeline.InitTransfers),
+	       static_cast<unsigned long>(fastTimeline.InitTransfers));
+
+	return 0;
+}
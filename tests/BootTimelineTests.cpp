@@ -0,0 +1,127 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Host tests of the boot timeline and the fast boot path
+// 
+
+#include <Windows.h>
+#include <ViGEm/km/BusShared.h>
+
+#include "SimulatedBoot.hpp"
+
+#include "HostTest.hpp"
+
+using ViGEm::Bus::Core::BootTimeline;
+
+#pragma region BootTimeline
+
+HOST_TEST(BootTimelineRecordsFirstArrival)
+{
+	BootTimeline timeline;
+	VIGEM_BOOT_TIMELINE result{};
+	const LONGLONG frequency = 10000000;
+
+	timeline.Mark(VigemBootPhasePlugIn, 1000, frequency);
+	timeline.Mark(VigemBootPhaseReady, 1000 + frequency / 100, frequency);
+	timeline.Mark(VigemBootPhaseReady, 1000 + frequency, frequency);
+	timeline.CountInitTransfer();
+
+	timeline.Get(&result);
+
+	CHECK(timeline.Reached(VigemBootPhaseReady));
+	CHECK(!timeline.Reached(VigemBootPhaseFirstReport));
+	CHECK_EQUAL(result.ReachedPhases, (1 << VigemBootPhasePlugIn) | (1 << VigemBootPhaseReady));
+	CHECK_EQUAL(result.PhaseTime[VigemBootPhaseReady], 10000);
+	CHECK_EQUAL(result.PhaseTime[VigemBootPhaseFirstReport], 0);
+	CHECK_EQUAL(result.InitTransfers, 1);
+}
+
+#pragma endregion
+
+#pragma region Simulated boot
+
+HOST_TEST(SimulatedBootReachesPhasesInOrder)
+{
+	Simulation::XusbTarget target(false);
+	VIGEM_BOOT_TIMELINE result{};
+
+	Simulation::Boot(target, Simulation::DEFAULT_HOST);
+	target.Timeline.Get(&result);
+
+	CHECK_EQUAL(result.ReachedPhases, (1 << VigemBootPhaseMax) - 1);
+	CHECK_EQUAL(result.InitTransfers, VigemBootPhaseInitStage5 - VigemBootPhaseInitStage0 + 1);
+
+	for (int phase = VigemBootPhasePnpStart; phase < VigemBootPhaseMax; phase++)
+		CHECK(result.PhaseTime[phase] >= result.PhaseTime[phase - 1]);
+}
+
+HOST_TEST(FastBootServesSequenceInOneTransfer)
+{
+	Simulation::XusbTarget regular(false);
+	Simulation::XusbTarget fast(true);
+	VIGEM_BOOT_TIMELINE regularResult{}, fastResult{};
+
+	Simulation::Boot(regular, Simulation::DEFAULT_HOST);
+	Simulation::Boot(fast, Simulation::DEFAULT_HOST);
+
+	regular.Timeline.Get(&regularResult);
+	fast.Timeline.Get(&fastResult);
+
+	CHECK_EQUAL(fastResult.InitTransfers, 1);
+	CHECK_EQUAL(fastResult.PhaseTime[VigemBootPhaseInitStage5], fastResult.PhaseTime[VigemBootPhaseInitStage0]);
+	CHECK(fastResult.PhaseTime[VigemBootPhaseReady] < regularResult.PhaseTime[VigemBootPhaseReady]);
+	CHECK(fastResult.PhaseTime[VigemBootPhaseFirstReport] < regularResult.PhaseTime[VigemBootPhaseFirstReport]);
+}
+
+HOST_TEST(FastBootSplitsSequenceOnShortTransfers)
+{
+	Simulation::XusbTarget target(true);
+	VIGEM_BOOT_TIMELINE result{};
+	auto host = Simulation::DEFAULT_HOST;
+
+	//
+	// Stage 0-3 (12 bytes) fit, the 14 byte input packet stage starts the next one
+	// 
+	host.TransferLength = 20;
+
+	Simulation::Boot(target, host);
+	target.Timeline.Get(&result);
+
+	CHECK_EQUAL(result.InitTransfers, 2);
+	CHECK(target.Timeline.Reached(VigemBootPhaseFirstReport));
+}
+
+#pragma endregion
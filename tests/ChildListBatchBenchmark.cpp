@@ -0,0 +1,168 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Teardown of a session's targets on process close against a simulated child
+// list, with one bus relations update per change against one per batch
+// 
+
+#include <Windows.h>
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+	//
+	// Framework semantics the bus relies on: a change outside an iteration
+	// invalidates the bus relations right away, changes during an iteration
+	// are reported together when it ends. Every update makes the PnP manager
+	// query the relations, which walks all present children.
+	// 
+	class SimulatedChildList
+	{
+	public:
+		explicit SimulatedChildList(ULONG Children) : _Present(Children, true)
+		{
+		}
+
+		void BeginIteration()
+		{
+			this->_Iterating = true;
+		}
+
+		void EndIteration()
+		{
+			this->_Iterating = false;
+
+			if (this->_Pending)
+				this->InvalidateRelations();
+
+			this->_Pending = false;
+		}
+
+		void MarkAsMissing(ULONG Child)
+		{
+			this->_Present[Child] = false;
+
+			if (this->_Iterating)
+				this->_Pending = true;
+			else
+				this->InvalidateRelations();
+		}
+
+		ULONG RelationUpdates{};
+
+		ULONG ChildrenReported{};
+
+	private:
+		void InvalidateRelations()
+		{
+			this->RelationUpdates++;
+
+			for (const auto present : this->_Present)
+			{
+				if (present)
+				{
+					this->ChildrenReported++;
+					this->_Sink = this->_Sink + 1;
+				}
+			}
+		}
+
+		std::vector<bool> _Present;
+
+		bool _Iterating{};
+
+		bool _Pending{};
+
+		volatile ULONG _Sink{};
+	};
+
+	const ULONG ITERATIONS = 200;
+
+	//
+	// Targets of other sessions stay plugged in
+	// 
+	const ULONG OTHER_TARGETS = 4;
+
+	void Teardown(const char* Name, ULONG Targets, bool Batched)
+	{
+		ULONG updates = 0;
+		ULONG reported = 0;
+
+		const auto start = std::chrono::steady_clock::now();
+
+		for (ULONG iteration = 0; iteration < ITERATIONS; iteration++)
+		{
+			SimulatedChildList list(Targets + OTHER_TARGETS);
+
+			if (Batched)
+				list.BeginIteration();
+
+			for (ULONG target = 0; target < Targets; target++)
+				list.MarkAsMissing(target);
+
+			if (Batched)
+				list.EndIteration();
+
+			updates = list.RelationUpdates;
+			reported = list.ChildrenReported;
+		}
+
+		const auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+
+		printf("%-10s %3lu targets: %3lu relation updates, %5lu children reported, %8.2f us\n",
+		       Name,
+		       static_cast<unsigned long>(Targets),
+		       static_cast<unsigned long>(updates),
+		       static_cast<unsigned long>(reported),
+		       elapsed.count() / ITERATIONS);
+	}
+}
+
+int main()
+{
+	const ULONG targets[] = { 1, 16, 256 };
+
+	for (const auto count : targets)
+	{
+		Teardown("Per change", count, false);
+		Teardown("Batched", count, true);
+	}
+
+	return 0;
+}
@@ -0,0 +1,116 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Throughput of the report converters against the baseline implementation
+// 
+
+#include <Windows.h>
+#include <ViGEm/Util.h>
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "BaselineUtil.hpp"
+
+static const ULONG BATCH_SIZE = 4096;
+static const ULONG ITERATIONS = 2000;
+
+//
+// Keeps the compiler from dropping conversions nobody reads
+// 
+static volatile ULONG Sink;
+
+template <typename Body>
+static void Measure(const char* Name, Body&& Convert)
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	for (ULONG iteration = 0; iteration < ITERATIONS; iteration++)
+		Convert();
+
+	const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+
+	printf("%-24s %8.2f ns/report\n", Name, elapsed.count() / (static_cast<double>(ITERATIONS) * BATCH_SIZE));
+}
+
+int main()
+{
+	std::vector<XUSB_REPORT> xusb(BATCH_SIZE);
+	std::vector<DS4_REPORT> ds4(BATCH_SIZE);
+
+	for (ULONG index = 0; index < BATCH_SIZE; index++)
+	{
+		xusb[index].wButtons = static_cast<USHORT>(index * 0x9E37);
+		xusb[index].bLeftTrigger = static_cast<BYTE>(index);
+		xusb[index].bRightTrigger = static_cast<BYTE>(index >> 4);
+		xusb[index].sThumbLX = static_cast<SHORT>(index * 17);
+		xusb[index].sThumbLY = static_cast<SHORT>(index * 31);
+		xusb[index].sThumbRX = static_cast<SHORT>(index * 257);
+		xusb[index].sThumbRY = static_cast<SHORT>(~index);
+	}
+
+	Measure("Baseline XUSB to DS4", [&]
+	{
+		for (ULONG index = 0; index < BATCH_SIZE; index++)
+		{
+			DS4_REPORT_INIT(&ds4[index]);
+			Baseline::XusbToDs4Report(&xusb[index], &ds4[index]);
+		}
+		Sink = Sink + ds4[BATCH_SIZE - 1].wButtons;
+	});
+
+	Measure("XUSB_TO_DS4", [&]
+	{
+		for (ULONG index = 0; index < BATCH_SIZE; index++)
+			XUSB_TO_DS4(&xusb[index], &ds4[index]);
+		Sink = Sink + ds4[BATCH_SIZE - 1].wButtons;
+	});
+
+	Measure("XUSB_TO_DS4_REPORTS", [&]
+	{
+		XUSB_TO_DS4_REPORTS(xusb.data(), ds4.data(), BATCH_SIZE);
+		Sink = Sink + ds4[BATCH_SIZE - 1].wButtons;
+	});
+
+	Measure("DS4_TO_XUSB_REPORTS", [&]
+	{
+		DS4_TO_XUSB_REPORTS(ds4.data(), xusb.data(), BATCH_SIZE);
+		Sink = Sink + xusb[BATCH_SIZE - 1].wButtons;
+	});
+
+	return 0;
+}
@@ -0,0 +1,152 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Cost of serving the enumeration descriptor requests from the compile-time tables
+// against building each descriptor on the stack per request like the baseline did
+// 
+
+#include <Windows.h>
+
+#include "UsbDescriptor.hpp"
+#include "XusbDescriptors.hpp"
+#include "Ds4Descriptors.hpp"
+
+#include "BaselineDescriptors.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+using namespace ViGEm::Bus::Core;
+using namespace ViGEm::Bus::Targets;
+
+static const ULONG ITERATIONS = 1000000;
+
+//
+// Hosts read the configuration descriptor header first to learn wTotalLength
+// 
+static const ULONG CONFIGURATION_HEADER_SIZE = 9;
+
+//
+// Large enough for any descriptor of either target
+// 
+static UCHAR TransferBuffer[512];
+
+static volatile ULONG Sink;
+
+//
+// Serves a request straight from a read-only table
+// 
+template <size_t N>
+static void ServeTable(const UCHAR (&Table)[N], ULONG Length)
+{
+	memcpy(TransferBuffer, Table, (Length < N) ? Length : N);
+}
+
+//
+// Serves a request like the former function bodies: the initializer is materialized
+// in a local array first. The empty asm keeps the compiler from folding both copies.
+// 
+template <size_t N>
+__attribute__((noinline)) static void ServeStack(const UCHAR (&Initializer)[N], ULONG Length)
+{
+	UCHAR descriptor[N];
+
+	memcpy(descriptor, Initializer, N);
+	__asm__ __volatile__("" : : "r"(descriptor) : "memory");
+
+	memcpy(TransferBuffer, descriptor, (Length < N) ? Length : N);
+}
+
+template <typename Body>
+static void Measure(const char* Name, size_t StackBytes, Body&& Enumerate)
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	for (ULONG iteration = 0; iteration < ITERATIONS; iteration++)
+	{
+		Enumerate();
+		Sink = Sink + TransferBuffer[0];
+	}
+
+	const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+
+	printf("%-22s %8.2f ns/enumeration   %4zu stack bytes per request (max)\n",
+	       Name,
+	       elapsed.count() / ITERATIONS,
+	       StackBytes);
+}
+
+//
+// One enumeration pass: the configuration descriptor header, the full configuration 
+// descriptor and, for DS4, the HID report descriptor and the string descriptors
+// 
+int main()
+{
+	Measure("XUSB tables", 0, []
+	{
+		ServeTable(XusbDescriptorData, CONFIGURATION_HEADER_SIZE);
+		ServeTable(XusbDescriptorData, sizeof(XusbDescriptorData));
+	});
+
+	Measure("XUSB stack", sizeof(Baseline::XusbConfiguration), []
+	{
+		ServeStack(Baseline::XusbConfiguration, CONFIGURATION_HEADER_SIZE);
+		ServeStack(Baseline::XusbConfiguration, sizeof(Baseline::XusbConfiguration));
+	});
+
+	Measure("DS4 tables", 0, []
+	{
+		ServeTable(Ds4DescriptorData, CONFIGURATION_HEADER_SIZE);
+		ServeTable(Ds4DescriptorData, sizeof(Ds4DescriptorData));
+		ServeTable(Ds4HidReportDescriptor, sizeof(Ds4HidReportDescriptor));
+		ServeTable(UsbLanguageIdDescriptor, sizeof(UsbLanguageIdDescriptor));
+		ServeTable(Ds4ManufacturerString.Data, Ds4ManufacturerString.Size);
+		ServeTable(Ds4ProductString.Data, Ds4ProductString.Size);
+	});
+
+	Measure("DS4 stack", sizeof(Baseline::Ds4HidReport), []
+	{
+		ServeStack(Baseline::Ds4Configuration, CONFIGURATION_HEADER_SIZE);
+		ServeStack(Baseline::Ds4Configuration, sizeof(Baseline::Ds4Configuration));
+		ServeStack(Baseline::Ds4HidReport, sizeof(Baseline::Ds4HidReport));
+		ServeStack(Baseline::LanguageId, sizeof(Baseline::LanguageId));
+		ServeStack(Baseline::Ds4Manufacturer, sizeof(Baseline::Ds4Manufacturer));
+		ServeStack(Baseline::Ds4Product, sizeof(Baseline::Ds4Product));
+	});
+
+	return 0;
+}
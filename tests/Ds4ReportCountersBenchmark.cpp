@@ -0,0 +1,204 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// A feeder whose input changes at 60 Hz against a polling host: compares
+// keeping the DS4 counters running on the client, which needs a submission
+// for every tick, with stamping them on delivery in the bus, and times the
+// counter update
+// 
+
+#include <Windows.h>
+#include <ViGEm/km/BusShared.h>
+
+#include "Ds4ReportCounters.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using ViGEm::Bus::Core::Ds4ReportCounters;
+
+//
+// Timestamps in microseconds
+// 
+static const LONGLONG DURATION = 2000000;
+static const LONGLONG FREQUENCY = 1000000;
+static const LONGLONG INPUT_INTERVAL = 16667;
+
+static volatile LONG Sink;
+
+struct Result
+{
+	double SubmitsPerSecond;
+
+	//
+	// Polls that saw the same report counter as the previous one
+	// 
+	double RepeatedPercent;
+
+	//
+	// Difference between the timestamp delta a game reads and the real time between polls
+	// 
+	double MeanTimestampError;
+	double MaxTimestampError;
+};
+
+//
+// FeederInterval of zero lets the bus stamp the counters, the feeder then
+// only submits when its input changes
+// 
+static Result Run(LONGLONG PollInterval, LONGLONG FeederInterval)
+{
+	std::mt19937 random(47);
+	std::uniform_int_distribution<LONGLONG> jitter(-250, 250);
+	Ds4ReportCounters feeder;
+	Ds4ReportCounters bus;
+	DS4_REPORT_EX cached{};
+	LONGLONG nextSubmit = 300;
+	LONGLONG nextInput = 0;
+	LONGLONG lastPoll = 0;
+	UCHAR lastFrame = 0;
+	USHORT lastTimestamp = 0;
+	ULONG submits = 0, polls = 0, repeated = 0;
+	double sum = 0, max = 0;
+
+	for (LONGLONG poll = PollInterval; poll < DURATION; poll += PollInterval)
+	{
+		//
+		// Everything the feeder submitted before the poll is in the cached report
+		// 
+		if (FeederInterval)
+		{
+			for (; nextSubmit <= poll; nextSubmit += FeederInterval)
+			{
+				const auto submitted = nextSubmit + jitter(random);
+
+				feeder.Advance(submitted > 0 ? submitted : 0, FREQUENCY, &cached);
+				submits++;
+			}
+		}
+		else
+		{
+			for (; nextInput <= poll; nextInput += INPUT_INTERVAL)
+				submits++;
+		}
+
+		DS4_REPORT_EX delivered = cached;
+
+		if (!FeederInterval)
+			bus.Advance(poll, FREQUENCY, &delivered);
+
+		const auto frame = static_cast<UCHAR>(delivered.Report.bSpecial >> 2);
+
+		if (polls > 0)
+		{
+			if (frame == lastFrame)
+				repeated++;
+
+			const auto steps = static_cast<USHORT>(delivered.Report.wTimestamp - lastTimestamp);
+			const auto error = std::fabs(steps * 16.0 / 3.0 - static_cast<double>(poll - lastPoll));
+
+			sum += error;
+			max = (error > max) ? error : max;
+		}
+
+		lastFrame = frame;
+		lastTimestamp = delivered.Report.wTimestamp;
+		lastPoll = poll;
+		polls++;
+	}
+
+	return {
+		submits * 1000000.0 / DURATION,
+		polls > 1 ? 100.0 * repeated / (polls - 1) : 0,
+		polls > 1 ? sum / (polls - 1) : 0,
+		max
+	};
+}
+
+int main()
+{
+	const LONGLONG pollIntervals[] = { 1000, 4000 };
+	const LONGLONG feederIntervals[] = { 1000, 4000, 0 };
+
+	printf("%-9s %-22s %10s %10s %10s %10s\n", "polls", "counters", "submits/s", "repeated", "mean err", "max err");
+
+	for (const auto pollInterval : pollIntervals)
+	{
+		for (const auto feederInterval : feederIntervals)
+		{
+			char mode[32];
+
+			if (feederInterval)
+				snprintf(mode, sizeof(mode), "client, %lld Hz", static_cast<long long>(1000000 / feederInterval));
+			else
+				snprintf(mode, sizeof(mode), "bus, on delivery");
+
+			const auto result = Run(pollInterval, feederInterval);
+
+			printf("%6lld Hz %-22s %10.0f %9.1f%% %7.1f us %7.1f us\n", static_cast<long long>(1000000 / pollInterval),
+			       mode, result.SubmitsPerSecond, result.RepeatedPercent, result.MeanTimestampError,
+			       result.MaxTimestampError);
+		}
+	}
+
+	//
+	// Cost per delivered report, touch data changing every other report
+	// 
+	static const ULONG ITERATIONS = 10000000;
+
+	Ds4ReportCounters counters;
+	DS4_REPORT_EX report{};
+
+	report.Report.bTouchPacketsN = 1;
+
+	const auto start = std::chrono::steady_clock::now();
+
+	for (ULONG iteration = 0; iteration < ITERATIONS; iteration++)
+	{
+		report.Report.sCurrentTouch.bTouchData1[0] = static_cast<BYTE>(iteration >> 1);
+
+		counters.Advance(static_cast<LONGLONG>(iteration) * 1000, FREQUENCY, &report);
+		Sink = Sink + report.Report.wTimestamp;
+	}
+
+	const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+
+	printf("\n%.2f ns per delivered report\n", elapsed.count() / ITERATIONS);
+
+	return 0;
+}
@@ -0,0 +1,159 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Host tests of the DS4 report counters the bus maintains on delivery
+// 
+
+#include <Windows.h>
+#include <ViGEm/km/BusShared.h>
+
+#include "Ds4ReportCounters.hpp"
+
+#include "HostTest.hpp"
+
+using ViGEm::Bus::Core::Ds4ReportCounters;
+
+HOST_TEST(Ds4ReportCountersFrameCounterWraps)
+{
+	Ds4ReportCounters counters;
+	DS4_REPORT_EX report{};
+
+	report.Report.bSpecial = DS4_SPECIAL_BUTTON_TOUCHPAD;
+
+	for (ULONG index = 0; index < 64; index++)
+	{
+		counters.Advance(0, 1000000, &report);
+		CHECK_EQUAL(report.Report.bSpecial >> 2, index);
+	}
+
+	counters.Advance(0, 1000000, &report);
+
+	CHECK_EQUAL(report.Report.bSpecial >> 2, 0);
+	CHECK_EQUAL(report.Report.bSpecial & 0x03, DS4_SPECIAL_BUTTON_TOUCHPAD);
+	CHECK_EQUAL(counters.Frame(), 1);
+}
+
+HOST_TEST(Ds4ReportCountersTimestampWraps)
+{
+	Ds4ReportCounters counters;
+	DS4_REPORT_EX report{};
+	const LONGLONG frequency = 10000000;
+
+	counters.Advance(5000, frequency, &report);
+	CHECK_EQUAL(report.Report.wTimestamp, 0);
+
+	//
+	// 187500 steps per second, wrapping at 16 bits
+	// 
+	counters.Advance(5000 + frequency, frequency, &report);
+	CHECK_EQUAL(report.Report.wTimestamp, 187500 - 65536 * 2);
+
+	counters.Advance(5000 + frequency / 1000, frequency, &report);
+	CHECK_EQUAL(report.Report.wTimestamp, 187);
+
+	counters.Reset();
+	counters.Advance(0, frequency, &report);
+	CHECK_EQUAL(report.Report.wTimestamp, 0);
+	CHECK_EQUAL(report.Report.bSpecial >> 2, 0);
+}
+
+HOST_TEST(Ds4ReportCountersTouchPacketOnChangeOnly)
+{
+	Ds4ReportCounters counters;
+	DS4_REPORT_EX report{};
+
+	counters.Advance(0, 1000000, &report);
+	CHECK_EQUAL(counters.TouchPacket(), 0);
+
+	report.Report.bTouchPacketsN = 1;
+	report.Report.sCurrentTouch.bIsUpTrackingNum1 = 0x80;
+
+	counters.Advance(0, 1000000, &report);
+	CHECK_EQUAL(report.Report.sCurrentTouch.bPacketCounter, 1);
+
+	counters.Advance(0, 1000000, &report);
+	CHECK_EQUAL(report.Report.sCurrentTouch.bPacketCounter, 1);
+
+	//
+	// Wraps at 8 bits
+	// 
+	for (ULONG index = 0; index < 256; index++)
+	{
+		report.Report.sCurrentTouch.bTouchData1[0] = static_cast<BYTE>(index + 1);
+		counters.Advance(0, 1000000, &report);
+	}
+
+	CHECK_EQUAL(report.Report.sCurrentTouch.bPacketCounter, 1);
+}
+
+HOST_TEST(Ds4ReportCountersKeepsButtonsAndUntouchedPackets)
+{
+	Ds4ReportCounters counters;
+	DS4_REPORT_EX report{};
+
+	report.Report.bSpecial = DS4_SPECIAL_BUTTON_PS;
+	report.Report.sCurrentTouch.bPacketCounter = 7;
+
+	for (ULONG index = 0; index < 3; index++)
+	{
+		counters.Advance(index * 1000, 1000000, &report);
+
+		CHECK_EQUAL(report.Report.bSpecial & 0x03, DS4_SPECIAL_BUTTON_PS);
+		CHECK_EQUAL(report.Report.sCurrentTouch.bPacketCounter, 7);
+	}
+
+	CHECK_EQUAL(counters.TouchPacket(), 0);
+}
+
+HOST_TEST(Ds4ReportCountersTimestampIgnoresBadClock)
+{
+	Ds4ReportCounters counters;
+	DS4_REPORT_EX report{};
+
+	counters.Advance(1000000, 1000000, &report);
+
+	//
+	// Zero frequency and a counter going backwards both stamp the epoch
+	// 
+	counters.Advance(2000000, 0, &report);
+	CHECK_EQUAL(report.Report.wTimestamp, 0);
+
+	counters.Advance(500000, 1000000, &report);
+	CHECK_EQUAL(report.Report.wTimestamp, 0);
+
+	counters.Advance(1000000 + 16, 1000000, &report);
+	CHECK_EQUAL(report.Report.wTimestamp, 3);
+}
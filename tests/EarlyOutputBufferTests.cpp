@@ -0,0 +1,169 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Host tests of the early output buffer, replaying output sent before the first
+// notification request
+// 
+
+#include <Windows.h>
+
+#include "EarlyOutputBuffer.hpp"
+
+#include "HostTest.hpp"
+
+#include <cstring>
+#include <vector>
+
+using ViGEm::Bus::Core::EarlyOutputBuffer;
+
+namespace
+{
+	typedef std::vector<UCHAR> Packet;
+
+	//
+	// Mirrors QueueOutput and CreateOutputBufferQueue: packets are held back until
+	// the first notification request creates the queue, then replayed in front
+	// 
+	class OutputPath
+	{
+	public:
+		void HostSends(const Packet& Data)
+		{
+			if (!this->_QueueCreated)
+				this->_Early.Store(Data.data(), static_cast<ULONG>(Data.size()));
+			else
+				this->Queue.push_back(Data);
+		}
+
+		void FirstNotificationRequest()
+		{
+			this->_QueueCreated = true;
+
+			this->_Early.Replay([this](const VOID* Buffer, ULONG Length)
+			{
+				const auto bytes = static_cast<const UCHAR*>(Buffer);
+
+				this->Queue.emplace_back(bytes, bytes + Length);
+			});
+		}
+
+		std::vector<Packet> Queue;
+
+	private:
+		EarlyOutputBuffer<4, 32> _Early;
+
+		bool _QueueCreated{};
+	};
+}
+
+#pragma region EarlyOutputBuffer
+
+HOST_TEST(EarlyOutputBootLedIsDelivered)
+{
+	OutputPath path;
+	const Packet led = { 0x01, 0x03, 0x02 };
+	const Packet rumble = { 0x00, 0x08, 0x00, 0x40, 0x80, 0x00, 0x00, 0x00 };
+
+	//
+	// XUSB: the host sets the player LED while the client is still plugging in
+	// 
+	path.HostSends(led);
+	CHECK(path.Queue.empty());
+
+	path.FirstNotificationRequest();
+	path.HostSends(rumble);
+
+	if (CHECK_EQUAL(path.Queue.size(), 2))
+	{
+		CHECK(path.Queue[0] == led);
+		CHECK(path.Queue[1] == rumble);
+	}
+}
+
+HOST_TEST(EarlyOutputLightbarIsDelivered)
+{
+	OutputPath path;
+
+	//
+	// DS4: rumble 0, lightbar 0x00 0x00 0x40 like the initial host write
+	// 
+	const Packet lightbar = { 0x00, 0x00, 0x00, 0x00, 0x40 };
+
+	path.HostSends(lightbar);
+	path.FirstNotificationRequest();
+
+	if (CHECK_EQUAL(path.Queue.size(), 1))
+		CHECK(path.Queue[0] == lightbar);
+
+	//
+	// Nothing is replayed twice
+	// 
+	path.FirstNotificationRequest();
+	CHECK_EQUAL(path.Queue.size(), 1);
+}
+
+HOST_TEST(EarlyOutputKeepsNewestPackets)
+{
+	EarlyOutputBuffer<4, 32> buffer;
+	std::vector<UCHAR> replayed;
+
+	for (UCHAR index = 0; index < 6; index++)
+		CHECK(buffer.Store(&index, 1));
+
+	CHECK_EQUAL(buffer.Count(), 4);
+	CHECK_EQUAL(buffer.Dropped(), 2);
+
+	CHECK_EQUAL(buffer.Replay([&](const VOID* Buffer, ULONG Length)
+	{
+		CHECK_EQUAL(Length, 1);
+		replayed.push_back(*static_cast<const UCHAR*>(Buffer));
+	}), 4);
+
+	CHECK(replayed == std::vector<UCHAR>({ 2, 3, 4, 5 }));
+	CHECK_EQUAL(buffer.Count(), 0);
+}
+
+HOST_TEST(EarlyOutputRejectsOversizedPackets)
+{
+	EarlyOutputBuffer<4, 32> buffer;
+	UCHAR packet[33] = {};
+
+	CHECK(!buffer.Store(packet, sizeof(packet)));
+	CHECK(buffer.Store(packet, sizeof(packet) - 1));
+	CHECK_EQUAL(buffer.Count(), 1);
+}
+
+#pragma endregion
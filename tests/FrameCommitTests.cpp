@@ -0,0 +1,289 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Host tests of frame staging and commits
+// 
+
+#include <Windows.h>
+
+#include "FrameCommit.hpp"
+
+#include "HostTest.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace ViGEm::Bus::Core;
+
+namespace
+{
+	typedef const void* OWNER;
+
+	const int OWNER_A = 1;
+	const int OWNER_B = 2;
+
+	struct Target
+	{
+		//
+		// Stands in for the target's report lock
+		// 
+		std::mutex Lock;
+
+		//
+		// Stands in for the cached report, carries the epoch it was committed with
+		// 
+		LONGLONG Current{};
+
+		FrameStage<LONGLONG, OWNER> Staged;
+	};
+
+	//
+	// Commits what Owner staged, the way the driver walks its staged list
+	// 
+	ULONG Commit(std::vector<Target>& Targets, OWNER Owner, std::mutex& StagingLock, void (*OnApplied)() = nullptr)
+	{
+		std::lock_guard<std::mutex> staging(StagingLock);
+		std::vector<Target*> frame;
+		ULONG count = 0;
+
+		for (auto& target : Targets)
+		{
+			if (target.Staged.IsStagedBy(Owner))
+				frame.push_back(&target);
+		}
+
+		CommitFrame(
+			[&frame](auto&& Function)
+			{
+				for (const auto target : frame)
+					Function(target);
+			},
+			[](Target* Target) { Target->Lock.lock(); },
+			[&count, OnApplied](Target* Target)
+			{
+				Target->Current = *Target->Staged.Take();
+				count++;
+
+				if (OnApplied)
+					OnApplied();
+			},
+			[](Target* Target) { Target->Lock.unlock(); }
+		);
+
+		return count;
+	}
+}
+
+HOST_TEST(FrameStageTracksOwner)
+{
+	FrameStage<LONGLONG, OWNER> stage;
+
+	CHECK(!stage.IsStaged());
+	CHECK(!stage.IsStagedBy(nullptr));
+
+	stage.Stage(1, &OWNER_A);
+	stage.Stage(2, &OWNER_A);
+
+	CHECK(stage.IsStagedBy(&OWNER_A));
+	CHECK(!stage.IsStagedBy(&OWNER_B));
+
+	//
+	// Restaging replaced the report
+	// 
+	CHECK_EQUAL(*stage.Take(), 2);
+	CHECK(!stage.IsStaged());
+
+	stage.Stage(3, &OWNER_B);
+	stage.Discard();
+	CHECK(!stage.IsStaged());
+}
+
+HOST_TEST(FrameCommitOnlyAppliesOwnersTargets)
+{
+	std::vector<Target> targets(3);
+	std::mutex staging;
+
+	targets[0].Staged.Stage(10, &OWNER_A);
+	targets[1].Staged.Stage(11, &OWNER_A);
+	targets[2].Staged.Stage(12, &OWNER_B);
+
+	CHECK_EQUAL(Commit(targets, &OWNER_A, staging), 2);
+
+	CHECK_EQUAL(targets[0].Current, 10);
+	CHECK_EQUAL(targets[1].Current, 11);
+	CHECK_EQUAL(targets[2].Current, 0);
+	CHECK(targets[2].Staged.IsStagedBy(&OWNER_B));
+
+	//
+	// Nothing left to commit for A
+	// 
+	CHECK_EQUAL(Commit(targets, &OWNER_A, staging), 0);
+	CHECK_EQUAL(Commit(targets, &OWNER_B, staging), 1);
+	CHECK_EQUAL(targets[2].Current, 12);
+}
+
+namespace
+{
+	std::vector<Target>* PolledTargets;
+
+	ULONG MixedPolls;
+
+	//
+	// Host poll issued in the middle of a commit: a target it can't lock would make it 
+	// wait for the commit to finish, so what it can read must all be of one epoch
+	// 
+	void Poll()
+	{
+		LONGLONG seen = -1;
+
+		for (auto& target : *PolledTargets)
+		{
+			if (!target.Lock.try_lock())
+				continue;
+
+			const auto epoch = target.Current;
+
+			target.Lock.unlock();
+
+			if (seen >= 0 && epoch != seen)
+				MixedPolls++;
+
+			seen = epoch;
+		}
+	}
+
+	void PollDuringCommit()
+	{
+		//
+		// From another thread, the committer owns the locks
+		// 
+		std::thread(Poll).join();
+	}
+}
+
+HOST_TEST(FrameCommitHoldsFrameDuringApply)
+{
+	std::vector<Target> targets(4);
+	std::mutex staging;
+
+	PolledTargets = &targets;
+	MixedPolls = 0;
+
+	for (LONGLONG epoch = 1; epoch <= 3; epoch++)
+	{
+		for (auto& target : targets)
+			target.Staged.Stage(epoch, &OWNER_A);
+
+		CHECK_EQUAL(Commit(targets, &OWNER_A, staging, PollDuringCommit), 4);
+	}
+
+	CHECK_EQUAL(MixedPolls, 0);
+}
+
+HOST_TEST(FrameCommitNeverShowsMixedEpoch)
+{
+	static const ULONG TARGETS = 8;
+	static const LONGLONG EPOCHS = 2000;
+
+	std::vector<Target> targets(TARGETS);
+	std::mutex staging;
+	std::atomic<bool> done{ false };
+	std::atomic<ULONG> mixed{ 0 };
+	std::atomic<ULONG> polls{ 0 };
+
+	//
+	// A poll reads every target once, each under its own lock only. Since epochs 
+	// only grow, a later read seeing an older epoch than an earlier one means the
+	// poll saw part of a frame.
+	// 
+	const auto poll = [&](bool Reverse)
+	{
+		while (!done)
+		{
+			LONGLONG previous = 0;
+
+			for (ULONG index = 0; index < TARGETS; index++)
+			{
+				auto& target = targets[Reverse ? TARGETS - 1 - index : index];
+				LONGLONG epoch;
+
+				{
+					std::lock_guard<std::mutex> lock(target.Lock);
+					epoch = target.Current;
+				}
+
+				if (epoch < previous)
+					mixed++;
+
+				previous = epoch;
+			}
+
+			polls++;
+
+			std::this_thread::yield();
+		}
+	};
+
+	std::thread forward(poll, false);
+	std::thread reverse(poll, true);
+
+	while (polls < 2)
+		std::this_thread::yield();
+
+	for (LONGLONG epoch = 1; epoch <= EPOCHS; epoch++)
+	{
+		{
+			std::lock_guard<std::mutex> lock(staging);
+
+			for (auto& target : targets)
+				target.Staged.Stage(epoch, &OWNER_A);
+		}
+
+		CHECK_EQUAL(Commit(targets, &OWNER_A, staging), TARGETS);
+	}
+
+	done = true;
+	forward.join();
+	reverse.join();
+
+	CHECK_EQUAL(mixed.load(), 0);
+	CHECK(polls.load() > 0);
+
+	for (auto& target : targets)
+		CHECK_EQUAL(target.Current, EPOCHS);
+}
@@ -0,0 +1,96 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "HostTest.hpp"
+
+namespace
+{
+	HostTest::Registration* Tests;
+
+	HostTest::Registration** Tail = &Tests;
+
+	int Failures;
+}
+
+//
+// Tests run in the order they are defined
+// 
+HostTest::Registration::Registration(const char* Name, TEST_FUNCTION Function)
+	: Name(Name), Function(Function), Next(nullptr)
+{
+	*Tail = this;
+	Tail = &this->Next;
+}
+
+bool HostTest::Check(bool Condition, const char* Expression, const char* File, int Line)
+{
+	if (!Condition)
+	{
+		std::printf("%s:%d: check failed: %s\n", File, Line, Expression);
+		Failures++;
+	}
+
+	return Condition;
+}
+
+bool HostTest::CheckEqual(long long Actual, long long Expected, const char* Expression, const char* File, int Line)
+{
+	if (Actual != Expected)
+	{
+		std::printf("%s:%d: %s is %lld, expected %lld\n", File, Line, Expression, Actual, Expected);
+		Failures++;
+	}
+
+	return Actual == Expected;
+}
+
+int main()
+{
+	int tests = 0;
+
+	for (auto test = Tests; test; test = test->Next)
+	{
+		const auto failures = Failures;
+
+		test->Function();
+		tests++;
+
+		std::printf("[%s] %s\n", (Failures == failures) ? "PASS" : "FAIL", test->Name);
+	}
+
+	std::printf("%d tests, %d failed checks\n", tests, Failures);
+
+	return (Failures == 0) ? 0 : 1;
+}
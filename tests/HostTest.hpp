@@ -0,0 +1,72 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include <cstdio>
+
+//
+// Minimal self-registering test harness for host builds of the portable code
+// 
+namespace HostTest
+{
+	typedef void (*TEST_FUNCTION)();
+
+	struct Registration
+	{
+		const char* Name;
+
+		TEST_FUNCTION Function;
+
+		Registration* Next;
+
+		Registration(const char* Name, TEST_FUNCTION Function);
+	};
+
+	bool Check(bool Condition, const char* Expression, const char* File, int Line);
+
+	bool CheckEqual(long long Actual, long long Expected, const char* Expression, const char* File, int Line);
+}
+
+#define HOST_TEST(Name) \
+	static void Name(); \
+	static HostTest::Registration Name##Registration(#Name, Name); \
+	static void Name()
+
+#define CHECK(Condition) \
+	HostTest::Check((Condition), #Condition, __FILE__, __LINE__)
+
+#define CHECK_EQUAL(Actual, Expected) \
+	HostTest::CheckEqual(static_cast<long long>(Actual), static_cast<long long>(Expected), #Actual, __FILE__, __LINE__)
@@ -0,0 +1,203 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// A feeder streaming motion samples at its own rate while the host polls at
+// another: compares the motion error of interpolating at poll time with
+// sending the latest sample, and times the resampler
+// 
+
+#include <Windows.h>
+#include <ViGEm/km/BusShared.h>
+
+#include "ImuResampler.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using ViGEm::Bus::Core::ImuResampler;
+
+//
+// Timestamps in microseconds
+// 
+static const LONGLONG DURATION = 2000000;
+static const LONGLONG HOLD = 8000;
+
+static const ULONG BATCH = 4;
+
+static volatile LONG Sink;
+
+//
+// Gyro reading of a controller swept back and forth twice a second
+// 
+static SHORT Motion(LONGLONG Time)
+{
+	return static_cast<SHORT>(12000.0 * std::sin(2.0 * 3.14159265358979 * 2.0 * Time / 1000000.0));
+}
+
+struct Error
+{
+	double Mean;
+	double Max;
+
+	//
+	// Average age of the motion handed to the host
+	// 
+	double Delay;
+};
+
+//
+// Samples arrive in batches of BATCH, every sample carries its capture time
+// 
+static Error Run(LONGLONG SampleInterval, LONGLONG PollInterval, bool Interpolate)
+{
+	std::mt19937 random(46);
+	std::uniform_int_distribution<LONGLONG> jitter(-PollInterval / 8, PollInterval / 8);
+	ImuResampler resampler;
+	DS4_IMU_SAMPLE batch[BATCH]{};
+	DS4_IMU_SAMPLE latest{};
+	DS4_IMU_SAMPLE sample{};
+	LONGLONG captured = 0;
+	double sum = 0, max = 0, delay = 0;
+	ULONG polls = 0;
+
+	for (LONGLONG poll = PollInterval; poll < DURATION; poll += PollInterval)
+	{
+		const auto now = poll + jitter(random);
+
+		//
+		// Everything captured up to one batch ago has been submitted
+		// 
+		while (captured + BATCH * SampleInterval <= now)
+		{
+			for (ULONG index = 0; index < BATCH; index++)
+			{
+				captured += SampleInterval;
+				batch[index].Timestamp = captured;
+				batch[index].wGyroX = Motion(captured);
+			}
+
+			resampler.Push(batch, BATCH);
+			latest = batch[BATCH - 1];
+		}
+
+		//
+		// Interpolation runs one batch behind so there's a sample on either side
+		// 
+		const auto time = now - BATCH * SampleInterval;
+
+		if (Interpolate)
+		{
+			if (!resampler.Resample(time, HOLD, &sample))
+				continue;
+		}
+		else
+		{
+			sample = latest;
+		}
+
+		const auto error = std::fabs(static_cast<double>(sample.wGyroX) - Motion(Interpolate ? time : now));
+
+		sum += error;
+		max = (error > max) ? error : max;
+		delay += static_cast<double>(now - (Interpolate ? time : latest.Timestamp));
+		polls++;
+	}
+
+	return { polls ? sum / polls : 0, max, polls ? delay / polls : 0 };
+}
+
+int main()
+{
+	const struct
+	{
+		LONGLONG Sample;
+		LONGLONG Poll;
+	} rates[] = {
+		{ 1000, 4000 },
+		{ 1000, 1000 },
+		{ 2500, 1000 },
+		{ 5000, 1000 },
+	};
+
+	printf("%-9s %-9s %-14s %9s %9s %9s\n", "samples", "polls", "mode", "mean err", "max err", "delay us");
+
+	for (const auto& rate : rates)
+	{
+		const auto held = Run(rate.Sample, rate.Poll, false);
+		const auto resampled = Run(rate.Sample, rate.Poll, true);
+		const auto sampleRate = static_cast<long long>(1000000 / rate.Sample);
+		const auto pollRate = static_cast<long long>(1000000 / rate.Poll);
+
+		printf("%6lld Hz %6lld Hz %-14s %9.1f %9.1f %9.0f\n", sampleRate, pollRate,
+		       "latest sample", held.Mean, held.Max, held.Delay);
+		printf("%6lld Hz %6lld Hz %-14s %9.1f %9.1f %9.0f\n", sampleRate, pollRate,
+		       "resampled", resampled.Mean, resampled.Max, resampled.Delay);
+	}
+
+	//
+	// Cost per poll with the buffer kept half full
+	// 
+	static const ULONG ITERATIONS = 1000000;
+
+	ImuResampler resampler;
+	DS4_IMU_SAMPLE samples[2]{};
+	DS4_IMU_SAMPLE sample{};
+
+	const auto start = std::chrono::steady_clock::now();
+
+	for (ULONG iteration = 0; iteration < ITERATIONS; iteration++)
+	{
+		const LONGLONG base = static_cast<LONGLONG>(iteration) * 2000;
+
+		samples[0].Timestamp = base + 1000;
+		samples[0].wGyroX = static_cast<SHORT>(iteration);
+		samples[1].Timestamp = base + 2000;
+		samples[1].wGyroX = static_cast<SHORT>(iteration + 1);
+
+		resampler.Push(samples, 2);
+
+		if (resampler.Resample(base - 64000, HOLD, &sample))
+			Sink = Sink + sample.wGyroX;
+	}
+
+	const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+
+	printf("\n%.2f ns per poll (push of 2 samples plus resample)\n", elapsed.count() / ITERATIONS);
+
+	return 0;
+}
@@ -0,0 +1,129 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Host tests of the motion sample resampler
+// 
+
+#include <Windows.h>
+#include <ViGEm/km/BusShared.h>
+
+#include "ImuResampler.hpp"
+
+#include "HostTest.hpp"
+
+using ViGEm::Bus::Core::ImuResampler;
+
+#pragma region ImuResampler
+
+HOST_TEST(ImuResamplerInterpolatesAndHolds)
+{
+	ImuResampler resampler;
+	DS4_IMU_SAMPLE samples[3]{};
+	DS4_IMU_SAMPLE sample{};
+
+	samples[0].Timestamp = 100;
+	samples[1].Timestamp = 200;
+	samples[1].wGyroX = 100;
+	samples[1].wAccelZ = -101;
+	samples[2].Timestamp = 150;
+
+	//
+	// Out of order samples are skipped
+	// 
+	CHECK_EQUAL(resampler.Push(samples, 3), 2);
+
+	CHECK(resampler.Resample(50, 100, &sample));
+	CHECK_EQUAL(sample.wGyroX, 0);
+	CHECK_EQUAL(sample.Timestamp, 50);
+
+	CHECK(resampler.Resample(150, 100, &sample));
+	CHECK_EQUAL(sample.wGyroX, 50);
+	CHECK_EQUAL(sample.wAccelZ, -51);
+
+	CHECK(resampler.Resample(250, 100, &sample));
+	CHECK_EQUAL(sample.wGyroX, 100);
+	CHECK_EQUAL(resampler.Underruns(), 1);
+
+	CHECK(!resampler.Resample(301, 100, &sample));
+	CHECK_EQUAL(resampler.Count(), 0);
+}
+
+HOST_TEST(ImuResamplerDropsOldestWhenFull)
+{
+	const ULONG count = ImuResampler::CAPACITY + 8;
+	ImuResampler resampler;
+	DS4_IMU_SAMPLE samples[count]{};
+	DS4_IMU_SAMPLE sample{};
+
+	for (ULONG index = 0; index < count; index++)
+	{
+		samples[index].Timestamp = 10 * (index + 1);
+		samples[index].wGyroY = static_cast<SHORT>(index);
+	}
+
+	CHECK_EQUAL(resampler.Push(samples, count), count);
+	CHECK_EQUAL(resampler.Count(), ImuResampler::CAPACITY);
+
+	//
+	// The first eight samples got pushed out
+	// 
+	CHECK(resampler.Resample(0, 10, &sample));
+	CHECK_EQUAL(sample.wGyroY, 8);
+}
+
+HOST_TEST(ImuResamplerRestartsAfterHoldExpired)
+{
+	ImuResampler resampler;
+	DS4_IMU_SAMPLE sample{};
+	DS4_IMU_SAMPLE latest{};
+
+	latest.Timestamp = 100;
+	latest.wAccelX = 42;
+
+	resampler.Push(&latest, 1);
+
+	CHECK(resampler.Resample(150, 50, &sample));
+	CHECK_EQUAL(sample.wAccelX, 42);
+	CHECK(!resampler.Resample(151, 50, &sample));
+
+	//
+	// A reset buffer takes samples older than the dropped one
+	// 
+	latest.Timestamp = 90;
+	CHECK_EQUAL(resampler.Push(&latest, 1), 1);
+}
+
+#pragma endregion
@@ -0,0 +1,223 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Throughput of the input fusion reducer for one to four writers, against a
+// straightforward branching reducer for XUSB
+// 
+
+#include <Windows.h>
+#include <ViGEm/km/BusShared.h>
+
+#include "InputFusion.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using ViGEm::Bus::Core::InputFusion;
+
+static const ULONG BATCH_SIZE = 4096;
+static const ULONG ITERATIONS = 500;
+
+static volatile ULONG Sink;
+
+//
+// Max-magnitude reducer as a user-space merge hop would write it
+// 
+static void BranchingFuseXusb(const XUSB_REPORT* const Reports[InputFusion::MAX_WRITERS], XUSB_REPORT* Fused)
+{
+	LONGLONG leftBest = -1, rightBest = -1;
+	LONG leftTriggerBest = -1, rightTriggerBest = -1;
+
+	*Fused = {};
+
+	for (ULONG i = 0; i < InputFusion::MAX_WRITERS; i++)
+	{
+		const auto report = Reports[i];
+
+		if (!report)
+			continue;
+
+		Fused->wButtons |= report->wButtons;
+
+		const LONGLONG left = static_cast<LONGLONG>(report->sThumbLX) * report->sThumbLX
+			+ static_cast<LONGLONG>(report->sThumbLY) * report->sThumbLY;
+
+		if (left > leftBest)
+		{
+			leftBest = left;
+			Fused->sThumbLX = report->sThumbLX;
+			Fused->sThumbLY = report->sThumbLY;
+		}
+
+		const LONGLONG right = static_cast<LONGLONG>(report->sThumbRX) * report->sThumbRX
+			+ static_cast<LONGLONG>(report->sThumbRY) * report->sThumbRY;
+
+		if (right > rightBest)
+		{
+			rightBest = right;
+			Fused->sThumbRX = report->sThumbRX;
+			Fused->sThumbRY = report->sThumbRY;
+		}
+
+		if (report->bLeftTrigger > leftTriggerBest)
+		{
+			leftTriggerBest = report->bLeftTrigger;
+			Fused->bLeftTrigger = report->bLeftTrigger;
+		}
+
+		if (report->bRightTrigger > rightTriggerBest)
+		{
+			rightTriggerBest = report->bRightTrigger;
+			Fused->bRightTrigger = report->bRightTrigger;
+		}
+	}
+}
+
+template <typename Body>
+static void Measure(const char* Name, ULONG Writers, Body&& Fuse)
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	for (ULONG iteration = 0; iteration < ITERATIONS; iteration++)
+		Fuse();
+
+	const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+
+	printf("%-26s %lu writers %8.2f ns/fuse\n",
+	       Name,
+	       static_cast<unsigned long>(Writers),
+	       elapsed.count() / (static_cast<double>(ITERATIONS) * BATCH_SIZE));
+}
+
+int main()
+{
+	std::mt19937 random(41);
+	std::vector<XUSB_REPORT> xusb(BATCH_SIZE * InputFusion::MAX_WRITERS);
+	std::vector<DS4_REPORT_EX> ds4(BATCH_SIZE * InputFusion::MAX_WRITERS);
+	const UCHAR priorities[InputFusion::MAX_WRITERS] = { 3, 1, 2, 0 };
+	XUSB_REPORT xusbFused;
+	DS4_REPORT_EX ds4Fused;
+
+	//
+	// Random deflections defeat the branch predictor like independent writers do
+	// 
+	for (auto& report : xusb)
+	{
+		report.wButtons = static_cast<USHORT>(random());
+		report.bLeftTrigger = static_cast<BYTE>(random());
+		report.bRightTrigger = static_cast<BYTE>(random());
+		report.sThumbLX = static_cast<SHORT>(random());
+		report.sThumbLY = static_cast<SHORT>(random());
+		report.sThumbRX = static_cast<SHORT>(random());
+		report.sThumbRY = static_cast<SHORT>(random());
+	}
+
+	for (auto& report : ds4)
+	{
+		DS4_REPORT_INIT(reinterpret_cast<PDS4_REPORT>(&report));
+		report.Report.wButtons = static_cast<USHORT>(random() & ~0xF) | static_cast<USHORT>(random() % 9);
+		report.Report.bThumbLX = static_cast<BYTE>(random());
+		report.Report.bThumbLY = static_cast<BYTE>(random());
+		report.Report.bThumbRX = static_cast<BYTE>(random());
+		report.Report.bThumbRY = static_cast<BYTE>(random());
+		report.Report.bTriggerL = static_cast<BYTE>(random());
+		report.Report.bTriggerR = static_cast<BYTE>(random());
+	}
+
+	for (ULONG writers = 1; writers <= InputFusion::MAX_WRITERS; writers++)
+	{
+		auto xusbReports = [&](ULONG Index, const XUSB_REPORT* Reports[InputFusion::MAX_WRITERS])
+		{
+			for (ULONG writer = 0; writer < InputFusion::MAX_WRITERS; writer++)
+				Reports[writer] = (writer < writers) ? &xusb[Index * InputFusion::MAX_WRITERS + writer] : nullptr;
+		};
+
+		Measure("Branching XUSB", writers, [&]
+		{
+			const XUSB_REPORT* reports[InputFusion::MAX_WRITERS];
+
+			for (ULONG index = 0; index < BATCH_SIZE; index++)
+			{
+				xusbReports(index, reports);
+				BranchingFuseXusb(reports, &xusbFused);
+				Sink = Sink + xusbFused.wButtons;
+			}
+		});
+
+		Measure("FuseXusb max magnitude", writers, [&]
+		{
+			const XUSB_REPORT* reports[InputFusion::MAX_WRITERS];
+
+			for (ULONG index = 0; index < BATCH_SIZE; index++)
+			{
+				xusbReports(index, reports);
+				InputFusion::FuseXusb(reports, priorities, VigemFusionPolicyMaxMagnitude, &xusbFused);
+				Sink = Sink + xusbFused.wButtons;
+			}
+		});
+
+		Measure("FuseXusb priority", writers, [&]
+		{
+			const XUSB_REPORT* reports[InputFusion::MAX_WRITERS];
+
+			for (ULONG index = 0; index < BATCH_SIZE; index++)
+			{
+				xusbReports(index, reports);
+				InputFusion::FuseXusb(reports, priorities, VigemFusionPolicyPriority, &xusbFused);
+				Sink = Sink + xusbFused.wButtons;
+			}
+		});
+
+		Measure("FuseDs4 max magnitude", writers, [&]
+		{
+			const DS4_REPORT_EX* reports[InputFusion::MAX_WRITERS];
+
+			for (ULONG index = 0; index < BATCH_SIZE; index++)
+			{
+				for (ULONG writer = 0; writer < InputFusion::MAX_WRITERS; writer++)
+					reports[writer] = (writer < writers) ? &ds4[index * InputFusion::MAX_WRITERS + writer] : nullptr;
+
+				InputFusion::FuseDs4(reports, priorities, VigemFusionPolicyMaxMagnitude, &ds4Fused);
+				Sink = Sink + ds4Fused.Report.wButtons;
+			}
+		});
+	}
+
+	return 0;
+}
@@ -0,0 +1,141 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Host tests of the input fusion reducer
+// 
+
+#include <Windows.h>
+#include <ViGEm/km/BusShared.h>
+
+#include "InputFusion.hpp"
+
+#include "HostTest.hpp"
+
+using ViGEm::Bus::Core::InputFusion;
+
+#pragma region InputFusion
+
+HOST_TEST(InputFusionXusbMaxMagnitude)
+{
+	XUSB_REPORT a{}, b{}, fused{};
+	const XUSB_REPORT* reports[InputFusion::MAX_WRITERS] = { &a, &b, nullptr, nullptr };
+	const UCHAR priorities[InputFusion::MAX_WRITERS] = { 0, 1, 0, 0 };
+
+	a.wButtons = XUSB_GAMEPAD_A;
+	a.sThumbLX = 1000;
+	a.bLeftTrigger = 200;
+	b.wButtons = XUSB_GAMEPAD_B;
+	b.sThumbLX = -20000;
+	b.bLeftTrigger = 100;
+
+	InputFusion::FuseXusb(reports, priorities, VigemFusionPolicyMaxMagnitude, &fused);
+
+	CHECK_EQUAL(fused.wButtons, XUSB_GAMEPAD_A | XUSB_GAMEPAD_B);
+	CHECK_EQUAL(fused.sThumbLX, -20000);
+	CHECK_EQUAL(fused.bLeftTrigger, 200);
+
+	//
+	// The higher priority writer wins every axis it deflects
+	// 
+	InputFusion::FuseXusb(reports, priorities, VigemFusionPolicyPriority, &fused);
+
+	CHECK_EQUAL(fused.sThumbLX, -20000);
+	CHECK_EQUAL(fused.bLeftTrigger, 100);
+}
+
+HOST_TEST(InputFusionDs4KeepsHatIntact)
+{
+	DS4_REPORT_EX a{}, b{}, fused{};
+	const DS4_REPORT_EX* reports[InputFusion::MAX_WRITERS] = { &a, nullptr, &b, nullptr };
+	const UCHAR priorities[InputFusion::MAX_WRITERS] = { 0, 0, 0, 0 };
+
+	DS4_REPORT_INIT(reinterpret_cast<PDS4_REPORT>(&a));
+	DS4_REPORT_INIT(reinterpret_cast<PDS4_REPORT>(&b));
+	a.Report.wButtons = DS4_BUTTON_CROSS | DS4_BUTTON_DPAD_NONE;
+	b.Report.wButtons = DS4_BUTTON_CIRCLE | DS4_BUTTON_DPAD_EAST;
+	b.Report.bThumbRY = 0x00;
+	a.Report.wGyroX = 123;
+
+	InputFusion::FuseDs4(reports, priorities, VigemFusionPolicyMaxMagnitude, &fused);
+
+	CHECK_EQUAL(fused.Report.wButtons, DS4_BUTTON_CROSS | DS4_BUTTON_CIRCLE | DS4_BUTTON_DPAD_EAST);
+	CHECK_EQUAL(fused.Report.bThumbRY, 0x00);
+	CHECK_EQUAL(fused.Report.bThumbLX, 0x80);
+	CHECK_EQUAL(fused.Report.wGyroX, 123);
+}
+
+#pragma endregion
+
+#pragma region InputFusion writers
+
+HOST_TEST(InputFusionSkipsDetachedWriters)
+{
+	XUSB_REPORT a{}, fused{};
+	const XUSB_REPORT* reports[InputFusion::MAX_WRITERS] = { nullptr, nullptr, nullptr, &a };
+	const UCHAR priorities[InputFusion::MAX_WRITERS] = { 9, 9, 9, 0 };
+
+	a.wButtons = XUSB_GAMEPAD_X;
+	a.sThumbRY = -1;
+	a.bRightTrigger = 1;
+
+	InputFusion::FuseXusb(reports, priorities, VigemFusionPolicyPriority, &fused);
+
+	CHECK_EQUAL(fused.wButtons, XUSB_GAMEPAD_X);
+	CHECK_EQUAL(fused.sThumbRY, -1);
+	CHECK_EQUAL(fused.bRightTrigger, 1);
+	CHECK_EQUAL(fused.sThumbLX, 0);
+}
+
+HOST_TEST(InputFusionPriorityIgnoresCenteredWriter)
+{
+	XUSB_REPORT high{}, low{}, fused{};
+	const XUSB_REPORT* reports[InputFusion::MAX_WRITERS] = { &high, &low, nullptr, nullptr };
+	const UCHAR priorities[InputFusion::MAX_WRITERS] = { 200, 1, 0, 0 };
+
+	//
+	// The high priority writer leaves the right stick centered
+	// 
+	high.sThumbLX = 10;
+	low.sThumbLX = 30000;
+	low.sThumbRX = 5;
+
+	InputFusion::FuseXusb(reports, priorities, VigemFusionPolicyPriority, &fused);
+
+	CHECK_EQUAL(fused.sThumbLX, 10);
+	CHECK_EQUAL(fused.sThumbRX, 5);
+}
+
+#pragma endregion
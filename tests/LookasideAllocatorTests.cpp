@@ -0,0 +1,128 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Host tests of the lookaside allocation mixin against the kernel stand-ins
+// 
+
+#include <Windows.h>
+#include <ntddk.h>
+
+#include "LookasideAllocator.hpp"
+
+#include "HostTest.hpp"
+
+using ViGEm::Bus::Core::LookasideAllocated;
+
+namespace
+{
+	class Target : public LookasideAllocated<Target, 'TSiV'>
+	{
+	public:
+		virtual ~Target() = default;
+
+		UCHAR State[512];
+	};
+
+	class DerivedTarget : public Target
+	{
+	public:
+		UCHAR Extra[64];
+	};
+}
+
+#pragma region LookasideAllocated
+
+HOST_TEST(LookasideCountsOutstandingBlocks)
+{
+	CHECK_EQUAL(Target::InitializeLookaside(), STATUS_SUCCESS);
+
+	const auto first = new Target();
+	const auto second = new Target();
+
+	CHECK_EQUAL(Target::Outstanding(), 2);
+
+	//
+	// Blocks of another size go to the pool and are not counted
+	// 
+	const auto derived = new DerivedTarget();
+
+	CHECK_EQUAL(Target::Outstanding(), 2);
+
+	delete derived;
+	delete first;
+	delete second;
+
+	CHECK_EQUAL(Target::Outstanding(), 0);
+
+	//
+	// A freed block is handed out again
+	// 
+	const auto recycled = new Target();
+
+	CHECK(recycled == first || recycled == second);
+
+	delete recycled;
+
+	Target::DeleteLookaside();
+}
+
+HOST_TEST(LookasideSurvivesDeleteWithOutstandingBlocks)
+{
+	const auto failures = HostAssertionFailures;
+
+	CHECK_EQUAL(Target::InitializeLookaside(), STATUS_SUCCESS);
+
+	const auto late = new Target();
+
+	//
+	// Deleting early asserts and keeps the list, the late free still returns
+	// the block where it came from
+	// 
+	Target::DeleteLookaside();
+
+	CHECK_EQUAL(HostAssertionFailures, failures + 1);
+	CHECK_EQUAL(Target::Outstanding(), 1);
+
+	delete late;
+
+	CHECK_EQUAL(Target::Outstanding(), 0);
+
+	Target::DeleteLookaside();
+
+	CHECK_EQUAL(HostAssertionFailures, failures + 1);
+}
+
+#pragma endregion
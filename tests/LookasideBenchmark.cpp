@@ -0,0 +1,155 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Plug/unplug churn through the lookaside mixin against the general-purpose
+// allocator, with unrelated allocations of random size in between
+// 
+
+#include <Windows.h>
+#include <ntddk.h>
+
+#include "LookasideAllocator.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using ViGEm::Bus::Core::LookasideAllocated;
+
+static const ULONG OPERATIONS = 2000000;
+
+//
+// Roughly the size of a target object and its per-target side allocations
+// 
+static const size_t TARGET_SIZE = 2048;
+static const size_t HEAP_SIZE = 1024;
+
+template <size_t Size>
+struct PlainBlock
+{
+	UCHAR Data[Size];
+};
+
+template <size_t Size>
+struct PooledBlock : LookasideAllocated<PooledBlock<Size>, 'BCiV'>
+{
+	UCHAR Data[Size];
+};
+
+static volatile ULONG Sink;
+
+template <template <size_t> class Block>
+static void Churn(const char* Name, ULONG Live)
+{
+	typedef Block<TARGET_SIZE> TargetBlock;
+	typedef Block<HEAP_SIZE> HeapBlock;
+
+	struct Slot
+	{
+		TargetBlock* Target;
+
+		HeapBlock* Heap;
+
+		void* Other;
+	};
+
+	std::mt19937 random(Live);
+	std::vector<Slot> slots(Live);
+
+	auto plug = [&](Slot& slot)
+	{
+		slot.Target = new TargetBlock();
+		slot.Heap = new HeapBlock();
+
+		//
+		// WDF objects and queues created along with the target
+		// 
+		slot.Other = malloc(64 + random() % 448);
+
+		Sink = Sink + slot.Target->Data[0] + slot.Heap->Data[0];
+	};
+
+	auto unplug = [&](Slot& slot)
+	{
+		delete slot.Target;
+		delete slot.Heap;
+		free(slot.Other);
+	};
+
+	for (auto& slot : slots)
+		plug(slot);
+
+	const auto start = std::chrono::steady_clock::now();
+
+	for (ULONG operation = 0; operation < OPERATIONS; operation++)
+	{
+		auto& slot = slots[random() % Live];
+
+		unplug(slot);
+		plug(slot);
+	}
+
+	const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+
+	for (auto& slot : slots)
+		unplug(slot);
+
+	printf("%-10s %3lu live targets: %7.1f ns per unplug + plug\n",
+	       Name,
+	       static_cast<unsigned long>(Live),
+	       elapsed.count() / OPERATIONS);
+}
+
+int main()
+{
+	PooledBlock<TARGET_SIZE>::InitializeLookaside();
+	PooledBlock<HEAP_SIZE>::InitializeLookaside();
+
+	const ULONG live[] = { 1, 16, 256 };
+
+	for (const auto count : live)
+	{
+		Churn<PlainBlock>("new/delete", count);
+		Churn<PooledBlock>("lookaside", count);
+	}
+
+	PooledBlock<TARGET_SIZE>::DeleteLookaside();
+	PooledBlock<HEAP_SIZE>::DeleteLookaside();
+
+	return 0;
+}
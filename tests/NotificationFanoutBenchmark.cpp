@@ -0,0 +1,166 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Cost of handing one output packet to 1, 4 and 16 subscribers through the
+// shared fan-out ring, against giving every subscriber a ring of its own
+// 
+
+#include <Windows.h>
+
+#include "NotificationFanout.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+
+using ViGEm::Bus::Core::NotificationFanout;
+
+//
+// Same geometry as the per-target ring in EmulationTargetPDO.hpp
+// 
+static const ULONG PACKETS = 32;
+static const ULONG PACKET_SIZE = 32;
+static const ULONG ITERATIONS = 200000;
+
+typedef NotificationFanout<PACKETS, PACKET_SIZE> Fanout;
+
+static volatile ULONG Sink;
+
+//
+// One private ring per subscriber, every packet gets copied for each of them
+// 
+class CopyingRings
+{
+public:
+	void Publish(const VOID* Data, ULONG Length, ULONG Subscribers)
+	{
+		for (ULONG subscriber = 0; subscriber < Subscribers; subscriber++)
+		{
+			auto& ring = this->_Rings[subscriber];
+			auto& packet = ring.Packets[ring.Head++ & (PACKETS - 1)];
+
+			RtlCopyMemory(packet.Data, Data, Length);
+			packet.Length = Length;
+		}
+	}
+
+	ULONG Consume(ULONG Subscriber)
+	{
+		auto& ring = this->_Rings[Subscriber];
+		const auto& packet = ring.Packets[ring.Tail++ & (PACKETS - 1)];
+
+		return packet.Data[0] + packet.Length;
+	}
+
+private:
+	struct RING
+	{
+		struct
+		{
+			ULONG Length;
+			UCHAR Data[PACKET_SIZE];
+		} Packets[PACKETS];
+
+		ULONG Head;
+		ULONG Tail;
+	};
+
+	RING _Rings[Fanout::MAX_SUBSCRIBERS]{};
+};
+
+template <typename Body>
+static double Measure(Body&& Deliver)
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	for (ULONG iteration = 0; iteration < ITERATIONS; iteration++)
+		Deliver(iteration);
+
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ITERATIONS;
+}
+
+int main()
+{
+	const ULONG counts[] = { 1, 4, 16 };
+	UCHAR packet[PACKET_SIZE] = {};
+
+	printf("%-12s %12s %12s %14s %14s\n", "subscribers", "fanout ns", "copying ns", "fanout bytes", "copying bytes");
+
+	for (const auto subscribers : counts)
+	{
+		const auto fanout = std::make_unique<Fanout>();
+		const auto copying = std::make_unique<CopyingRings>();
+		ULONG slots[Fanout::MAX_SUBSCRIBERS];
+
+		for (ULONG index = 0; index < subscribers; index++)
+			fanout->Subscribe(&slots[index]);
+
+		//
+		// Publish a packet, then let every subscriber read it like the
+		// pending notification requests do
+		// 
+		const auto shared = Measure([&](ULONG Iteration)
+		{
+			packet[0] = static_cast<UCHAR>(Iteration);
+			fanout->Publish(packet, sizeof(packet));
+
+			for (ULONG index = 0; index < subscribers; index++)
+			{
+				const auto received = fanout->Peek(slots[index]);
+				Sink = Sink + received->Data[0] + received->Length;
+				fanout->Release(slots[index]);
+			}
+		});
+
+		const auto copied = Measure([&](ULONG Iteration)
+		{
+			packet[0] = static_cast<UCHAR>(Iteration);
+			copying->Publish(packet, sizeof(packet), subscribers);
+
+			for (ULONG index = 0; index < subscribers; index++)
+				Sink = Sink + copying->Consume(index);
+		});
+
+		printf("%-12lu %12.2f %12.2f %14zu %14zu\n",
+		       static_cast<unsigned long>(subscribers),
+		       shared,
+		       copied,
+		       sizeof(Fanout),
+		       static_cast<size_t>(subscribers) * (sizeof(CopyingRings) / Fanout::MAX_SUBSCRIBERS));
+	}
+
+	return 0;
+}
@@ -0,0 +1,155 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Host tests of the notification fan-out ring
+// 
+
+#include <Windows.h>
+
+#include "NotificationFanout.hpp"
+
+#include "HostTest.hpp"
+
+using ViGEm::Bus::Core::NotificationFanout;
+
+#pragma region NotificationFanout
+
+HOST_TEST(NotificationFanoutDeliversToEverySubscriber)
+{
+	NotificationFanout<4, 8> fanout;
+	ULONG first, second;
+	UCHAR packet[8] = { 1, 2, 3 };
+
+	CHECK_EQUAL(fanout.Publish(packet, 3), 0);
+
+	CHECK(fanout.Subscribe(&first));
+	CHECK(fanout.Subscribe(&second));
+	CHECK(first != second);
+
+	CHECK_EQUAL(fanout.Publish(packet, 3), 2);
+	CHECK_EQUAL(fanout.Publish(packet, 9), 0);
+
+	const ULONG subscribers[] = { first, second };
+
+	for (const auto subscriber : subscribers)
+	{
+		const auto received = fanout.Peek(subscriber);
+
+		if (CHECK(received != nullptr))
+		{
+			CHECK_EQUAL(received->Length, 3);
+			CHECK_EQUAL(received->Data[2], 3);
+		}
+
+		fanout.Release(subscriber);
+		CHECK(fanout.Peek(subscriber) == nullptr);
+	}
+}
+
+HOST_TEST(NotificationFanoutDropsForLaggingSubscriber)
+{
+	NotificationFanout<4, 8> fanout;
+	ULONG fast, slow;
+
+	fanout.Subscribe(&fast);
+	fanout.Subscribe(&slow);
+
+	for (UCHAR value = 0; value < 6; value++)
+	{
+		fanout.Publish(&value, 1);
+
+		fanout.Peek(fast);
+		fanout.Release(fast);
+	}
+
+	CHECK_EQUAL(fanout.TakeDropped(fast), 0);
+	CHECK_EQUAL(fanout.TakeDropped(slow), 2);
+	CHECK_EQUAL(fanout.TakeDropped(slow), 0);
+
+	//
+	// The slow subscriber continues with the oldest packet still in the ring
+	// 
+	const auto oldest = fanout.Peek(slow);
+
+	if (CHECK(oldest != nullptr))
+		CHECK_EQUAL(oldest->Data[0], 2);
+
+	fanout.Unsubscribe(slow);
+	CHECK(!fanout.IsSubscribed(slow));
+	CHECK_EQUAL(fanout.Subscribers(), 1UL << fast);
+	CHECK_EQUAL(fanout.Publish(oldest->Data, 1), 1);
+}
+
+HOST_TEST(NotificationFanoutSkipsPacketsBeforeSubscribing)
+{
+	NotificationFanout<4, 8> fanout;
+	ULONG early, late;
+	UCHAR value = 1;
+
+	fanout.Subscribe(&early);
+	fanout.Publish(&value, 1);
+
+	fanout.Subscribe(&late);
+	CHECK(fanout.Peek(late) == nullptr);
+
+	value = 2;
+	CHECK_EQUAL(fanout.Publish(&value, 1), 2);
+
+	const auto received = fanout.Peek(late);
+
+	if (CHECK(received != nullptr))
+		CHECK_EQUAL(received->Data[0], 2);
+}
+
+HOST_TEST(NotificationFanoutRejectsSubscribersBeyondCapacity)
+{
+	NotificationFanout<4, 8> fanout;
+	ULONG subscriber;
+
+	for (ULONG index = 0; index < NotificationFanout<4, 8>::MAX_SUBSCRIBERS; index++)
+		CHECK(fanout.Subscribe(&subscriber));
+
+	CHECK(!fanout.Subscribe(&subscriber));
+
+	//
+	// A freed slot is handed out again
+	// 
+	fanout.Unsubscribe(3);
+	CHECK(fanout.Subscribe(&subscriber));
+	CHECK_EQUAL(subscriber, 3);
+}
+
+#pragma endregion
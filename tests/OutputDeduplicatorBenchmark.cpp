@@ -0,0 +1,155 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// A game resending its rumble state while the listener's queue overruns for
+// a while: compares remembering every packet on receipt with remembering only
+// delivered ones, and prints the cost of the duplicate check
+// 
+
+#include <Windows.h>
+
+#include "OutputDeduplicator.hpp"
+
+#include <chrono>
+#include <cstdio>
+
+using ViGEm::Bus::Core::OutputDeduplicator;
+
+static const ULONG PACKET_SIZE = 8;
+static const ULONG ITERATIONS = 2000000;
+
+//
+// Resends per rumble change, games commonly push the state every frame
+// 
+static const ULONG RESENDS = 16;
+
+static const ULONG CHANGES = 4;
+
+static volatile ULONG Sink;
+
+struct Outcome
+{
+	ULONG Delivered;
+	ULONG Suppressed;
+
+	//
+	// Packets the listener kept running on an outdated rumble state after
+	// its queue drained again
+	// 
+	ULONG Stale;
+};
+
+//
+// The listener's queue is full for Busy packets starting with the first change
+// 
+static Outcome Simulate(bool RememberUndelivered, ULONG Busy)
+{
+	OutputDeduplicator<16> dedup;
+	Outcome outcome{};
+	UCHAR seen = 0;
+
+	for (ULONG index = 0; index < CHANGES * RESENDS; index++)
+	{
+		const auto state = static_cast<UCHAR>(index / RESENDS);
+		const UCHAR packet[PACKET_SIZE] = { 0x00, 0x08, 0x00, state, 0x80 };
+		const auto dropped = index >= RESENDS && index < RESENDS + Busy;
+
+		if (dedup.IsDuplicate(packet, sizeof(packet)))
+		{
+			outcome.Suppressed++;
+		}
+		else
+		{
+			if (!dropped)
+			{
+				outcome.Delivered++;
+				seen = state;
+			}
+
+			if (!dropped || RememberUndelivered)
+				dedup.Remember(packet, sizeof(packet));
+		}
+
+		if (!dropped && seen != state)
+			outcome.Stale++;
+	}
+
+	return outcome;
+}
+
+int main()
+{
+	const ULONG windows[] = { 0, 4, 15 };
+
+	printf("%-22s %6s %10s %11s %6s\n", "policy", "busy", "delivered", "suppressed", "stale");
+
+	for (const auto busy : windows)
+	{
+		const auto eager = Simulate(true, busy);
+		const auto delivered = Simulate(false, busy);
+
+		printf("%-22s %6lu %10lu %11lu %6lu\n", "remember on receipt", static_cast<unsigned long>(busy),
+		       static_cast<unsigned long>(eager.Delivered), static_cast<unsigned long>(eager.Suppressed),
+		       static_cast<unsigned long>(eager.Stale));
+		printf("%-22s %6lu %10lu %11lu %6lu\n", "remember on delivery", static_cast<unsigned long>(busy),
+		       static_cast<unsigned long>(delivered.Delivered), static_cast<unsigned long>(delivered.Suppressed),
+		       static_cast<unsigned long>(delivered.Stale));
+	}
+
+	OutputDeduplicator<16> dedup;
+	UCHAR packet[PACKET_SIZE] = { 0x00, 0x08 };
+
+	const auto start = std::chrono::steady_clock::now();
+
+	for (ULONG iteration = 0; iteration < ITERATIONS; iteration++)
+	{
+		packet[3] = static_cast<UCHAR>(iteration / RESENDS);
+
+		if (!dedup.IsDuplicate(packet, sizeof(packet)))
+			dedup.Remember(packet, sizeof(packet));
+		else
+			Sink = Sink + 1;
+	}
+
+	const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+
+	printf("\n%.2f ns per check, %lu of %lu packets dropped\n",
+	       elapsed.count() / ITERATIONS,
+	       static_cast<unsigned long>(Sink),
+	       static_cast<unsigned long>(ITERATIONS));
+
+	return 0;
+}
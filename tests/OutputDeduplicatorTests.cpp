@@ -0,0 +1,116 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Host tests of the output transfer deduplicator
+// 
+
+#include <Windows.h>
+
+#include "OutputDeduplicator.hpp"
+
+#include "HostTest.hpp"
+
+using ViGEm::Bus::Core::OutputDeduplicator;
+
+namespace
+{
+	const UCHAR RUMBLE_ON[] = { 0x00, 0x08, 0x00, 0xFF, 0x80, 0x00, 0x00, 0x00 };
+	const UCHAR RUMBLE_OFF[] = { 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+}
+
+HOST_TEST(OutputDeduplicatorDropsRepeatOfDeliveredPacket)
+{
+	OutputDeduplicator<16> dedup;
+
+	CHECK(!dedup.IsDuplicate(RUMBLE_ON, sizeof(RUMBLE_ON)));
+
+	dedup.Remember(RUMBLE_ON, sizeof(RUMBLE_ON));
+
+	CHECK(dedup.IsDuplicate(RUMBLE_ON, sizeof(RUMBLE_ON)));
+	CHECK(!dedup.IsDuplicate(RUMBLE_OFF, sizeof(RUMBLE_OFF)));
+	CHECK(!dedup.IsDuplicate(RUMBLE_ON, sizeof(RUMBLE_ON) - 1));
+}
+
+HOST_TEST(OutputDeduplicatorPassesRepeatsNobodyReceived)
+{
+	OutputDeduplicator<16> dedup;
+
+	//
+	// Without a listener the packet is never remembered, every resend goes
+	// through until one of them gets delivered
+	// 
+	for (int resend = 0; resend < 3; resend++)
+		CHECK(!dedup.IsDuplicate(RUMBLE_ON, sizeof(RUMBLE_ON)));
+
+	dedup.Remember(RUMBLE_ON, sizeof(RUMBLE_ON));
+
+	CHECK(dedup.IsDuplicate(RUMBLE_ON, sizeof(RUMBLE_ON)));
+}
+
+HOST_TEST(OutputDeduplicatorForgetsOnNewListener)
+{
+	OutputDeduplicator<16> dedup;
+
+	dedup.Remember(RUMBLE_ON, sizeof(RUMBLE_ON));
+	dedup.Forget();
+
+	CHECK(!dedup.IsDuplicate(RUMBLE_ON, sizeof(RUMBLE_ON)));
+}
+
+HOST_TEST(OutputDeduplicatorIgnoresLongPackets)
+{
+	OutputDeduplicator<4> dedup;
+
+	dedup.Remember(RUMBLE_ON, 4);
+	CHECK(dedup.IsDuplicate(RUMBLE_ON, 4));
+
+	//
+	// Too long to remember, and the previous packet no longer is the last one
+	// 
+	dedup.Remember(RUMBLE_ON, sizeof(RUMBLE_ON));
+
+	CHECK(!dedup.IsDuplicate(RUMBLE_ON, sizeof(RUMBLE_ON)));
+	CHECK(!dedup.IsDuplicate(RUMBLE_ON, 4));
+}
+
+HOST_TEST(OutputDeduplicatorNeverDropsEmptyPackets)
+{
+	OutputDeduplicator<16> dedup;
+
+	dedup.Remember(RUMBLE_ON, 0);
+
+	CHECK(!dedup.IsDuplicate(RUMBLE_ON, 0));
+}
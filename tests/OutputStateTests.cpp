@@ -0,0 +1,179 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Host tests of the output state page sequence lock helpers in BusShared.h
+// 
+
+#include <Windows.h>
+#include <ViGEm/km/BusShared.h>
+
+#include "HostTest.hpp"
+
+#include <atomic>
+#include <thread>
+
+namespace
+{
+	//
+	// Every field derived from one value, a torn read mixes two of them
+	// 
+	void MakeState(ULONG Value, PVIGEM_OUTPUT_STATE State)
+	{
+		RtlZeroMemory(State, sizeof(VIGEM_OUTPUT_STATE));
+
+		State->SerialNo = Value;
+		State->TargetType = DualShock4Wired;
+		State->LargeMotor = static_cast<UCHAR>(Value);
+		State->SmallMotor = static_cast<UCHAR>(Value >> 8);
+		State->LedNumber = static_cast<UCHAR>(Value >> 16);
+		State->LightbarColor.Red = static_cast<UCHAR>(Value);
+
+		for (auto& byte : State->Reserved)
+			byte = static_cast<UCHAR>(Value);
+	}
+
+	bool IsConsistent(const VIGEM_OUTPUT_STATE& State)
+	{
+		VIGEM_OUTPUT_STATE expected;
+
+		MakeState(State.SerialNo, &expected);
+
+		return RtlEqualMemory(
+			reinterpret_cast<const UCHAR*>(&State) + FIELD_OFFSET(VIGEM_OUTPUT_STATE, SerialNo),
+			reinterpret_cast<const UCHAR*>(&expected) + FIELD_OFFSET(VIGEM_OUTPUT_STATE, SerialNo),
+			sizeof(VIGEM_OUTPUT_STATE) - FIELD_OFFSET(VIGEM_OUTPUT_STATE, SerialNo)
+		);
+	}
+}
+
+HOST_TEST(OutputStateWriteIgnoresSequenceInPage)
+{
+	VIGEM_OUTPUT_STATE entry{};
+	VIGEM_OUTPUT_STATE values;
+	VIGEM_OUTPUT_STATE read;
+	LONG sequence = 0;
+
+	MakeState(7, &values);
+	VIGEM_OUTPUT_STATE_WRITE(&entry, &sequence, &values);
+
+	CHECK_EQUAL(sequence, 2);
+	CHECK_EQUAL(entry.Sequence, 2);
+	CHECK(VIGEM_OUTPUT_STATE_READ(&entry, &read));
+	CHECK(IsConsistent(read));
+	CHECK_EQUAL(read.SerialNo, 7);
+
+	//
+	// The session scribbling over the page doesn't steer the writer
+	// 
+	entry.Sequence = 12345;
+
+	MakeState(8, &values);
+	VIGEM_OUTPUT_STATE_WRITE(&entry, &sequence, &values);
+
+	CHECK_EQUAL(sequence, 4);
+	CHECK_EQUAL(entry.Sequence, 4);
+	CHECK(VIGEM_OUTPUT_STATE_READ(&entry, &read));
+	CHECK_EQUAL(read.SerialNo, 8);
+}
+
+HOST_TEST(OutputStateReadFailsWhileWriting)
+{
+	VIGEM_OUTPUT_STATE entry{};
+	VIGEM_OUTPUT_STATE read;
+
+	entry.Sequence = 3;
+
+	CHECK(!VIGEM_OUTPUT_STATE_READ(&entry, &read));
+}
+
+HOST_TEST(OutputStateReaderNeverSeesTornEntry)
+{
+	static const ULONG WRITES = 200000;
+
+	VIGEM_OUTPUT_STATE entry{};
+	VIGEM_OUTPUT_STATE values;
+	LONG sequence = 0;
+	std::atomic<bool> done{ false };
+	ULONG torn = 0, reads = 0, retries = 0;
+
+	//
+	// Reads before the first write in the loop must pass the check as well
+	// 
+	MakeState(0, &values);
+	VIGEM_OUTPUT_STATE_WRITE(&entry, &sequence, &values);
+
+	std::thread writer([&]
+	{
+		for (ULONG value = 1; value <= WRITES; value++)
+		{
+			MakeState(value, &values);
+			VIGEM_OUTPUT_STATE_WRITE(&entry, &sequence, &values);
+		}
+
+		done = true;
+	});
+
+	VIGEM_OUTPUT_STATE read;
+	ULONG last = 0;
+
+	while (!done)
+	{
+		if (!VIGEM_OUTPUT_STATE_READ(&entry, &read))
+		{
+			retries++;
+			continue;
+		}
+
+		reads++;
+
+		if (!IsConsistent(read) || read.SerialNo < last)
+			torn++;
+
+		last = read.SerialNo;
+	}
+
+	writer.join();
+
+	CHECK_EQUAL(torn, 0);
+	CHECK(reads > 0);
+
+	CHECK(VIGEM_OUTPUT_STATE_READ(&entry, &read));
+	CHECK_EQUAL(read.SerialNo, WRITES);
+
+	printf("  %lu consistent reads, %lu retries\n",
+	       static_cast<unsigned long>(reads),
+	       static_cast<unsigned long>(retries));
+}
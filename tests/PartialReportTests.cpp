@@ -0,0 +1,232 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Host tests of the DS4 partial report helpers in Common.h and BusShared.h
+// 
+
+#include <Windows.h>
+#include <ViGEm/km/BusShared.h>
+
+#include "HostTest.hpp"
+
+namespace
+{
+	const UCHAR OFFSETS[] = DS4_PARTIAL_FIELD_OFFSETS;
+
+	void Fill(PDS4_REPORT_EX Report, UCHAR Seed)
+	{
+		for (ULONG index = 0; index < sizeof(Report->ReportBuffer); index++)
+			Report->ReportBuffer[index] = static_cast<UCHAR>(Seed + index);
+	}
+
+	ULONG PackedLength(ULONG FieldMask)
+	{
+		ULONG length = 0;
+
+		for (ULONG field = 0; field < DS4_PARTIAL_FIELD_COUNT; field++)
+		{
+			if (FieldMask & (1UL << field))
+				length += OFFSETS[field + 1] - OFFSETS[field];
+		}
+
+		return length;
+	}
+
+	//
+	// Field of the report byte, DS4_PARTIAL_FIELD_COUNT past the last field
+	// 
+	ULONG FieldOf(ULONG Offset)
+	{
+		for (ULONG field = 0; field < DS4_PARTIAL_FIELD_COUNT; field++)
+		{
+			if (Offset >= OFFSETS[field] && Offset < OFFSETS[field + 1])
+				return field;
+		}
+
+		return DS4_PARTIAL_FIELD_COUNT;
+	}
+}
+
+HOST_TEST(PartialFieldOffsetsTileTheReport)
+{
+	CHECK_EQUAL(OFFSETS[0], 0);
+	CHECK_EQUAL(sizeof(OFFSETS), DS4_PARTIAL_FIELD_COUNT + 1);
+	CHECK(OFFSETS[DS4_PARTIAL_FIELD_COUNT] <= sizeof(DS4_REPORT_EX));
+	CHECK_EQUAL(DS4_PARTIAL_FIELD_ALL, (1UL << DS4_PARTIAL_FIELD_COUNT) - 1);
+
+	for (ULONG field = 0; field < DS4_PARTIAL_FIELD_COUNT; field++)
+		CHECK(OFFSETS[field] < OFFSETS[field + 1]);
+
+	CHECK(PackedLength(DS4_PARTIAL_FIELD_ALL) <= sizeof(DS4_SUBMIT_PARTIAL_REPORT::Data));
+}
+
+HOST_TEST(PartialPackMergeRoundTripsEveryMask)
+{
+	DS4_REPORT_EX source, target;
+	DS4_SUBMIT_PARTIAL_REPORT partial;
+	ULONG failures = 0;
+
+	Fill(&source, 0x10);
+
+	for (ULONG mask = 0; mask <= DS4_PARTIAL_FIELD_ALL; mask++)
+	{
+		DS4_SUBMIT_PARTIAL_REPORT_INIT(&partial, 1);
+		DS4_SUBMIT_PARTIAL_REPORT_PACK(&partial, mask, &source);
+
+		if (partial.FieldMask != mask
+			|| partial.Size != FIELD_OFFSET(DS4_SUBMIT_PARTIAL_REPORT, Data) + PackedLength(mask))
+		{
+			failures++;
+			continue;
+		}
+
+		Fill(&target, 0x80);
+
+		if (!DS4_SUBMIT_PARTIAL_REPORT_MERGE(&partial, &target))
+		{
+			failures++;
+			continue;
+		}
+
+		//
+		// Carried fields come from the source, everything else stays
+		// 
+		for (ULONG offset = 0; offset < sizeof(target.ReportBuffer); offset++)
+		{
+			const auto field = FieldOf(offset);
+			const auto carried = field < DS4_PARTIAL_FIELD_COUNT && (mask & (1UL << field));
+			const auto expected = carried ? source.ReportBuffer[offset] : static_cast<UCHAR>(0x80 + offset);
+
+			if (target.ReportBuffer[offset] != expected)
+			{
+				failures++;
+				break;
+			}
+		}
+	}
+
+	CHECK_EQUAL(failures, 0);
+}
+
+HOST_TEST(PartialPackDropsUnknownBits)
+{
+	DS4_REPORT_EX source;
+	DS4_SUBMIT_PARTIAL_REPORT partial;
+
+	Fill(&source, 0);
+
+	DS4_SUBMIT_PARTIAL_REPORT_INIT(&partial, 1);
+	DS4_SUBMIT_PARTIAL_REPORT_PACK(&partial, DS4_PARTIAL_FIELD_TRIGGERS | 0x80000000, &source);
+
+	CHECK_EQUAL(partial.FieldMask, DS4_PARTIAL_FIELD_TRIGGERS);
+	CHECK_EQUAL(partial.Size, FIELD_OFFSET(DS4_SUBMIT_PARTIAL_REPORT, Data) + 2);
+	CHECK_EQUAL(partial.Data[0], source.Report.bTriggerL);
+	CHECK_EQUAL(partial.Data[1], source.Report.bTriggerR);
+}
+
+HOST_TEST(PartialMergeRejectsMismatchedSize)
+{
+	DS4_REPORT_EX source, target, untouched;
+	DS4_SUBMIT_PARTIAL_REPORT partial;
+
+	Fill(&source, 0x10);
+	Fill(&target, 0x80);
+	untouched = target;
+
+	DS4_SUBMIT_PARTIAL_REPORT_INIT(&partial, 1);
+	DS4_SUBMIT_PARTIAL_REPORT_PACK(&partial, DS4_PARTIAL_FIELD_THUMBS | DS4_PARTIAL_FIELD_TOUCH, &source);
+
+	const auto size = partial.Size;
+	const ULONG wrong[] = { size - 1, size + 1, FIELD_OFFSET(DS4_SUBMIT_PARTIAL_REPORT, Data), 0 };
+
+	for (const auto candidate : wrong)
+	{
+		partial.Size = candidate;
+
+		CHECK(!DS4_SUBMIT_PARTIAL_REPORT_MERGE(&partial, &target));
+		CHECK(RtlEqualMemory(&target, &untouched, sizeof(target)));
+	}
+
+	partial.Size = size;
+	partial.FieldMask |= 1UL << DS4_PARTIAL_FIELD_COUNT;
+
+	CHECK(!DS4_SUBMIT_PARTIAL_REPORT_MERGE(&partial, &target));
+	CHECK(RtlEqualMemory(&target, &untouched, sizeof(target)));
+}
+
+HOST_TEST(PartialMergeAcceptsEmptyMask)
+{
+	DS4_REPORT_EX target, untouched;
+	DS4_SUBMIT_PARTIAL_REPORT partial;
+
+	Fill(&target, 0x80);
+	untouched = target;
+
+	DS4_SUBMIT_PARTIAL_REPORT_INIT(&partial, 1);
+
+	CHECK(DS4_SUBMIT_PARTIAL_REPORT_MERGE(&partial, &target));
+	CHECK(RtlEqualMemory(&target, &untouched, sizeof(target)));
+}
+
+HOST_TEST(PartialDiffPacksOnlyChangedFields)
+{
+	DS4_REPORT_EX previous, current, rebuilt;
+	DS4_SUBMIT_PARTIAL_REPORT partial;
+
+	Fill(&previous, 0x10);
+	current = previous;
+
+	current.Report.bTriggerR++;
+	current.Report.wGyroZ++;
+	current.ReportBuffer[OFFSETS[DS4_PARTIAL_FIELD_COUNT] - 1]++;
+
+	const auto mask = DS4_PARTIAL_REPORT_DIFF(&previous, &current);
+
+	CHECK_EQUAL(mask, DS4_PARTIAL_FIELD_TRIGGERS | DS4_PARTIAL_FIELD_GYRO | DS4_PARTIAL_FIELD_TOUCH);
+	CHECK_EQUAL(DS4_PARTIAL_REPORT_DIFF(&current, &current), 0);
+
+	DS4_SUBMIT_PARTIAL_REPORT_INIT(&partial, 1);
+	DS4_SUBMIT_PARTIAL_REPORT_PACK(&partial, mask, &current);
+
+	rebuilt = previous;
+
+	CHECK(DS4_SUBMIT_PARTIAL_REPORT_MERGE(&partial, &rebuilt));
+	CHECK(RtlEqualMemory(
+		rebuilt.ReportBuffer,
+		current.ReportBuffer,
+		OFFSETS[DS4_PARTIAL_FIELD_COUNT]
+	));
+}
@@ -0,0 +1,237 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Simulated host poller: age of the input the host receives for feeders that run 
+// free, wake on the host poll signal, or align to the measured poll interval
+// 
+
+#include <Windows.h>
+
+#include "PollIntervalEstimator.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+using ViGEm::Bus::Core::PollIntervalEstimator;
+
+namespace
+{
+	//
+	// Time is in microseconds
+	// 
+	const LONGLONG FREQUENCY = 1000000;
+
+	const LONGLONG DURATION = 20 * FREQUENCY;
+
+	//
+	// Sampling the input to submitting the report
+	// 
+	const LONGLONG PROCESSING = 100;
+
+	//
+	// IOCTL_VIGEM_AWAIT_POLL completion to the feeder running again
+	// 
+	const LONGLONG WAKE_LATENCY = 50;
+
+	//
+	// How early an aligned feeder samples before the predicted poll
+	// 
+	const LONGLONG LEAD = 300;
+
+	enum Feeder
+	{
+		FreeRunning,
+		AwaitPoll,
+		AwaitPollAligned
+	};
+
+	const char* const FEEDER_NAMES[] = { "free running", "await poll", "await poll + aligned" };
+
+	struct Result
+	{
+		std::vector<LONGLONG> Ages;
+
+		ULONG Lost;
+
+		ULONG EmptyPolls;
+	};
+
+	class Random
+	{
+	public:
+		LONGLONG Next(LONGLONG Range)
+		{
+			this->_State = this->_State * 6364136223846793005ULL + 1442695040888963407ULL;
+
+			return (Range > 0) ? static_cast<LONGLONG>((this->_State >> 33) % static_cast<unsigned long long>(Range)) : 0;
+		}
+
+	private:
+		unsigned long long _State = 0x853C49E6748FEA9BULL;
+	};
+
+	//
+	// The host completes a transfer on the poll after the report went in and only then
+	// posts the next one; a report submitted without a transfer pending is lost, the
+	// same as SubmitReportImpl returning STATUS_NO_MORE_ENTRIES
+	// 
+	Result Simulate(Feeder Feeder, LONGLONG PollInterval, LONGLONG Jitter)
+	{
+		PollIntervalEstimator estimator;
+		Random random;
+		Result result{};
+
+		bool pending = true;
+		bool delivered = false;
+		LONGLONG deliveredSample = 0;
+		LONGLONG nextPoll = PollInterval;
+
+		LONGLONG nextSample = 0;
+		LONGLONG sampledAt = -1;
+		LONGLONG postedAt = 0;
+		bool waiting = (Feeder != FreeRunning);
+
+		result.Ages.reserve(static_cast<size_t>(DURATION / PollInterval));
+
+		for (LONGLONG now = 0; now < DURATION; now++)
+		{
+			if (now == nextPoll)
+			{
+				if (delivered)
+				{
+					result.Ages.push_back(now - deliveredSample);
+					delivered = false;
+					pending = true;
+					postedAt = now;
+					estimator.Sample(now, FREQUENCY);
+				}
+				else
+				{
+					result.EmptyPolls++;
+				}
+
+				nextPoll += PollInterval + random.Next(2 * Jitter + 1) - Jitter;
+			}
+
+			//
+			// Wake up on the poll signal
+			// 
+			if (waiting && pending && now >= postedAt + WAKE_LATENCY)
+			{
+				waiting = false;
+
+				//
+				// Transfers only get posted after a completion, so a missed poll stretches
+				// the average while the minimum stays at the host's real interval
+				// 
+				const LONGLONG interval = estimator.Minimum();
+
+				if (Feeder == AwaitPollAligned && interval > LEAD + WAKE_LATENCY)
+				{
+					//
+					// Sleep until just before the predicted poll, with timer overshoot
+					// 
+					nextSample = postedAt + interval - LEAD + random.Next(100);
+				}
+				else
+				{
+					nextSample = now;
+				}
+			}
+
+			if (now == nextSample && sampledAt < 0)
+			{
+				sampledAt = now;
+			}
+
+			if (sampledAt >= 0 && now == sampledAt + PROCESSING)
+			{
+				if (pending)
+				{
+					pending = false;
+					delivered = true;
+					deliveredSample = sampledAt;
+				}
+				else
+				{
+					result.Lost++;
+				}
+
+				sampledAt = -1;
+
+				if (Feeder == FreeRunning)
+					nextSample = now - PROCESSING + PollInterval + PollInterval / 32;
+				else
+					waiting = true;
+			}
+		}
+
+		return result;
+	}
+}
+
+int main()
+{
+	const LONGLONG intervals[] = { 1000, 4000, 8000 };
+
+	for (const auto interval : intervals)
+	{
+		for (int feeder = FreeRunning; feeder <= AwaitPollAligned; feeder++)
+		{
+			auto result = Simulate(static_cast<Feeder>(feeder), interval, interval / 50);
+			auto& ages = result.Ages;
+
+			std::sort(ages.begin(), ages.end());
+
+			LONGLONG total = 0;
+
+			for (const auto age : ages)
+				total += age;
+
+			printf("%lld us poll  %-22s %7zu delivered %7lu lost %7lu empty polls   input age avg %5lld us p99 %5lld us\n",
+			       static_cast<long long>(interval),
+			       FEEDER_NAMES[feeder],
+			       ages.size(),
+			       static_cast<unsigned long>(result.Lost),
+			       static_cast<unsigned long>(result.EmptyPolls),
+			       static_cast<long long>(ages.empty() ? 0 : total / static_cast<LONGLONG>(ages.size())),
+			       static_cast<long long>(ages.empty() ? 0 : ages[(ages.size() - 1) * 99 / 100]));
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,138 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Host tests of the polling interval estimator
+// 
+
+#include <Windows.h>
+
+#include "PollIntervalEstimator.hpp"
+
+#include "HostTest.hpp"
+
+using ViGEm::Bus::Core::PollIntervalEstimator;
+
+#pragma region PollIntervalEstimator
+
+HOST_TEST(PollIntervalEstimatorTracksIntervals)
+{
+	const LONGLONG frequency = 10000000;
+	PollIntervalEstimator estimator;
+
+	estimator.Sample(1000, frequency);
+	CHECK_EQUAL(estimator.Count(), 0);
+	CHECK_EQUAL(estimator.Average(), 0);
+
+	//
+	// 1 ms polls with one 2 ms gap
+	// 
+	LONGLONG now = 1000;
+
+	for (ULONG index = 0; index < 16; index++)
+	{
+		now += (index == 8) ? 20000 : 10000;
+		estimator.Sample(now, frequency);
+	}
+
+	CHECK_EQUAL(estimator.Count(), 16);
+	CHECK_EQUAL(estimator.Last(), 1000);
+	CHECK_EQUAL(estimator.Minimum(), 1000);
+	CHECK_EQUAL(estimator.Maximum(), 2000);
+	CHECK(estimator.Average() > 1000 && estimator.Average() < 1200);
+	CHECK_EQUAL(estimator.LastArrival(), now);
+
+	estimator.Reset();
+	CHECK_EQUAL(estimator.Count(), 0);
+}
+
+HOST_TEST(PollIntervalEstimatorIgnoresInvalidSamples)
+{
+	PollIntervalEstimator estimator;
+
+	estimator.Sample(5000, 1000000);
+
+	//
+	// Counter going backwards or no frequency doesn't produce an interval
+	// 
+	estimator.Sample(4000, 1000000);
+	estimator.Sample(6000, 0);
+	CHECK_EQUAL(estimator.Count(), 0);
+
+	estimator.Sample(7000, 1000000);
+	CHECK_EQUAL(estimator.Count(), 1);
+	CHECK_EQUAL(estimator.Last(), 1000);
+}
+
+HOST_TEST(PollIntervalEstimatorClampsLongGaps)
+{
+	PollIntervalEstimator estimator;
+
+	//
+	// Over an hour at 1 MHz doesn't fit microseconds in a ULONG
+	// 
+	estimator.Sample(1, 1000000);
+	estimator.Sample(1 + 5000LL * 1000000, 1000000);
+
+	CHECK_EQUAL(estimator.Last(), MAXULONG);
+	CHECK_EQUAL(estimator.Maximum(), MAXULONG);
+}
+
+HOST_TEST(PollIntervalEstimatorAverageConverges)
+{
+	PollIntervalEstimator estimator;
+	LONGLONG now = 0;
+
+	for (ULONG index = 0; index < 8; index++)
+	{
+		now += 8000;
+		estimator.Sample(now, 1000000);
+	}
+
+	//
+	// Host switches from 8 ms to 1 ms polling
+	// 
+	for (ULONG index = 0; index < 64; index++)
+	{
+		now += 1000;
+		estimator.Sample(now, 1000000);
+	}
+
+	CHECK(estimator.Average() >= 1000 && estimator.Average() < 1010);
+	CHECK_EQUAL(estimator.Minimum(), 1000);
+	CHECK_EQUAL(estimator.Maximum(), 8000);
+}
+
+#pragma endregion
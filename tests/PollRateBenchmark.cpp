@@ -0,0 +1,174 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Poll rates a simulated full-speed host achieves for the advertised bInterval, and
+// the cost of patching the descriptors at plug-in
+// 
+
+#include <Windows.h>
+
+#include "UsbDescriptor.hpp"
+#include "XusbDescriptors.hpp"
+#include "Ds4Descriptors.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace ViGEm::Bus::Core;
+using namespace ViGEm::Bus::Targets;
+
+namespace
+{
+	//
+	// 1 ms frames, one simulated minute
+	// 
+	const ULONG FRAMES = 60000;
+
+	const ULONG PATCH_ITERATIONS = 200000;
+
+	struct Endpoint
+	{
+		UCHAR Address;
+
+		UCHAR Interval;
+	};
+
+	std::vector<Endpoint> InterruptInEndpoints(const UCHAR* Descriptor, ULONG Length)
+	{
+		std::vector<Endpoint> endpoints;
+
+		for (ULONG offset = 0; offset + 1 < Length && Descriptor[offset] >= 2;)
+		{
+			if (Descriptor[offset + 1] == USB_DESCRIPTOR_TYPE_ENDPOINT
+				&& (Descriptor[offset + 3] & USB_ENDPOINT_TRANSFER_TYPE_MASK) == USB_ENDPOINT_TRANSFER_TYPE_INTERRUPT
+				&& (Descriptor[offset + 2] & 0x80))
+			{
+				endpoints.push_back({ Descriptor[offset + 2], Descriptor[offset + 6] });
+			}
+
+			offset += Descriptor[offset];
+		}
+
+		return endpoints;
+	}
+
+	//
+	// Full-speed hosts schedule interrupt endpoints on a power of two frame period 
+	// no longer than bInterval (at most 32), each endpoint on its own branch
+	// 
+	ULONG SchedulePeriod(UCHAR Interval)
+	{
+		ULONG period = 1;
+
+		while (period * 2 <= Interval && period < 32)
+			period *= 2;
+
+		return period;
+	}
+
+	double AchievedRate(const Endpoint& Endpoint, ULONG Branch)
+	{
+		const auto period = SchedulePeriod(Endpoint.Interval);
+		ULONG polls = 0;
+
+		for (ULONG frame = 0; frame < FRAMES; frame++)
+		{
+			if (frame % period == Branch % period)
+				polls++;
+		}
+
+		return polls * 1000.0 / FRAMES;
+	}
+
+	template <size_t N>
+	void Run(const char* Name, const UCHAR (&Descriptor)[N])
+	{
+		const UCHAR intervals[] = { 0, 1, 2, 3, 4, 8, 10, 16 };
+
+		for (const auto interval : intervals)
+		{
+			UCHAR copy[N];
+
+			memcpy(copy, Descriptor, N);
+
+			//
+			// 0 keeps the advertised defaults, like a plug-in without the option
+			// 
+			if (interval)
+				usb_patch_interrupt_intervals(copy, N, interval);
+
+			const auto endpoints = InterruptInEndpoints(copy, N);
+
+			if (endpoints.empty())
+				continue;
+
+			//
+			// The first interrupt IN endpoint carries the input reports
+			// 
+			const auto& report = endpoints.front();
+
+			const auto start = std::chrono::steady_clock::now();
+			volatile ULONG sink = 0;
+
+			for (ULONG iteration = 0; iteration < PATCH_ITERATIONS; iteration++)
+			{
+				memcpy(copy, Descriptor, N);
+				sink += usb_patch_interrupt_intervals(copy, N, interval ? interval : 4);
+			}
+
+			const auto patch = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()
+				/ PATCH_ITERATIONS;
+
+			printf("%-5s PollingInterval %2u   report endpoint 0x%02X bInterval %2u   %7.1f polls/s   copy + patch %6.1f ns\n",
+			       Name,
+			       interval,
+			       report.Address,
+			       report.Interval,
+			       AchievedRate(report, 0),
+			       patch);
+		}
+	}
+}
+
+int main()
+{
+	Run("XUSB", XusbDescriptorData);
+	Run("DS4", Ds4DescriptorData);
+
+	return 0;
+}
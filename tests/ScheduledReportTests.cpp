@@ -0,0 +1,184 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Host tests of the scheduled report queue
+// 
+
+#include <Windows.h>
+
+#include "ScheduledReportQueue.hpp"
+
+#include "HostTest.hpp"
+
+using namespace ViGEm::Bus::Core;
+
+namespace
+{
+	struct Entry
+	{
+		LONGLONG DueTime;
+
+		ULONG Sequence;
+
+		UCHAR Retries;
+
+		bool operator<(const Entry& other) const
+		{
+			return (this->DueTime != other.DueTime)
+				? (this->DueTime < other.DueTime)
+				: (static_cast<LONG>(this->Sequence - other.Sequence) < 0);
+		}
+	};
+}
+
+#pragma region FixedMinHeap
+
+HOST_TEST(FixedMinHeapPopsInAscendingOrder)
+{
+	FixedMinHeap<LONG, 64> heap;
+	ULONG seed = 12345;
+
+	for (ULONG index = 0; index < 64; index++)
+	{
+		seed = seed * 1103515245 + 12345;
+		CHECK(heap.Push(static_cast<LONG>((seed >> 16) % 1000)));
+	}
+
+	CHECK(!heap.Push(0));
+	CHECK_EQUAL(heap.Count(), 64);
+
+	LONG previous = -1;
+	LONG item;
+
+	while (heap.Pop(&item))
+	{
+		CHECK(item >= previous);
+		previous = item;
+	}
+
+	CHECK_EQUAL(heap.Count(), 0);
+	CHECK(heap.Top() == nullptr);
+}
+
+HOST_TEST(FixedMinHeapTopIsSmallest)
+{
+	FixedMinHeap<LONG, 4> heap;
+
+	heap.Push(30);
+	heap.Push(10);
+	heap.Push(20);
+
+	CHECK_EQUAL(*heap.Top(), 10);
+	CHECK(heap.Pop(nullptr));
+	CHECK_EQUAL(*heap.Top(), 20);
+
+	heap.Clear();
+	CHECK(!heap.Pop(nullptr));
+}
+
+#pragma endregion
+
+#pragma region ScheduledReportQueue
+
+HOST_TEST(ScheduledReportQueuePopsOnlyDueReports)
+{
+	ScheduledReportQueue<Entry, 8, 2> queue;
+	Entry entry{};
+	LONGLONG dueIn = -1;
+
+	CHECK(!queue.PopDue(100, &entry, &dueIn));
+	CHECK_EQUAL(dueIn, 0);
+
+	CHECK(queue.Push({ 200, 1, 0 }));
+	CHECK(queue.Push({ 150, 2, 0 }));
+	CHECK(queue.Push({ 150, 3, 0 }));
+
+	CHECK(!queue.PopDue(100, &entry, &dueIn));
+	CHECK_EQUAL(dueIn, 50);
+
+	//
+	// Equal due times go out in submission order
+	// 
+	CHECK(queue.PopDue(150, &entry, &dueIn));
+	CHECK_EQUAL(entry.Sequence, 2);
+	CHECK(queue.PopDue(150, &entry, &dueIn));
+	CHECK_EQUAL(entry.Sequence, 3);
+	CHECK(!queue.PopDue(150, &entry, &dueIn));
+	CHECK_EQUAL(dueIn, 50);
+}
+
+HOST_TEST(ScheduledReportQueueDropsAfterMaxRetries)
+{
+	ScheduledReportQueue<Entry, 8, 2> queue;
+	Entry entry{};
+	LONGLONG dueIn;
+
+	CHECK(queue.Push({ 10, 1, 0 }));
+
+	for (ULONG attempt = 0; attempt < 2; attempt++)
+	{
+		CHECK(queue.PopDue(10, &entry, &dueIn));
+		CHECK(queue.Retry(entry));
+	}
+
+	CHECK(queue.PopDue(10, &entry, &dueIn));
+	CHECK_EQUAL(entry.Retries, 2);
+	CHECK(!queue.Retry(entry));
+	CHECK_EQUAL(queue.Dropped(), 1);
+	CHECK_EQUAL(queue.Count(), 0);
+}
+
+HOST_TEST(ScheduledReportQueueDropsRetryWhenFull)
+{
+	ScheduledReportQueue<Entry, 2, 4> queue;
+	Entry entry{};
+	LONGLONG dueIn;
+
+	CHECK(queue.Push({ 10, 1, 0 }));
+	CHECK(queue.PopDue(10, &entry, &dueIn));
+
+	//
+	// Filled up while the report was out for delivery
+	// 
+	CHECK(queue.Push({ 20, 2, 0 }));
+	CHECK(queue.Push({ 30, 3, 0 }));
+
+	CHECK(!queue.Retry(entry));
+	CHECK_EQUAL(queue.Dropped(), 1);
+	CHECK_EQUAL(queue.Count(), 2);
+}
+
+#pragma endregion
@@ -0,0 +1,233 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Simulated delivery error of scheduled reports against their requested due time
+// 
+
+#include <Windows.h>
+
+#include "ScheduledReportQueue.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using namespace ViGEm::Bus::Core;
+
+namespace
+{
+	struct Entry
+	{
+		LONGLONG DueTime;
+
+		ULONG Sequence;
+
+		UCHAR Retries;
+
+		bool operator<(const Entry& other) const
+		{
+			return (this->DueTime != other.DueTime)
+				? (this->DueTime < other.DueTime)
+				: (static_cast<LONG>(this->Sequence - other.Sequence) < 0);
+		}
+	};
+
+	//
+	// Same limits as the driver, time is in microseconds
+	// 
+	typedef ScheduledReportQueue<Entry, 64, 32> QUEUE;
+
+	const LONGLONG RETRY_INTERVAL = 1000;
+
+	const ULONG REPORTS = 200000;
+
+	const LONGLONG NEVER = 0x7FFFFFFFFFFFFFFF;
+
+	struct Result
+	{
+		std::vector<LONGLONG> Errors;
+
+		ULONG Rejected;
+
+		ULONG Dropped;
+	};
+
+	//
+	// One outstanding IN request, re-issued on the next poll boundary after it got 
+	// completed. StallAfter stops the host from polling at that point in time.
+	// 
+	Result Simulate(LONGLONG PollInterval, LONGLONG FeedInterval, LONGLONG MaxLead, LONGLONG StallAfter)
+	{
+		static QUEUE queue;
+		Result result{};
+		ULONG seed = 0x1234567;
+		ULONG fed = 0;
+		bool inPending = false;
+		LONGLONG nextPoll = 0;
+		LONGLONG nextFeed = 0;
+		LONGLONG timer = NEVER;
+
+		queue = QUEUE();
+		result.Errors.reserve(REPORTS);
+
+		const auto deliver = [&](LONGLONG Now)
+		{
+			Entry entry;
+			LONGLONG dueIn;
+
+			timer = NEVER;
+
+			while (queue.PopDue(Now, &entry, &dueIn))
+			{
+				if (inPending)
+				{
+					inPending = false;
+					result.Errors.push_back(Now - entry.DueTime);
+					continue;
+				}
+
+				if (queue.Retry(entry))
+				{
+					timer = Now + RETRY_INTERVAL;
+					return;
+				}
+			}
+
+			if (dueIn > 0)
+				timer = Now + dueIn;
+		};
+
+		while (fed < REPORTS || queue.Count() > 0)
+		{
+			const auto poll = (nextPoll < StallAfter) ? nextPoll : NEVER;
+			const auto feed = (fed < REPORTS) ? nextFeed : NEVER;
+			const auto now = std::min({ poll, feed, timer });
+
+			if (now == NEVER)
+				break;
+
+			if (now == feed)
+			{
+				seed = seed * 1103515245 + 12345;
+
+				if (!queue.Push({ now + static_cast<LONGLONG>((seed >> 8) % MaxLead), fed, 0 }))
+					result.Rejected++;
+
+				fed++;
+				nextFeed += FeedInterval;
+				deliver(now);
+			}
+			else if (now == poll)
+			{
+				nextPoll += PollInterval;
+
+				if (!inPending)
+				{
+					inPending = true;
+					deliver(now);
+				}
+			}
+			else
+			{
+				deliver(now);
+			}
+		}
+
+		result.Dropped = queue.Dropped();
+
+		return result;
+	}
+
+	void Report(const char* Name, Result&& Result, double Nanoseconds)
+	{
+		auto& errors = Result.Errors;
+
+		std::sort(errors.begin(), errors.end());
+
+		const auto percentile = [&](double Fraction)
+		{
+			return static_cast<long long>(errors.empty() ? 0 : errors[static_cast<size_t>(Fraction * (errors.size() - 1))]);
+		};
+
+		printf("%-24s %8zu delivered %6lu rejected %6lu dropped   error p50 %5lld us p99 %5lld us max %6lld us   %6.1f ns/report\n",
+		       Name,
+		       errors.size(),
+		       static_cast<unsigned long>(Result.Rejected),
+		       static_cast<unsigned long>(Result.Dropped),
+		       percentile(0.5),
+		       percentile(0.99),
+		       percentile(1.0),
+		       Nanoseconds / REPORTS);
+	}
+}
+
+int main()
+{
+	struct
+	{
+		const char* Name;
+
+		LONGLONG PollInterval;
+
+		LONGLONG FeedInterval;
+
+		LONGLONG MaxLead;
+
+		LONGLONG StallAfter;
+	} scenarios[] = {
+		{ "1 ms poll", 1000, 2000, 20000, NEVER },
+		{ "4 ms poll", 4000, 8000, 20000, NEVER },
+		{ "8 ms poll", 8000, 16000, 20000, NEVER },
+		{ "1 ms poll, oversubmit", 1000, 500, 20000, NEVER },
+		{ "host stalls halfway", 1000, 2000, 20000, 2000LL * REPORTS / 2 },
+	};
+
+	for (const auto& scenario : scenarios)
+	{
+		const auto start = std::chrono::steady_clock::now();
+
+		auto result = Simulate(scenario.PollInterval, scenario.FeedInterval, scenario.MaxLead, scenario.StallAfter);
+
+		Report(
+			scenario.Name,
+			std::move(result),
+			std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()
+		);
+	}
+
+	return 0;
+}
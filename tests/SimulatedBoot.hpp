@@ -0,0 +1,179 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Simulated host driving a target through the XUSB boot sequence, shared by the 
+// boot timeline tests and BootTimelineReport
+// 
+
+#pragma once
+
+#include "BootTimeline.hpp"
+#include "XusbInitSequence.hpp"
+
+namespace Simulation
+{
+	//
+	// Counter ticks are microseconds
+	// 
+	const LONGLONG FREQUENCY = 1000000;
+
+	struct HostProfile
+	{
+		//
+		// Plug-in until the PnP manager starts the device
+		// 
+		LONGLONG PnpStartDelay;
+
+		//
+		// Start until the host selects the configuration
+		// 
+		LONGLONG ConfigurationDelay;
+
+		//
+		// Data pipe poll period (bInterval 4 on full speed)
+		// 
+		LONGLONG PollPeriod;
+
+		//
+		// TransferBufferLength of the data pipe IN requests
+		// 
+		ULONG TransferLength;
+
+		//
+		// Ready until the feeder submits its first report
+		// 
+		LONGLONG FeederDelay;
+	};
+
+	const HostProfile DEFAULT_HOST = { 150000, 20000, 4000, 32, 1000 };
+
+	//
+	// Mirrors the data pipe path of EmulationTargetXUSB::UsbBulkOrInterruptTransfer
+	// 
+	class XusbTarget
+	{
+	public:
+		explicit XusbTarget(bool FastBoot) : _FastBoot(FastBoot)
+		{
+		}
+
+		//
+		// Serves the init stages that fit, false once the sequence is done or the
+		// transfer is too short for the pending stage
+		// 
+		bool ServeInitTransfer(ULONG TransferLength, LONGLONG Now)
+		{
+			using ViGEm::Bus::Targets::XusbInitSequence;
+
+			if (this->_Stage >= ARRAYSIZE(XusbInitSequence))
+				return false;
+
+			ULONG length = 0;
+
+			do
+			{
+				const auto& stage = XusbInitSequence[this->_Stage];
+
+				if (length + stage.Length > TransferLength)
+				{
+					if (length == 0)
+						return false;
+
+					break;
+				}
+
+				length += stage.Length;
+
+				this->Timeline.Mark(static_cast<VIGEM_BOOT_PHASE>(VigemBootPhaseInitStage0 + this->_Stage++),
+				                    Now, FREQUENCY);
+			} while (this->_FastBoot && this->_Stage < ARRAYSIZE(XusbInitSequence));
+
+			this->Timeline.CountInitTransfer();
+
+			return true;
+		}
+
+		bool InitDone() const
+		{
+			return this->_Stage == ARRAYSIZE(ViGEm::Bus::Targets::XusbInitSequence);
+		}
+
+		ViGEm::Bus::Core::BootTimeline Timeline;
+
+	private:
+		bool _FastBoot;
+
+		ULONG _Stage{};
+	};
+
+	//
+	// Plugs the target in at 0 and polls the data pipe until the first report got delivered
+	// 
+	inline void Boot(XusbTarget& Target, const HostProfile& Host)
+	{
+		LONGLONG now = 0;
+
+		Target.Timeline.Mark(VigemBootPhasePlugIn, now, FREQUENCY);
+
+		now += Host.PnpStartDelay;
+		Target.Timeline.Mark(VigemBootPhasePnpStart, now, FREQUENCY);
+
+		now += Host.ConfigurationDelay;
+		Target.Timeline.Mark(VigemBootPhaseConfigurationSelected, now, FREQUENCY);
+
+		//
+		// One IN request per poll period until the init sequence is through
+		// 
+		while (Target.ServeInitTransfer(Host.TransferLength, now))
+			now += Host.PollPeriod;
+
+		if (!Target.InitDone())
+			return;
+
+		//
+		// The host sets the player LED once the sequence completed
+		// 
+		Target.Timeline.Mark(VigemBootPhaseReady, now, FREQUENCY);
+
+		//
+		// The report waits for the next poll after the feeder submitted it
+		// 
+		const auto submitted = now + Host.FeederDelay;
+		const auto delivered = now + ((submitted - now + Host.PollPeriod - 1) / Host.PollPeriod) * Host.PollPeriod;
+
+		Target.Timeline.Mark(VigemBootPhaseFirstReport, delivered, FREQUENCY);
+	}
+}
@@ -0,0 +1,179 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Host tests of target leases and the secret key helpers
+// 
+
+#include <Windows.h>
+
+#include "TargetLease.hpp"
+
+#include "HostTest.hpp"
+
+using namespace ViGEm::Bus::Core;
+
+#pragma region TargetLease
+
+HOST_TEST(TargetLeaseExpiresAfterGracePeriod)
+{
+	TargetLease lease;
+
+	CHECK(!lease.Orphan(0));
+	CHECK(lease.Grant(42, 50));
+	CHECK(lease.IsHeld());
+
+	CHECK(lease.Orphan(100));
+	CHECK(lease.IsOrphaned());
+	CHECK(!lease.Expire(149));
+	CHECK(!lease.Reclaim(41));
+	CHECK(lease.Expire(150));
+	CHECK(!lease.Expire(150));
+	CHECK(!lease.Reclaim(42));
+	CHECK(!lease.Grant(42, 50));
+}
+
+HOST_TEST(TargetLeaseReclaimBeatsExpiry)
+{
+	TargetLease lease;
+
+	lease.Grant(7, 50);
+	lease.Orphan(100);
+
+	CHECK(lease.Reclaim(7));
+	CHECK(lease.IsHeld());
+	CHECK(!lease.Reclaim(7));
+	CHECK(!lease.Expire(1000));
+
+	//
+	// Leases can be orphaned again after a reclaim
+	// 
+	CHECK(lease.Orphan(1000));
+	CHECK(lease.Expire(1050));
+}
+
+HOST_TEST(TargetLeaseRevokeOnTransfer)
+{
+	TargetLease lease;
+
+	lease.Grant(9, 50);
+
+	//
+	// A transfer claim drops the lease of the previous owner
+	// 
+	lease.Revoke();
+
+	CHECK(!lease.IsHeld());
+	CHECK_EQUAL(lease.Key(), 0);
+	CHECK(!lease.Orphan(100));
+	CHECK(!lease.Reclaim(9));
+
+	//
+	// The new owner grants its own
+	// 
+	CHECK(lease.Grant(11, 50));
+	CHECK(lease.Orphan(100));
+
+	//
+	// Orphaned leases are left alone
+	// 
+	lease.Revoke();
+
+	CHECK(lease.IsOrphaned());
+	CHECK(lease.Reclaim(11));
+}
+
+#pragma endregion
+
+#pragma region SecretKey
+
+HOST_TEST(SecretKeySkipsZeroDraws)
+{
+	ULONG draws = 0;
+	ULONG key = 0;
+
+	CHECK(generate_secret_key([&draws](PUCHAR Buffer, ULONG Length)
+	{
+		const ULONG value = (draws++ < 2) ? 0 : 0xA5A5A5A5;
+
+		memcpy(Buffer, &value, Length);
+		return true;
+	}, &key));
+
+	CHECK_EQUAL(draws, 3);
+	CHECK_EQUAL(key, 0xA5A5A5A5);
+}
+
+HOST_TEST(SecretKeyFailsWithItsSource)
+{
+	ULONG draws = 0;
+	ULONG key = 7;
+
+	CHECK(!generate_secret_key([&draws](PUCHAR, ULONG)
+	{
+		draws++;
+		return false;
+	}, &key));
+
+	CHECK_EQUAL(draws, 1);
+	CHECK_EQUAL(key, 7);
+
+	//
+	// A source stuck at zero gives up instead of spinning
+	// 
+	draws = 0;
+
+	CHECK(!generate_secret_key([&draws](PUCHAR Buffer, ULONG Length)
+	{
+		draws++;
+		memset(Buffer, 0, Length);
+		return true;
+	}, &key));
+
+	CHECK_EQUAL(draws, MAX_SECRET_KEY_DRAWS);
+}
+
+HOST_TEST(SecretKeyComparesEveryBit)
+{
+	const ULONG key = 0x80000001;
+
+	CHECK(secret_key_equals(key, key));
+	CHECK(!secret_key_equals(0, 0));
+
+	for (ULONG bit = 0; bit < 32; bit++)
+		CHECK(!secret_key_equals(key, key ^ (1UL << bit)));
+}
+
+#pragma endregion
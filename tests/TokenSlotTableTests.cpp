@@ -0,0 +1,198 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Host tests of the target token slot table
+// 
+
+#include <Windows.h>
+
+#include "TokenSlotTable.hpp"
+
+#include "HostTest.hpp"
+
+using namespace ViGEm::Bus::Core;
+
+namespace
+{
+	struct Target
+	{
+		int Id;
+	};
+
+	typedef const void* OWNER;
+
+	typedef TokenSlotTable<Target, OWNER, 4> SLOTS;
+
+	const UCHAR ROLE_OWNER = 0;
+	const UCHAR ROLE_WRITER = 1;
+	const UCHAR ROLE_SUBSCRIBER = 2;
+
+	const int OWNER_A = 1;
+	const int OWNER_B = 2;
+}
+
+HOST_TEST(TokenSlotTableResolvesForIssuingOwnerAndRole)
+{
+	static SLOTS slots;
+	Target target{ 1 };
+	ULONG token = 0;
+	ULONG roleIndex = 0;
+
+	slots.Initialize();
+
+	CHECK(slots.Issue(&target, &OWNER_A, ROLE_WRITER, 3, &token));
+	CHECK(token != 0);
+
+	CHECK(slots.Resolve(token, &OWNER_A, SLOTS::RoleMask(ROLE_WRITER), &roleIndex) == &target);
+	CHECK_EQUAL(roleIndex, 3);
+
+	CHECK(slots.Resolve(token, &OWNER_B, SLOTS::RoleMask(ROLE_WRITER), nullptr) == nullptr);
+	CHECK(slots.Resolve(token, &OWNER_A, SLOTS::RoleMask(ROLE_OWNER), nullptr) == nullptr);
+	CHECK(slots.Resolve(token, &OWNER_A, SLOTS::RoleMask(ROLE_OWNER) | SLOTS::RoleMask(ROLE_WRITER), nullptr) == &target);
+
+	CHECK(slots.IsIssued(token, &target, &OWNER_A, ROLE_WRITER));
+	CHECK(!slots.IsIssued(token, &target, &OWNER_A, ROLE_SUBSCRIBER));
+}
+
+HOST_TEST(TokenSlotTableRejectsStaleTokenAfterReuse)
+{
+	static SLOTS slots;
+	Target first{ 1 };
+	Target second{ 2 };
+	ULONG stale = 0;
+	ULONG fresh = 0;
+
+	slots.Initialize();
+
+	CHECK(slots.Issue(&first, &OWNER_A, ROLE_OWNER, 0, &stale));
+	CHECK(slots.Revoke(stale));
+	CHECK(!slots.Revoke(stale));
+
+	//
+	// Same slot handed out again (e.g. to a recycled target object)
+	// 
+	CHECK(slots.Issue(&second, &OWNER_A, ROLE_OWNER, 0, &fresh));
+	CHECK_EQUAL(SLOTS::TokenIndex(fresh), SLOTS::TokenIndex(stale));
+	CHECK(fresh != stale);
+
+	CHECK(slots.Resolve(stale, &OWNER_A, SLOTS::RoleMask(ROLE_OWNER), nullptr) == nullptr);
+	CHECK(slots.Resolve(fresh, &OWNER_A, SLOTS::RoleMask(ROLE_OWNER), nullptr) == &second);
+	CHECK(!slots.RevokeIssued(stale, &second, SLOTS::RoleMask(ROLE_OWNER)));
+	CHECK(slots.Resolve(fresh, &OWNER_A, SLOTS::RoleMask(ROLE_OWNER), nullptr) == &second);
+}
+
+HOST_TEST(TokenSlotTableGenerationWrapsAroundSkippingZero)
+{
+	static SLOTS slots;
+	Target target{ 1 };
+	ULONG first = 0;
+	ULONG token = 0;
+
+	slots.Initialize();
+
+	CHECK(slots.Issue(&target, &OWNER_A, ROLE_OWNER, 0, &first));
+	CHECK(slots.Revoke(first));
+
+	//
+	// Cycle the slot through every other non-zero generation
+	// 
+	for (ULONG cycle = 0; cycle < 0xFFFE; cycle++)
+	{
+		CHECK(slots.Issue(&target, &OWNER_A, ROLE_OWNER, 0, &token));
+		CHECK(SLOTS::TokenGeneration(token) != 0);
+		CHECK(token != first);
+		CHECK(!slots.Resolve(first, &OWNER_A, SLOTS::RoleMask(ROLE_OWNER), nullptr));
+		CHECK(slots.Revoke(token));
+	}
+
+	//
+	// Only after a full wrap does the first token come back
+	// 
+	CHECK(slots.Issue(&target, &OWNER_A, ROLE_OWNER, 0, &token));
+	CHECK_EQUAL(token, first);
+}
+
+HOST_TEST(TokenSlotTableExhaustsAndRecovers)
+{
+	static SLOTS slots;
+	Target target{ 1 };
+	ULONG tokens[4];
+	ULONG extra = 0;
+
+	slots.Initialize();
+
+	for (ULONG index = 0; index < 4; index++)
+		CHECK(slots.Issue(&target, &OWNER_A, ROLE_SUBSCRIBER, static_cast<UCHAR>(index), &tokens[index]));
+
+	CHECK(!slots.Issue(&target, &OWNER_A, ROLE_SUBSCRIBER, 4, &extra));
+
+	CHECK(slots.Revoke(tokens[2]));
+	CHECK(slots.Issue(&target, &OWNER_A, ROLE_SUBSCRIBER, 4, &extra));
+	CHECK_EQUAL(SLOTS::TokenIndex(extra), SLOTS::TokenIndex(tokens[2]));
+}
+
+HOST_TEST(TokenSlotTableRevokesByOwnerAndTarget)
+{
+	static SLOTS slots;
+	Target first{ 1 };
+	Target second{ 2 };
+	ULONG owner = 0;
+	ULONG writer = 0;
+	ULONG subscriber = 0;
+	ULONG other = 0;
+
+	slots.Initialize();
+
+	CHECK(slots.Issue(&first, &OWNER_A, ROLE_OWNER, 0, &owner));
+	CHECK(slots.Issue(&first, &OWNER_B, ROLE_WRITER, 1, &writer));
+	CHECK(slots.Issue(&first, &OWNER_B, ROLE_SUBSCRIBER, 0, &subscriber));
+	CHECK(slots.Issue(&second, &OWNER_B, ROLE_OWNER, 0, &other));
+
+	//
+	// Secondaries of one target only
+	// 
+	CHECK_EQUAL(slots.RevokeTarget(&first, SLOTS::RoleMask(ROLE_WRITER) | SLOTS::RoleMask(ROLE_SUBSCRIBER)), 2);
+	CHECK(slots.IsIssued(owner, &first, &OWNER_A, ROLE_OWNER));
+	CHECK(!slots.Resolve(writer, &OWNER_B, SLOTS::RoleMask(ROLE_WRITER), nullptr));
+	CHECK(slots.IsIssued(other, &second, &OWNER_B, ROLE_OWNER));
+
+	CHECK_EQUAL(slots.RevokeOwner(&OWNER_B), 1);
+	CHECK(!slots.IsIssued(other, &second, &OWNER_B, ROLE_OWNER));
+	CHECK(slots.IsIssued(owner, &first, &OWNER_A, ROLE_OWNER));
+
+	CHECK(slots.RevokeIssued(owner, &first, SLOTS::RoleMask(ROLE_OWNER)));
+	CHECK_EQUAL(slots.RevokeOwner(&OWNER_A), 0);
+}
@@ -0,0 +1,109 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Cost of compiling and applying an SDK input transform
+// 
+
+#include <Windows.h>
+#include <ViGEm/km/BusShared.h>
+#include <ViGEm/Client.h>
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+static const ULONG BATCH_SIZE = 4096;
+static const ULONG ITERATIONS = 2000;
+
+template <typename Body>
+static double Measure(ULONG Iterations, Body&& Run)
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	for (ULONG iteration = 0; iteration < Iterations; iteration++)
+		Run();
+
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / Iterations;
+}
+
+int main()
+{
+	const auto transform = vigem_transform_alloc();
+	std::vector<XUSB_REPORT> xusb(BATCH_SIZE);
+	std::vector<DS4_REPORT_EX> ds4(BATCH_SIZE);
+
+	for (ULONG index = 0; index < BATCH_SIZE; index++)
+	{
+		xusb[index].wButtons = static_cast<USHORT>(index * 0x9E37);
+		xusb[index].sThumbLX = static_cast<SHORT>(index * 17);
+		xusb[index].sThumbRY = static_cast<SHORT>(~index);
+		ds4[index].Report.wButtons = static_cast<USHORT>(index * 0x9E37);
+		ds4[index].Report.bThumbLX = static_cast<BYTE>(index);
+	}
+
+	vigem_transform_set_axis(transform, VIGEM_TRANSFORM_AXIS_LEFT_X, 0.1f, 0.9f, 2.0f, FALSE);
+	vigem_transform_set_axis(transform, VIGEM_TRANSFORM_AXIS_RIGHT_TRIGGER, 0.2f, 1.0f, 1.0f, TRUE);
+	vigem_transform_remap_x360_button(transform, XUSB_GAMEPAD_A, XUSB_GAMEPAD_B);
+	vigem_transform_remap_ds4_button(transform, DS4_BUTTON_CROSS, DS4_BUTTON_CIRCLE);
+
+	//
+	// Every set_axis call marks the tables dirty, so each run recompiles them
+	// 
+	const auto compile = Measure(20, [&]
+	{
+		vigem_transform_set_axis(transform, VIGEM_TRANSFORM_AXIS_LEFT_X, 0.1f, 0.9f, 2.0f, FALSE);
+		vigem_transform_apply_x360(transform, xusb.data(), 1);
+		vigem_transform_apply_ds4(transform, ds4.data(), 1);
+	});
+
+	const auto x360 = Measure(ITERATIONS, [&]
+	{
+		vigem_transform_apply_x360(transform, xusb.data(), BATCH_SIZE);
+	});
+
+	const auto dualShock = Measure(ITERATIONS, [&]
+	{
+		vigem_transform_apply_ds4(transform, ds4.data(), BATCH_SIZE);
+	});
+
+	printf("%-28s %10.2f us\n", "Compile tables", compile / 1000.0);
+	printf("%-28s %10.2f ns/report\n", "vigem_transform_apply_x360", x360 / BATCH_SIZE);
+	printf("%-28s %10.2f ns/report\n", "vigem_transform_apply_ds4", dualShock / BATCH_SIZE);
+
+	vigem_transform_free(transform);
+
+	return 0;
+}
@@ -0,0 +1,280 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Host tests of the SDK input transform pipeline
+// 
+
+#include <Windows.h>
+#include <ViGEm/km/BusShared.h>
+#include <ViGEm/Client.h>
+
+#include <cmath>
+
+#include "HostTest.hpp"
+
+HOST_TEST(IdentityTransformLeavesX360ReportsUnchanged)
+{
+	const auto transform = vigem_transform_alloc();
+	static XUSB_REPORT reports[0x10000];
+	ULONG mismatches = 0;
+
+	for (ULONG index = 0; index < ARRAYSIZE(reports); index++)
+	{
+		reports[index].wButtons = static_cast<USHORT>(index);
+		reports[index].bLeftTrigger = static_cast<BYTE>(index);
+		reports[index].bRightTrigger = static_cast<BYTE>(index >> 8);
+		reports[index].sThumbLX = static_cast<SHORT>(index);
+		reports[index].sThumbLY = static_cast<SHORT>(~index);
+		reports[index].sThumbRX = static_cast<SHORT>(index * 3);
+		reports[index].sThumbRY = static_cast<SHORT>(index * 257);
+	}
+
+	CHECK_EQUAL(vigem_transform_apply_x360(transform, reports, ARRAYSIZE(reports)), VIGEM_ERROR_NONE);
+
+	for (ULONG index = 0; index < ARRAYSIZE(reports); index++)
+	{
+		mismatches += reports[index].wButtons != static_cast<USHORT>(index)
+			|| reports[index].bLeftTrigger != static_cast<BYTE>(index)
+			|| reports[index].bRightTrigger != static_cast<BYTE>(index >> 8)
+			|| reports[index].sThumbLX != static_cast<SHORT>(index)
+			|| reports[index].sThumbLY != static_cast<SHORT>(~index)
+			|| reports[index].sThumbRX != static_cast<SHORT>(index * 3)
+			|| reports[index].sThumbRY != static_cast<SHORT>(index * 257);
+	}
+
+	CHECK_EQUAL(mismatches, 0);
+
+	vigem_transform_free(transform);
+}
+
+HOST_TEST(IdentityTransformLeavesDs4ReportsUnchanged)
+{
+	const auto transform = vigem_transform_alloc();
+	DS4_REPORT_EX reports[0x100], expected[0x100];
+
+	for (ULONG index = 0; index < ARRAYSIZE(reports); index++)
+	{
+		for (ULONG offset = 0; offset < sizeof(reports[index].ReportBuffer); offset++)
+			reports[index].ReportBuffer[offset] = static_cast<UCHAR>(index * 7 + offset);
+
+		expected[index] = reports[index];
+	}
+
+	CHECK_EQUAL(vigem_transform_apply_ds4(transform, reports, ARRAYSIZE(reports)), VIGEM_ERROR_NONE);
+	CHECK(memcmp(reports, expected, sizeof(reports)) == 0);
+
+	vigem_transform_free(transform);
+}
+
+HOST_TEST(X360StickFollowsDeadzoneSaturationAndCurve)
+{
+	static const struct
+	{
+		SHORT Input;
+		SHORT Output;
+	} cases[] = {
+		{ -32768, -32768 },
+		{ -29491, -32768 },
+		{ -16384, -8192 },
+		{ -3276, 0 },
+		{ 0, 0 },
+		{ 16384, 8192 },
+		{ 29491, 32767 },
+		{ 32767, 32767 },
+	};
+
+	const auto transform = vigem_transform_alloc();
+	XUSB_REPORT report{};
+
+	CHECK_EQUAL(vigem_transform_set_axis(transform, VIGEM_TRANSFORM_AXIS_LEFT_X, 0.1f, 0.9f, 2.0f, FALSE), VIGEM_ERROR_NONE);
+
+	for (const auto& entry : cases)
+	{
+		report.sThumbLX = entry.Input;
+		report.sThumbRX = entry.Input;
+
+		vigem_transform_apply_x360(transform, &report, 1);
+
+		CHECK_EQUAL(report.sThumbLX, entry.Output);
+		CHECK_EQUAL(report.sThumbRX, entry.Input);
+	}
+
+	vigem_transform_free(transform);
+}
+
+HOST_TEST(X360TriggerFollowsDeadzoneAndInversion)
+{
+	static const struct
+	{
+		BYTE Input;
+		BYTE Output;
+	} cases[] = {
+		{ 0, 255 },
+		{ 51, 255 },
+		{ 52, 254 },
+		{ 128, 159 },
+		{ 255, 0 },
+	};
+
+	const auto transform = vigem_transform_alloc();
+	XUSB_REPORT report{};
+
+	CHECK_EQUAL(vigem_transform_set_axis(transform, VIGEM_TRANSFORM_AXIS_LEFT_TRIGGER, 0.2f, 1.0f, 1.0f, TRUE), VIGEM_ERROR_NONE);
+
+	for (const auto& entry : cases)
+	{
+		report.bLeftTrigger = entry.Input;
+		report.bRightTrigger = entry.Input;
+
+		vigem_transform_apply_x360(transform, &report, 1);
+
+		CHECK_EQUAL(report.bLeftTrigger, entry.Output);
+		CHECK_EQUAL(report.bRightTrigger, entry.Input);
+	}
+
+	vigem_transform_free(transform);
+}
+
+HOST_TEST(X360ButtonsAreRemapped)
+{
+	const auto transform = vigem_transform_alloc();
+	XUSB_REPORT report{};
+
+	CHECK_EQUAL(vigem_transform_remap_x360_button(transform, XUSB_GAMEPAD_A, XUSB_GAMEPAD_B), VIGEM_ERROR_NONE);
+	CHECK_EQUAL(vigem_transform_remap_x360_button(transform, XUSB_GAMEPAD_B, XUSB_GAMEPAD_A), VIGEM_ERROR_NONE);
+	CHECK_EQUAL(vigem_transform_remap_x360_button(transform, XUSB_GAMEPAD_BACK, 0), VIGEM_ERROR_NONE);
+
+	report.wButtons = XUSB_GAMEPAD_A | XUSB_GAMEPAD_BACK | XUSB_GAMEPAD_DPAD_UP;
+	vigem_transform_apply_x360(transform, &report, 1);
+
+	CHECK_EQUAL(report.wButtons, XUSB_GAMEPAD_B | XUSB_GAMEPAD_DPAD_UP);
+
+	vigem_transform_free(transform);
+}
+
+HOST_TEST(Ds4StickFollowsDeadzoneSaturationAndCurve)
+{
+	static const struct
+	{
+		BYTE Input;
+		BYTE Output;
+	} cases[] = {
+		{ 0, 0 },
+		{ 10, 0 },
+		{ 64, 96 },
+		{ 115, 128 },
+		{ 128, 128 },
+		{ 141, 128 },
+		{ 192, 160 },
+		{ 250, 255 },
+		{ 255, 255 },
+	};
+
+	const auto transform = vigem_transform_alloc();
+	DS4_REPORT_EX report{};
+
+	CHECK_EQUAL(vigem_transform_set_axis(transform, VIGEM_TRANSFORM_AXIS_LEFT_X, 0.1f, 0.9f, 2.0f, FALSE), VIGEM_ERROR_NONE);
+
+	for (const auto& entry : cases)
+	{
+		report.Report.bThumbLX = entry.Input;
+		report.Report.bThumbRX = entry.Input;
+
+		vigem_transform_apply_ds4(transform, &report, 1);
+
+		CHECK_EQUAL(report.Report.bThumbLX, entry.Output);
+		CHECK_EQUAL(report.Report.bThumbRX, entry.Input);
+	}
+
+	vigem_transform_free(transform);
+}
+
+HOST_TEST(Ds4ButtonsAreRemappedAndDpadPassesThrough)
+{
+	const auto transform = vigem_transform_alloc();
+	DS4_REPORT_EX report{};
+
+	CHECK_EQUAL(vigem_transform_remap_ds4_button(transform, DS4_BUTTON_CROSS, DS4_BUTTON_CIRCLE | DS4_BUTTON_SQUARE), VIGEM_ERROR_NONE);
+
+	report.Report.wButtons = DS4_BUTTON_CROSS | DS4_BUTTON_DPAD_SOUTHWEST | DS4_BUTTON_OPTIONS;
+	vigem_transform_apply_ds4(transform, &report, 1);
+
+	CHECK_EQUAL(report.Report.wButtons, DS4_BUTTON_CIRCLE | DS4_BUTTON_SQUARE | DS4_BUTTON_DPAD_SOUTHWEST | DS4_BUTTON_OPTIONS);
+
+	vigem_transform_free(transform);
+}
+
+HOST_TEST(TransformRecompilesAfterChange)
+{
+	const auto transform = vigem_transform_alloc();
+	XUSB_REPORT report{};
+
+	report.sThumbLY = 1000;
+	vigem_transform_apply_x360(transform, &report, 1);
+	CHECK_EQUAL(report.sThumbLY, 1000);
+
+	CHECK_EQUAL(vigem_transform_set_axis(transform, VIGEM_TRANSFORM_AXIS_LEFT_Y, 0.0f, 1.0f, 1.0f, TRUE), VIGEM_ERROR_NONE);
+
+	vigem_transform_apply_x360(transform, &report, 1);
+	CHECK_EQUAL(report.sThumbLY, -1000);
+
+	vigem_transform_free(transform);
+}
+
+HOST_TEST(TransformRejectsInvalidParameters)
+{
+	const auto transform = vigem_transform_alloc();
+	XUSB_REPORT report{};
+
+	CHECK_EQUAL(vigem_transform_set_axis(nullptr, VIGEM_TRANSFORM_AXIS_LEFT_X, 0.0f, 1.0f, 1.0f, FALSE), VIGEM_ERROR_INVALID_PARAMETER);
+	CHECK_EQUAL(vigem_transform_set_axis(transform, VIGEM_TRANSFORM_AXIS_COUNT, 0.0f, 1.0f, 1.0f, FALSE), VIGEM_ERROR_INVALID_PARAMETER);
+	CHECK_EQUAL(vigem_transform_set_axis(transform, VIGEM_TRANSFORM_AXIS_LEFT_X, 0.5f, 0.5f, 1.0f, FALSE), VIGEM_ERROR_INVALID_PARAMETER);
+	CHECK_EQUAL(vigem_transform_set_axis(transform, VIGEM_TRANSFORM_AXIS_LEFT_X, 0.0f, 1.5f, 1.0f, FALSE), VIGEM_ERROR_INVALID_PARAMETER);
+	CHECK_EQUAL(vigem_transform_set_axis(transform, VIGEM_TRANSFORM_AXIS_LEFT_X, 0.0f, 1.0f, 0.0f, FALSE), VIGEM_ERROR_INVALID_PARAMETER);
+	CHECK_EQUAL(vigem_transform_set_axis(transform, VIGEM_TRANSFORM_AXIS_LEFT_X, 0.0f, 1.0f, NAN, FALSE), VIGEM_ERROR_INVALID_PARAMETER);
+
+	CHECK_EQUAL(vigem_transform_remap_x360_button(transform, XUSB_GAMEPAD_A | XUSB_GAMEPAD_B, 0), VIGEM_ERROR_INVALID_PARAMETER);
+	CHECK_EQUAL(vigem_transform_remap_x360_button(transform, 0x0800, 0), VIGEM_ERROR_INVALID_PARAMETER);
+	CHECK_EQUAL(vigem_transform_remap_ds4_button(transform, DS4_BUTTON_DPAD_SOUTH, 0), VIGEM_ERROR_INVALID_PARAMETER);
+	CHECK_EQUAL(vigem_transform_remap_ds4_button(transform, DS4_BUTTON_CROSS, DS4_BUTTON_DPAD_EAST), VIGEM_ERROR_INVALID_PARAMETER);
+
+	CHECK_EQUAL(vigem_transform_apply_x360(transform, nullptr, 1), VIGEM_ERROR_INVALID_PARAMETER);
+	CHECK_EQUAL(vigem_transform_apply_x360(transform, nullptr, 0), VIGEM_ERROR_NONE);
+	CHECK_EQUAL(vigem_transform_apply_x360(nullptr, &report, 1), VIGEM_ERROR_INVALID_PARAMETER);
+	CHECK_EQUAL(vigem_transform_apply_ds4(nullptr, nullptr, 0), VIGEM_ERROR_INVALID_PARAMETER);
+
+	vigem_transform_free(transform);
+}
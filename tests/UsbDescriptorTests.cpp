@@ -0,0 +1,168 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Host tests of the USB descriptor helpers and tables
+// 
+
+#include <Windows.h>
+
+#include "UsbDescriptor.hpp"
+#include "XusbDescriptors.hpp"
+#include "Ds4Descriptors.hpp"
+
+#include "BaselineDescriptors.hpp"
+#include "HostTest.hpp"
+
+#include <cstring>
+
+using namespace ViGEm::Bus::Core;
+using namespace ViGEm::Bus::Targets;
+
+#pragma region Interval patch
+
+namespace
+{
+	template <size_t N>
+	struct PatchedDescriptor
+	{
+		UCHAR Data[N];
+
+		ULONG Patched;
+	};
+
+	template <size_t N>
+	constexpr PatchedDescriptor<N> PatchCopy(const UCHAR (&Descriptor)[N], UCHAR Interval)
+	{
+		PatchedDescriptor<N> copy{};
+
+		for (size_t index = 0; index < N; index++)
+			copy.Data[index] = Descriptor[index];
+
+		copy.Patched = usb_patch_interrupt_intervals(copy.Data, N, Interval);
+
+		return copy;
+	}
+
+	//
+	// Patching the real tables happens at compile time just as well
+	// 
+	constexpr auto XusbPatched = PatchCopy(XusbDescriptorData, 1);
+	constexpr auto Ds4Patched = PatchCopy(Ds4DescriptorData, 1);
+
+	static_assert(XusbPatched.Patched == 7, "XUSB has seven interrupt endpoints");
+	static_assert(Ds4Patched.Patched == 2, "DS4 has two interrupt endpoints");
+	static_assert(usb_is_valid_configuration_descriptor(XusbPatched.Data, sizeof(XusbPatched.Data)),
+		"Patched XUSB descriptor is malformed");
+	static_assert(usb_is_valid_configuration_descriptor(Ds4Patched.Data, sizeof(Ds4Patched.Data)),
+		"Patched DS4 descriptor is malformed");
+}
+
+HOST_TEST(DescriptorIntervalPatchTouchesInterruptEndpointsOnly)
+{
+	UCHAR xusb[sizeof(XusbDescriptorData)];
+	UCHAR ds4[sizeof(Ds4DescriptorData)];
+
+	memcpy(xusb, XusbDescriptorData, sizeof(xusb));
+	memcpy(ds4, Ds4DescriptorData, sizeof(ds4));
+
+	CHECK_EQUAL(usb_patch_interrupt_intervals(xusb, sizeof(xusb), 1), 7);
+	CHECK_EQUAL(usb_patch_interrupt_intervals(ds4, sizeof(ds4), 1), 2);
+
+	//
+	// Only bInterval bytes change
+	// 
+	ULONG changed = 0;
+
+	for (ULONG index = 0; index < sizeof(xusb); index++)
+		changed += (xusb[index] != XusbDescriptorData[index]);
+
+	CHECK_EQUAL(changed, 7);
+	CHECK(usb_is_valid_configuration_descriptor(xusb, sizeof(xusb)));
+}
+
+HOST_TEST(DescriptorIntervalPatchStopsAtMalformedDescriptor)
+{
+	UCHAR descriptor[] =
+	{
+		0x09, 0x02, 0x20, 0x00, 0x01, 0x01, 0x00, 0xA0, 0xFA, // Configuration
+		0x07, 0x05, 0x81, 0x03, 0x20, 0x00, 0x04,             // Interrupt IN
+		0x00, 0x05, 0x82, 0x03, 0x20, 0x00, 0x04,             // Zero length
+		0x07, 0x05, 0x83, 0x03, 0x20, 0x00, 0x04,             // Never reached
+	};
+
+	CHECK_EQUAL(usb_patch_interrupt_intervals(descriptor, sizeof(descriptor), 2), 1);
+	CHECK_EQUAL(descriptor[15], 2);
+	CHECK_EQUAL(descriptor[22], 4);
+	CHECK_EQUAL(descriptor[29], 4);
+}
+
+HOST_TEST(DescriptorIntervalPatchIgnoresTruncatedEndpoint)
+{
+	UCHAR descriptor[] =
+	{
+		0x09, 0x02, 0x10, 0x00, 0x01, 0x01, 0x00, 0xA0, 0xFA, // Configuration
+		0x07, 0x05, 0x81, 0x03, 0x20, 0x00, 0x04,             // Interrupt IN
+	};
+
+	//
+	// Last byte (bInterval) cut off
+	// 
+	CHECK_EQUAL(usb_patch_interrupt_intervals(descriptor, sizeof(descriptor) - 1, 1), 0);
+	CHECK_EQUAL(descriptor[15], 4);
+}
+
+#pragma endregion
+
+#pragma region Tables
+
+template <size_t N, size_t M>
+static void CheckSameBytes(const UCHAR (&Actual)[N], const UCHAR (&Expected)[M])
+{
+	if (CHECK_EQUAL(N, M))
+		CHECK(memcmp(Actual, Expected, N) == 0);
+}
+
+HOST_TEST(DescriptorTablesMatchBaseline)
+{
+	CheckSameBytes(XusbDescriptorData, Baseline::XusbConfiguration);
+	CheckSameBytes(Ds4DescriptorData, Baseline::Ds4Configuration);
+	CheckSameBytes(Ds4HidReportDescriptor, Baseline::Ds4HidReport);
+	CheckSameBytes(UsbLanguageIdDescriptor, Baseline::LanguageId);
+	CheckSameBytes(Ds4ManufacturerString.Data, Baseline::Ds4Manufacturer);
+	CheckSameBytes(Ds4ProductString.Data, Baseline::Ds4Product);
+}
+
+#pragma endregion
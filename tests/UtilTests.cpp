@@ -0,0 +1,313 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Host tests of the report converters in ViGEm/Util.h
+// 
+
+#include <Windows.h>
+#include <ViGEm/Util.h>
+
+#include "BaselineUtil.hpp"
+#include "HostTest.hpp"
+
+//
+// Output states the converters have to add to; hats and buttons already set
+// 
+static void PrefillOutput(ULONG Index, PDS4_REPORT Output)
+{
+	DS4_REPORT_INIT(Output);
+
+	if (Index == 0)
+		return;
+
+	Output->wButtons = static_cast<USHORT>((0x1230 * Index) & 0xFFF0);
+	Output->bSpecial = static_cast<BYTE>(Index & 0x03);
+	Output->bThumbLX = static_cast<BYTE>(Index * 31);
+	Output->bTriggerR = static_cast<BYTE>(Index * 17);
+
+	DS4_SET_DPAD(Output, static_cast<DS4_DPAD_DIRECTIONS>((Index - 1) % 9));
+}
+
+static const ULONG PREFILLED_OUTPUTS = 19;
+
+//
+// Field-wise, DS4_REPORT has a padding byte memcmp would pick up
+// 
+static bool SameReport(const DS4_REPORT* Left, const DS4_REPORT* Right)
+{
+	return Left->bThumbLX == Right->bThumbLX
+		&& Left->bThumbLY == Right->bThumbLY
+		&& Left->bThumbRX == Right->bThumbRX
+		&& Left->bThumbRY == Right->bThumbRY
+		&& Left->wButtons == Right->wButtons
+		&& Left->bSpecial == Right->bSpecial
+		&& Left->bTriggerL == Right->bTriggerL
+		&& Left->bTriggerR == Right->bTriggerR;
+}
+
+HOST_TEST(XusbToDs4ReportMatchesBaselineWithPrefilledOutput)
+{
+	ULONG mismatches = 0;
+
+	for (ULONG buttons = 0; buttons <= 0xFFFF; buttons++)
+	{
+		XUSB_REPORT input{};
+
+		input.wButtons = static_cast<USHORT>(buttons);
+		input.bLeftTrigger = static_cast<BYTE>(buttons);
+		input.bRightTrigger = static_cast<BYTE>(buttons >> 8);
+		input.sThumbLX = static_cast<SHORT>(buttons * 7);
+		input.sThumbLY = static_cast<SHORT>(buttons * 13);
+		input.sThumbRX = static_cast<SHORT>(~buttons);
+		input.sThumbRY = static_cast<SHORT>(buttons);
+
+		for (ULONG prefill = 0; prefill < PREFILLED_OUTPUTS; prefill++)
+		{
+			DS4_REPORT expected, actual;
+
+			PrefillOutput(prefill, &expected);
+			PrefillOutput(prefill, &actual);
+
+			Baseline::XusbToDs4Report(&input, &expected);
+			XUSB_TO_DS4_REPORT(&input, &actual);
+
+			mismatches += !SameReport(&expected, &actual);
+		}
+	}
+
+	CHECK_EQUAL(mismatches, 0);
+}
+
+HOST_TEST(XusbToDs4ReportMatchesBaselineForEveryAxisValue)
+{
+	ULONG mismatches = 0;
+
+	for (LONG value = SHRT_MIN; value <= SHRT_MAX; value++)
+	{
+		XUSB_REPORT input{};
+		DS4_REPORT expected, actual;
+
+		input.sThumbLX = input.sThumbLY = input.sThumbRX = input.sThumbRY = static_cast<SHORT>(value);
+
+		DS4_REPORT_INIT(&expected);
+		DS4_REPORT_INIT(&actual);
+
+		Baseline::XusbToDs4Report(&input, &expected);
+		XUSB_TO_DS4_REPORT(&input, &actual);
+
+		mismatches += !SameReport(&expected, &actual);
+	}
+
+	CHECK_EQUAL(mismatches, 0);
+}
+
+HOST_TEST(XusbToDs4ReportKeepsHatWithoutDpadInput)
+{
+	XUSB_REPORT input{};
+	DS4_REPORT output;
+
+	DS4_REPORT_INIT(&output);
+	output.wButtons = 0x1234;
+	input.wButtons = XUSB_GAMEPAD_A;
+
+	XUSB_TO_DS4_REPORT(&input, &output);
+
+	CHECK_EQUAL(output.wButtons, 0x1234 | DS4_BUTTON_CROSS);
+
+	input.wButtons = XUSB_GAMEPAD_DPAD_UP | XUSB_GAMEPAD_DPAD_RIGHT;
+
+	XUSB_TO_DS4_REPORT(&input, &output);
+
+	CHECK_EQUAL(output.wButtons & 0xF, DS4_BUTTON_DPAD_NORTHEAST);
+}
+
+HOST_TEST(XusbToDs4MatchesBaselineButtonsOnFreshOutput)
+{
+	ULONG mismatches = 0;
+
+	for (ULONG buttons = 0; buttons <= 0xFFFF; buttons++)
+	{
+		XUSB_REPORT input{};
+		DS4_REPORT expected, actual;
+
+		input.wButtons = static_cast<USHORT>(buttons);
+		input.bLeftTrigger = static_cast<BYTE>(buttons);
+		input.bRightTrigger = static_cast<BYTE>(buttons >> 8);
+
+		DS4_REPORT_INIT(&expected);
+		Baseline::XusbToDs4Report(&input, &expected);
+
+		memset(&actual, 0xCD, sizeof(actual));
+		XUSB_TO_DS4(&input, &actual);
+
+		mismatches += (expected.wButtons != actual.wButtons
+			|| expected.bSpecial != actual.bSpecial
+			|| expected.bTriggerL != actual.bTriggerL
+			|| expected.bTriggerR != actual.bTriggerR);
+	}
+
+	CHECK_EQUAL(mismatches, 0);
+}
+
+HOST_TEST(XusbToDs4CentersAndSaturatesSticks)
+{
+	XUSB_REPORT input{};
+	DS4_REPORT output;
+
+	XUSB_TO_DS4(&input, &output);
+
+	CHECK_EQUAL(output.bThumbLX, 0x80);
+	CHECK_EQUAL(output.bThumbLY, 0x80);
+
+	input.sThumbLX = SHRT_MIN;
+	input.sThumbLY = SHRT_MIN;
+	input.sThumbRX = SHRT_MAX;
+	input.sThumbRY = SHRT_MAX;
+
+	XUSB_TO_DS4(&input, &output);
+
+	CHECK_EQUAL(output.bThumbLX, 0x00);
+	CHECK_EQUAL(output.bThumbLY, 0xFF);
+	CHECK_EQUAL(output.bThumbRX, 0xFF);
+	CHECK_EQUAL(output.bThumbRY, 0x00);
+}
+
+HOST_TEST(Ds4ToXusbRoundTripsThroughXusbToDs4)
+{
+	ULONG mismatches = 0;
+
+	for (ULONG value = 0; value <= 0xFF; value++)
+	{
+		DS4_REPORT input, output;
+		XUSB_REPORT translated;
+
+		DS4_REPORT_INIT(&input);
+		input.bThumbLX = input.bThumbLY = input.bThumbRX = input.bThumbRY = static_cast<BYTE>(value);
+		input.bTriggerL = static_cast<BYTE>(value);
+		input.bTriggerR = static_cast<BYTE>(~value);
+
+		//
+		// Every button but the trigger ones, with each valid hat value
+		// 
+		input.wButtons = static_cast<USHORT>((((value << 8) | value) & 0xF3F0) | (value % 9));
+		input.bSpecial = static_cast<BYTE>(value & DS4_SPECIAL_BUTTON_PS);
+
+		//
+		// Trigger buttons follow the analog values after a round trip
+		// 
+		input.wButtons |= (input.bTriggerL ? DS4_BUTTON_TRIGGER_LEFT : 0) | (input.bTriggerR ? DS4_BUTTON_TRIGGER_RIGHT : 0);
+
+		DS4_TO_XUSB(&input, &translated);
+		XUSB_TO_DS4(&translated, &output);
+
+		mismatches += !SameReport(&input, &output);
+	}
+
+	CHECK_EQUAL(mismatches, 0);
+}
+
+//
+// Pre-filled outputs must not leak into the batch results
+// 
+HOST_TEST(XusbToDs4ReportsMatchesBaselineWithPrefilledOutput)
+{
+	static XUSB_REPORT input[0x10000];
+	static DS4_REPORT actual[0x10000];
+	ULONG mismatches = 0;
+
+	for (ULONG index = 0; index < ARRAYSIZE(input); index++)
+	{
+		input[index].wButtons = static_cast<USHORT>(index);
+		input[index].bLeftTrigger = static_cast<BYTE>(index * 7);
+		input[index].bRightTrigger = static_cast<BYTE>(index >> 8);
+		input[index].sThumbLX = static_cast<SHORT>(index * 3);
+		input[index].sThumbLY = static_cast<SHORT>(~index);
+		input[index].sThumbRX = static_cast<SHORT>(index * 257);
+		input[index].sThumbRY = static_cast<SHORT>(index << 1);
+
+		PrefillOutput(index % PREFILLED_OUTPUTS, &actual[index]);
+	}
+
+	XUSB_TO_DS4_REPORTS(input, actual, ARRAYSIZE(input));
+
+	for (ULONG index = 0; index < ARRAYSIZE(input); index++)
+	{
+		DS4_REPORT expected;
+
+		DS4_REPORT_INIT(&expected);
+		Baseline::XusbToDs4Report(&input[index], &expected);
+
+		mismatches += !SameReport(&expected, &actual[index]);
+	}
+
+	CHECK_EQUAL(mismatches, 0);
+}
+
+HOST_TEST(Ds4ToXusbReportsMatchesSingleConversionWithPrefilledOutput)
+{
+	static DS4_REPORT input[0x10000];
+	static XUSB_REPORT actual[0x10000];
+	ULONG mismatches = 0;
+
+	for (ULONG index = 0; index < ARRAYSIZE(input); index++)
+	{
+		DS4_REPORT_INIT(&input[index]);
+		input[index].wButtons = static_cast<USHORT>((index & 0xFFF0) | (index % 9));
+		input[index].bSpecial = static_cast<BYTE>(index & 0x03);
+		input[index].bThumbLX = static_cast<BYTE>(index);
+		input[index].bThumbLY = static_cast<BYTE>(index >> 8);
+		input[index].bThumbRX = static_cast<BYTE>(index * 3);
+		input[index].bThumbRY = static_cast<BYTE>(~index);
+		input[index].bTriggerL = static_cast<BYTE>(index * 5);
+		input[index].bTriggerR = static_cast<BYTE>(index >> 4);
+
+		memset(&actual[index], static_cast<int>(index), sizeof(XUSB_REPORT));
+	}
+
+	DS4_TO_XUSB_REPORTS(input, actual, ARRAYSIZE(input));
+
+	for (ULONG index = 0; index < ARRAYSIZE(input); index++)
+	{
+		XUSB_REPORT expected;
+
+		memset(&expected, 0xCD, sizeof(expected));
+		DS4_TO_XUSB(&input[index], &expected);
+
+		mismatches += (memcmp(&expected, &actual[index], sizeof(XUSB_REPORT)) != 0);
+	}
+
+	CHECK_EQUAL(mismatches, 0);
+}
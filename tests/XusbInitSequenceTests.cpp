@@ -0,0 +1,170 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Host tests of the shared XUSB init sequence tables
+// 
+
+#include <Windows.h>
+#include <ViGEm/Common.h>
+
+#include "UsbDescriptor.hpp"
+#include "XusbDescriptors.hpp"
+#include "XusbInitSequence.hpp"
+#include "Ds4Descriptors.hpp"
+
+#include "BaselineDescriptors.hpp"
+#include "HostTest.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+using namespace ViGEm::Bus::Targets;
+
+#pragma region Init sequence
+
+HOST_TEST(XusbInitTablesMatchBlobStorage)
+{
+	for (ULONG stage = 0; stage < ARRAYSIZE(XusbInitSequence); stage++)
+	{
+		const auto& entry = XusbInitSequence[stage];
+
+		CHECK(Baseline::XusbBlobOffsets[stage] + entry.Length <= sizeof(Baseline::XusbBlobStorage));
+		CHECK(memcmp(entry.Data, &Baseline::XusbBlobStorage[Baseline::XusbBlobOffsets[stage]], entry.Length) == 0);
+	}
+
+	CHECK(memcmp(XusbCapabilities, &Baseline::XusbBlobStorage[Baseline::XusbBlobOffsets[6]], sizeof(XusbCapabilities)) == 0);
+	CHECK(memcmp(XusbXenonMagic, &Baseline::XusbBlobStorage[Baseline::XusbBlobOffsets[7]], sizeof(XusbXenonMagic)) == 0);
+}
+
+HOST_TEST(XusbInitSequenceFitsDataPipe)
+{
+	//
+	// wMaxPacketSize of the data pipe (endpoint 0x81) in the configuration descriptor
+	// 
+	const ULONG maxPacketSize = XusbDescriptorData[39] | (XusbDescriptorData[40] << 8);
+	UCHAR transfer[64];
+	ULONG served = 0;
+
+	CHECK_EQUAL(XusbDescriptorData[37], 0x81);
+	CHECK_EQUAL(XusbInitPacketSize, 2 + sizeof(XUSB_REPORT));
+
+	//
+	// Replays the boot like the interrupt handler does, one stage per pending request
+	// 
+	for (const auto& stage : XusbInitSequence)
+	{
+		if (!CHECK(stage.Length <= maxPacketSize))
+			continue;
+
+		memset(transfer, 0xCC, sizeof(transfer));
+		memcpy(transfer, stage.Data, stage.Length);
+
+		CHECK_EQUAL(transfer[stage.Length], 0xCC);
+		served++;
+	}
+
+	CHECK_EQUAL(served, VigemBootPhaseInitStage5 - VigemBootPhaseInitStage0 + 1);
+
+	//
+	// Stage 4 is the empty input packet: report Id 0, Size 0x14
+	// 
+	CHECK_EQUAL(XusbInitSequence[4].Data[0], 0x00);
+	CHECK_EQUAL(XusbInitSequence[4].Data[1], 0x14);
+}
+
+#pragma endregion
+
+#pragma region Memory footprint
+
+namespace
+{
+	struct TargetFootprint
+	{
+		const char* Name;
+
+		//
+		// Non-paged bytes every plug-in allocates for constant data
+		// 
+		ULONG PerTargetBytes;
+
+		//
+		// Read-only image bytes shared by all targets of the type
+		// 
+		ULONG SharedBytes;
+	};
+
+	constexpr ULONG XusbSharedInitBytes()
+	{
+		ULONG bytes = sizeof(XusbInitSequence) + sizeof(XusbCapabilities) + sizeof(XusbXenonMagic);
+
+		for (const auto& stage : XusbInitSequence)
+			bytes += (stage.Data == XusbInitStage4) ? sizeof(XusbInitStage4) : stage.Length;
+
+		return bytes;
+	}
+}
+
+HOST_TEST(TargetFootprintReport)
+{
+	const TargetFootprint footprints[] =
+	{
+		{ "Baseline XUSB", sizeof(Baseline::XusbBlobStorage), sizeof(Baseline::XusbConfiguration) },
+		{ "XUSB", 0, XusbSharedInitBytes() + sizeof(XusbDescriptorData) },
+		{ "DS4", 0, sizeof(Ds4DescriptorData) + sizeof(Ds4HidReportDescriptor) 
+			+ Ds4ManufacturerString.Size + Ds4ProductString.Size },
+	};
+	const ULONG targets[] = { 1, 16, 256 };
+
+	for (const auto& footprint : footprints)
+	{
+		for (const auto count : targets)
+		{
+			printf("%-14s %3lu targets: %6lu per-target bytes, %4lu shared bytes\n",
+			       footprint.Name,
+			       static_cast<unsigned long>(count),
+			       static_cast<unsigned long>(footprint.PerTargetBytes * count),
+			       static_cast<unsigned long>(footprint.SharedBytes));
+		}
+	}
+
+	//
+	// Constant data must not come back as a per-target allocation
+	// 
+	CHECK_EQUAL(footprints[1].PerTargetBytes, 0);
+	CHECK_EQUAL(footprints[2].PerTargetBytes, 0);
+}
+
+#pragma endregion
@@ -0,0 +1,144 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Just enough of the Windows headers to compile the portable driver and SDK
+// headers on a POSIX host. Not a general replacement.
+// 
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <climits>
+
+typedef void VOID, *PVOID, *LPVOID;
+typedef char CHAR, *PCHAR;
+typedef unsigned char UCHAR, BYTE, BOOLEAN, *PUCHAR, *PBYTE;
+typedef int16_t SHORT, *PSHORT;
+typedef uint16_t USHORT, WORD, *PUSHORT;
+typedef int32_t LONG, BOOL, *PLONG;
+typedef uint32_t ULONG, DWORD, *PULONG;
+typedef int64_t LONGLONG;
+typedef uint64_t ULONGLONG;
+typedef uintptr_t ULONG_PTR, DWORD_PTR, SIZE_T;
+typedef void* HANDLE;
+typedef void (*FARPROC)();
+
+typedef struct _OVERLAPPED
+{
+    ULONG_PTR Internal;
+    ULONG_PTR InternalHigh;
+    ULONGLONG Offset;
+    HANDLE hEvent;
+} OVERLAPPED, *LPOVERLAPPED;
+
+typedef struct _GUID
+{
+    ULONG Data1;
+    USHORT Data2;
+    USHORT Data3;
+    UCHAR Data4[8];
+} GUID;
+
+#define TRUE    1
+#define FALSE   0
+
+#define MAXULONG    0xffffffff
+
+#define IN
+#define OUT
+#define CALLBACK
+#define FORCEINLINE inline
+#define _In_
+#define _In_opt_
+#define _Out_
+#define _Out_opt_
+#define _Inout_
+#define _In_reads_(n)
+#define _Out_writes_(n)
+#define _Function_class_(n)
+
+#define C_ASSERT(e)         static_assert(e, #e)
+#define FIELD_OFFSET(t, f)  offsetof(t, f)
+#define ARRAYSIZE(a)        (sizeof(a) / sizeof((a)[0]))
+
+#define DEFINE_GUID(name, l, w1, w2, b1, b2, b3, b4, b5, b6, b7, b8) \
+    static const GUID name = { l, w1, w2, { b1, b2, b3, b4, b5, b6, b7, b8 } }
+
+#define CTL_CODE(type, function, method, access) \
+    (((type) << 16) | ((access) << 14) | ((function) << 2) | (method))
+#define FILE_DEVICE_BUS_EXTENDER    0x0000002A
+#define METHOD_BUFFERED             0
+#define METHOD_OUT_DIRECT           2
+#define FILE_ANY_ACCESS             0
+#define FILE_READ_DATA              0x0001
+#define FILE_WRITE_DATA             0x0002
+
+#define RtlZeroMemory(d, n)     memset((d), 0, (n))
+#define RtlCopyMemory(d, s, n)  memcpy((d), (s), (n))
+#define RtlCopyBytes            RtlCopyMemory
+#define RtlEqualMemory(a, b, n) (memcmp((a), (b), (n)) == 0)
+#define CopyMemory              RtlCopyMemory
+#define ZeroMemory              RtlZeroMemory
+
+#define MemoryBarrier()         __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+inline LONG InterlockedExchange(volatile LONG* Target, LONG Value)
+{
+    return __atomic_exchange_n(Target, Value, __ATOMIC_SEQ_CST);
+}
+
+inline LONG InterlockedCompareExchange(volatile LONG* Target, LONG Exchange, LONG Comparand)
+{
+    __atomic_compare_exchange_n(Target, &Comparand, Exchange, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    return Comparand;
+}
+
+inline LONG InterlockedOr(volatile LONG* Target, LONG Value)
+{
+    return __atomic_fetch_or(Target, Value, __ATOMIC_SEQ_CST);
+}
+
+inline LONG InterlockedIncrement(volatile LONG* Target)
+{
+    return __atomic_add_fetch(Target, 1, __ATOMIC_SEQ_CST);
+}
+
+inline LONG InterlockedDecrement(volatile LONG* Target)
+{
+    return __atomic_sub_fetch(Target, 1, __ATOMIC_SEQ_CST);
+}
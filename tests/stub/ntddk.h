@@ -0,0 +1,150 @@
+/*
+* Virtual Gamepad Emulation Framework - Windows kernel-mode bus driver
+*
+* BSD 3-Clause License
+*
+* Copyright (c) 2018-2020, Nefarius Software Solutions e.U. and Contributors
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Just enough of the kernel pool and lookaside list routines to run the
+// allocation helpers on a POSIX host. The lookaside list is a plain free list
+// bounded like the kernel's; assertion failures are counted, not fatal.
+// 
+
+#pragma once
+
+#include <Windows.h>
+
+#include <cstdlib>
+
+typedef LONG NTSTATUS;
+
+#define STATUS_SUCCESS              ((NTSTATUS)0x00000000L)
+#define STATUS_INSUFFICIENT_RESOURCES ((NTSTATUS)0xC000009AL)
+#define NT_SUCCESS(s)               (((NTSTATUS)(s)) >= 0)
+
+typedef enum _POOL_TYPE
+{
+    NonPagedPoolNx = 512
+} POOL_TYPE;
+
+inline LONG HostAssertionFailures;
+
+#define NT_ASSERTMSG(m, e)  ((void)((e) || (HostAssertionFailures++, false)))
+
+typedef struct _LOOKASIDE_LIST_EX
+{
+    struct _LOOKASIDE_ENTRY* FreeList;
+
+    size_t Size;
+
+    ULONG Depth;
+
+    ULONG TotalAllocates;
+
+    ULONG AllocateMisses;
+
+    ULONG TotalFrees;
+} LOOKASIDE_LIST_EX, *PLOOKASIDE_LIST_EX;
+
+struct _LOOKASIDE_ENTRY
+{
+    _LOOKASIDE_ENTRY* Next;
+};
+
+//
+// Kernel lookaside lists keep at most this many free blocks
+// 
+const ULONG HOST_LOOKASIDE_MAXIMUM_DEPTH = 256;
+
+inline NTSTATUS ExInitializeLookasideListEx(PLOOKASIDE_LIST_EX Lookaside, PVOID, PVOID, POOL_TYPE, ULONG,
+                                            size_t Size, ULONG, USHORT)
+{
+    *Lookaside = {};
+    Lookaside->Size = (Size < sizeof(_LOOKASIDE_ENTRY)) ? sizeof(_LOOKASIDE_ENTRY) : Size;
+
+    return STATUS_SUCCESS;
+}
+
+inline PVOID ExAllocateFromLookasideListEx(PLOOKASIDE_LIST_EX Lookaside)
+{
+    Lookaside->TotalAllocates++;
+
+    if (const auto entry = Lookaside->FreeList)
+    {
+        Lookaside->FreeList = entry->Next;
+        Lookaside->Depth--;
+
+        return entry;
+    }
+
+    Lookaside->AllocateMisses++;
+
+    return malloc(Lookaside->Size);
+}
+
+inline VOID ExFreeToLookasideListEx(PLOOKASIDE_LIST_EX Lookaside, PVOID Entry)
+{
+    Lookaside->TotalFrees++;
+
+    if (Lookaside->Depth == HOST_LOOKASIDE_MAXIMUM_DEPTH)
+    {
+        free(Entry);
+        return;
+    }
+
+    const auto entry = static_cast<_LOOKASIDE_ENTRY*>(Entry);
+
+    entry->Next = Lookaside->FreeList;
+    Lookaside->FreeList = entry;
+    Lookaside->Depth++;
+}
+
+inline VOID ExDeleteLookasideListEx(PLOOKASIDE_LIST_EX Lookaside)
+{
+    while (const auto entry = Lookaside->FreeList)
+    {
+        Lookaside->FreeList = entry->Next;
+        free(entry);
+    }
+
+    Lookaside->Depth = 0;
+}
+
+inline PVOID ExAllocatePoolWithTag(POOL_TYPE, size_t Size, ULONG)
+{
+    return malloc(Size);
+}
+
+inline VOID ExFreePoolWithTag(PVOID Entry, ULONG)
+{
+    free(Entry);
+}